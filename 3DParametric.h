@@ -0,0 +1,579 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "3DPlane.h"
+#include "AABB.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // The points origin + t * direction, t >= 0. direction need not be unit
+    // length; intersection distances are in units of it.
+    class Ray {
+    public:
+        Vector3 origin;
+        Vector3 direction;
+
+        Ray();
+        Ray(const Vector3& origin, const Vector3& direction);
+
+        Vector3 At(float t) const;
+        Vector3 ClosestPoint(const Vector3& p) const;
+    };
+
+    // The points point + t * direction for every t.
+    class Line {
+    public:
+        Vector3 point;
+        Vector3 direction;
+
+        Line();
+        Line(const Vector3& point, const Vector3& direction);
+
+        static Line FromPoints(const Vector3& a, const Vector3& b);
+
+        Vector3 ClosestPoint(const Vector3& p) const;
+        float Distance(const Vector3& p) const;
+    };
+
+    // The points between start (t = 0) and end (t = 1).
+    class Segment {
+    public:
+        Vector3 start;
+        Vector3 end;
+
+        Segment();
+        Segment(const Vector3& start, const Vector3& end);
+
+        Vector3 At(float t) const;
+        float Length() const;
+        Vector3 ClosestPoint(const Vector3& p) const;
+        float Distance(const Vector3& p) const;
+    };
+
+    /********************************************************************
+    // RAY INTERSECTION
+    //
+    // Each test returns true and the entry distance t in [0, tMax] when the
+    // ray hits. A ray starting inside a sphere or box hits it at t = 0.
+    // Triangles are two-sided.
+    ********************************************************************/
+    bool IntersectRay(const Ray& ray, const Plane& plane, float tMax, float& t);
+    bool IntersectRay(const Ray& ray, const Vector3& center, float radius, float tMax, float& t);
+    bool IntersectRay(const Ray& ray, const AABB& box, float tMax, float& t);
+    bool IntersectRay(const Ray& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float tMax, float& t);
+
+    // Non-owning views of rays and primitives stored as component arrays.
+    struct RayStreamView {
+        const float* originX;
+        const float* originY;
+        const float* originZ;
+        const float* directionX;
+        const float* directionY;
+        const float* directionZ;
+        size_t count;
+
+        RayStreamView(const float* originX, const float* originY, const float* originZ, const float* directionX, const float* directionY, const float* directionZ, size_t count)
+            : originX(originX)
+            , originY(originY)
+            , originZ(originZ)
+            , directionX(directionX)
+            , directionY(directionY)
+            , directionZ(directionZ)
+            , count(count)
+        {
+        }
+    };
+
+    struct TriangleStreamView {
+        Vector3StreamView v0;
+        Vector3StreamView v1;
+        Vector3StreamView v2;
+        size_t count;
+
+        TriangleStreamView(const Vector3StreamView& v0, const Vector3StreamView& v1, const Vector3StreamView& v2)
+            : v0(v0)
+            , v1(v1)
+            , v2(v2)
+            , count(v0.count)
+        {
+        }
+    };
+
+    struct PlaneStreamView {
+        const float* normalX;
+        const float* normalY;
+        const float* normalZ;
+        const float* d;
+        size_t count;
+
+        PlaneStreamView(const float* normalX, const float* normalY, const float* normalZ, const float* d, size_t count)
+            : normalX(normalX)
+            , normalY(normalY)
+            , normalZ(normalZ)
+            , d(d)
+            , count(count)
+        {
+        }
+    };
+
+    struct SphereStreamView {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* radius;
+        size_t count;
+
+        SphereStreamView(const float* x, const float* y, const float* z, const float* radius, size_t count)
+            : x(x)
+            , y(y)
+            , z(z)
+            , radius(radius)
+            , count(count)
+        {
+        }
+    };
+
+    /********************************************************************
+    // BATCH RAY INTERSECTION
+    //
+    // One ray against many primitives, or many rays against one. t[i]
+    // receives the distance of element i as IntersectRay would compute it,
+    // or INFINITY on a miss; the return value is the number of hits. Eight
+    // (AVX2) or four (SSE) elements are tested at a time.
+    ********************************************************************/
+    size_t IntersectTriangles(const Ray& ray, const TriangleStreamView& triangles, float tMax, float* t);
+    size_t IntersectPlanes(const Ray& ray, const PlaneStreamView& planes, float tMax, float* t);
+    size_t IntersectSpheres(const Ray& ray, const SphereStreamView& spheres, float tMax, float* t);
+    size_t IntersectAABBs(const Ray& ray, const AABBStreamView& boxes, float tMax, float* t);
+
+    size_t IntersectRays(const RayStreamView& rays, const Vector3& v0, const Vector3& v1, const Vector3& v2, float tMax, float* t);
+    size_t IntersectRays(const RayStreamView& rays, const Plane& plane, float tMax, float* t);
+    size_t IntersectRays(const RayStreamView& rays, const Vector3& center, float radius, float tMax, float* t);
+    size_t IntersectRays(const RayStreamView& rays, const AABB& box, float tMax, float* t);
+
+    inline Ray::Ray()
+        : origin(0.0f, 0.0f, 0.0f)
+        , direction(0.0f, 0.0f, 1.0f)
+    {
+    }
+
+    inline Ray::Ray(const Vector3& origin, const Vector3& direction)
+        : origin(origin)
+        , direction(direction)
+    {
+    }
+
+    inline Vector3 Ray::At(float t) const
+    {
+        return origin + direction * t;
+    }
+
+    inline Vector3 Ray::ClosestPoint(const Vector3& p) const
+    {
+        float t = DotProduct(p - origin, direction) / DotProduct(direction, direction);
+        return At(t > 0.0f ? t : 0.0f);
+    }
+
+    inline Line::Line()
+        : point(0.0f, 0.0f, 0.0f)
+        , direction(0.0f, 0.0f, 1.0f)
+    {
+    }
+
+    inline Line::Line(const Vector3& point, const Vector3& direction)
+        : point(point)
+        , direction(direction)
+    {
+    }
+
+    inline Line Line::FromPoints(const Vector3& a, const Vector3& b)
+    {
+        return Line(a, b - a);
+    }
+
+    inline Vector3 Line::ClosestPoint(const Vector3& p) const
+    {
+        return point + direction * (DotProduct(p - point, direction) / DotProduct(direction, direction));
+    }
+
+    inline float Line::Distance(const Vector3& p) const
+    {
+        return (p - ClosestPoint(p)).Magnitude();
+    }
+
+    inline Segment::Segment()
+        : start(0.0f, 0.0f, 0.0f)
+        , end(0.0f, 0.0f, 0.0f)
+    {
+    }
+
+    inline Segment::Segment(const Vector3& start, const Vector3& end)
+        : start(start)
+        , end(end)
+    {
+    }
+
+    inline Vector3 Segment::At(float t) const
+    {
+        return start + (end - start) * t;
+    }
+
+    inline float Segment::Length() const
+    {
+        return (end - start).Magnitude();
+    }
+
+    inline Vector3 Segment::ClosestPoint(const Vector3& p) const
+    {
+        Vector3 d = end - start;
+        float lengthSq = DotProduct(d, d);
+        if (lengthSq <= 0.0f)
+            return start;
+        float t = DotProduct(p - start, d) / lengthSq;
+        return At(t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t);
+    }
+
+    inline float Segment::Distance(const Vector3& p) const
+    {
+        return (p - ClosestPoint(p)).Magnitude();
+    }
+
+    namespace Detail {
+        // A point or direction as three lanes of components.
+        template <typename F>
+        struct Vec3Lanes {
+            F x, y, z;
+        };
+
+        template <typename F>
+        inline Vec3Lanes<F> LoadVec3(const float* x, const float* y, const float* z, size_t i, F lanes)
+        {
+            Vec3Lanes<F> v = { LoadLanes(x + i, lanes), LoadLanes(y + i, lanes), LoadLanes(z + i, lanes) };
+            return v;
+        }
+
+        template <typename F>
+        inline Vec3Lanes<F> BroadcastVec3(const Vector3& v, F lanes)
+        {
+            Vec3Lanes<F> r = { Broadcast(v.x, lanes), Broadcast(v.y, lanes), Broadcast(v.z, lanes) };
+            return r;
+        }
+
+        template <typename F>
+        inline Vec3Lanes<F> Sub(const Vec3Lanes<F>& a, const Vec3Lanes<F>& b)
+        {
+            Vec3Lanes<F> r = { Sub(a.x, b.x), Sub(a.y, b.y), Sub(a.z, b.z) };
+            return r;
+        }
+
+        template <typename F>
+        inline F Dot(const Vec3Lanes<F>& a, const Vec3Lanes<F>& b)
+        {
+            return MulAdd(a.x, b.x, MulAdd(a.y, b.y, Mul(a.z, b.z)));
+        }
+
+        template <typename F>
+        inline Vec3Lanes<F> Cross(const Vec3Lanes<F>& a, const Vec3Lanes<F>& b)
+        {
+            Vec3Lanes<F> r = { Sub(Mul(a.y, b.z), Mul(a.z, b.y)), Sub(Mul(a.z, b.x), Mul(a.x, b.z)), Sub(Mul(a.x, b.y), Mul(a.y, b.x)) };
+            return r;
+        }
+
+        // t where hit and 0 <= t <= tMax, INFINITY elsewhere. NaN lanes
+        // fail every comparison and so miss.
+        template <typename F, typename M>
+        inline F HitOrInfinity(M hit, F t, F tMax)
+        {
+            hit = And(hit, And(LessEqual(Broadcast(0.0f, t), t), LessEqual(t, tMax)));
+            return Select(hit, t, Broadcast(INFINITY, t));
+        }
+
+        // Moller-Trumbore, two-sided. A ray in the triangle's plane has
+        // det = 0 and misses through inf / NaN barycentrics.
+        template <typename F>
+        inline F RayTriangle(const Vec3Lanes<F>& o, const Vec3Lanes<F>& d, const Vec3Lanes<F>& v0, const Vec3Lanes<F>& v1, const Vec3Lanes<F>& v2, F tMax)
+        {
+            Vec3Lanes<F> e1 = Sub(v1, v0), e2 = Sub(v2, v0);
+            Vec3Lanes<F> p = Cross(d, e2);
+            F invDet = Div(Broadcast(1.0f, tMax), Dot(e1, p));
+            Vec3Lanes<F> s = Sub(o, v0);
+            F u = Mul(Dot(s, p), invDet);
+            Vec3Lanes<F> q = Cross(s, e1);
+            F v = Mul(Dot(d, q), invDet);
+            F t = Mul(Dot(e2, q), invDet);
+            F zero = Broadcast(0.0f, t);
+            return HitOrInfinity(And(And(LessEqual(zero, u), LessEqual(zero, v)), LessEqual(Add(u, v), Broadcast(1.0f, t))), t, tMax);
+        }
+
+        template <typename F>
+        inline F RayPlane(const Vec3Lanes<F>& o, const Vec3Lanes<F>& d, const Vec3Lanes<F>& n, F planeD, F tMax)
+        {
+            F t = Div(Sub(Broadcast(0.0f, tMax), Add(Dot(n, o), planeD)), Dot(n, d));
+            return HitOrInfinity(LessEqual(t, t), t, tMax);
+        }
+
+        // Roots of |o + t d - c|^2 = r^2; the near one, clamped to 0 when
+        // the origin is inside.
+        template <typename F>
+        inline F RaySphere(const Vec3Lanes<F>& o, const Vec3Lanes<F>& d, const Vec3Lanes<F>& center, F radius, F tMax)
+        {
+            Vec3Lanes<F> m = Sub(o, center);
+            F a = Dot(d, d), b = Dot(m, d);
+            F c = Sub(Dot(m, m), Mul(radius, radius));
+            F discriminant = Sub(Mul(b, b), Mul(a, c));
+            F root = Sqrt(Max(discriminant, Broadcast(0.0f, a)));
+            F invA = Div(Broadcast(1.0f, a), a);
+            F tFar = Mul(Sub(root, b), invA);
+            F tNear = Max(Mul(Sub(Sub(Broadcast(0.0f, a), b), root), invA), Broadcast(0.0f, a));
+            return HitOrInfinity(And(LessEqual(Broadcast(0.0f, a), discriminant), LessEqual(Broadcast(0.0f, a), tFar)), tNear, tMax);
+        }
+
+        // Slab test; NaNs from 0 * inf are dropped as in IntersectRay(AABB).
+        template <typename F>
+        inline F RayBox(const Vec3Lanes<F>& o, const Vec3Lanes<F>& invD, const Vec3Lanes<F>& lo, const Vec3Lanes<F>& hi, F tMax)
+        {
+            F t0 = Mul(Sub(lo.x, o.x), invD.x), t1 = Mul(Sub(hi.x, o.x), invD.x);
+            F enter = Max(Min(t0, t1), Broadcast(0.0f, tMax));
+            F exit = Min(Max(t0, t1), tMax);
+            t0 = Mul(Sub(lo.y, o.y), invD.y);
+            t1 = Mul(Sub(hi.y, o.y), invD.y);
+            enter = Max(Min(t0, t1), enter);
+            exit = Min(Max(t0, t1), exit);
+            t0 = Mul(Sub(lo.z, o.z), invD.z);
+            t1 = Mul(Sub(hi.z, o.z), invD.z);
+            enter = Max(Min(t0, t1), enter);
+            exit = Min(Max(t0, t1), exit);
+            return Select(LessEqual(enter, exit), enter, Broadcast(INFINITY, enter));
+        }
+
+        template <typename F>
+        inline Vec3Lanes<F> Reciprocal(const Vec3Lanes<F>& v)
+        {
+            F one = Broadcast(1.0f, v.x);
+            Vec3Lanes<F> r = { Div(one, v.x), Div(one, v.y), Div(one, v.z) };
+            return r;
+        }
+
+        // Stores hit(i, lanes) to t[i ..] for every element and counts the
+        // finite results.
+        template <typename F>
+        inline size_t StoreHits(F hit, size_t i, float* t)
+        {
+            const int lanes = sizeof(F) / sizeof(float);
+            StoreLanes(t + i, hit);
+            int hits = MoveMask(LessThan(hit, Broadcast(INFINITY, hit)));
+            size_t n = 0;
+            for (int k = 0; k < lanes; ++k)
+                n += (hits >> k) & 1;
+            return n;
+        }
+
+        template <typename Hit>
+        size_t EvaluateHits(const Hit& hit, size_t count, float* t)
+        {
+            size_t n = 0, i = 0;
+#if USING_AVX2
+            for (; i + 8 <= count; i += 8)
+                n += StoreHits(hit(i, _mm256_setzero_ps()), i, t);
+#elif USING_SSE
+            for (; i + 4 <= count; i += 4)
+                n += StoreHits(hit(i, _mm_setzero_ps()), i, t);
+#endif
+            for (; i < count; ++i)
+                n += StoreHits(hit(i, 0.0f), i, t);
+            return n;
+        }
+
+        // One ray against element i of a stream.
+        struct RayAgainstTriangles {
+            const Ray& ray;
+            const TriangleStreamView& triangles;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                const TriangleStreamView& s = triangles;
+                return RayTriangle(BroadcastVec3(ray.origin, lanes), BroadcastVec3(ray.direction, lanes), LoadVec3(s.v0.x, s.v0.y, s.v0.z, i, lanes),
+                    LoadVec3(s.v1.x, s.v1.y, s.v1.z, i, lanes), LoadVec3(s.v2.x, s.v2.y, s.v2.z, i, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RayAgainstPlanes {
+            const Ray& ray;
+            const PlaneStreamView& planes;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RayPlane(BroadcastVec3(ray.origin, lanes), BroadcastVec3(ray.direction, lanes), LoadVec3(planes.normalX, planes.normalY, planes.normalZ, i, lanes),
+                    LoadLanes(planes.d + i, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RayAgainstSpheres {
+            const Ray& ray;
+            const SphereStreamView& spheres;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RaySphere(BroadcastVec3(ray.origin, lanes), BroadcastVec3(ray.direction, lanes), LoadVec3(spheres.x, spheres.y, spheres.z, i, lanes),
+                    LoadLanes(spheres.radius + i, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RayAgainstAABBs {
+            const Ray& ray;
+            Vector3 invDirection;
+            const AABBStreamView& boxes;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RayBox(BroadcastVec3(ray.origin, lanes), BroadcastVec3(invDirection, lanes), LoadVec3(boxes.minX, boxes.minY, boxes.minZ, i, lanes),
+                    LoadVec3(boxes.maxX, boxes.maxY, boxes.maxZ, i, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        // Ray i of a stream against one primitive.
+        struct RaysAgainstTriangle {
+            const RayStreamView& rays;
+            Vector3 v0, v1, v2;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RayTriangle(LoadVec3(rays.originX, rays.originY, rays.originZ, i, lanes), LoadVec3(rays.directionX, rays.directionY, rays.directionZ, i, lanes),
+                    BroadcastVec3(v0, lanes), BroadcastVec3(v1, lanes), BroadcastVec3(v2, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RaysAgainstPlane {
+            const RayStreamView& rays;
+            const Plane& plane;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RayPlane(LoadVec3(rays.originX, rays.originY, rays.originZ, i, lanes), LoadVec3(rays.directionX, rays.directionY, rays.directionZ, i, lanes),
+                    BroadcastVec3(plane.normal, lanes), Broadcast(plane.d, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RaysAgainstSphere {
+            const RayStreamView& rays;
+            Vector3 center;
+            float radius, tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RaySphere(LoadVec3(rays.originX, rays.originY, rays.originZ, i, lanes), LoadVec3(rays.directionX, rays.directionY, rays.directionZ, i, lanes),
+                    BroadcastVec3(center, lanes), Broadcast(radius, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        struct RaysAgainstAABB {
+            const RayStreamView& rays;
+            const AABB& box;
+            float tMax;
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                return RayBox(LoadVec3(rays.originX, rays.originY, rays.originZ, i, lanes), Reciprocal(LoadVec3(rays.directionX, rays.directionY, rays.directionZ, i, lanes)),
+                    BroadcastVec3(box.minimum, lanes), BroadcastVec3(box.maximum, lanes), Broadcast(tMax, lanes));
+            }
+        };
+
+        inline bool FiniteHit(float hit, float& t)
+        {
+            if (!(hit < INFINITY))
+                return false;
+            t = hit;
+            return true;
+        }
+    } // end namespace Detail
+
+    inline bool IntersectRay(const Ray& ray, const Plane& plane, float tMax, float& t)
+    {
+        return Detail::FiniteHit(Detail::RayPlane(Detail::BroadcastVec3(ray.origin, 0.0f), Detail::BroadcastVec3(ray.direction, 0.0f), Detail::BroadcastVec3(plane.normal, 0.0f), plane.d, tMax), t);
+    }
+
+    inline bool IntersectRay(const Ray& ray, const Vector3& center, float radius, float tMax, float& t)
+    {
+        return Detail::FiniteHit(Detail::RaySphere(Detail::BroadcastVec3(ray.origin, 0.0f), Detail::BroadcastVec3(ray.direction, 0.0f), Detail::BroadcastVec3(center, 0.0f), radius, tMax), t);
+    }
+
+    inline bool IntersectRay(const Ray& ray, const AABB& box, float tMax, float& t)
+    {
+        Vector3 inv(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+        return IntersectRay(box, ray.origin, inv, tMax, t);
+    }
+
+    inline bool IntersectRay(const Ray& ray, const Vector3& v0, const Vector3& v1, const Vector3& v2, float tMax, float& t)
+    {
+        return Detail::FiniteHit(Detail::RayTriangle(Detail::BroadcastVec3(ray.origin, 0.0f), Detail::BroadcastVec3(ray.direction, 0.0f), Detail::BroadcastVec3(v0, 0.0f),
+                                     Detail::BroadcastVec3(v1, 0.0f), Detail::BroadcastVec3(v2, 0.0f), tMax),
+            t);
+    }
+
+    inline size_t IntersectTriangles(const Ray& ray, const TriangleStreamView& triangles, float tMax, float* t)
+    {
+        Detail::RayAgainstTriangles hit = { ray, triangles, tMax };
+        return Detail::EvaluateHits(hit, triangles.count, t);
+    }
+
+    inline size_t IntersectPlanes(const Ray& ray, const PlaneStreamView& planes, float tMax, float* t)
+    {
+        Detail::RayAgainstPlanes hit = { ray, planes, tMax };
+        return Detail::EvaluateHits(hit, planes.count, t);
+    }
+
+    inline size_t IntersectSpheres(const Ray& ray, const SphereStreamView& spheres, float tMax, float* t)
+    {
+        Detail::RayAgainstSpheres hit = { ray, spheres, tMax };
+        return Detail::EvaluateHits(hit, spheres.count, t);
+    }
+
+    inline size_t IntersectAABBs(const Ray& ray, const AABBStreamView& boxes, float tMax, float* t)
+    {
+        Vector3 inv(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+        Detail::RayAgainstAABBs hit = { ray, inv, boxes, tMax };
+        return Detail::EvaluateHits(hit, boxes.count, t);
+    }
+
+    inline size_t IntersectRays(const RayStreamView& rays, const Vector3& v0, const Vector3& v1, const Vector3& v2, float tMax, float* t)
+    {
+        Detail::RaysAgainstTriangle hit = { rays, v0, v1, v2, tMax };
+        return Detail::EvaluateHits(hit, rays.count, t);
+    }
+
+    inline size_t IntersectRays(const RayStreamView& rays, const Plane& plane, float tMax, float* t)
+    {
+        Detail::RaysAgainstPlane hit = { rays, plane, tMax };
+        return Detail::EvaluateHits(hit, rays.count, t);
+    }
+
+    inline size_t IntersectRays(const RayStreamView& rays, const Vector3& center, float radius, float tMax, float* t)
+    {
+        Detail::RaysAgainstSphere hit = { rays, center, radius, tMax };
+        return Detail::EvaluateHits(hit, rays.count, t);
+    }
+
+    inline size_t IntersectRays(const RayStreamView& rays, const AABB& box, float tMax, float* t)
+    {
+        Detail::RaysAgainstAABB hit = { rays, box, tMax };
+        return Detail::EvaluateHits(hit, rays.count, t);
+    }
+} // end namespace Math
+} // end namespace Oblivion
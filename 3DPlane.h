@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Vector3.h"
+
+namespace Oblivion {
+namespace Math {
+    // The plane DotProduct(normal, p) + d = 0. Points with a positive signed
+    // distance are in front of it (inside, for frustum planes).
+    class Plane {
+    public:
+        Vector3 normal;
+        float d;
+
+        Plane();
+        Plane(const Vector3& normal, const float& d);
+        Plane(const float& a, const float& b, const float& c, const float& d);
+
+        static Plane FromPointNormal(const Vector3& point, const Vector3& normal);
+        // Counter-clockwise a, b, c face the normal.
+        static Plane FromPoints(const Vector3& a, const Vector3& b, const Vector3& c);
+
+        // Exact distance only when the normal is unit length.
+        float SignedDistance(const Vector3& p) const;
+        // Scales the normal to unit length and d with it.
+        Plane& Normalize();
+    };
+
+    inline Plane::Plane()
+        : normal(0.0f, 0.0f, 1.0f)
+        , d(0.0f)
+    {
+    }
+
+    inline Plane::Plane(const Vector3& normal, const float& d)
+        : normal(normal)
+        , d(d)
+    {
+    }
+
+    inline Plane::Plane(const float& a, const float& b, const float& c, const float& d)
+        : normal(a, b, c)
+        , d(d)
+    {
+    }
+
+    inline Plane Plane::FromPointNormal(const Vector3& point, const Vector3& normal)
+    {
+        return Plane(normal, -DotProduct(normal, point));
+    }
+
+    inline Plane Plane::FromPoints(const Vector3& a, const Vector3& b, const Vector3& c)
+    {
+        Vector3 n = CrossProduct(b - a, c - a);
+        return FromPointNormal(a, Math::Normalize(n));
+    }
+
+    inline float Plane::SignedDistance(const Vector3& p) const
+    {
+        return DotProduct(normal, p) + d;
+    }
+
+    inline Plane& Plane::Normalize()
+    {
+        float length = normal.Magnitude();
+        if (length > 0.0f) {
+            float invLen = 1.0f / length;
+            normal = normal * invLen;
+            d *= invLen;
+        }
+
+        return *this;
+    }
+}
+}
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "BatchTransform.h"
+#include "MathFunctions.h"
+#include "Vector3.h"
+
+namespace Oblivion {
+namespace Math {
+    // Axis-aligned box between minimum and maximum, both inclusive. The
+    // default box is empty (minimum = +inf, maximum = -inf), so merging into
+    // it yields the other operand.
+    class AABB {
+    public:
+        Vector3 minimum;
+        Vector3 maximum;
+
+        AABB();
+        AABB(const Vector3& minimum, const Vector3& maximum);
+
+        static AABB FromCenterExtents(const Vector3& center, const Vector3& extents);
+
+        bool IsEmpty() const;
+        Vector3 Center() const;
+        // Half the size along each axis.
+        Vector3 Extents() const;
+        float SurfaceArea() const;
+        bool Contains(const Vector3& p) const;
+
+        AABB& Merge(const Vector3& p);
+        AABB& Merge(const AABB& box);
+    };
+
+    static_assert(sizeof(AABB) == 6 * sizeof(float), "the batch kernels load a box as six packed floats");
+
+    // Non-owning view of axis-aligned boxes stored as six component arrays.
+    struct AABBStreamView {
+        const float* minX;
+        const float* minY;
+        const float* minZ;
+        const float* maxX;
+        const float* maxY;
+        const float* maxZ;
+        size_t count;
+
+        AABBStreamView(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, size_t count)
+            : minX(minX)
+            , minY(minY)
+            , minZ(minZ)
+            , maxX(maxX)
+            , maxY(maxY)
+            , maxZ(maxZ)
+            , count(count)
+        {
+        }
+    };
+
+    AABB Union(const AABB& a, const AABB& b);
+    // Boxes that only touch intersect.
+    bool Intersects(const AABB& a, const AABB& b);
+
+    // Bounds of the box after the affine transform m (Arvo): the same result
+    // as transforming all eight corners, in about a quarter of the work.
+    // Empty boxes stay empty.
+    AABB TransformBounds(const AABB& box, const Matrix44& m);
+
+    // Slab test of the ray origin + t * direction, t in [0, tMax], taking
+    // invDirection = 1 / direction per component. On a hit tEntry is the
+    // parameter where the ray enters the box (0 when it starts inside).
+    // A ray lying exactly in a face plane of the box may be reported either way.
+    bool IntersectRay(const AABB& box, const Vector3& origin, const Vector3& invDirection, float tMax, float& tEntry);
+
+    /********************************************************************
+    // BATCH OPERATIONS
+    ********************************************************************/
+    // Union of boxes[0 .. count); empty for count == 0.
+    AABB Union(const AABB* boxes, size_t count);
+    // out[i] = Union(a[i], b[i]); out may alias a or b.
+    void Union(const AABB* a, const AABB* b, AABB* out, size_t count);
+
+    // Writes the indices of the boxes intersecting query to hits, in order,
+    // and returns how many there are. hits must have room for count indices.
+    size_t CollectOverlaps(const AABB& query, const AABB* boxes, size_t count, uint32_t* hits);
+    size_t CollectOverlaps(const AABB& query, const AABBStreamView& boxes, uint32_t* hits);
+
+    inline AABB::AABB()
+        : minimum(INFINITY, INFINITY, INFINITY)
+        , maximum(-INFINITY, -INFINITY, -INFINITY)
+    {
+    }
+
+    inline AABB::AABB(const Vector3& minimum, const Vector3& maximum)
+        : minimum(minimum)
+        , maximum(maximum)
+    {
+    }
+
+    inline AABB AABB::FromCenterExtents(const Vector3& center, const Vector3& extents)
+    {
+        return AABB(center - extents, center + extents);
+    }
+
+    inline bool AABB::IsEmpty() const
+    {
+        return !(minimum.x <= maximum.x && minimum.y <= maximum.y && minimum.z <= maximum.z);
+    }
+
+    inline Vector3 AABB::Center() const
+    {
+        return (minimum + maximum) * 0.5f;
+    }
+
+    inline Vector3 AABB::Extents() const
+    {
+        return (maximum - minimum) * 0.5f;
+    }
+
+    inline float AABB::SurfaceArea() const
+    {
+        Vector3 size = maximum - minimum;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    inline bool AABB::Contains(const Vector3& p) const
+    {
+        return p.x >= minimum.x && p.y >= minimum.y && p.z >= minimum.z && p.x <= maximum.x && p.y <= maximum.y && p.z <= maximum.z;
+    }
+
+    inline AABB& AABB::Merge(const Vector3& p)
+    {
+        return Merge(AABB(p, p));
+    }
+
+    inline AABB& AABB::Merge(const AABB& box)
+    {
+        // Scalar on purpose: for a single box, packing the 12-byte vectors into
+        // SSE registers and back costs more than the six compares.
+        minimum = Vector3(Min(minimum.x, box.minimum.x), Min(minimum.y, box.minimum.y), Min(minimum.z, box.minimum.z));
+        maximum = Vector3(Max(maximum.x, box.maximum.x), Max(maximum.y, box.maximum.y), Max(maximum.z, box.maximum.z));
+        return *this;
+    }
+
+    inline AABB Union(const AABB& a, const AABB& b)
+    {
+        AABB result = a;
+        return result.Merge(b);
+    }
+
+    inline bool Intersects(const AABB& a, const AABB& b)
+    {
+        return a.minimum.x <= b.maximum.x && b.minimum.x <= a.maximum.x && a.minimum.y <= b.maximum.y && b.minimum.y <= a.maximum.y && a.minimum.z <= b.maximum.z && b.minimum.z <= a.maximum.z;
+    }
+
+    inline AABB TransformBounds(const AABB& box, const Matrix44& m)
+    {
+        if (box.IsEmpty())
+            return box;
+
+        // Row-vector convention: the result starts at the translation row and
+        // each input axis i adds the smaller / larger of m[i] * min and m[i] * max.
+#if USING_SSE
+        __m128 lo = _mm_load_ps(m[3]), hi = lo;
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        for (int i = 0; i < 3; ++i) {
+            __m128 row = _mm_load_ps(m[i]);
+            __m128 a = _mm_mul_ps(row, _mm_set1_ps(minimum[i]));
+            __m128 b = _mm_mul_ps(row, _mm_set1_ps(maximum[i]));
+            lo = _mm_add_ps(lo, _mm_min_ps(a, b));
+            hi = _mm_add_ps(hi, _mm_max_ps(a, b));
+        }
+
+        // Whole-register stores: writing result piecewise and copying it out
+        // would stall on store forwarding.
+        alignas(16) float l[4], h[4];
+        _mm_store_ps(l, lo);
+        _mm_store_ps(h, hi);
+        return AABB(Vector3(l[0], l[1], l[2]), Vector3(h[0], h[1], h[2]));
+#else
+        float lo[3] = { m[3][0], m[3][1], m[3][2] };
+        float hi[3] = { m[3][0], m[3][1], m[3][2] };
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                float a = m[i][j] * minimum[i];
+                float b = m[i][j] * maximum[i];
+                lo[j] += Min(a, b);
+                hi[j] += Max(a, b);
+            }
+        }
+        return AABB(Vector3(lo[0], lo[1], lo[2]), Vector3(hi[0], hi[1], hi[2]));
+#endif
+    }
+
+    inline bool IntersectRay(const AABB& box, const Vector3& origin, const Vector3& invDirection, float tMax, float& tEntry)
+    {
+#if USING_SSE
+        __m128 o = Detail::LoadXYZ(origin), inv = Detail::LoadXYZ(invDirection);
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(Detail::LoadXYZ(box.minimum), o), inv);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(Detail::LoadXYZ(box.maximum), o), inv);
+        // Clamping to [0, tMax] with the bound as the second operand also
+        // replaces the NaN of a 0 * inf lane. Lane 3 is unused; give it the
+        // whole interval.
+        __m128 limit = _mm_set1_ps(tMax);
+        __m128 enter = _mm_max_ps(_mm_min_ps(t0, t1), _mm_setzero_ps());
+        __m128 leave = _mm_blend_ps(_mm_min_ps(_mm_max_ps(t0, t1), limit), limit, 8);
+        enter = _mm_max_ps(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(1, 0, 3, 2)));
+        enter = _mm_max_ss(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(2, 3, 0, 1)));
+        leave = _mm_min_ps(leave, _mm_shuffle_ps(leave, leave, _MM_SHUFFLE(1, 0, 3, 2)));
+        leave = _mm_min_ss(leave, _mm_shuffle_ps(leave, leave, _MM_SHUFFLE(2, 3, 0, 1)));
+        float tNear = _mm_cvtss_f32(enter), tFar = _mm_cvtss_f32(leave);
+#else
+        float tNear = 0.0f, tFar = tMax;
+        const float* o = &origin.x;
+        const float* inv = &invDirection.x;
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        for (int i = 0; i < 3; ++i) {
+            float t0 = (minimum[i] - o[i]) * inv[i];
+            float t1 = (maximum[i] - o[i]) * inv[i];
+            // Bounds second so a NaN from 0 * inf is dropped.
+            tNear = Max(Min(t0, t1), tNear);
+            tFar = Min(Max(t0, t1), tFar);
+        }
+#endif
+        if (tNear > tFar)
+            return false;
+        tEntry = tNear;
+        return true;
+    }
+
+    namespace Detail {
+        // Largest separation between query and element(s) i over the three
+        // axes, negated: below zero where they do not overlap.
+        struct OverlapScore {
+            const AABB& query;
+            const AABBStreamView& boxes;
+
+            OverlapScore(const AABB& query, const AABBStreamView& boxes)
+                : query(query)
+                , boxes(boxes)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F gapX = Max(Sub(Broadcast(query.minimum.x, lanes), LoadLanes(boxes.maxX + i, lanes)), Sub(LoadLanes(boxes.minX + i, lanes), Broadcast(query.maximum.x, lanes)));
+                F gapY = Max(Sub(Broadcast(query.minimum.y, lanes), LoadLanes(boxes.maxY + i, lanes)), Sub(LoadLanes(boxes.minY + i, lanes), Broadcast(query.maximum.y, lanes)));
+                F gapZ = Max(Sub(Broadcast(query.minimum.z, lanes), LoadLanes(boxes.maxZ + i, lanes)), Sub(LoadLanes(boxes.minZ + i, lanes), Broadcast(query.maximum.z, lanes)));
+                return Sub(Broadcast(0.0f, lanes), Max(gapX, Max(gapY, gapZ)));
+            }
+        };
+    } // end namespace Detail
+
+    inline AABB Union(const AABB* boxes, size_t count)
+    {
+#if USING_SSE
+        // Two independent accumulators per bound hide the min/max latency.
+        __m128 lo0 = _mm_set1_ps(INFINITY), lo1 = lo0;
+        __m128 hi0 = _mm_set1_ps(-INFINITY), hi1 = hi0;
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            lo0 = _mm_min_ps(lo0, Detail::LoadXYZ(boxes[i].minimum));
+            hi0 = _mm_max_ps(hi0, Detail::LoadXYZ(boxes[i].maximum));
+            lo1 = _mm_min_ps(lo1, Detail::LoadXYZ(boxes[i + 1].minimum));
+            hi1 = _mm_max_ps(hi1, Detail::LoadXYZ(boxes[i + 1].maximum));
+        }
+        if (i < count) {
+            lo0 = _mm_min_ps(lo0, Detail::LoadXYZ(boxes[i].minimum));
+            hi0 = _mm_max_ps(hi0, Detail::LoadXYZ(boxes[i].maximum));
+        }
+
+        alignas(16) float l[4], h[4];
+        _mm_store_ps(l, _mm_min_ps(lo0, lo1));
+        _mm_store_ps(h, _mm_max_ps(hi0, hi1));
+        return AABB(Vector3(l[0], l[1], l[2]), Vector3(h[0], h[1], h[2]));
+#else
+        AABB result;
+        for (size_t i = 0; i < count; ++i)
+            result.Merge(boxes[i]);
+        return result;
+#endif
+    }
+
+    inline void Union(const AABB* a, const AABB* b, AABB* out, size_t count)
+    {
+        // Elementwise on the packed (minimum, maximum) floats: min and max of
+        // both inputs, blended so each float takes the bound it belongs to.
+        size_t i = 0;
+#if USING_AVX2
+        // Four boxes are three registers of six mins-then-maxes.
+        for (; i + 4 <= count; i += 4) {
+            const float* x = &a[i].minimum.x;
+            const float* y = &b[i].minimum.x;
+            __m256 x0 = _mm256_loadu_ps(x), x1 = _mm256_loadu_ps(x + 8), x2 = _mm256_loadu_ps(x + 16);
+            __m256 y0 = _mm256_loadu_ps(y), y1 = _mm256_loadu_ps(y + 8), y2 = _mm256_loadu_ps(y + 16);
+            float* o = &out[i].minimum.x;
+            _mm256_storeu_ps(o, _mm256_blend_ps(_mm256_min_ps(x0, y0), _mm256_max_ps(x0, y0), 0x38));
+            _mm256_storeu_ps(o + 8, _mm256_blend_ps(_mm256_min_ps(x1, y1), _mm256_max_ps(x1, y1), 0x8E));
+            _mm256_storeu_ps(o + 16, _mm256_blend_ps(_mm256_min_ps(x2, y2), _mm256_max_ps(x2, y2), 0xE3));
+        }
+#endif
+#if USING_SSE
+        // Two overlapping loads per box: (minimum, maximum.x) and
+        // (minimum.z, maximum). The shared floats get the same result.
+        for (; i < count; ++i) {
+            const float* x = &a[i].minimum.x;
+            const float* y = &b[i].minimum.x;
+            __m128 x0 = _mm_loadu_ps(x), x1 = _mm_loadu_ps(x + 2);
+            __m128 y0 = _mm_loadu_ps(y), y1 = _mm_loadu_ps(y + 2);
+            float* o = &out[i].minimum.x;
+            _mm_storeu_ps(o, _mm_blend_ps(_mm_min_ps(x0, y0), _mm_max_ps(x0, y0), 0x8));
+            _mm_storeu_ps(o + 2, _mm_blend_ps(_mm_min_ps(x1, y1), _mm_max_ps(x1, y1), 0xE));
+        }
+#else
+        for (; i < count; ++i)
+            out[i] = Union(a[i], b[i]);
+#endif
+    }
+
+    inline size_t CollectOverlaps(const AABB& query, const AABB* boxes, size_t count, uint32_t* hits)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hits[n] = (uint32_t)i;
+            n += Intersects(query, boxes[i]) ? 1 : 0;
+        }
+        return n;
+    }
+
+    inline size_t CollectOverlaps(const AABB& query, const AABBStreamView& boxes, uint32_t* hits)
+    {
+        return Detail::SelectIndices(Detail::OverlapScore(query, boxes), boxes.count, hits);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Affine2D.h"
+#include "MathFunctions.h"
+#include "Vector2D.h"
+
+namespace Oblivion {
+namespace Math {
+    // Axis-aligned rectangle between minimum and maximum, both inclusive; the
+    // 2D counterpart of AABB. The default box is empty (minimum = +inf,
+    // maximum = -inf), so merging into it yields the other operand.
+    class AABB2D {
+    public:
+        Vector2D minimum;
+        Vector2D maximum;
+
+        AABB2D();
+        AABB2D(const Vector2D& minimum, const Vector2D& maximum);
+
+        static AABB2D FromCenterExtents(const Vector2D& center, const Vector2D& extents);
+
+        bool IsEmpty() const;
+        Vector2D Center() const;
+        // Half the size along each axis.
+        Vector2D Extents() const;
+        float Area() const;
+        bool Contains(const Vector2D& p) const;
+
+        AABB2D& Merge(const Vector2D& p);
+        AABB2D& Merge(const AABB2D& box);
+    };
+
+    static_assert(sizeof(AABB2D) == 4 * sizeof(float), "the batch kernels load a box as four packed floats");
+
+    AABB2D Union(const AABB2D& a, const AABB2D& b);
+    // The overlap of a and b; empty when they do not intersect.
+    AABB2D Intersection(const AABB2D& a, const AABB2D& b);
+    // Boxes that only touch intersect.
+    bool Intersects(const AABB2D& a, const AABB2D& b);
+
+    // Bounds of the box after the affine transform m, as for the 3D
+    // TransformBounds. Empty boxes stay empty.
+    AABB2D TransformBounds(const AABB2D& box, const Affine2D& m);
+
+    /********************************************************************
+    // BATCH 2D BOX OPERATIONS
+    //
+    // A box is four packed floats, so the kernels work on whole boxes: one
+    // per SSE register, two per AVX2 register.
+    ********************************************************************/
+    // Bounds of points[0 .. count); empty for count == 0.
+    AABB2D BoundingBox(const Vector2D* points, size_t count);
+    // Union of boxes[0 .. count); empty for count == 0.
+    AABB2D Union(const AABB2D* boxes, size_t count);
+    // out[i] = Union(a[i], b[i]); out may alias a or b.
+    void Union(const AABB2D* a, const AABB2D* b, AABB2D* out, size_t count);
+    // out[i] = Intersection(a[i], b[i]); out may alias a or b.
+    void Intersection(const AABB2D* a, const AABB2D* b, AABB2D* out, size_t count);
+
+    // Writes the indices of the boxes intersecting query to hits, in order,
+    // and returns how many there are. hits must have room for count indices.
+    size_t CollectOverlaps(const AABB2D& query, const AABB2D* boxes, size_t count, uint32_t* hits);
+
+    inline AABB2D::AABB2D()
+        : minimum(INFINITY, INFINITY)
+        , maximum(-INFINITY, -INFINITY)
+    {
+    }
+
+    inline AABB2D::AABB2D(const Vector2D& minimum, const Vector2D& maximum)
+        : minimum(minimum)
+        , maximum(maximum)
+    {
+    }
+
+    inline AABB2D AABB2D::FromCenterExtents(const Vector2D& center, const Vector2D& extents)
+    {
+        return AABB2D(center - extents, center + extents);
+    }
+
+    inline bool AABB2D::IsEmpty() const
+    {
+        return !(minimum.x <= maximum.x && minimum.y <= maximum.y);
+    }
+
+    inline Vector2D AABB2D::Center() const
+    {
+        return (minimum + maximum) * 0.5f;
+    }
+
+    inline Vector2D AABB2D::Extents() const
+    {
+        return (maximum - minimum) * 0.5f;
+    }
+
+    inline float AABB2D::Area() const
+    {
+        Vector2D size = maximum - minimum;
+        return size.x * size.y;
+    }
+
+    inline bool AABB2D::Contains(const Vector2D& p) const
+    {
+        return p.x >= minimum.x && p.y >= minimum.y && p.x <= maximum.x && p.y <= maximum.y;
+    }
+
+    inline AABB2D& AABB2D::Merge(const Vector2D& p)
+    {
+        return Merge(AABB2D(p, p));
+    }
+
+    inline AABB2D& AABB2D::Merge(const AABB2D& box)
+    {
+        minimum = Vector2D(Min(minimum.x, box.minimum.x), Min(minimum.y, box.minimum.y));
+        maximum = Vector2D(Max(maximum.x, box.maximum.x), Max(maximum.y, box.maximum.y));
+        return *this;
+    }
+
+    inline AABB2D Union(const AABB2D& a, const AABB2D& b)
+    {
+        AABB2D result = a;
+        return result.Merge(b);
+    }
+
+    inline AABB2D Intersection(const AABB2D& a, const AABB2D& b)
+    {
+        return AABB2D(Vector2D(Max(a.minimum.x, b.minimum.x), Max(a.minimum.y, b.minimum.y)), Vector2D(Min(a.maximum.x, b.maximum.x), Min(a.maximum.y, b.maximum.y)));
+    }
+
+    inline bool Intersects(const AABB2D& a, const AABB2D& b)
+    {
+        return a.minimum.x <= b.maximum.x && b.minimum.x <= a.maximum.x && a.minimum.y <= b.maximum.y && b.minimum.y <= a.maximum.y;
+    }
+
+    inline AABB2D TransformBounds(const AABB2D& box, const Affine2D& m)
+    {
+        if (box.IsEmpty())
+            return box;
+
+        // Column-vector convention: output axis i starts at the translation
+        // and each input axis j adds the smaller / larger of m[i][j] * min
+        // and m[i][j] * max.
+        float lo[2] = { m.translation.x, m.translation.y };
+        float hi[2] = { m.translation.x, m.translation.y };
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        for (int i = 0; i < 2; ++i) {
+            for (int j = 0; j < 2; ++j) {
+                float a = m.linear.m[i][j] * minimum[j];
+                float b = m.linear.m[i][j] * maximum[j];
+                lo[i] += Min(a, b);
+                hi[i] += Max(a, b);
+            }
+        }
+        return AABB2D(Vector2D(lo[0], lo[1]), Vector2D(hi[0], hi[1]));
+    }
+
+    namespace Detail {
+        // Elementwise on (minimum, maximum) pairs: the first two floats of
+        // each box take the lower bound, the last two the upper, or the
+        // other way round for the intersection.
+        template <bool IsUnion>
+        void CombineBoxes(const AABB2D* a, const AABB2D* b, AABB2D* out, size_t count)
+        {
+            size_t i = 0;
+#if USING_AVX2
+            for (; i + 2 <= count; i += 2) {
+                __m256 x = _mm256_loadu_ps(&a[i].minimum.x), y = _mm256_loadu_ps(&b[i].minimum.x);
+                __m256 lo = _mm256_min_ps(x, y), hi = _mm256_max_ps(x, y);
+                _mm256_storeu_ps(&out[i].minimum.x, IsUnion ? _mm256_blend_ps(lo, hi, 0xCC) : _mm256_blend_ps(hi, lo, 0xCC));
+            }
+#endif
+#if USING_SSE
+            for (; i < count; ++i) {
+                __m128 x = _mm_loadu_ps(&a[i].minimum.x), y = _mm_loadu_ps(&b[i].minimum.x);
+                __m128 lo = _mm_min_ps(x, y), hi = _mm_max_ps(x, y);
+                _mm_storeu_ps(&out[i].minimum.x, IsUnion ? _mm_blend_ps(lo, hi, 0xC) : _mm_blend_ps(hi, lo, 0xC));
+            }
+#else
+            for (; i < count; ++i)
+                out[i] = IsUnion ? Union(a[i], b[i]) : Intersection(a[i], b[i]);
+#endif
+        }
+
+#if USING_SSE
+        // Boxes b overlap the query q when (b.min, -b.max) <= (q.max, -q.min)
+        // in all four floats, so one compare per box.
+        inline __m128 NegateMaximum(__m128 box)
+        {
+            return _mm_xor_ps(box, _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+        }
+#endif
+
+#if USING_AVX2
+        inline __m256 NegateMaximum(__m256 boxes)
+        {
+            return _mm256_xor_ps(boxes, _mm256_setr_ps(0.0f, 0.0f, -0.0f, -0.0f, 0.0f, 0.0f, -0.0f, -0.0f));
+        }
+
+        // Every index is written but the cursor only advances past the
+        // boxes whose four compares all hold, as in AppendSelected.
+        inline size_t AppendBoxPair(__m256 inside, size_t i, uint32_t* out, size_t n)
+        {
+            int bits = _mm256_movemask_ps(inside);
+            out[n] = (uint32_t)i;
+            n += (bits & 0xF) == 0xF ? 1 : 0;
+            out[n] = (uint32_t)(i + 1);
+            n += (bits >> 4) == 0xF ? 1 : 0;
+            return n;
+        }
+#endif
+    } // end namespace Detail
+
+    inline AABB2D BoundingBox(const Vector2D* points, size_t count)
+    {
+        size_t i = 0;
+#if USING_AVX2
+        // Points stay interleaved; the (x, y) pairs of each register fold
+        // together at the end.
+        __m256 lo8 = _mm256_set1_ps(INFINITY), hi8 = _mm256_set1_ps(-INFINITY);
+        __m256 lo8b = lo8, hi8b = hi8;
+        for (; i + 8 <= count; i += 8) {
+            __m256 a = _mm256_loadu_ps(&points[i].x), b = _mm256_loadu_ps(&points[i + 4].x);
+            lo8 = _mm256_min_ps(lo8, a);
+            hi8 = _mm256_max_ps(hi8, a);
+            lo8b = _mm256_min_ps(lo8b, b);
+            hi8b = _mm256_max_ps(hi8b, b);
+        }
+        lo8 = _mm256_min_ps(lo8, lo8b);
+        hi8 = _mm256_max_ps(hi8, hi8b);
+        __m128 lo = _mm_min_ps(_mm256_castps256_ps128(lo8), _mm256_extractf128_ps(lo8, 1));
+        __m128 hi = _mm_max_ps(_mm256_castps256_ps128(hi8), _mm256_extractf128_ps(hi8, 1));
+#elif USING_SSE
+        __m128 lo = _mm_set1_ps(INFINITY), hi = _mm_set1_ps(-INFINITY);
+#endif
+#if USING_SSE
+        for (; i + 2 <= count; i += 2) {
+            __m128 a = _mm_loadu_ps(&points[i].x);
+            lo = _mm_min_ps(lo, a);
+            hi = _mm_max_ps(hi, a);
+        }
+        lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+        hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+        alignas(16) float l[4], h[4];
+        _mm_store_ps(l, lo);
+        _mm_store_ps(h, hi);
+        AABB2D result(Vector2D(l[0], l[1]), Vector2D(h[0], h[1]));
+#else
+        AABB2D result;
+#endif
+        for (; i < count; ++i)
+            result.Merge(points[i]);
+        return result;
+    }
+
+    inline AABB2D Union(const AABB2D* boxes, size_t count)
+    {
+#if USING_SSE
+        // Two accumulators hide the min/max latency; the blend keeps the
+        // minimum half of the first and the maximum half of the second.
+        __m128 lo0 = _mm_set1_ps(INFINITY), lo1 = lo0;
+        __m128 hi0 = _mm_set1_ps(-INFINITY), hi1 = hi0;
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            __m128 a = _mm_loadu_ps(&boxes[i].minimum.x), b = _mm_loadu_ps(&boxes[i + 1].minimum.x);
+            lo0 = _mm_min_ps(lo0, a);
+            hi0 = _mm_max_ps(hi0, a);
+            lo1 = _mm_min_ps(lo1, b);
+            hi1 = _mm_max_ps(hi1, b);
+        }
+        if (i < count) {
+            __m128 a = _mm_loadu_ps(&boxes[i].minimum.x);
+            lo0 = _mm_min_ps(lo0, a);
+            hi0 = _mm_max_ps(hi0, a);
+        }
+
+        AABB2D result;
+        _mm_storeu_ps(&result.minimum.x, _mm_blend_ps(_mm_min_ps(lo0, lo1), _mm_max_ps(hi0, hi1), 0xC));
+        return result;
+#else
+        AABB2D result;
+        for (size_t i = 0; i < count; ++i)
+            result.Merge(boxes[i]);
+        return result;
+#endif
+    }
+
+    inline void Union(const AABB2D* a, const AABB2D* b, AABB2D* out, size_t count)
+    {
+        Detail::CombineBoxes<true>(a, b, out, count);
+    }
+
+    inline void Intersection(const AABB2D* a, const AABB2D* b, AABB2D* out, size_t count)
+    {
+        Detail::CombineBoxes<false>(a, b, out, count);
+    }
+
+    inline size_t CollectOverlaps(const AABB2D& query, const AABB2D* boxes, size_t count, uint32_t* hits)
+    {
+        size_t n = 0, i = 0;
+#if USING_AVX2
+        {
+            __m128 q = _mm_setr_ps(query.maximum.x, query.maximum.y, -query.minimum.x, -query.minimum.y);
+            __m256 q2 = _mm256_set_m128(q, q);
+            for (; i + 8 <= count; i += 8) {
+                __m256 a = Detail::NegateMaximum(_mm256_loadu_ps(&boxes[i].minimum.x));
+                __m256 b = Detail::NegateMaximum(_mm256_loadu_ps(&boxes[i + 2].minimum.x));
+                __m256 c = Detail::NegateMaximum(_mm256_loadu_ps(&boxes[i + 4].minimum.x));
+                __m256 d = Detail::NegateMaximum(_mm256_loadu_ps(&boxes[i + 6].minimum.x));
+                n = Detail::AppendBoxPair(_mm256_cmp_ps(a, q2, _CMP_LE_OQ), i, hits, n);
+                n = Detail::AppendBoxPair(_mm256_cmp_ps(b, q2, _CMP_LE_OQ), i + 2, hits, n);
+                n = Detail::AppendBoxPair(_mm256_cmp_ps(c, q2, _CMP_LE_OQ), i + 4, hits, n);
+                n = Detail::AppendBoxPair(_mm256_cmp_ps(d, q2, _CMP_LE_OQ), i + 6, hits, n);
+            }
+        }
+#endif
+#if USING_SSE
+        __m128 q = _mm_setr_ps(query.maximum.x, query.maximum.y, -query.minimum.x, -query.minimum.y);
+        for (; i < count; ++i) {
+            __m128 inside = _mm_cmple_ps(Detail::NegateMaximum(_mm_loadu_ps(&boxes[i].minimum.x)), q);
+            hits[n] = (uint32_t)i;
+            n += _mm_movemask_ps(inside) == 0xF ? 1 : 0;
+        }
+#else
+        for (; i < count; ++i) {
+            hits[n] = (uint32_t)i;
+            n += Intersects(query, boxes[i]) ? 1 : 0;
+        }
+#endif
+        return n;
+    }
+} // end namespace Math
+} // end namespace Oblivion
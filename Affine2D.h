@@ -0,0 +1,326 @@
+#pragma once
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+
+#include "Mat2x2.h"
+#include "MathFunctions.h"
+#include "Vector2D.h"
+
+namespace Oblivion {
+namespace Math {
+    // A 2D affine transform: p' = linear * p + translation, with points as
+    // column vectors, so x' = m[0][0] x + m[0][1] y + translation.x. As with
+    // Mat2x2's operator*, a * b applies a first and then b.
+    class Affine2D {
+    public:
+        Mat2x2 linear;
+        Vector2D translation;
+
+        // The identity.
+        Affine2D();
+        Affine2D(const Mat2x2& linear, const Vector2D& translation);
+
+        // Counter-clockwise rotation by angle radians about the origin.
+        static Affine2D Rotation(float angle);
+        static Affine2D Translation(const Vector2D& t);
+        static Affine2D Scale(const Vector2D& s);
+        // Scale, then rotate, then translate: the usual sprite or widget
+        // placement.
+        static Affine2D FromTRS(const Vector2D& translation, float angle, const Vector2D& scale);
+
+        Vector2D TransformPoint(const Vector2D& p) const;
+        // Ignores the translation.
+        Vector2D TransformDirection(const Vector2D& v) const;
+
+        // Sets *singular (when given) to whether the linear part has no
+        // inverse, in which case the identity is returned.
+        Affine2D Inverse(bool* singular = NULL) const;
+    };
+
+    Affine2D operator*(const Affine2D& a, const Affine2D& b);
+
+    static_assert(sizeof(Vector2D) == 2 * sizeof(float), "the batch kernels load Vector2D arrays as packed floats");
+
+    /********************************************************************
+    // BATCH 2D TRANSFORMS
+    //
+    // Transform arrays of Vector2D. in == out transforms in place; other
+    // overlaps are not supported. With USING_FMA the results may differ
+    // from TransformPoint / TransformDirection by rounding.
+    //
+    // RotationMany and RotateMany take one angle per element and evaluate
+    // SinCos eight (or four) lanes at a time at precision P.
+    ********************************************************************/
+    void TransformPoints(const Affine2D& m, const Vector2D* in, Vector2D* out, size_t count);
+    void TransformDirections(const Affine2D& m, const Vector2D* in, Vector2D* out, size_t count);
+
+    // out[i] = Affine2D::Rotation(angles[i]).linear.
+    template <Precision P = Precision::MATH_PRECISION>
+    void RotationMany(const float* angles, size_t count, Mat2x2* out);
+    // out[i] = in[i] rotated counter-clockwise by angles[i] about the
+    // origin; out may alias in.
+    template <Precision P = Precision::MATH_PRECISION>
+    void RotateMany(const Vector2D* in, const float* angles, size_t count, Vector2D* out);
+
+    inline Affine2D::Affine2D()
+        : linear(1.0f, 0.0f, 0.0f, 1.0f)
+    {
+    }
+
+    inline Affine2D::Affine2D(const Mat2x2& linear, const Vector2D& translation)
+        : linear(linear)
+        , translation(translation)
+    {
+    }
+
+    inline Affine2D Affine2D::Rotation(float angle)
+    {
+        float s, c;
+        SinCos(angle, s, c);
+        // Mat2x2's four-float constructor takes the columns.
+        return Affine2D(Mat2x2(c, s, -s, c), Vector2D());
+    }
+
+    inline Affine2D Affine2D::Translation(const Vector2D& t)
+    {
+        return Affine2D(Mat2x2(1.0f, 0.0f, 0.0f, 1.0f), t);
+    }
+
+    inline Affine2D Affine2D::Scale(const Vector2D& s)
+    {
+        return Affine2D(Mat2x2(s.x, 0.0f, 0.0f, s.y), Vector2D());
+    }
+
+    inline Affine2D Affine2D::FromTRS(const Vector2D& translation, float angle, const Vector2D& scale)
+    {
+        float s, c;
+        SinCos(angle, s, c);
+        return Affine2D(Mat2x2(c * scale.x, s * scale.x, -s * scale.y, c * scale.y), translation);
+    }
+
+    inline Vector2D Affine2D::TransformPoint(const Vector2D& p) const
+    {
+        return Vector2D(linear.m[0][0] * p.x + linear.m[0][1] * p.y + translation.x, linear.m[1][0] * p.x + linear.m[1][1] * p.y + translation.y);
+    }
+
+    inline Vector2D Affine2D::TransformDirection(const Vector2D& v) const
+    {
+        return Vector2D(linear.m[0][0] * v.x + linear.m[0][1] * v.y, linear.m[1][0] * v.x + linear.m[1][1] * v.y);
+    }
+
+    inline Affine2D Affine2D::Inverse(bool* singular) const
+    {
+        float det = determinant(linear);
+        // Catches zero, denormal and NaN determinants alike.
+        bool isSingular = !(fabsf(1.0f / det) <= FLT_MAX);
+        if (singular)
+            *singular = isSingular;
+        if (isSingular)
+            return Affine2D();
+
+        Affine2D result(inverse(linear), Vector2D());
+        Vector2D t = result.TransformDirection(translation);
+        result.translation = Vector2D(-t.x, -t.y);
+        return result;
+    }
+
+    inline Affine2D operator*(const Affine2D& a, const Affine2D& b)
+    {
+        return Affine2D(a.linear * b.linear, b.TransformPoint(a.translation));
+    }
+
+    namespace Detail {
+        // count points through m; Point selects whether the translation is
+        // added.
+        template <bool Point>
+        void TransformArray2D(const Affine2D& m, const Vector2D* in, Vector2D* out, size_t count)
+        {
+            const float m00 = m.linear.m[0][0], m01 = m.linear.m[0][1];
+            const float m10 = m.linear.m[1][0], m11 = m.linear.m[1][1];
+            const float tx = Point ? m.translation.x : 0.0f, ty = Point ? m.translation.y : 0.0f;
+            size_t i = 0;
+
+            // The points stay interleaved: a register of (x, y) pairs times
+            // (m00, m11) plus the pair-swapped register times (m01, m10) is
+            // the transform, with no shuffles beyond the swap.
+#if USING_AVX2
+            {
+                __m256 diagonal = _mm256_setr_ps(m00, m11, m00, m11, m00, m11, m00, m11);
+                __m256 cross = _mm256_setr_ps(m01, m10, m01, m10, m01, m10, m01, m10);
+                __m256 t = _mm256_setr_ps(tx, ty, tx, ty, tx, ty, tx, ty);
+                for (; i + 8 <= count; i += 8) {
+                    __m256 a = _mm256_loadu_ps(&in[i].x), b = _mm256_loadu_ps(&in[i + 4].x);
+                    a = MulAdd(a, diagonal, MulAdd(_mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)), cross, t));
+                    b = MulAdd(b, diagonal, MulAdd(_mm256_permute_ps(b, _MM_SHUFFLE(2, 3, 0, 1)), cross, t));
+                    _mm256_storeu_ps(&out[i].x, a);
+                    _mm256_storeu_ps(&out[i + 4].x, b);
+                }
+            }
+#endif
+#if USING_SSE
+            {
+                __m128 diagonal = _mm_setr_ps(m00, m11, m00, m11);
+                __m128 cross = _mm_setr_ps(m01, m10, m01, m10);
+                __m128 t = _mm_setr_ps(tx, ty, tx, ty);
+                for (; i + 4 <= count; i += 4) {
+                    __m128 a = _mm_loadu_ps(&in[i].x), b = _mm_loadu_ps(&in[i + 2].x);
+                    a = MulAdd(a, diagonal, MulAdd(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), cross, t));
+                    b = MulAdd(b, diagonal, MulAdd(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), cross, t));
+                    _mm_storeu_ps(&out[i].x, a);
+                    _mm_storeu_ps(&out[i + 2].x, b);
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                Vector2D p = in[i];
+                out[i] = Vector2D(MulAdd(p.x, m00, MulAdd(p.y, m01, tx)), MulAdd(p.y, m11, MulAdd(p.x, m10, ty)));
+            }
+        }
+
+        // One point per lane in and out, split into x and y registers in
+        // element order.
+        inline void LoadPoints(const Vector2D* p, float& x, float& y)
+        {
+            x = p->x;
+            y = p->y;
+        }
+
+        inline void StorePoints(Vector2D* p, float x, float y)
+        {
+            *p = Vector2D(x, y);
+        }
+
+        // c, -s / s, c for one matrix per lane.
+        inline void StoreRotation2D(Mat2x2* out, float s, float c)
+        {
+            *out = Mat2x2(c, s, -s, c);
+        }
+
+#if USING_SSE
+        inline void LoadPoints(const Vector2D* p, __m128& x, __m128& y)
+        {
+            __m128 a = _mm_loadu_ps(&p[0].x), b = _mm_loadu_ps(&p[2].x);
+            x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        inline void StorePoints(Vector2D* p, __m128 x, __m128 y)
+        {
+            _mm_storeu_ps(&p[0].x, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(&p[2].x, _mm_unpackhi_ps(x, y));
+        }
+
+        // Mat2x2 is row-major, so matrix k is (c, -s, s, c) of lane k.
+        inline void StoreRotation2D(Mat2x2* out, __m128 s, __m128 c)
+        {
+            __m128 top = _mm_unpacklo_ps(c, _mm_xor_ps(s, _mm_set1_ps(-0.0f)));
+            __m128 bottom = _mm_unpacklo_ps(s, c);
+            _mm_storeu_ps(&out[0].m[0][0], _mm_movelh_ps(top, bottom));
+            _mm_storeu_ps(&out[1].m[0][0], _mm_movehl_ps(bottom, top));
+            top = _mm_unpackhi_ps(c, _mm_xor_ps(s, _mm_set1_ps(-0.0f)));
+            bottom = _mm_unpackhi_ps(s, c);
+            _mm_storeu_ps(&out[2].m[0][0], _mm_movelh_ps(top, bottom));
+            _mm_storeu_ps(&out[3].m[0][0], _mm_movehl_ps(bottom, top));
+        }
+#endif
+
+#if USING_AVX2
+        // The in-lane shuffles leave elements in the order 0 1 4 5 2 3 6 7;
+        // swapping the middle pairs of floats restores it, and is its own
+        // inverse for the store.
+        inline __m256 SwapMiddlePairs(__m256 v)
+        {
+            return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+
+        inline void LoadPoints(const Vector2D* p, __m256& x, __m256& y)
+        {
+            __m256 a = _mm256_loadu_ps(&p[0].x), b = _mm256_loadu_ps(&p[4].x);
+            x = SwapMiddlePairs(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            y = SwapMiddlePairs(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        inline void StorePoints(Vector2D* p, __m256 x, __m256 y)
+        {
+            x = SwapMiddlePairs(x);
+            y = SwapMiddlePairs(y);
+            _mm256_storeu_ps(&p[0].x, _mm256_unpacklo_ps(x, y));
+            _mm256_storeu_ps(&p[4].x, _mm256_unpackhi_ps(x, y));
+        }
+
+        // The SSE store in both 128-bit lanes: matrices 0-1 and 4-5 from the
+        // low halves of each lane, 2-3 and 6-7 from the high halves.
+        inline void StoreRotation2D(Mat2x2* out, __m256 s, __m256 c)
+        {
+            __m256 negS = _mm256_xor_ps(s, _mm256_set1_ps(-0.0f));
+            __m256 topLo = _mm256_unpacklo_ps(c, negS), bottomLo = _mm256_unpacklo_ps(s, c);
+            __m256 topHi = _mm256_unpackhi_ps(c, negS), bottomHi = _mm256_unpackhi_ps(s, c);
+            __m256 m0 = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(topLo), _mm256_castps_pd(bottomLo)));
+            __m256 m1 = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(topLo), _mm256_castps_pd(bottomLo)));
+            __m256 m2 = _mm256_castpd_ps(_mm256_unpacklo_pd(_mm256_castps_pd(topHi), _mm256_castps_pd(bottomHi)));
+            __m256 m3 = _mm256_castpd_ps(_mm256_unpackhi_pd(_mm256_castps_pd(topHi), _mm256_castps_pd(bottomHi)));
+            _mm256_storeu_ps(&out[0].m[0][0], _mm256_permute2f128_ps(m0, m1, 0x20));
+            _mm256_storeu_ps(&out[2].m[0][0], _mm256_permute2f128_ps(m2, m3, 0x20));
+            _mm256_storeu_ps(&out[4].m[0][0], _mm256_permute2f128_ps(m0, m1, 0x31));
+            _mm256_storeu_ps(&out[6].m[0][0], _mm256_permute2f128_ps(m2, m3, 0x31));
+        }
+#endif
+
+        template <Precision P>
+        struct RotationKernel {
+            const float* angles;
+            Mat2x2* out;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F s, c;
+                Trig<P>::SinCos(LoadLanes(angles + i, lanes), s, c);
+                StoreRotation2D(out + i, s, c);
+            }
+        };
+
+        template <Precision P>
+        struct RotatePointsKernel {
+            const Vector2D* in;
+            const float* angles;
+            Vector2D* out;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F s, c, x, y;
+                Trig<P>::SinCos(LoadLanes(angles + i, lanes), s, c);
+                LoadPoints(in + i, x, y);
+                StorePoints(out + i, Sub(Mul(c, x), Mul(s, y)), MulAdd(s, x, Mul(c, y)));
+            }
+        };
+    } // end namespace Detail
+
+    inline void TransformPoints(const Affine2D& m, const Vector2D* in, Vector2D* out, size_t count)
+    {
+        Detail::TransformArray2D<true>(m, in, out, count);
+    }
+
+    inline void TransformDirections(const Affine2D& m, const Vector2D* in, Vector2D* out, size_t count)
+    {
+        Detail::TransformArray2D<false>(m, in, out, count);
+    }
+
+    template <Precision P>
+    inline void RotationMany(const float* angles, size_t count, Mat2x2* out)
+    {
+        Detail::RotationKernel<P> kernel = { angles, out };
+        Detail::ForEachLanes(count, kernel);
+    }
+
+    template <Precision P>
+    inline void RotateMany(const Vector2D* in, const float* angles, size_t count, Vector2D* out)
+    {
+        Detail::RotatePointsKernel<P> kernel = { in, angles, out };
+        Detail::ForEachLanes(count, kernel);
+    }
+} // end namespace Math
+} // end namespace Oblivion
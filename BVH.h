@@ -0,0 +1,669 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AABB.h"
+#include "Parallel.h"
+
+namespace Oblivion {
+namespace Math {
+    struct BVHBuildNode;
+
+    // One node of the flattened 4-wide tree: the bounds of the four children
+    // side by side, so a single SSE register tests them all, in two cache
+    // lines.
+    struct alignas(64) BVHNode {
+        enum : uint32_t { EmptyChild = 0xffffffffu };
+
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        // count[k] == 0: child[k] is an inner node index, or EmptyChild.
+        // count[k] > 0: a leaf of primitives child[k] .. child[k] + count[k]
+        // in BVH::Primitives() order.
+        uint32_t child[4];
+        uint32_t count[4];
+
+        bool IsEmpty(int k) const { return count[k] == 0 && child[k] == EmptyChild; }
+        bool IsLeaf(int k) const { return count[k] > 0; }
+        AABB Bounds(int k) const;
+        void SetBounds(int k, const AABB& b);
+    };
+
+    typedef std::vector<BVHNode, Detail::AlignedAllocator<BVHNode> > BVHNodeArray;
+
+    // parallelThreshold counts primitives: subtrees at least that large are
+    // built on their own thread.
+    struct BVHBuildOptions : ParallelOptions {
+        // Ranges of at most this many primitives become leaves.
+        uint32_t maxLeafSize;
+        // SAH bins per split, at most 32.
+        uint32_t binCount;
+
+        BVHBuildOptions()
+            : ParallelOptions(16384)
+            , maxLeafSize(4)
+            , binCount(16)
+        {
+        }
+    };
+
+    /********************************************************************
+    // BOUNDING VOLUME HIERARCHY
+    //
+    // Built over primitive bounds with a binned surface area heuristic,
+    // then collapsed to 4-wide nodes stored depth-first in one array
+    // (children after their parent). The tree refers to primitives by
+    // their index in the bounds array given to Build; queries report those
+    // indices and test the primitive bounds, so callbacks only see
+    // primitives whose box is hit.
+    ********************************************************************/
+    class BVH {
+    public:
+        void Build(const AABB* bounds, size_t count, const BVHBuildOptions& options = BVHBuildOptions());
+
+        bool IsEmpty() const { return nodes.empty(); }
+        const BVHNodeArray& Nodes() const { return nodes; }
+        const std::vector<uint32_t>& Primitives() const { return primitives; }
+        AABB Bounds() const;
+
+        // Nearest-first traversal of the ray origin + t * direction, t in
+        // [0, tMax]. intersect(primitive, tMax) tests one primitive, shrinks
+        // tMax on a closer hit and returns whether it hit; boxes beyond the
+        // current tMax are skipped. Returns true if any call returned true.
+        template <typename Intersect>
+        bool Raycast(const Vector3& origin, const Vector3& direction, float& tMax, Intersect intersect) const;
+
+        // visit(primitive) for every primitive whose bounds overlap box or
+        // the sphere.
+        template <typename Visit>
+        void QueryOverlaps(const AABB& box, Visit visit) const;
+        template <typename Visit>
+        void QuerySphere(const Vector3& center, float radius, Visit visit) const;
+
+        // The same queries appending to out; return how many were added.
+        size_t CollectOverlaps(const AABB& box, std::vector<uint32_t>& out) const;
+        size_t CollectOverlaps(const Vector3& center, float radius, std::vector<uint32_t>& out) const;
+
+        // Recomputes every node from new primitive bounds, indexed as in
+        // Build, keeping the topology. Quality degrades as primitives move
+        // far from where they were built; rebuild then.
+        void Refit(const AABB* bounds);
+        // Only the listed primitives changed; touches their ancestors only.
+        void Refit(const AABB* bounds, const uint32_t* changed, size_t changedCount);
+
+    private:
+        BVHNodeArray nodes;
+        // Primitive indices in leaf order and their bounds in the same order.
+        std::vector<uint32_t> primitives;
+        std::vector<AABB> primitiveBounds;
+        std::vector<uint32_t> parents;
+        // Per primitive: its position in primitives and its leaf's node.
+        std::vector<uint32_t> positions;
+        std::vector<uint32_t> leafNodes;
+
+        void RefitNode(uint32_t index);
+        uint32_t Flatten(const BVHBuildNode* node, uint32_t parent);
+    };
+
+    // world[i] = TransformBounds(local[i], transforms[i]), for refitting moving
+    // objects.
+    void TransformBounds(const AABB* local, const Matrix44* transforms, AABB* world, size_t count);
+
+    inline AABB BVHNode::Bounds(int k) const
+    {
+        return AABB(Vector3(minX[k], minY[k], minZ[k]), Vector3(maxX[k], maxY[k], maxZ[k]));
+    }
+
+    inline void BVHNode::SetBounds(int k, const AABB& b)
+    {
+        minX[k] = b.minimum.x;
+        minY[k] = b.minimum.y;
+        minZ[k] = b.minimum.z;
+        maxX[k] = b.maximum.x;
+        maxY[k] = b.maximum.y;
+        maxZ[k] = b.maximum.z;
+    }
+
+    // Binary tree produced by the builder and consumed by BVH::Flatten.
+    struct BVHBuildNode {
+        AABB bounds;
+        uint32_t first;
+        uint32_t count;
+        std::unique_ptr<BVHBuildNode> children[2];
+
+        bool IsLeaf() const { return !children[0]; }
+    };
+
+    namespace Detail {
+        class BVHBuilder {
+        public:
+            // Past this depth splits fall back to the median, which bounds
+            // the tree depth (and so the traversal stack) for any input.
+            static const int MaxSAHDepth = 48;
+
+            BVHBuilder(const AABB* bounds, size_t count, const BVHBuildOptions& options)
+                : bounds(bounds)
+                , options(options)
+                , indices(count)
+                , centroids(count)
+            {
+                assert(options.binCount >= 2 && options.binCount <= MaxBins);
+                for (size_t i = 0; i < count; ++i) {
+                    indices[i] = (uint32_t)i;
+                    centroids[i] = bounds[i].Center();
+                }
+            }
+
+            std::unique_ptr<BVHBuildNode> Build()
+            {
+                unsigned threads = Detail::ThreadCount(indices.size(), options.parallelThreshold, options.threadCount);
+                int threadDepth = 0;
+                while ((1u << threadDepth) < threads)
+                    ++threadDepth;
+                return Build(0, (uint32_t)indices.size(), 0, threadDepth);
+            }
+
+            std::vector<uint32_t>& Indices() { return indices; }
+
+        private:
+            static const uint32_t MaxBins = 32;
+
+            const AABB* bounds;
+            BVHBuildOptions options;
+            std::vector<uint32_t> indices;
+            std::vector<Vector3> centroids;
+
+            static float Axis(const Vector3& v, int axis) { return axis == 0 ? v.x : axis == 1 ? v.y : v.z; }
+
+            std::unique_ptr<BVHBuildNode> Build(uint32_t first, uint32_t count, int depth, int threadDepth)
+            {
+                std::unique_ptr<BVHBuildNode> node(new BVHBuildNode());
+                node->first = first;
+                node->count = count;
+
+                AABB centroidBounds;
+                for (uint32_t i = first; i < first + count; ++i) {
+                    node->bounds.Merge(bounds[indices[i]]);
+                    centroidBounds.Merge(centroids[indices[i]]);
+                }
+                if (count <= options.maxLeafSize)
+                    return node;
+
+                uint32_t middle = Split(first, count, centroidBounds, depth);
+                uint32_t leftCount = middle - first;
+
+                if (count >= options.parallelThreshold && threadDepth > 0) {
+                    std::thread worker([&]() { node->children[0] = Build(first, leftCount, depth + 1, threadDepth - 1); });
+                    node->children[1] = Build(middle, count - leftCount, depth + 1, threadDepth - 1);
+                    worker.join();
+                } else {
+                    node->children[0] = Build(first, leftCount, depth + 1, 0);
+                    node->children[1] = Build(middle, count - leftCount, depth + 1, 0);
+                }
+                return node;
+            }
+
+            // Partitions [first, first + count) and returns the start of the
+            // right half, which is never empty.
+            uint32_t Split(uint32_t first, uint32_t count, const AABB& centroidBounds, int depth)
+            {
+                Vector3 extent = centroidBounds.maximum - centroidBounds.minimum;
+                int axis = extent.x > extent.y && extent.x > extent.z ? 0 : extent.y > extent.z ? 1 : 2;
+                float lo = Axis(centroidBounds.minimum, axis), size = Axis(extent, axis);
+
+                if (size > 0.0f && depth < MaxSAHDepth) {
+                    const uint32_t binCount = options.binCount;
+                    const float scale = binCount / size;
+                    AABB binBounds[MaxBins];
+                    uint32_t binCounts[MaxBins] = { 0 };
+                    for (uint32_t i = first; i < first + count; ++i) {
+                        uint32_t bin = std::min(binCount - 1, (uint32_t)((Axis(centroids[indices[i]], axis) - lo) * scale));
+                        binBounds[bin].Merge(bounds[indices[i]]);
+                        ++binCounts[bin];
+                    }
+
+                    // Sweep from the right for the suffix costs, then from the
+                    // left for the best split: area(left) * n(left) + area(right) * n(right).
+                    float rightCost[MaxBins];
+                    AABB right;
+                    uint32_t rightCount = 0;
+                    for (uint32_t b = binCount - 1; b > 0; --b) {
+                        right.Merge(binBounds[b]);
+                        rightCount += binCounts[b];
+                        rightCost[b] = rightCount ? right.SurfaceArea() * rightCount : 0.0f;
+                    }
+
+                    float bestCost = INFINITY;
+                    uint32_t bestBin = 0;
+                    AABB left;
+                    uint32_t leftCount = 0;
+                    for (uint32_t b = 1; b < binCount; ++b) {
+                        left.Merge(binBounds[b - 1]);
+                        leftCount += binCounts[b - 1];
+                        float cost = (leftCount ? left.SurfaceArea() * leftCount : 0.0f) + rightCost[b];
+                        if (leftCount && leftCount < count && cost < bestCost) {
+                            bestCost = cost;
+                            bestBin = b;
+                        }
+                    }
+
+                    if (bestBin > 0) {
+                        uint32_t* begin = indices.data() + first;
+                        uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t p) {
+                            return std::min(binCount - 1, (uint32_t)((Axis(centroids[p], axis) - lo) * scale)) < bestBin;
+                        });
+                        return first + (uint32_t)(middle - begin);
+                    }
+                }
+
+                // Coincident centroids or too deep: split at the median.
+                uint32_t* begin = indices.data() + first;
+                std::nth_element(begin, begin + count / 2, begin + count, [&](uint32_t a, uint32_t b) {
+                    return Axis(centroids[a], axis) < Axis(centroids[b], axis);
+                });
+                return first + count / 2;
+            }
+        };
+
+        // Ray state for testing the four children of a node.
+        struct BVHRay {
+#if USING_SSE
+            __m128 ox, oy, oz, ix, iy, iz;
+#else
+            float o[3], inv[3];
+#endif
+
+            BVHRay(const Vector3& origin, const Vector3& direction)
+            {
+#if USING_SSE
+                ox = _mm_set1_ps(origin.x);
+                oy = _mm_set1_ps(origin.y);
+                oz = _mm_set1_ps(origin.z);
+                ix = _mm_set1_ps(1.0f / direction.x);
+                iy = _mm_set1_ps(1.0f / direction.y);
+                iz = _mm_set1_ps(1.0f / direction.z);
+#else
+                o[0] = origin.x;
+                o[1] = origin.y;
+                o[2] = origin.z;
+                inv[0] = 1.0f / direction.x;
+                inv[1] = 1.0f / direction.y;
+                inv[2] = 1.0f / direction.z;
+#endif
+            }
+
+            // Slab test against the four children; returns a bit per hit
+            // child and writes the entry parameters. Same NaN handling as
+            // IntersectRay in AABB.h.
+            int Intersect(const BVHNode& n, float tMax, float tEnter[4]) const
+            {
+#if USING_SSE
+                __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.minX), ox), ix);
+                __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.maxX), ox), ix);
+                __m128 enter = _mm_max_ps(_mm_min_ps(t0, t1), _mm_setzero_ps());
+                __m128 exit = _mm_min_ps(_mm_max_ps(t0, t1), _mm_set1_ps(tMax));
+                t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.minY), oy), iy);
+                t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.maxY), oy), iy);
+                enter = _mm_max_ps(_mm_min_ps(t0, t1), enter);
+                exit = _mm_min_ps(_mm_max_ps(t0, t1), exit);
+                t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.minZ), oz), iz);
+                t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(n.maxZ), oz), iz);
+                enter = _mm_max_ps(_mm_min_ps(t0, t1), enter);
+                exit = _mm_min_ps(_mm_max_ps(t0, t1), exit);
+                _mm_storeu_ps(tEnter, enter);
+                return _mm_movemask_ps(_mm_cmple_ps(enter, exit));
+#else
+                const float* lo[3] = { n.minX, n.minY, n.minZ };
+                const float* hi[3] = { n.maxX, n.maxY, n.maxZ };
+                int mask = 0;
+                for (int k = 0; k < 4; ++k) {
+                    float enter = 0.0f, exit = tMax;
+                    for (int a = 0; a < 3; ++a) {
+                        float t0 = (lo[a][k] - o[a]) * inv[a];
+                        float t1 = (hi[a][k] - o[a]) * inv[a];
+                        enter = Max(Min(t0, t1), enter);
+                        exit = Min(Max(t0, t1), exit);
+                    }
+                    tEnter[k] = enter;
+                    mask |= (enter <= exit) << k;
+                }
+                return mask;
+#endif
+            }
+        };
+
+        // Bit per child whose bounds overlap box.
+        inline int OverlapMask(const BVHNode& n, const AABB& box)
+        {
+#if USING_SSE
+            __m128 apart = _mm_cmplt_ps(_mm_load_ps(n.maxX), _mm_set1_ps(box.minimum.x));
+            apart = _mm_or_ps(apart, _mm_cmplt_ps(_mm_load_ps(n.maxY), _mm_set1_ps(box.minimum.y)));
+            apart = _mm_or_ps(apart, _mm_cmplt_ps(_mm_load_ps(n.maxZ), _mm_set1_ps(box.minimum.z)));
+            apart = _mm_or_ps(apart, _mm_cmpgt_ps(_mm_load_ps(n.minX), _mm_set1_ps(box.maximum.x)));
+            apart = _mm_or_ps(apart, _mm_cmpgt_ps(_mm_load_ps(n.minY), _mm_set1_ps(box.maximum.y)));
+            apart = _mm_or_ps(apart, _mm_cmpgt_ps(_mm_load_ps(n.minZ), _mm_set1_ps(box.maximum.z)));
+            return ~_mm_movemask_ps(apart) & 15;
+#else
+            int mask = 0;
+            for (int k = 0; k < 4; ++k)
+                mask |= Intersects(n.Bounds(k), box) << k;
+            return mask;
+#endif
+        }
+
+        // Squared distance from p to the box, 0 inside.
+        inline float SquaredDistance(const AABB& b, const Vector3& p)
+        {
+            float dx = Max(Max(b.minimum.x - p.x, p.x - b.maximum.x), 0.0f);
+            float dy = Max(Max(b.minimum.y - p.y, p.y - b.maximum.y), 0.0f);
+            float dz = Max(Max(b.minimum.z - p.z, p.z - b.maximum.z), 0.0f);
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        // Bit per child within radius of center.
+        inline int SphereMask(const BVHNode& n, const Vector3& center, float radius)
+        {
+#if USING_SSE
+            __m128 zero = _mm_setzero_ps();
+            __m128 c = _mm_set1_ps(center.x);
+            __m128 d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(n.minX), c), _mm_sub_ps(c, _mm_load_ps(n.maxX))), zero);
+            __m128 sum = _mm_mul_ps(d, d);
+            c = _mm_set1_ps(center.y);
+            d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(n.minY), c), _mm_sub_ps(c, _mm_load_ps(n.maxY))), zero);
+            sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+            c = _mm_set1_ps(center.z);
+            d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_load_ps(n.minZ), c), _mm_sub_ps(c, _mm_load_ps(n.maxZ))), zero);
+            sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+            return _mm_movemask_ps(_mm_cmple_ps(sum, _mm_set1_ps(radius * radius)));
+#else
+            int mask = 0;
+            for (int k = 0; k < 4; ++k)
+                mask |= (SquaredDistance(n.Bounds(k), center) <= radius * radius) << k;
+            return mask;
+#endif
+        }
+
+        // Depth-first walk calling visit(primitive) for every primitive in
+        // a leaf selected by childMask(node) whose bounds pass primitiveTest.
+        template <typename ChildMask, typename PrimitiveTest, typename Visit>
+        void VisitBVH(const BVHNodeArray& nodes, const std::vector<uint32_t>& primitives, const std::vector<AABB>& primitiveBounds, ChildMask childMask, PrimitiveTest primitiveTest, Visit& visit)
+        {
+            if (nodes.empty())
+                return;
+
+            uint32_t stack[256];
+            int size = 0;
+            stack[size++] = 0;
+            while (size > 0) {
+                const BVHNode& n = nodes[stack[--size]];
+                int mask = childMask(n);
+                for (int k = 0; k < 4; ++k) {
+                    if (!(mask & (1 << k)) || n.IsEmpty(k))
+                        continue;
+                    if (n.IsLeaf(k)) {
+                        for (uint32_t i = n.child[k]; i < n.child[k] + n.count[k]; ++i)
+                            if (primitiveTest(primitiveBounds[i]))
+                                visit(primitives[i]);
+                    } else {
+                        assert(size < 256);
+                        stack[size++] = n.child[k];
+                    }
+                }
+            }
+        }
+    } // end namespace Detail
+
+    inline void BVH::Build(const AABB* bounds, size_t count, const BVHBuildOptions& options)
+    {
+        assert(count < BVHNode::EmptyChild);
+        nodes.clear();
+        parents.clear();
+        primitives.clear();
+        primitiveBounds.clear();
+        positions.assign(count, 0);
+        leafNodes.assign(count, 0);
+        if (count == 0)
+            return;
+
+        Detail::BVHBuilder builder(bounds, count, options);
+        std::unique_ptr<BVHBuildNode> root = builder.Build();
+        primitives.swap(builder.Indices());
+        primitiveBounds.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            primitiveBounds[i] = bounds[primitives[i]];
+            positions[primitives[i]] = (uint32_t)i;
+        }
+
+        if (root->IsLeaf()) {
+            // Too few primitives to split: a root whose only child is a leaf.
+            BVHNode n;
+            for (int k = 0; k < 4; ++k) {
+                n.child[k] = BVHNode::EmptyChild;
+                n.count[k] = 0;
+                n.SetBounds(k, AABB(Vector3(INFINITY, INFINITY, INFINITY), Vector3(INFINITY, INFINITY, INFINITY)));
+            }
+            n.child[0] = 0;
+            n.count[0] = root->count;
+            n.SetBounds(0, root->bounds);
+            nodes.push_back(n);
+            parents.push_back(BVHNode::EmptyChild);
+        } else {
+            Flatten(root.get(), BVHNode::EmptyChild);
+        }
+    }
+
+    inline uint32_t BVH::Flatten(const BVHBuildNode* node, uint32_t parent)
+    {
+        // Open the largest inner child until there are four.
+        const BVHBuildNode* children[4] = { node->children[0].get(), node->children[1].get(), NULL, NULL };
+        int childCount = 2;
+        while (childCount < 4) {
+            int best = -1;
+            float bestArea = -1.0f;
+            for (int k = 0; k < childCount; ++k) {
+                if (!children[k]->IsLeaf() && children[k]->bounds.SurfaceArea() > bestArea) {
+                    best = k;
+                    bestArea = children[k]->bounds.SurfaceArea();
+                }
+            }
+            if (best < 0)
+                break;
+            const BVHBuildNode* opened = children[best];
+            children[best] = opened->children[0].get();
+            children[childCount++] = opened->children[1].get();
+        }
+
+        uint32_t index = (uint32_t)nodes.size();
+        nodes.push_back(BVHNode());
+        parents.push_back(parent);
+
+        // Empty slots are +inf boxes: no ray, box or sphere reaches them.
+        AABB unused(Vector3(INFINITY, INFINITY, INFINITY), Vector3(INFINITY, INFINITY, INFINITY));
+        for (int k = 0; k < 4; ++k) {
+            // nodes may reallocate in the recursion, so index it each time.
+            if (k >= childCount) {
+                nodes[index].child[k] = BVHNode::EmptyChild;
+                nodes[index].count[k] = 0;
+                nodes[index].SetBounds(k, unused);
+                continue;
+            }
+
+            const BVHBuildNode* c = children[k];
+            uint32_t child = c->first, count = c->count;
+            if (c->IsLeaf()) {
+                for (uint32_t i = c->first; i < c->first + c->count; ++i)
+                    leafNodes[primitives[i]] = index;
+            } else {
+                child = Flatten(c, index);
+                count = 0;
+            }
+            nodes[index].child[k] = child;
+            nodes[index].count[k] = count;
+            nodes[index].SetBounds(k, c->bounds);
+        }
+        return index;
+    }
+
+    inline AABB BVH::Bounds() const
+    {
+        AABB result;
+        if (!nodes.empty())
+            for (int k = 0; k < 4; ++k)
+                if (!nodes[0].IsEmpty(k))
+                    result.Merge(nodes[0].Bounds(k));
+        return result;
+    }
+
+    template <typename Intersect>
+    bool BVH::Raycast(const Vector3& origin, const Vector3& direction, float& tMax, Intersect intersect) const
+    {
+        if (nodes.empty())
+            return false;
+
+        Detail::BVHRay ray(origin, direction);
+        Vector3 inv(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        bool hit = false;
+
+        struct Entry {
+            uint32_t node;
+            float tEnter;
+        };
+        Entry stack[256];
+        int size = 0;
+        stack[size++] = Entry { 0, 0.0f };
+
+        while (size > 0) {
+            Entry e = stack[--size];
+            if (e.tEnter > tMax)
+                continue;
+
+            const BVHNode& n = nodes[e.node];
+            float tEnter[4];
+            int mask = ray.Intersect(n, tMax, tEnter);
+
+            // Hit children sorted near to far.
+            int order[4], hits = 0;
+            for (int k = 0; k < 4; ++k) {
+                if (!(mask & (1 << k)) || n.IsEmpty(k))
+                    continue;
+                int j = hits++;
+                for (; j > 0 && tEnter[order[j - 1]] > tEnter[k]; --j)
+                    order[j] = order[j - 1];
+                order[j] = k;
+            }
+
+            // Leaves now, nearest first; inner nodes pushed far to near so
+            // the nearest is popped next.
+            for (int j = 0; j < hits; ++j) {
+                int k = order[j];
+                if (!n.IsLeaf(k) || tEnter[k] > tMax)
+                    continue;
+                for (uint32_t i = n.child[k]; i < n.child[k] + n.count[k]; ++i) {
+                    float t;
+                    if (IntersectRay(primitiveBounds[i], origin, inv, tMax, t) && intersect(primitives[i], tMax))
+                        hit = true;
+                }
+            }
+            for (int j = hits - 1; j >= 0; --j) {
+                int k = order[j];
+                if (n.IsLeaf(k))
+                    continue;
+                assert(size < 256);
+                stack[size++] = Entry { n.child[k], tEnter[k] };
+            }
+        }
+        return hit;
+    }
+
+    template <typename Visit>
+    void BVH::QueryOverlaps(const AABB& box, Visit visit) const
+    {
+        Detail::VisitBVH(
+            nodes, primitives, primitiveBounds, [&](const BVHNode& n) { return Detail::OverlapMask(n, box); },
+            [&](const AABB& b) { return Intersects(b, box); }, visit);
+    }
+
+    template <typename Visit>
+    void BVH::QuerySphere(const Vector3& center, float radius, Visit visit) const
+    {
+        Detail::VisitBVH(
+            nodes, primitives, primitiveBounds, [&](const BVHNode& n) { return Detail::SphereMask(n, center, radius); },
+            [&](const AABB& b) { return Detail::SquaredDistance(b, center) <= radius * radius; }, visit);
+    }
+
+    inline size_t BVH::CollectOverlaps(const AABB& box, std::vector<uint32_t>& out) const
+    {
+        size_t before = out.size();
+        QueryOverlaps(box, [&](uint32_t p) { out.push_back(p); });
+        return out.size() - before;
+    }
+
+    inline size_t BVH::CollectOverlaps(const Vector3& center, float radius, std::vector<uint32_t>& out) const
+    {
+        size_t before = out.size();
+        QuerySphere(center, radius, [&](uint32_t p) { out.push_back(p); });
+        return out.size() - before;
+    }
+
+    inline void BVH::RefitNode(uint32_t index)
+    {
+        BVHNode& n = nodes[index];
+        for (int k = 0; k < 4; ++k) {
+            if (n.IsEmpty(k))
+                continue;
+            if (n.IsLeaf(k)) {
+                n.SetBounds(k, Union(primitiveBounds.data() + n.child[k], n.count[k]));
+            } else {
+                const BVHNode& c = nodes[n.child[k]];
+                AABB b;
+                for (int j = 0; j < 4; ++j)
+                    if (!c.IsEmpty(j))
+                        b.Merge(c.Bounds(j));
+                n.SetBounds(k, b);
+            }
+        }
+    }
+
+    inline void BVH::Refit(const AABB* bounds)
+    {
+        for (size_t i = 0; i < primitives.size(); ++i)
+            primitiveBounds[i] = bounds[primitives[i]];
+        // Children come after their parents, so a reverse sweep is bottom-up.
+        for (size_t i = nodes.size(); i-- > 0;)
+            RefitNode((uint32_t)i);
+    }
+
+    inline void BVH::Refit(const AABB* bounds, const uint32_t* changed, size_t changedCount)
+    {
+        if (nodes.empty())
+            return;
+
+        std::vector<uint8_t> dirty(nodes.size(), 0);
+        for (size_t i = 0; i < changedCount; ++i) {
+            uint32_t p = changed[i];
+            primitiveBounds[positions[p]] = bounds[p];
+            dirty[leafNodes[p]] = 1;
+        }
+        for (size_t i = nodes.size(); i-- > 0;) {
+            if (!dirty[i])
+                continue;
+            RefitNode((uint32_t)i);
+            if (parents[i] != BVHNode::EmptyChild)
+                dirty[parents[i]] = 1;
+        }
+    }
+
+    inline void TransformBounds(const AABB* local, const Matrix44* transforms, AABB* world, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            world[i] = TransformBounds(local[i], transforms[i]);
+    }
+} // end namespace Math
+} // end namespace Oblivion
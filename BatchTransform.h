@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "Matrix44.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // BATCH TRANSFORMS
+    //
+    // Transform arrays of vectors through one matrix. Strides are in bytes
+    // so the inputs may be fields of larger vertex structs. in == out
+    // (with equal strides) transforms in place; other overlaps are not
+    // supported.
+    //
+    // Points are treated as w = 1 and directions as w = 0, matching
+    // operator*(const Matrix44&, const Vector4&); Vector4 outputs get
+    // w = 1 and w = 0 respectively. With USING_FMA the results may differ
+    // from the single-vector operators by rounding.
+    ********************************************************************/
+    void TransformPoints(const Matrix44& m, const Vector3* in, Vector3* out, size_t count, size_t inStride = sizeof(Vector3), size_t outStride = sizeof(Vector3));
+    void TransformPoints(const Matrix44& m, const Vector4* in, Vector4* out, size_t count, size_t inStride = sizeof(Vector4), size_t outStride = sizeof(Vector4));
+    void TransformDirections(const Matrix44& m, const Vector3* in, Vector3* out, size_t count, size_t inStride = sizeof(Vector3), size_t outStride = sizeof(Vector3));
+    void TransformDirections(const Matrix44& m, const Vector4* in, Vector4* out, size_t count, size_t inStride = sizeof(Vector4), size_t outStride = sizeof(Vector4));
+
+    namespace Detail {
+        template <typename V>
+        inline const V& StridedAt(const V* base, size_t i, size_t stride)
+        {
+            return *reinterpret_cast<const V*>(reinterpret_cast<const char*>(base) + i * stride);
+        }
+
+        template <typename V>
+        inline V& StridedAt(V* base, size_t i, size_t stride)
+        {
+            return *reinterpret_cast<V*>(reinterpret_cast<char*>(base) + i * stride);
+        }
+
+        inline void SetW(Vector3&, float) { }
+        inline void SetW(Vector4& v, float w) { v.w = w; }
+
+#if USING_SSE
+        // Loads (x, y, z, 0) without reading past the end of the vector.
+        inline __m128 LoadXYZ(const Vector3& v)
+        {
+            __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&v.x)));
+            return _mm_movelh_ps(xy, _mm_load_ss(&v.z));
+        }
+
+        inline __m128 LoadXYZ(const Vector4& v)
+        {
+            return _mm_loadu_ps(&v.x);
+        }
+
+        inline void StoreXYZW(Vector3& v, __m128 r)
+        {
+            _mm_storel_pi(reinterpret_cast<__m64*>(&v.x), r);
+            _mm_store_ss(&v.z, _mm_movehl_ps(r, r));
+        }
+
+        inline void StoreXYZW(Vector4& v, __m128 r)
+        {
+            _mm_storeu_ps(&v.x, r);
+        }
+#endif
+
+        // Shared kernel for the public overloads. Point selects whether the
+        // translation row is applied.
+        template <bool Point, typename V>
+        void TransformArray(const Matrix44& m, const V* in, V* out, size_t count, size_t inStride, size_t outStride)
+        {
+            const float w = Point ? 1.0f : 0.0f;
+            size_t i = 0;
+
+#if USING_AVX2
+            // Eight vectors per iteration: pairs are packed into the two 128-bit
+            // lanes and transposed in-lane to x/y/z registers.
+            {
+                __m256 m00 = _mm256_set1_ps(m[0][0]), m01 = _mm256_set1_ps(m[0][1]), m02 = _mm256_set1_ps(m[0][2]);
+                __m256 m10 = _mm256_set1_ps(m[1][0]), m11 = _mm256_set1_ps(m[1][1]), m12 = _mm256_set1_ps(m[1][2]);
+                __m256 m20 = _mm256_set1_ps(m[2][0]), m21 = _mm256_set1_ps(m[2][1]), m22 = _mm256_set1_ps(m[2][2]);
+                __m256 t0 = _mm256_set1_ps(Point ? m[3][0] : 0.0f);
+                __m256 t1 = _mm256_set1_ps(Point ? m[3][1] : 0.0f);
+                __m256 t2 = _mm256_set1_ps(Point ? m[3][2] : 0.0f);
+                __m256 wv = _mm256_set1_ps(w);
+
+                for (; i + 8 <= count; i += 8) {
+                    __m256 x = _mm256_set_m128(LoadXYZ(StridedAt(in, i + 4, inStride)), LoadXYZ(StridedAt(in, i + 0, inStride)));
+                    __m256 y = _mm256_set_m128(LoadXYZ(StridedAt(in, i + 5, inStride)), LoadXYZ(StridedAt(in, i + 1, inStride)));
+                    __m256 z = _mm256_set_m128(LoadXYZ(StridedAt(in, i + 6, inStride)), LoadXYZ(StridedAt(in, i + 2, inStride)));
+                    __m256 r = _mm256_set_m128(LoadXYZ(StridedAt(in, i + 7, inStride)), LoadXYZ(StridedAt(in, i + 3, inStride)));
+                    Transpose4InLanes(x, y, z, r);
+
+                    __m256 ox = MulAdd(x, m00, MulAdd(y, m10, MulAdd(z, m20, t0)));
+                    __m256 oy = MulAdd(x, m01, MulAdd(y, m11, MulAdd(z, m21, t1)));
+                    __m256 oz = MulAdd(x, m02, MulAdd(y, m12, MulAdd(z, m22, t2)));
+                    __m256 ow = wv;
+                    Transpose4InLanes(ox, oy, oz, ow);
+
+                    StoreXYZW(StridedAt(out, i + 0, outStride), _mm256_castps256_ps128(ox));
+                    StoreXYZW(StridedAt(out, i + 1, outStride), _mm256_castps256_ps128(oy));
+                    StoreXYZW(StridedAt(out, i + 2, outStride), _mm256_castps256_ps128(oz));
+                    StoreXYZW(StridedAt(out, i + 3, outStride), _mm256_castps256_ps128(ow));
+                    StoreXYZW(StridedAt(out, i + 4, outStride), _mm256_extractf128_ps(ox, 1));
+                    StoreXYZW(StridedAt(out, i + 5, outStride), _mm256_extractf128_ps(oy, 1));
+                    StoreXYZW(StridedAt(out, i + 6, outStride), _mm256_extractf128_ps(oz, 1));
+                    StoreXYZW(StridedAt(out, i + 7, outStride), _mm256_extractf128_ps(ow, 1));
+                }
+            }
+#endif
+
+#if USING_SSE
+            // Four vectors per iteration (and the AVX2 remainder).
+            {
+                __m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]);
+                __m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]);
+                __m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]);
+                __m128 t0 = _mm_set1_ps(Point ? m[3][0] : 0.0f);
+                __m128 t1 = _mm_set1_ps(Point ? m[3][1] : 0.0f);
+                __m128 t2 = _mm_set1_ps(Point ? m[3][2] : 0.0f);
+
+                for (; i + 4 <= count; i += 4) {
+                    __m128 x = LoadXYZ(StridedAt(in, i + 0, inStride));
+                    __m128 y = LoadXYZ(StridedAt(in, i + 1, inStride));
+                    __m128 z = LoadXYZ(StridedAt(in, i + 2, inStride));
+                    __m128 r = LoadXYZ(StridedAt(in, i + 3, inStride));
+                    _MM_TRANSPOSE4_PS(x, y, z, r);
+
+                    __m128 ox = MulAdd(x, m00, MulAdd(y, m10, MulAdd(z, m20, t0)));
+                    __m128 oy = MulAdd(x, m01, MulAdd(y, m11, MulAdd(z, m21, t1)));
+                    __m128 oz = MulAdd(x, m02, MulAdd(y, m12, MulAdd(z, m22, t2)));
+                    __m128 ow = _mm_set1_ps(w);
+                    _MM_TRANSPOSE4_PS(ox, oy, oz, ow);
+
+                    StoreXYZW(StridedAt(out, i + 0, outStride), ox);
+                    StoreXYZW(StridedAt(out, i + 1, outStride), oy);
+                    StoreXYZW(StridedAt(out, i + 2, outStride), oz);
+                    StoreXYZW(StridedAt(out, i + 3, outStride), ow);
+                }
+            }
+#endif
+
+            // Scalar loop with the matrix hoisted into locals.
+            const float m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+            const float m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+            const float m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+            const float t0 = Point ? m[3][0] : 0.0f;
+            const float t1 = Point ? m[3][1] : 0.0f;
+            const float t2 = Point ? m[3][2] : 0.0f;
+
+            for (; i < count; ++i) {
+                const V& v = StridedAt(in, i, inStride);
+                float x = v.x, y = v.y, z = v.z;
+
+                V& r = StridedAt(out, i, outStride);
+                r.x = x * m00 + y * m10 + z * m20 + t0;
+                r.y = x * m01 + y * m11 + z * m21 + t1;
+                r.z = x * m02 + y * m12 + z * m22 + t2;
+                SetW(r, w);
+            }
+        }
+    } // end namespace Detail
+
+    inline void TransformPoints(const Matrix44& m, const Vector3* in, Vector3* out, size_t count, size_t inStride, size_t outStride)
+    {
+        Detail::TransformArray<true>(m, in, out, count, inStride, outStride);
+    }
+
+    inline void TransformPoints(const Matrix44& m, const Vector4* in, Vector4* out, size_t count, size_t inStride, size_t outStride)
+    {
+        Detail::TransformArray<true>(m, in, out, count, inStride, outStride);
+    }
+
+    inline void TransformDirections(const Matrix44& m, const Vector3* in, Vector3* out, size_t count, size_t inStride, size_t outStride)
+    {
+        Detail::TransformArray<false>(m, in, out, count, inStride, outStride);
+    }
+
+    inline void TransformDirections(const Matrix44& m, const Vector4* in, Vector4* out, size_t count, size_t inStride, size_t outStride)
+    {
+        Detail::TransformArray<false>(m, in, out, count, inStride, outStride);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+
+#include "Matrix44.h"
+#include "Quaternion.h"
+#include "Transform.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // DUAL QUATERNION
+    //
+    // A rigid transform as real + dual * e: real is the rotation and
+    // dual = 0.5 * (0, translation) * real. Like Quaternion<T>, a * b is
+    // the algebraic product and applies b first. Unit dual quaternions
+    // (|real| = 1, real . dual = 0) are assumed unless noted; blends are
+    // brought back with Normalized.
+    ********************************************************************/
+    template <typename T>
+    class DualQuaternion {
+    public:
+        Quaternion<T> real;
+        Quaternion<T> dual;
+
+        DualQuaternion()
+            : real(T(1), Vector3D<T>(T(0), T(0), T(0)))
+            , dual(T(0), Vector3D<T>(T(0), T(0), T(0)))
+        {
+        }
+
+        DualQuaternion(const Quaternion<T>& real, const Quaternion<T>& dual)
+            : real(real)
+            , dual(dual)
+        {
+        }
+
+        // Rotation by the unit quaternion, then translation.
+        DualQuaternion(const Quaternion<T>& rotation, const Vector3D<T>& translation)
+            : real(rotation)
+            , dual(Quaternion<T>(T(0), translation * T(0.5)) * rotation)
+        {
+        }
+
+        const Quaternion<T>& Rotation() const { return real; }
+        Vector3D<T> Translation() const;
+
+        Vector3D<T> TransformPoint(const Vector3D<T>& p) const;
+        Vector3D<T> TransformDirection(const Vector3D<T>& d) const;
+
+        DualQuaternion operator*(const DualQuaternion& b) const;
+        DualQuaternion operator*(T scalar) const { return DualQuaternion(real * scalar, dual * scalar); }
+        DualQuaternion operator+(const DualQuaternion& b) const { return DualQuaternion(real + b.real, dual + b.dual); }
+
+        // Conjugate of both parts: the inverse of a unit dual quaternion.
+        DualQuaternion Conjugate() const;
+        // Divided by |real|, with the part of dual along real removed.
+        // real must not be zero.
+        DualQuaternion Normalized() const;
+
+        // The scale of t is dropped; FromMatrix44 takes a rotation and
+        // translation matrix as produced by ToMatrix44.
+        static DualQuaternion FromTransform(const Transform& t);
+        Transform ToTransform() const;
+        static DualQuaternion FromMatrix44(const Matrix44& m) { return FromTransform(Transform::FromMatrix44(m)); }
+        Matrix44 ToMatrix44() const { return ToTransform().ToMatrix44(); }
+    };
+
+    // Dual quaternion linear blending: the weighted sum, with each term's
+    // sign flipped onto the hemisphere of dq[0], normalized. The weights
+    // must not cancel out.
+    template <typename T>
+    DualQuaternion<T> Blend(const DualQuaternion<T>* dq, const T* weights, size_t count);
+
+    namespace Detail {
+        template <typename T>
+        inline Quaternion<T> Conjugate(const Quaternion<T>& q)
+        {
+            return Quaternion<T>(q.w, Vector3D<T>(-q.v.x, -q.v.y, -q.v.z));
+        }
+
+        template <typename T>
+        inline T Dot(const Quaternion<T>& a, const Quaternion<T>& b)
+        {
+            return a.w * b.w + a.v.x * b.v.x + a.v.y * b.v.y + a.v.z * b.v.z;
+        }
+    } // end namespace Detail
+
+    template <typename T>
+    inline Vector3D<T> DualQuaternion<T>::Translation() const
+    {
+        // 2 * dual * conjugate(real), which has no scalar part.
+        Quaternion<T> t = dual * Detail::Conjugate(real);
+        return t.v * T(2);
+    }
+
+    template <typename T>
+    inline Vector3D<T> DualQuaternion<T>::TransformDirection(const Vector3D<T>& d) const
+    {
+        return real.Rotate(d);
+    }
+
+    template <typename T>
+    inline Vector3D<T> DualQuaternion<T>::TransformPoint(const Vector3D<T>& p) const
+    {
+        return TransformDirection(p) + Translation();
+    }
+
+    template <typename T>
+    inline DualQuaternion<T> DualQuaternion<T>::operator*(const DualQuaternion& b) const
+    {
+        return DualQuaternion(real * b.real, real * b.dual + dual * b.real);
+    }
+
+    template <typename T>
+    inline DualQuaternion<T> DualQuaternion<T>::Conjugate() const
+    {
+        return DualQuaternion(Detail::Conjugate(real), Detail::Conjugate(dual));
+    }
+
+    template <typename T>
+    inline DualQuaternion<T> DualQuaternion<T>::Normalized() const
+    {
+        T inverseLength = T(1) / sqrt(Detail::Dot(real, real));
+        Quaternion<T> r = real * inverseLength;
+        Quaternion<T> d = dual * inverseLength;
+        return DualQuaternion(r, d - r * Detail::Dot(r, d));
+    }
+
+    template <typename T>
+    inline DualQuaternion<T> DualQuaternion<T>::FromTransform(const Transform& t)
+    {
+        const Quaternion<float>& q = t.rotation;
+        Quaternion<T> rotation(T(q.w), Vector3D<T>(T(q.v.x), T(q.v.y), T(q.v.z)));
+        return DualQuaternion(rotation, Vector3D<T>(T(t.translation.x), T(t.translation.y), T(t.translation.z)));
+    }
+
+    template <typename T>
+    inline Transform DualQuaternion<T>::ToTransform() const
+    {
+        Vector3D<T> t = Translation();
+        return Transform(Quaternion<float>(float(real.w), Vector3D<float>(float(real.v.x), float(real.v.y), float(real.v.z))), Vector3(float(t.x), float(t.y), float(t.z)));
+    }
+
+    template <typename T>
+    inline DualQuaternion<T> Blend(const DualQuaternion<T>* dq, const T* weights, size_t count)
+    {
+        DualQuaternion<T> sum = dq[0] * weights[0];
+        for (size_t i = 1; i < count; ++i) {
+            T w = Detail::Dot(dq[0].real, dq[i].real) < T(0) ? -weights[i] : weights[i];
+            sum = sum + dq[i] * w;
+        }
+        return sum.Normalized();
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -1 +1,369 @@
 #pragma once
+
+#include <math.h>
+#include <limits>
+
+#include "MathFunctions.h"
+#include "Quaternion.h"
+#include "QuaternionStream.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // EULER ANGLES
+    //
+    // Three angles (radians) about fixed axes, applied in the order the
+    // name spells: XYZ rotates about x first, then y, then z, so for row
+    // vectors the matrix is Rx * Ry * Rz and the quaternion qz * qy * qx.
+    // Read right to left, the same name is the intrinsic sequence z-y'-x''.
+    // The first six orders use three different axes (Tait-Bryan: yaw,
+    // pitch, roll); the last six repeat the first axis (proper Euler).
+    //
+    // Conversions back to angles work directly on the quaternion (matrices
+    // are converted to a quaternion first). The middle angle lands in
+    // [-pi/2, pi/2] for Tait-Bryan orders and [0, pi] for proper Euler
+    // ones, the others in [-pi, pi]. At gimbal lock only the sum or
+    // difference of the first and third angles is defined; the third is
+    // then set to zero.
+    ********************************************************************/
+    enum class EulerOrder {
+        XYZ,
+        XZY,
+        YXZ,
+        YZX,
+        ZXY,
+        ZYX,
+        XYX,
+        XZX,
+        YXY,
+        YZY,
+        ZXZ,
+        ZYZ
+    };
+
+    template <typename T>
+    class EulerAngles {
+    public:
+        T first;
+        T second;
+        T third;
+        EulerOrder order;
+
+        EulerAngles()
+            : first(0)
+            , second(0)
+            , third(0)
+            , order(EulerOrder::XYZ)
+        {
+        }
+
+        EulerAngles(const T& first, const T& second, const T& third, EulerOrder order = EulerOrder::XYZ)
+            : first(first)
+            , second(second)
+            , third(third)
+            , order(order)
+        {
+        }
+
+        Quaternion<T> ToQuaternion() const;
+        Mat3x3<T> ToMat3x3() const { return ToQuaternion().ToMat3x3(); }
+        Matrix44 ToMatrix44() const { return ToQuaternion().ToMatrix44(); }
+
+        // q need not be normalized, and q and -q give the same angles.
+        static EulerAngles FromQuaternion(const Quaternion<T>& q, EulerOrder order);
+        // The upper 3x3 of m must be a rotation.
+        static EulerAngles FromMatrix(const Mat3x3<T>& m, EulerOrder order) { return FromQuaternion(Quaternion<T>::FromMatrix(m), order); }
+        static EulerAngles FromMatrix(const Matrix44& m, EulerOrder order) { return FromQuaternion(Quaternion<T>::FromMatrix(m), order); }
+    };
+
+    // Batch conversions for animation tracks. The angles are a
+    // Vector3Stream whose x, y and z hold the first, second and third
+    // angle; every element uses the same order. Outputs are resized to
+    // the input count, except the caller-allocated matrices.
+    void EulerToQuaternionMany(const Vector3StreamView& angles, EulerOrder order, QuaternionStream& out);
+    void EulerToMatrix44Many(const Vector3StreamView& angles, EulerOrder order, Matrix44* out);
+    void QuaternionToEulerMany(const QuaternionStreamView& q, EulerOrder order, Vector3Stream& out);
+
+    namespace Detail {
+        // Axis indices of an order: i, j and k are the first, second and
+        // third axes, m the one not among i and j. parity is +1 when
+        // (i, j, m) is a cyclic permutation of (0, 1, 2), so e_i x e_j
+        // = parity * e_m.
+        struct EulerAxes {
+            int i, j, k, m;
+            bool proper;
+            int parity;
+        };
+
+        constexpr EulerAxes AxesOf(EulerOrder order)
+        {
+            // Orders come in pairs sharing the first axis, the second axis
+            // being the lower of the other two, then the higher.
+            int n = int(order) % 6;
+            int i = n / 2;
+            int j = n % 2 == 0 ? (i == 0 ? 1 : 0) : (i == 2 ? 1 : 2);
+            bool proper = int(order) >= 6;
+            return EulerAxes{ i, j, proper ? i : 3 - i - j, 3 - i - j, proper, (j - i + 3) % 3 == 1 ? 1 : -1 };
+        }
+
+        // The Hamilton product q_k(third) * q_j(second) * q_i(first) from
+        // half-angle sines s and cosines c, into q = (w, x, y, z).
+        template <typename T>
+        inline void EulerProduct(const EulerAxes& e, T s1, T c1, T s2, T c2, T s3, T c3, T* q)
+        {
+            // q_j * q_i: the cross term e_j x e_i lies along -parity * e_m.
+            T t[4];
+            t[0] = c2 * c1;
+            t[1 + e.i] = c2 * s1;
+            t[1 + e.j] = s2 * c1;
+            t[1 + e.m] = T(-e.parity) * (s2 * s1);
+
+            // q_k * t, with e_k x t = t[k + 1] e_[k + 2] - t[k + 2] e_[k + 1].
+            int k1 = (e.k + 1) % 3, k2 = (e.k + 2) % 3;
+            q[0] = c3 * t[0] - s3 * t[1 + e.k];
+            q[1 + e.k] = c3 * t[1 + e.k] + s3 * t[0];
+            q[1 + k1] = c3 * t[1 + k1] - s3 * t[1 + k2];
+            q[1 + k2] = c3 * t[1 + k2] + s3 * t[1 + k1];
+        }
+
+        // Moves an angle in (-2 pi, 2 pi) into [-pi, pi].
+        template <typename T>
+        inline T WrapAngle(T angle)
+        {
+            const T pi = T(3.14159265358979323846), twoPi = T(6.28318530717958647692);
+            return angle > pi ? angle - twoPi : (angle < -pi ? angle + twoPi : angle);
+        }
+    } // end namespace Detail
+
+    template <typename T>
+    inline Quaternion<T> EulerAngles<T>::ToQuaternion() const
+    {
+        T s1, c1, s2, c2, s3, c3;
+        Detail::ScalarSinCos(first * T(0.5), s1, c1);
+        Detail::ScalarSinCos(second * T(0.5), s2, c2);
+        Detail::ScalarSinCos(third * T(0.5), s3, c3);
+        T q[4];
+        Detail::EulerProduct(Detail::AxesOf(order), s1, c1, s2, c2, s3, c3, q);
+        return Quaternion<T>(q[0], Vector3D<T>(q[1], q[2], q[3]));
+    }
+
+    template <typename T>
+    inline EulerAngles<T> EulerAngles<T>::FromQuaternion(const Quaternion<T>& q, EulerOrder order)
+    {
+        // Bernardes and Viollet's direct method: a, b, c, d are the
+        // quaternion of the equivalent proper Euler sequence (Tait-Bryan
+        // orders are rotated onto one), whose half-angle sum and
+        // difference are atan2(b, a) and atan2(d, c).
+        const Detail::EulerAxes e = Detail::AxesOf(order);
+        const T v[3] = { q.v.x, q.v.y, q.v.z };
+        const T sign = T(e.parity);
+        T a, b, c, d;
+        if (e.proper) {
+            a = q.w;
+            b = v[e.i];
+            c = v[e.j];
+            d = v[e.m] * sign;
+        } else {
+            a = q.w - v[e.j];
+            b = v[e.i] + v[e.m] * sign;
+            c = v[e.j] + q.w;
+            d = v[e.m] * sign - v[e.i];
+        }
+
+        T ab = sqrt(a * a + b * b), cd = sqrt(c * c + d * d);
+        T halfSum = Detail::ScalarATan2(b, a), halfDiff = Detail::ScalarATan2(d, c);
+        const T lock = T(16) * std::numeric_limits<T>::epsilon();
+
+        EulerAngles result(0, T(2) * Detail::ScalarATan2(cd, ab), 0, order);
+        if (cd <= lock * ab)
+            result.first = T(2) * halfSum;
+        else if (ab <= lock * cd)
+            result.first = T(-2) * halfDiff;
+        else {
+            result.first = halfSum - halfDiff;
+            result.third = halfSum + halfDiff;
+        }
+        if (!e.proper) {
+            result.second -= T(1.57079632679489661923);
+            result.third *= sign;
+        }
+        result.first = Detail::WrapAngle(result.first);
+        result.third = Detail::WrapAngle(result.third);
+        return result;
+    }
+
+    namespace Detail {
+        // Lane versions of EulerProduct and FromQuaternion, with the axes
+        // fixed at compile time so the index arithmetic folds away.
+        template <EulerOrder O, typename F>
+        inline void EulerQuaternionLanes(F first, F second, F third, F* q)
+        {
+            constexpr EulerAxes e = AxesOf(O);
+            F half = Broadcast(0.5f, first);
+            F s1, c1, s2, c2, s3, c3;
+            SinCos(Mul(first, half), s1, c1);
+            SinCos(Mul(second, half), s2, c2);
+            SinCos(Mul(third, half), s3, c3);
+
+            F t[4];
+            t[0] = Mul(c2, c1);
+            t[1 + e.i] = Mul(c2, s1);
+            t[1 + e.j] = Mul(s2, c1);
+            t[1 + e.m] = Mul(Broadcast(float(-e.parity), first), Mul(s2, s1));
+
+            constexpr int k1 = (e.k + 1) % 3, k2 = (e.k + 2) % 3;
+            q[0] = Sub(Mul(c3, t[0]), Mul(s3, t[1 + e.k]));
+            q[1 + e.k] = MulAdd(c3, t[1 + e.k], Mul(s3, t[0]));
+            q[1 + k1] = Sub(Mul(c3, t[1 + k1]), Mul(s3, t[1 + k2]));
+            q[1 + k2] = MulAdd(c3, t[1 + k2], Mul(s3, t[1 + k1]));
+        }
+
+        template <typename F>
+        inline F WrapAngleLanes(F angle)
+        {
+            F pi = Broadcast(3.14159265f, angle), twoPi = Broadcast(6.28318531f, angle);
+            angle = Select(LessThan(pi, angle), Sub(angle, twoPi), angle);
+            return Select(LessThan(angle, Sub(Broadcast(0.0f, angle), pi)), Add(angle, twoPi), angle);
+        }
+
+        template <EulerOrder O, typename F>
+        inline void EulerAnglesLanes(const F* q, F& first, F& second, F& third)
+        {
+            constexpr EulerAxes e = AxesOf(O);
+            F zero = Broadcast(0.0f, q[0]), two = Broadcast(2.0f, q[0]);
+            F sign = Broadcast(float(e.parity), q[0]);
+            F a, b, c, d;
+            if (e.proper) {
+                a = q[0];
+                b = q[1 + e.i];
+                c = q[1 + e.j];
+                d = Mul(q[1 + e.m], sign);
+            } else {
+                a = Sub(q[0], q[1 + e.j]);
+                b = MulAdd(q[1 + e.m], sign, q[1 + e.i]);
+                c = Add(q[1 + e.j], q[0]);
+                d = Sub(Mul(q[1 + e.m], sign), q[1 + e.i]);
+            }
+
+            F ab = Sqrt(MulAdd(a, a, Mul(b, b))), cd = Sqrt(MulAdd(c, c, Mul(d, d)));
+            F halfSum = ATan2(b, a), halfDiff = ATan2(d, c);
+            F lock = Broadcast(16.0f * std::numeric_limits<float>::epsilon(), q[0]);
+            auto middleZero = LessThan(cd, Mul(lock, ab));
+            auto middlePi = LessThan(ab, Mul(lock, cd));
+
+            second = Mul(two, ATan2(cd, ab));
+            first = Select(middleZero, Mul(two, halfSum), Select(middlePi, Mul(Broadcast(-2.0f, q[0]), halfDiff), Sub(halfSum, halfDiff)));
+            third = Select(middleZero, zero, Select(middlePi, zero, Add(halfSum, halfDiff)));
+            if (!e.proper) {
+                second = Sub(second, Broadcast(1.57079633f, q[0]));
+                third = Mul(third, sign);
+            }
+            first = WrapAngleLanes(first);
+            third = WrapAngleLanes(third);
+        }
+
+        struct EulerToQuaternionData {
+            Vector3StreamView angles;
+            float *w, *x, *y, *z;
+        };
+
+        struct EulerToMatrixData {
+            Vector3StreamView angles;
+            Matrix44* out;
+        };
+
+        struct QuaternionToEulerData {
+            QuaternionStreamView q;
+            float *first, *second, *third;
+        };
+
+        template <EulerOrder O>
+        struct EulerToQuaternionKernel {
+            EulerToQuaternionData d;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F q[4];
+                EulerQuaternionLanes<O>(LoadLanes(d.angles.x + i, lanes), LoadLanes(d.angles.y + i, lanes), LoadLanes(d.angles.z + i, lanes), q);
+                StoreLanes(d.w + i, q[0]);
+                StoreLanes(d.x + i, q[1]);
+                StoreLanes(d.y + i, q[2]);
+                StoreLanes(d.z + i, q[3]);
+            }
+        };
+
+        template <EulerOrder O>
+        struct EulerToMatrixKernel {
+            EulerToMatrixData d;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F q[4], r[9];
+                EulerQuaternionLanes<O>(LoadLanes(d.angles.x + i, lanes), LoadLanes(d.angles.y + i, lanes), LoadLanes(d.angles.z + i, lanes), q);
+                RotationLanes(q[0], q[1], q[2], q[3], r);
+                StoreRotation(d.out + i, r);
+            }
+        };
+
+        template <EulerOrder O>
+        struct QuaternionToEulerKernel {
+            QuaternionToEulerData d;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F q[4] = { LoadLanes(d.q.w + i, lanes), LoadLanes(d.q.x + i, lanes), LoadLanes(d.q.y + i, lanes), LoadLanes(d.q.z + i, lanes) };
+                F first, second, third;
+                EulerAnglesLanes<O>(q, first, second, third);
+                StoreLanes(d.first + i, first);
+                StoreLanes(d.second + i, second);
+                StoreLanes(d.third + i, third);
+            }
+        };
+
+        // ForEachLanes over Kernel<order>{ data }, one instantiation per
+        // order.
+        template <template <EulerOrder> class Kernel, typename Data>
+        inline void ForEachLanes(EulerOrder order, size_t count, const Data& data)
+        {
+            switch (order) {
+            case EulerOrder::XYZ: ForEachLanes(count, Kernel<EulerOrder::XYZ>{ data }); break;
+            case EulerOrder::XZY: ForEachLanes(count, Kernel<EulerOrder::XZY>{ data }); break;
+            case EulerOrder::YXZ: ForEachLanes(count, Kernel<EulerOrder::YXZ>{ data }); break;
+            case EulerOrder::YZX: ForEachLanes(count, Kernel<EulerOrder::YZX>{ data }); break;
+            case EulerOrder::ZXY: ForEachLanes(count, Kernel<EulerOrder::ZXY>{ data }); break;
+            case EulerOrder::ZYX: ForEachLanes(count, Kernel<EulerOrder::ZYX>{ data }); break;
+            case EulerOrder::XYX: ForEachLanes(count, Kernel<EulerOrder::XYX>{ data }); break;
+            case EulerOrder::XZX: ForEachLanes(count, Kernel<EulerOrder::XZX>{ data }); break;
+            case EulerOrder::YXY: ForEachLanes(count, Kernel<EulerOrder::YXY>{ data }); break;
+            case EulerOrder::YZY: ForEachLanes(count, Kernel<EulerOrder::YZY>{ data }); break;
+            case EulerOrder::ZXZ: ForEachLanes(count, Kernel<EulerOrder::ZXZ>{ data }); break;
+            case EulerOrder::ZYZ: ForEachLanes(count, Kernel<EulerOrder::ZYZ>{ data }); break;
+            }
+        }
+    } // end namespace Detail
+
+    inline void EulerToQuaternionMany(const Vector3StreamView& angles, EulerOrder order, QuaternionStream& out)
+    {
+        out.Resize(angles.count);
+        Detail::EulerToQuaternionData data = { angles, out.W(), out.X(), out.Y(), out.Z() };
+        Detail::ForEachLanes<Detail::EulerToQuaternionKernel>(order, angles.count, data);
+    }
+
+    inline void EulerToMatrix44Many(const Vector3StreamView& angles, EulerOrder order, Matrix44* out)
+    {
+        Detail::EulerToMatrixData data = { angles, out };
+        Detail::ForEachLanes<Detail::EulerToMatrixKernel>(order, angles.count, data);
+    }
+
+    inline void QuaternionToEulerMany(const QuaternionStreamView& q, EulerOrder order, Vector3Stream& out)
+    {
+        out.Resize(q.count);
+        Detail::QuaternionToEulerData data = { q, out.X(), out.Y(), out.Z() };
+        Detail::ForEachLanes<Detail::QuaternionToEulerKernel>(order, q.count, data);
+    }
+} // end namespace Math
+} // end namespace Oblivion
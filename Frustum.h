@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "3DParametric.h"
+#include "AABB.h"
+#include "MatrixClipSpace.h"
+
+namespace Oblivion {
+namespace Math {
+    // Six planes with unit normals pointing into the volume.
+    class Frustum {
+    public:
+        enum PlaneIndex {
+            Left,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far,
+            PlaneCount
+        };
+
+        Plane planes[PlaneCount];
+
+        // Planes of the clip volume of m (Gribb-Hartmann), in the space m
+        // transforms from: pass view * projection for world-space planes.
+        // The near plane follows the depth range selected by USING_OPENGL.
+        static Frustum FromMatrix(const Matrix44& m);
+
+        bool Contains(const Vector3& p) const;
+
+        // Conservative tests: volumes outside the frustum but near one of its
+        // edges may be reported as intersecting, never the reverse.
+        bool Intersects(const Vector3& boxMin, const Vector3& boxMax) const;
+        bool Intersects(const Vector3& center, float radius) const;
+        bool Intersects(const AABB& box) const;
+    };
+
+    /********************************************************************
+    // BATCH CULLING
+    //
+    // Writes the indices of the volumes that intersect the frustum to
+    // visible, in increasing order, and returns how many there are. visible
+    // must have room for count indices. Each element gets the answer of
+    // Frustum::Intersects, up to rounding for volumes touching a plane.
+    ********************************************************************/
+    size_t CullAABBs(const Frustum& frustum, const AABBStreamView& boxes, uint32_t* visible);
+    size_t CullSpheres(const Frustum& frustum, const SphereStreamView& spheres, uint32_t* visible);
+
+    inline Frustum Frustum::FromMatrix(const Matrix44& m)
+    {
+        // With row vectors clip = v * m, so each clip coordinate is a dot
+        // product with a column of m.
+        Plane column[4];
+        for (int j = 0; j < 4; ++j)
+            column[j] = Plane(m[0][j], m[1][j], m[2][j], m[3][j]);
+
+        Frustum f;
+        f.planes[Left] = Plane(column[3].normal + column[0].normal, column[3].d + column[0].d);
+        f.planes[Right] = Plane(column[3].normal - column[0].normal, column[3].d - column[0].d);
+        f.planes[Bottom] = Plane(column[3].normal + column[1].normal, column[3].d + column[1].d);
+        f.planes[Top] = Plane(column[3].normal - column[1].normal, column[3].d - column[1].d);
+#if USING_OPENGL == 0
+        f.planes[Near] = column[2];
+#else
+        f.planes[Near] = Plane(column[3].normal + column[2].normal, column[3].d + column[2].d);
+#endif
+        f.planes[Far] = Plane(column[3].normal - column[2].normal, column[3].d - column[2].d);
+
+        for (int i = 0; i < PlaneCount; ++i)
+            f.planes[i].Normalize();
+        return f;
+    }
+
+    inline bool Frustum::Contains(const Vector3& p) const
+    {
+        for (int i = 0; i < PlaneCount; ++i)
+            if (planes[i].SignedDistance(p) < 0.0f)
+                return false;
+        return true;
+    }
+
+    inline bool Frustum::Intersects(const Vector3& boxMin, const Vector3& boxMax) const
+    {
+        // Only the corner furthest along the normal needs testing.
+        for (int i = 0; i < PlaneCount; ++i) {
+            const Vector3& n = planes[i].normal;
+            Vector3 corner(n.x >= 0.0f ? boxMax.x : boxMin.x, n.y >= 0.0f ? boxMax.y : boxMin.y, n.z >= 0.0f ? boxMax.z : boxMin.z);
+            if (planes[i].SignedDistance(corner) < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    inline bool Frustum::Intersects(const Vector3& center, float radius) const
+    {
+        for (int i = 0; i < PlaneCount; ++i)
+            if (planes[i].SignedDistance(center) + radius < 0.0f)
+                return false;
+        return true;
+    }
+
+    inline bool Frustum::Intersects(const AABB& box) const
+    {
+        return Intersects(box.minimum, box.maximum);
+    }
+
+    namespace Detail {
+        // One plane and the component arrays holding each box's corner
+        // furthest along its normal.
+        struct BoxCullPlane {
+            const float* x;
+            const float* y;
+            const float* z;
+            float nx, ny, nz, d;
+        };
+
+        // Smallest signed distance of the far corners over all planes; the
+        // box is outside where it is negative.
+        struct BoxDistance {
+            BoxCullPlane planes[Frustum::PlaneCount];
+
+            BoxDistance(const Frustum& f, const AABBStreamView& boxes)
+            {
+                for (int k = 0; k < Frustum::PlaneCount; ++k) {
+                    const Plane& p = f.planes[k];
+                    BoxCullPlane c = { p.normal.x >= 0.0f ? boxes.maxX : boxes.minX, p.normal.y >= 0.0f ? boxes.maxY : boxes.minY, p.normal.z >= 0.0f ? boxes.maxZ : boxes.minZ, p.normal.x, p.normal.y, p.normal.z, p.d };
+                    planes[k] = c;
+                }
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F result = Broadcast(INFINITY, lanes);
+                for (int k = 0; k < Frustum::PlaneCount; ++k) {
+                    const BoxCullPlane& p = planes[k];
+                    F distance = MulAdd(LoadLanes(p.z + i, lanes), Broadcast(p.nz, lanes), Broadcast(p.d, lanes));
+                    distance = MulAdd(LoadLanes(p.y + i, lanes), Broadcast(p.ny, lanes), distance);
+                    distance = MulAdd(LoadLanes(p.x + i, lanes), Broadcast(p.nx, lanes), distance);
+                    result = Min(result, distance);
+                }
+                return result;
+            }
+        };
+
+        struct SphereDistance {
+            const Frustum& frustum;
+            const SphereStreamView& spheres;
+
+            SphereDistance(const Frustum& f, const SphereStreamView& spheres)
+                : frustum(f)
+                , spheres(spheres)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F x = LoadLanes(spheres.x + i, lanes), y = LoadLanes(spheres.y + i, lanes), z = LoadLanes(spheres.z + i, lanes);
+                F result = Broadcast(INFINITY, lanes);
+                for (int k = 0; k < Frustum::PlaneCount; ++k) {
+                    const Plane& p = frustum.planes[k];
+                    F distance = MulAdd(z, Broadcast(p.normal.z, lanes), Broadcast(p.d, lanes));
+                    distance = MulAdd(y, Broadcast(p.normal.y, lanes), distance);
+                    distance = MulAdd(x, Broadcast(p.normal.x, lanes), distance);
+                    result = Min(result, distance);
+                }
+                return Add(result, LoadLanes(spheres.radius + i, lanes));
+            }
+        };
+    } // end namespace Detail
+
+    inline size_t CullAABBs(const Frustum& frustum, const AABBStreamView& boxes, uint32_t* visible)
+    {
+        return Detail::SelectIndices(Detail::BoxDistance(frustum, boxes), boxes.count, visible);
+    }
+
+    inline size_t CullSpheres(const Frustum& frustum, const SphereStreamView& spheres, uint32_t* visible)
+    {
+        return Detail::SelectIndices(Detail::SphereDistance(frustum, spheres), spheres.count, visible);
+    }
+} // end namespace Math
+} // end namespace Oblivion
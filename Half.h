@@ -0,0 +1,138 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "MathSIMD.h"
+
+namespace Oblivion {
+namespace Math {
+    namespace Detail {
+        // IEEE 754 binary16 <-> binary32, round to nearest even.
+        inline uint16_t FloatToHalfBits(float f)
+        {
+#if USING_F16C
+            return _cvtss_sh(f, 0);
+#else
+            uint32_t x;
+            memcpy(&x, &f, sizeof(x));
+
+            uint32_t sign = (x >> 16) & 0x8000u;
+            uint32_t absx = x & 0x7fffffffu;
+
+            // Inf and NaN (NaNs stay quiet)
+            if (absx >= 0x7f800000u) {
+                return (uint16_t)(sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u | ((absx >> 13) & 0x3ffu) : 0u));
+            }
+            // Rounds past the largest half (65504)
+            if (absx >= 0x477ff000u) {
+                return (uint16_t)(sign | 0x7c00u);
+            }
+            // Subnormal half or zero
+            if (absx < 0x38800000u) {
+                if (absx <= 0x33000000u) {
+                    return (uint16_t)sign;
+                }
+                uint32_t exponent = absx >> 23;
+                uint32_t mantissa = (absx & 0x7fffffu) | 0x800000u;
+                uint32_t shift = 126u - exponent;
+                uint32_t result = mantissa >> shift;
+                uint32_t round = (mantissa >> (shift - 1)) & 1u;
+                uint32_t sticky = mantissa & ((1u << (shift - 1)) - 1u);
+                if (round && (sticky || (result & 1u))) {
+                    ++result;
+                }
+                return (uint16_t)(sign | result);
+            }
+
+            uint32_t result = (absx - 0x38000000u) >> 13;
+            uint32_t remainder = absx & 0x1fffu;
+            if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u))) {
+                ++result;
+            }
+            return (uint16_t)(sign | result);
+#endif
+        }
+
+        inline float HalfBitsToFloat(uint16_t h)
+        {
+#if USING_F16C
+            return _cvtsh_ss(h);
+#else
+            uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+            uint32_t exponent = (h >> 10) & 0x1fu;
+            uint32_t mantissa = h & 0x3ffu;
+            uint32_t bits;
+
+            if (exponent == 0) {
+                float f = (float)mantissa * (1.0f / 16777216.0f);
+                return sign ? -f : f;
+            } else if (exponent == 31) {
+                bits = sign | 0x7f800000u | (mantissa << 13);
+            } else {
+                bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+            }
+
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            return f;
+#endif
+        }
+    } // end namespace Detail
+
+    // 16-bit floating point storage type. Arithmetic is carried out in float
+    // and rounded back to half after every operation, so Vector<N, Half> and
+    // Matrix<R, C, Half> halve the memory of their float counterparts at the
+    // cost of precision. Conversions are not constexpr.
+    class Half {
+    public:
+        uint16_t bits;
+
+        constexpr Half()
+            : bits(0)
+        {
+        }
+
+        Half(float f)
+            : bits(Detail::FloatToHalfBits(f))
+        {
+        }
+
+        static constexpr Half FromBits(uint16_t bits)
+        {
+            return Half(bits, 0);
+        }
+
+        operator float() const
+        {
+            return Detail::HalfBitsToFloat(bits);
+        }
+
+        Half& operator+=(Half h) { return *this = Half(float(*this) + float(h)); }
+        Half& operator-=(Half h) { return *this = Half(float(*this) - float(h)); }
+        Half& operator*=(Half h) { return *this = Half(float(*this) * float(h)); }
+        Half& operator/=(Half h) { return *this = Half(float(*this) / float(h)); }
+
+    private:
+        constexpr Half(uint16_t bits, int)
+            : bits(bits)
+        {
+        }
+    };
+
+    inline Half operator+(Half a, Half b) { return Half(float(a) + float(b)); }
+    inline Half operator-(Half a, Half b) { return Half(float(a) - float(b)); }
+    inline Half operator*(Half a, Half b) { return Half(float(a) * float(b)); }
+    inline Half operator/(Half a, Half b) { return Half(float(a) / float(b)); }
+    inline Half operator-(Half a) { return Half::FromBits((uint16_t)(a.bits ^ 0x8000u)); }
+    inline bool operator==(Half a, Half b) { return float(a) == float(b); }
+    inline bool operator!=(Half a, Half b) { return float(a) != float(b); }
+    inline bool operator<(Half a, Half b) { return float(a) < float(b); }
+    inline bool operator>(Half a, Half b) { return float(a) > float(b); }
+
+    namespace Detail {
+        inline Half SquareRoot(Half h) { return Half(sqrtf(float(h))); }
+    } // end namespace Detail
+} // end namespace Math
+} // end namespace Oblivion
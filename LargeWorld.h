@@ -0,0 +1,198 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "Mappings.h"
+#include "MathSIMD.h"
+#include "Matrix44.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // CAMERA-RELATIVE RENDERING
+    //
+    // World positions and object transforms stay in double; what reaches
+    // the float types is relative to an origin that follows the camera,
+    // so the float precision is spent near the viewer instead of near
+    // (0, 0, 0). The origin is subtracted in double and only the small
+    // difference is rounded. Rotation and scale rows are rounded as they
+    // are, since they do not grow with distance.
+    //
+    // Move the origin once per frame (usually to the camera position) and
+    // convert everything in bulk with the batch overloads, so the per-
+    // vertex work downstream is all float. Results made with an earlier
+    // origin are not updated when it moves.
+    ********************************************************************/
+    class CameraRelativeOrigin {
+    public:
+        explicit CameraRelativeOrigin(const Vector3d& origin = Vector3d())
+            : origin(origin)
+        {
+        }
+
+        void SetOrigin(const Vector3d& o) { origin = o; }
+        const Vector3d& GetOrigin() const { return origin; }
+
+        Vector3 ToRelative(const Vector3d& world) const;
+        Vector3d ToWorld(const Vector3& relative) const;
+
+        // Object-to-world to object-to-relative: the translation row moves
+        // by -origin.
+        Matrix44 ToRelative(const Matrix44d& world) const;
+        // World-to-view to relative-to-view: the origin is folded into the
+        // translation row in double, where it mostly cancels with the
+        // camera position.
+        Matrix44 ToRelativeView(const Matrix44d& view) const;
+
+        // Batch versions of ToRelative. out is resized to count.
+        void ToRelative(const Vector3d* world, size_t count, Vector3Stream& out) const;
+        void ToRelative(const Matrix44d* world, Matrix44* out, size_t count) const;
+
+    private:
+        Vector3d origin;
+    };
+
+    namespace Detail {
+        static_assert(sizeof(Vector3d) == 3 * sizeof(double) && sizeof(Matrix44d) == 16 * sizeof(double), "double vectors must be packed");
+
+        inline const double* Components(const Vector3d& v) { return &v.x; }
+        inline const double* Components(const Vector4d& v) { return &v.x; }
+
+#if USING_SSE
+        // Four doubles minus four doubles, rounded to floats.
+        inline __m128 SubtractToFloat(const double* a, const double* b)
+        {
+#if USING_AVX2
+            return _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(a), _mm256_loadu_pd(b)));
+#else
+            __m128 low = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+            __m128 high = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2)));
+            return _mm_movelh_ps(low, high);
+#endif
+        }
+
+        // A matrix row, with (x, y, z, 0) subtracted.
+        inline __m128 RelativeRow(const double* row, double x, double y, double z)
+        {
+#if USING_AVX2
+            return _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(row), _mm256_setr_pd(x, y, z, 0.0)));
+#else
+            __m128 low = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(row), _mm_setr_pd(x, y)));
+            __m128 high = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(row + 2), _mm_setr_pd(z, 0.0)));
+            return _mm_movelh_ps(low, high);
+#endif
+        }
+
+        template <int Mask>
+        inline __m128 Shuffle(__m128 a, __m128 b) { return _mm_shuffle_ps(a, b, Mask); }
+        // a with its last element replaced by b's.
+        inline __m128 BlendLast(__m128 a, __m128 b) { return _mm_blend_ps(a, b, 0x8); }
+#if USING_AVX2
+        template <int Mask>
+        inline __m256 Shuffle(__m256 a, __m256 b) { return _mm256_shuffle_ps(a, b, Mask); }
+        inline __m256 BlendLast(__m256 a, __m256 b) { return _mm256_blend_ps(a, b, 0x88); }
+#endif
+
+        // Splits packed x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 into x, y
+        // and z, in each 128-bit lane.
+        template <typename F>
+        inline void DeinterleaveXYZ(F a, F b, F c, F& x, F& y, F& z)
+        {
+            x = BlendLast(Shuffle<_MM_SHUFFLE(2, 2, 3, 0)>(a, b), Shuffle<_MM_SHUFFLE(1, 1, 1, 1)>(c, c));
+            F t = Shuffle<_MM_SHUFFLE(3, 0, 1, 1)>(a, b);
+            y = BlendLast(Shuffle<_MM_SHUFFLE(3, 3, 2, 0)>(t, t), Shuffle<_MM_SHUFFLE(2, 2, 2, 2)>(c, c));
+            t = Shuffle<_MM_SHUFFLE(1, 1, 2, 2)>(a, b);
+            z = Shuffle<_MM_SHUFFLE(3, 0, 2, 0)>(t, c);
+        }
+
+#endif
+    } // end namespace Detail
+
+    inline Vector3 CameraRelativeOrigin::ToRelative(const Vector3d& world) const
+    {
+        return Vector3(float(world.x - origin.x), float(world.y - origin.y), float(world.z - origin.z));
+    }
+
+    inline Vector3d CameraRelativeOrigin::ToWorld(const Vector3& relative) const
+    {
+        return Vector3d(relative.x + origin.x, relative.y + origin.y, relative.z + origin.z);
+    }
+
+    inline Matrix44 CameraRelativeOrigin::ToRelative(const Matrix44d& world) const
+    {
+        Matrix44 result;
+        ToRelative(&world, &result, 1);
+        return result;
+    }
+
+    inline Matrix44 CameraRelativeOrigin::ToRelativeView(const Matrix44d& view) const
+    {
+        // relative * R + (origin * R + t): the view of world = relative + origin.
+        Vector4d t = view[3] + view[0] * origin.x + view[1] * origin.y + view[2] * origin.z;
+        Matrix44d relative(view[0], view[1], view[2], t);
+        return Matrix44(Matrix<4, 4, float>(relative));
+    }
+
+    inline void CameraRelativeOrigin::ToRelative(const Vector3d* world, size_t count, Vector3Stream& out) const
+    {
+        out.Resize(count);
+        float* ox = out.X();
+        float* oy = out.Y();
+        float* oz = out.Z();
+        size_t i = 0;
+#if USING_SSE
+        // The origin four times over, matching four packed points.
+        double repeated[12];
+        for (int k = 0; k < 12; ++k)
+            repeated[k] = origin[k % 3];
+#if USING_AVX2
+        for (; i + 8 <= count; i += 8) {
+            const double* p = Detail::Components(world[i]);
+            __m256 a = _mm256_set_m128(Detail::SubtractToFloat(p + 12, repeated), Detail::SubtractToFloat(p, repeated));
+            __m256 b = _mm256_set_m128(Detail::SubtractToFloat(p + 16, repeated + 4), Detail::SubtractToFloat(p + 4, repeated + 4));
+            __m256 c = _mm256_set_m128(Detail::SubtractToFloat(p + 20, repeated + 8), Detail::SubtractToFloat(p + 8, repeated + 8));
+            __m256 x, y, z;
+            Detail::DeinterleaveXYZ(a, b, c, x, y, z);
+            _mm256_store_ps(ox + i, x);
+            _mm256_store_ps(oy + i, y);
+            _mm256_store_ps(oz + i, z);
+        }
+#endif
+        for (; i + 4 <= count; i += 4) {
+            const double* p = Detail::Components(world[i]);
+            __m128 x, y, z;
+            Detail::DeinterleaveXYZ(Detail::SubtractToFloat(p, repeated), Detail::SubtractToFloat(p + 4, repeated + 4), Detail::SubtractToFloat(p + 8, repeated + 8), x, y, z);
+            _mm_store_ps(ox + i, x);
+            _mm_store_ps(oy + i, y);
+            _mm_store_ps(oz + i, z);
+        }
+#endif
+        for (; i < count; ++i) {
+            ox[i] = float(world[i].x - origin.x);
+            oy[i] = float(world[i].y - origin.y);
+            oz[i] = float(world[i].z - origin.z);
+        }
+    }
+
+    inline void CameraRelativeOrigin::ToRelative(const Matrix44d* world, Matrix44* out, size_t count) const
+    {
+        for (size_t i = 0; i < count; ++i) {
+            for (int r = 0; r < 4; ++r) {
+                const double* row = Detail::Components(world[i][r]);
+                // Only the translation row moves.
+                double x = r == 3 ? origin.x : 0.0, y = r == 3 ? origin.y : 0.0, z = r == 3 ? origin.z : 0.0;
+#if USING_SSE
+                _mm_store_ps(out[i].m[r], Detail::RelativeRow(row, x, y, z));
+#else
+                out[i].m[r][0] = float(row[0] - x);
+                out[i].m[r][1] = float(row[1] - y);
+                out[i].m[r][2] = float(row[2] - z);
+                out[i].m[r][3] = float(row[3]);
+#endif
+            }
+        }
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -1,7 +1,25 @@
 #pragma once
 
-#include "Vector2D.h"
-#include "Vector3.h"
-#include "Vector4.h"
-#include "Mat3x3.h"
-#include "Matrix4.h"
\ No newline at end of file
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace Oblivion {
+namespace Math {
+    // Element-type spellings used by the templated classes (Mat3x3<T>,
+    // Quaternion<T>), backed by the templated core in Vector.h and Matrix.h.
+    template <typename T>
+    using Vector3D = Vector<3, T>;
+
+    template <typename T>
+    using Vector4D = Vector<4, T>;
+
+    template <typename T>
+    using Mat4x4 = Matrix<4, 4, T>;
+
+    // Double-precision world coordinates; see LargeWorld.h for getting
+    // them to the float types.
+    typedef Vector<3, double> Vector3d;
+    typedef Vector<4, double> Vector4d;
+    typedef Matrix<4, 4, double> Matrix44d;
+} // end namespace Math
+} // end namespace Oblivion
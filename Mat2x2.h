@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string.h>
+
 #include "Vector2D.h"
 
 namespace Oblivion {
@@ -116,7 +118,7 @@ namespace Math {
         return m1.m[0][0] * m1.m[1][1] - m1.m[0][1] * m1.m[1][0];
     }
 
-    Mat2x2 inverse(const Mat2x2& m1)
+    inline Mat2x2 inverse(const Mat2x2& m1)
     {
         float determinant = m1.m[0][0] * m1.m[1][1] - m1.m[1][0] * m1.m[0][1];
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <math.h>
+#include <stddef.h>
+
 #include "Mappings.h"
 
 namespace Oblivion {
@@ -54,7 +57,7 @@ namespace Math {
 
         inline Mat3x3& Identity()
         {
-            m[0][0] = m[1][1] = m[2][2] = 1.0f;
+            m[0][0] = m[1][1] = m[2][2] = T(1);
             return *this;
         }
 
@@ -95,7 +98,7 @@ namespace Math {
             return *this;
         }
 
-        inline Mat3x3 operator*(const float& scalar) const
+        inline Mat3x3 operator*(const T& scalar) const
         {
             return Mat3x3(
                 scalar * m[0][0], scalar * m[0][1], scalar * m[0][2],
@@ -153,20 +156,25 @@ namespace Math {
                 Vector3D<T>(m[0][2], m[1][2], m[2][2]));
         }
 
-        inline float Determinant() const
+        inline T Determinant() const
         {
             return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[1][0] * (m[0][1] * m[2][2] - m[0][2] * m[2][1]) + m[2][0] * (m[0][1] * m[1][2] - m[0][2] * m[1][1]);
         }
 
-        inline Mat3x3 Inverse() const
+        // Returns the identity and sets *singular if the matrix has no
+        // inverse (no finite 1 / determinant), like Matrix44::Inverse.
+        inline Mat3x3 Inverse(bool* singular = NULL) const
         {
-            float determinant = Determinant();
+            T determinant = Determinant();
+            T inversedDet = T(1) / determinant;
+            bool noInverse = Detail::NoInverse(determinant);
 
-            if (determinant == 0.0f) {
-                return Identity(); // Return an identity matrix if the current matrix is singular.
+            if (singular != NULL) {
+                *singular = noInverse;
+            }
+            if (noInverse) {
+                return Mat3x3(T(1));
             }
-
-            float inversedDet = 1.0f / determinant;
 
             // Transposed inverse matrix
             return Mat3x3(
@@ -179,7 +187,14 @@ namespace Math {
                 (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * inversedDet,
                 -(m[0][0] * m[2][1] - m[0][1] * m[2][0]) * inversedDet,
                 (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inversedDet);
-        }   
+        }
+
+        // The x with x * m = b (row vectors, as operator* computes), that is
+        // b * Inverse(singular).
+        inline Vector3D<T> Solve(const Vector3D<T>& b, bool* singular = NULL) const
+        {
+            return Inverse(singular) * b;
+        }
     };
 } // end namespace Math
 } // end namespace Oblivion
\ No newline at end of file
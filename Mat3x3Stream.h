@@ -0,0 +1,393 @@
+#pragma once
+
+#include <assert.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Mat3x3.h"
+#include "Matrix44.h"
+#include "QuaternionStream.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // Non-owning view of nine element arrays; m[r][c] holds element (r, c)
+    // of every matrix.
+    struct Mat3x3StreamView {
+        const float* m[3][3];
+        size_t count;
+
+        Mat3x3StreamView(const float* const (&elements)[3][3], size_t count)
+            : count(count)
+        {
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    m[r][c] = elements[r][c];
+        }
+    };
+
+    // Structure-of-arrays Mat3x3<float> container, laid out like
+    // QuaternionStream: one 32-byte aligned block per element, padded to a
+    // multiple of BlockSize.
+    class Mat3x3Stream {
+    public:
+        static const size_t BlockSize = 8;
+        static const size_t Alignment = 32;
+
+        Mat3x3Stream();
+        explicit Mat3x3Stream(size_t count);
+        Mat3x3Stream(const Mat3x3<float>* m, size_t count);
+        Mat3x3Stream(const Mat3x3Stream& s);
+        Mat3x3Stream(Mat3x3Stream&& s);
+        ~Mat3x3Stream();
+
+        Mat3x3Stream& operator=(const Mat3x3Stream& s);
+        Mat3x3Stream& operator=(Mat3x3Stream&& s);
+
+        size_t Size() const { return count; }
+        float* Element(int row, int column) { return data + (3 * row + column) * capacity; }
+        const float* Element(int row, int column) const { return data + (3 * row + column) * capacity; }
+
+        Mat3x3<float> Get(size_t i) const;
+        void Set(size_t i, const Mat3x3<float>& m);
+
+        // Preserves the first min(Size(), count) elements; new elements are zero.
+        void Resize(size_t count);
+        void Assign(const Mat3x3<float>* m, size_t count);
+        void CopyTo(Mat3x3<float>* out) const;
+
+        operator Mat3x3StreamView() const;
+
+    private:
+        float* data;
+        size_t count;
+        size_t capacity;
+    };
+
+    /********************************************************************
+    // BATCH INVERSE, SOLVE AND NORMAL MATRIX
+    //
+    // Adjugate over determinant with eight (or four) matrices per
+    // register. A matrix is singular where 1 / determinant is not finite,
+    // as for Mat3x3::Inverse; its result is the identity (Solve: x = b)
+    // and singular[i] is set to 1, otherwise 0. singular may be NULL. Each
+    // returns the number of singular matrices, so a batch that needs no
+    // fallback costs one comparison.
+    //
+    // SolveMany finds the x with x * a = b (row vectors, as Mat3x3 and
+    // Vector3D multiply). NormalMatrixMany computes the inverse transpose
+    // of the upper 3x3 of each m, which takes normals to world space the
+    // way m takes points. out is resized to fit and may not be an input.
+    ********************************************************************/
+    size_t InverseMany(const Mat3x3StreamView& m, Mat3x3Stream& out, uint8_t* singular = NULL);
+    size_t InverseMany(const Mat3x3<float>* m, size_t count, Mat3x3<float>* out, uint8_t* singular = NULL);
+    size_t SolveMany(const Mat3x3StreamView& a, const Vector3StreamView& b, Vector3Stream& x, uint8_t* singular = NULL);
+    size_t NormalMatrixMany(const Matrix44* m, size_t count, Mat3x3Stream& out, uint8_t* singular = NULL);
+    size_t NormalMatrixMany(const Matrix44* m, size_t count, Mat3x3<float>* out, uint8_t* singular = NULL);
+
+    // The inverse transpose of the upper 3x3 of m; the identity, with
+    // *singular set, if it has no inverse.
+    Mat3x3<float> NormalMatrixFromMatrix44(const Matrix44& m, bool* singular = NULL);
+
+    inline Mat3x3<float> NormalMatrixFromMatrix44(const Matrix44& m, bool* singular)
+    {
+        Mat3x3<float> upper(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2]);
+        return upper.Inverse(singular).Transpose();
+    }
+
+    namespace Detail {
+        // Inverts the nine lanes in r in place; lanes with no finite
+        // 1 / determinant get the identity. Returns the mask of the
+        // invertible lanes.
+        template <typename F>
+        inline auto InverseLanes(F* r) -> decltype(LessThan(r[0], r[0]))
+        {
+            F adjugate[9] = {
+                Sub(Mul(r[4], r[8]), Mul(r[5], r[7])), Sub(Mul(r[2], r[7]), Mul(r[1], r[8])), Sub(Mul(r[1], r[5]), Mul(r[2], r[4])),
+                Sub(Mul(r[5], r[6]), Mul(r[3], r[8])), Sub(Mul(r[0], r[8]), Mul(r[2], r[6])), Sub(Mul(r[2], r[3]), Mul(r[0], r[5])),
+                Sub(Mul(r[3], r[7]), Mul(r[4], r[6])), Sub(Mul(r[1], r[6]), Mul(r[0], r[7])), Sub(Mul(r[0], r[4]), Mul(r[1], r[3]))
+            };
+            F determinant = MulAdd(r[0], adjugate[0], MulAdd(r[1], adjugate[3], Mul(r[2], adjugate[6])));
+            F inverse = Div(Broadcast(1.0f, determinant), determinant);
+            // False for infinity and NaN.
+            auto invertible = LessEqual(Abs(inverse), Broadcast(FLT_MAX, inverse));
+
+            F zero = Broadcast(0.0f, inverse), one = Broadcast(1.0f, inverse);
+            for (int k = 0; k < 9; ++k)
+                r[k] = Select(invertible, Mul(adjugate[k], inverse), k % 4 == 0 ? one : zero);
+            return invertible;
+        }
+
+        // Writes singular[i + k] for the lanes of a mask of invertible
+        // lanes and returns how many are singular.
+        template <typename F, typename Mask>
+        inline size_t StoreSingular(Mask invertible, F, size_t i, uint8_t* singular)
+        {
+            const int lanes = sizeof(F) / sizeof(float);
+            int bits = MoveMask(invertible);
+            size_t count = 0;
+            for (int k = 0; k < lanes; ++k) {
+                uint8_t s = (uint8_t)(((bits >> k) & 1) ^ 1);
+                if (singular != NULL)
+                    singular[i + k] = s;
+                count += s;
+            }
+            return count;
+        }
+
+        // Matrix sources and destinations for the kernels: SoA element
+        // arrays, or packed Mat3x3 / Matrix44 gathered into lanes.
+        struct ElementArrays {
+            float* m[9];
+
+            explicit ElementArrays(Mat3x3Stream& s)
+            {
+                for (int k = 0; k < 9; ++k)
+                    m[k] = s.Element(k / 3, k % 3);
+            }
+        };
+
+        template <typename F>
+        inline void LoadMatrix(const Mat3x3StreamView& v, size_t i, F lanes, F* r)
+        {
+            for (int k = 0; k < 9; ++k)
+                r[k] = LoadLanes(v.m[k / 3][k % 3] + i, lanes);
+        }
+
+        template <typename M, typename F>
+        inline void LoadMatrix(const M* m, size_t i, F, F* r)
+        {
+            LoadRotation(m + i, r);
+        }
+
+        template <typename F>
+        inline void StoreMatrix(const ElementArrays& out, size_t i, const F* r)
+        {
+            for (int k = 0; k < 9; ++k)
+                StoreLanes(out.m[k] + i, r[k]);
+        }
+
+        template <typename F>
+        inline void StoreMatrix(Mat3x3<float>* out, size_t i, const F* r)
+        {
+            StoreRotation(out + i, r);
+        }
+
+        // out[i] = inverse(m[i]), transposed for normal matrices.
+        template <typename Source, typename Destination, bool Transpose>
+        struct InverseKernel {
+            Source m;
+            Destination out;
+            uint8_t* singular;
+            size_t* singularCount;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F r[9];
+                LoadMatrix(m, i, lanes, r);
+                *singularCount += StoreSingular(InverseLanes(r), lanes, i, singular);
+                if (Transpose) {
+                    F t[9] = { r[0], r[3], r[6], r[1], r[4], r[7], r[2], r[5], r[8] };
+                    StoreMatrix(out, i, t);
+                } else
+                    StoreMatrix(out, i, r);
+            }
+        };
+
+        struct SolveKernel {
+            const Mat3x3StreamView& a;
+            const Vector3StreamView& b;
+            float* x[3];
+            uint8_t* singular;
+            size_t* singularCount;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F r[9];
+                LoadMatrix(a, i, lanes, r);
+                *singularCount += StoreSingular(InverseLanes(r), lanes, i, singular);
+                F bx = LoadLanes(b.x + i, lanes), by = LoadLanes(b.y + i, lanes), bz = LoadLanes(b.z + i, lanes);
+                for (int c = 0; c < 3; ++c)
+                    StoreLanes(x[c] + i, MulAdd(bx, r[c], MulAdd(by, r[3 + c], Mul(bz, r[6 + c]))));
+            }
+        };
+
+        template <bool Transpose, typename Source, typename Destination>
+        inline size_t InvertAll(const Source& m, size_t count, const Destination& out, uint8_t* singular)
+        {
+            size_t singularCount = 0;
+            InverseKernel<Source, Destination, Transpose> kernel = { m, out, singular, &singularCount };
+            ForEachLanes(count, kernel);
+            return singularCount;
+        }
+    } // end namespace Detail
+
+    inline size_t InverseMany(const Mat3x3StreamView& m, Mat3x3Stream& out, uint8_t* singular)
+    {
+        out.Resize(m.count);
+        return Detail::InvertAll<false>(m, m.count, Detail::ElementArrays(out), singular);
+    }
+
+    inline size_t InverseMany(const Mat3x3<float>* m, size_t count, Mat3x3<float>* out, uint8_t* singular)
+    {
+        return Detail::InvertAll<false>(m, count, out, singular);
+    }
+
+    inline size_t SolveMany(const Mat3x3StreamView& a, const Vector3StreamView& b, Vector3Stream& x, uint8_t* singular)
+    {
+        assert(a.count == b.count);
+        x.Resize(a.count);
+        size_t singularCount = 0;
+        Detail::SolveKernel kernel = { a, b, { x.X(), x.Y(), x.Z() }, singular, &singularCount };
+        Detail::ForEachLanes(a.count, kernel);
+        return singularCount;
+    }
+
+    inline size_t NormalMatrixMany(const Matrix44* m, size_t count, Mat3x3Stream& out, uint8_t* singular)
+    {
+        out.Resize(count);
+        return Detail::InvertAll<true>(m, count, Detail::ElementArrays(out), singular);
+    }
+
+    inline size_t NormalMatrixMany(const Matrix44* m, size_t count, Mat3x3<float>* out, uint8_t* singular)
+    {
+        return Detail::InvertAll<true>(m, count, out, singular);
+    }
+
+    /********************************************************************
+    // MAT3X3STREAM MEMBER FUNCTIONS
+    ********************************************************************/
+    inline Mat3x3Stream::Mat3x3Stream()
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+    }
+
+    inline Mat3x3Stream::Mat3x3Stream(size_t count)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Resize(count);
+    }
+
+    inline Mat3x3Stream::Mat3x3Stream(const Mat3x3<float>* m, size_t count)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Assign(m, count);
+    }
+
+    inline Mat3x3Stream::Mat3x3Stream(const Mat3x3Stream& s)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        *this = s;
+    }
+
+    inline Mat3x3Stream::Mat3x3Stream(Mat3x3Stream&& s)
+        : data(s.data)
+        , count(s.count)
+        , capacity(s.capacity)
+    {
+        s.data = NULL;
+        s.count = s.capacity = 0;
+    }
+
+    inline Mat3x3Stream::~Mat3x3Stream()
+    {
+        Detail::AlignedFree(data);
+    }
+
+    inline Mat3x3Stream& Mat3x3Stream::operator=(const Mat3x3Stream& s)
+    {
+        if (this != &s) {
+            Resize(s.count);
+            for (int k = 0; k < 9; ++k)
+                memcpy(Element(k / 3, k % 3), s.Element(k / 3, k % 3), sizeof(float) * count);
+        }
+        return *this;
+    }
+
+    inline Mat3x3Stream& Mat3x3Stream::operator=(Mat3x3Stream&& s)
+    {
+        if (this != &s) {
+            Detail::AlignedFree(data);
+            data = s.data;
+            count = s.count;
+            capacity = s.capacity;
+            s.data = NULL;
+            s.count = s.capacity = 0;
+        }
+        return *this;
+    }
+
+    inline Mat3x3<float> Mat3x3Stream::Get(size_t i) const
+    {
+        Mat3x3<float> m;
+        for (int k = 0; k < 9; ++k)
+            m.m[k / 3][k % 3] = Element(k / 3, k % 3)[i];
+        return m;
+    }
+
+    inline void Mat3x3Stream::Set(size_t i, const Mat3x3<float>& m)
+    {
+        for (int k = 0; k < 9; ++k)
+            Element(k / 3, k % 3)[i] = m.m[k / 3][k % 3];
+    }
+
+    inline void Mat3x3Stream::Resize(size_t newCount)
+    {
+        if (newCount > capacity) {
+            size_t newCapacity = (newCount + BlockSize - 1) / BlockSize * BlockSize;
+            float* newData = static_cast<float*>(Detail::AlignedAlloc(sizeof(float) * 9 * newCapacity, Alignment));
+            assert(newData != NULL);
+            memset(newData, 0, sizeof(float) * 9 * newCapacity);
+
+            if (data != NULL) {
+                for (size_t c = 0; c < 9; ++c)
+                    memcpy(newData + c * newCapacity, data + c * capacity, sizeof(float) * count);
+                Detail::AlignedFree(data);
+            }
+
+            data = newData;
+            capacity = newCapacity;
+        } else if (newCount > count) {
+            for (size_t c = 0; c < 9; ++c)
+                memset(data + c * capacity + count, 0, sizeof(float) * (newCount - count));
+        }
+
+        count = newCount;
+    }
+
+    inline void Mat3x3Stream::Assign(const Mat3x3<float>* m, size_t newCount)
+    {
+        Resize(newCount);
+        for (size_t i = 0; i < count; ++i)
+            Set(i, m[i]);
+    }
+
+    inline void Mat3x3Stream::CopyTo(Mat3x3<float>* out) const
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = Get(i);
+    }
+
+    inline Mat3x3Stream::operator Mat3x3StreamView() const
+    {
+        const float* const elements[3][3] = {
+            { Element(0, 0), Element(0, 1), Element(0, 2) },
+            { Element(1, 0), Element(1, 1), Element(1, 2) },
+            { Element(2, 0), Element(2, 1), Element(2, 2) }
+        };
+        return Mat3x3StreamView(elements, count);
+    }
+} // end namespace Math
+} // end namespace Oblivion
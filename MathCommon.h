@@ -2,8 +2,11 @@
 
 #include "MathFunctions.h"
 #include "Vector2D.h"
-#include "Vector3D.h"
-#include "Vector4D.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Vector.h"
 #include "Mat2x2.h"
 #include "Mat3x3.h"
-#include "Mat4x4.h"
+#include "Matrix44.h"
+#include "Matrix.h"
+#include "Quaternion.h"
@@ -2,44 +2,501 @@
 
 #include <math.h>
 
+#include "MathSIMD.h"
+
 //PI defines
-#define PI 3.14159265359f 
+#define PI 3.14159265359f
+
+// Default precision tier for the trigonometric functions below; one of Fast,
+// Accurate or Exact. Define before including any math header to change it.
+#ifndef MATH_PRECISION
+#define MATH_PRECISION Accurate
+#endif
 
 namespace Oblivion
 {
 	namespace Math
 	{
+		// Precision tiers for Sin, Cos, Tan, SinCos, ASin, ACos, ATan and ATan2.
+		//   Fast     - short minimax polynomials, about 4e-5 absolute error.
+		//   Accurate - Cody-Waite reduction and Cephes polynomials, about 3 ULP
+		//              (2.5 for Sin/Cos, 3.5 for Tan) over |x| <= 8192.
+		//   Exact    - the C library float functions.
+		// Each function is a template on the tier, defaulting to MATH_PRECISION,
+		// and accepts a float, an SSE __m128 or an AVX2 __m256.
+		enum class Precision
+		{
+			Fast,
+			Accurate,
+			Exact
+		};
+
+		namespace Detail
+		{
+			template<typename F>
+			inline float PerLane(float x, F f)
+			{
+				return f(x);
+			}
+
+			template<typename F>
+			inline float PerLane(float y, float x, F f)
+			{
+				return f(y, x);
+			}
+
+#if USING_SSE
+			template<typename F>
+			inline __m128 PerLane(__m128 x, F f)
+			{
+				alignas(16) float v[4];
+				_mm_store_ps(v, x);
+				for (int i = 0; i < 4; ++i)
+					v[i] = f(v[i]);
+				return _mm_load_ps(v);
+			}
+
+			template<typename F>
+			inline __m128 PerLane(__m128 y, __m128 x, F f)
+			{
+				alignas(16) float vy[4], vx[4];
+				_mm_store_ps(vy, y);
+				_mm_store_ps(vx, x);
+				for (int i = 0; i < 4; ++i)
+					vy[i] = f(vy[i], vx[i]);
+				return _mm_load_ps(vy);
+			}
+#endif
+
+#if USING_AVX2
+			template<typename F>
+			inline __m256 PerLane(__m256 x, F f)
+			{
+				alignas(32) float v[8];
+				_mm256_store_ps(v, x);
+				for (int i = 0; i < 8; ++i)
+					v[i] = f(v[i]);
+				return _mm256_load_ps(v);
+			}
+
+			template<typename F>
+			inline __m256 PerLane(__m256 y, __m256 x, F f)
+			{
+				alignas(32) float vy[8], vx[8];
+				_mm256_store_ps(vy, y);
+				_mm256_store_ps(vx, x);
+				for (int i = 0; i < 8; ++i)
+					vy[i] = f(vy[i], vx[i]);
+				return _mm256_load_ps(vy);
+			}
+#endif
+
+			// Cephes single-precision polynomials. Reduce subtracts q * pi / 2
+			// in four parts, each short enough that its product with q is exact
+			// for the quadrant counts we promise to handle.
+			struct AccurateKernel
+			{
+				template<typename L>
+				static L Reduce(L x, L q)
+				{
+					L r = MulAdd(q, Broadcast(-1.5703125f, x), x);
+					r = MulAdd(q, Broadcast(-4.8351287841796875e-4f, x), r);
+					r = MulAdd(q, Broadcast(-3.13855707645416259765625e-7f, x), r);
+					return MulAdd(q, Broadcast(-6.077100628276710381e-11f, x), r);
+				}
+
+				// sin(r) for |r| <= pi / 4
+				template<typename L>
+				static L SinPolynomial(L r)
+				{
+					L z = Mul(r, r);
+					L p = MulAdd(Broadcast(-1.9515295891e-4f, r), z, Broadcast(8.3321608736e-3f, r));
+					p = MulAdd(p, z, Broadcast(-1.6666654611e-1f, r));
+					return MulAdd(Mul(p, z), r, r);
+				}
+
+				// cos(r) for |r| <= pi / 4
+				template<typename L>
+				static L CosPolynomial(L r)
+				{
+					L z = Mul(r, r);
+					L p = MulAdd(Broadcast(2.443315711809948e-5f, r), z, Broadcast(-1.388731625493765e-3f, r));
+					p = MulAdd(p, z, Broadcast(4.166664568298827e-2f, r));
+					return MulAdd(Mul(p, z), z, MulAdd(z, Broadcast(-0.5f, r), Broadcast(1.0f, r)));
+				}
+
+				// tan(r) for |r| <= pi / 4
+				template<typename L>
+				static L TanPolynomial(L r)
+				{
+					L z = Mul(r, r);
+					L p = MulAdd(Broadcast(9.38540185543e-3f, r), z, Broadcast(3.11992232697e-3f, r));
+					p = MulAdd(p, z, Broadcast(2.44301354525e-2f, r));
+					p = MulAdd(p, z, Broadcast(5.34112807005e-2f, r));
+					p = MulAdd(p, z, Broadcast(1.33387994085e-1f, r));
+					p = MulAdd(p, z, Broadcast(3.33331568548e-1f, r));
+					return MulAdd(Mul(p, z), r, r);
+				}
+
+				// asin(t) for |t| <= 0.5, z = t * t
+				template<typename L>
+				static L ASinPolynomial(L t, L z)
+				{
+					L p = MulAdd(Broadcast(4.2163199048e-2f, t), z, Broadcast(2.4181311049e-2f, t));
+					p = MulAdd(p, z, Broadcast(4.5470025998e-2f, t));
+					p = MulAdd(p, z, Broadcast(7.4953002686e-2f, t));
+					p = MulAdd(p, z, Broadcast(1.6666752422e-1f, t));
+					return MulAdd(Mul(p, z), t, t);
+				}
+
+				// atan(t) for |t| <= tan(pi / 8), z = t * t
+				template<typename L>
+				static L ATanPolynomial(L t, L z)
+				{
+					L p = MulAdd(Broadcast(8.05374449538e-2f, t), z, Broadcast(-1.38776856032e-1f, t));
+					p = MulAdd(p, z, Broadcast(1.99777106478e-1f, t));
+					p = MulAdd(p, z, Broadcast(-3.33329491539e-1f, t));
+					return MulAdd(Mul(p, z), t, t);
+				}
+			};
+
+			// Minimax fits over the same reduced ranges, two terms each.
+			struct FastKernel
+			{
+				template<typename L>
+				static L Reduce(L x, L q)
+				{
+					L r = MulAdd(q, Broadcast(-1.5703125f, x), x);
+					return MulAdd(q, Broadcast(-4.8382679e-4f, x), r);
+				}
+
+				template<typename L>
+				static L SinPolynomial(L r)
+				{
+					L z = Mul(r, r);
+					L p = MulAdd(Broadcast(8.164608673254121e-3f, r), z, Broadcast(-1.6663458530585198e-1f, r));
+					return MulAdd(Mul(p, z), r, r);
+				}
+
+				template<typename L>
+				static L CosPolynomial(L r)
+				{
+					L z = Mul(r, r);
+					L p = MulAdd(Broadcast(4.0908443319313925e-2f, r), z, Broadcast(-0.5f, r));
+					return MulAdd(p, z, Broadcast(1.0f, r));
+				}
+
+				template<typename L>
+				static L TanPolynomial(L r)
+				{
+					return Div(SinPolynomial(r), CosPolynomial(r));
+				}
+
+				template<typename L>
+				static L ASinPolynomial(L t, L z)
+				{
+					L p = MulAdd(Broadcast(9.43767243684142e-2f, t), z, Broadcast(1.6504153292705562e-1f, t));
+					return MulAdd(Mul(p, z), t, t);
+				}
+
+				template<typename L>
+				static L ATanPolynomial(L t, L z)
+				{
+					L p = MulAdd(Broadcast(1.7044939381432309e-1f, t), z, Broadcast(-3.3184910323629585e-1f, t));
+					return MulAdd(Mul(p, z), t, t);
+				}
+			};
+
+			// Range reduction and reconstruction shared by both polynomial tiers.
+			// Quadrant bookkeeping stays in float so it vectorizes without
+			// integer instructions.
+			template<typename K>
+			struct PolynomialTrig
+			{
+				template<typename L>
+				static void SinCos(L x, L& s, L& c)
+				{
+					L q = Round(Mul(x, Broadcast(0.636619772f, x)));
+					L r = K::Reduce(x, q);
+					L sinR = K::SinPolynomial(r);
+					L cosR = K::CosPolynomial(r);
+
+					// q mod 4 for the sine, (q + 1) mod 4 for the cosine.
+					L q4 = Sub(q, Mul(Broadcast(4.0f, x), Floor(Mul(q, Broadcast(0.25f, x)))));
+					L q14 = Add(q4, Broadcast(1.0f, x));
+					q14 = Sub(q14, Mul(Broadcast(4.0f, x), Floor(Mul(q14, Broadcast(0.25f, x)))));
+					L odd = Sub(q4, Mul(Broadcast(2.0f, x), Floor(Mul(q4, Broadcast(0.5f, x)))));
+
+					auto swap = LessThan(Broadcast(0.5f, x), odd);
+					s = NegateIf(LessThan(Broadcast(1.5f, x), q4), Select(swap, cosR, sinR));
+					c = NegateIf(LessThan(Broadcast(1.5f, x), q14), Select(swap, sinR, cosR));
+				}
+
+				template<typename L>
+				static L Sin(L x)
+				{
+					L s, c;
+					SinCos(x, s, c);
+					return s;
+				}
+
+				template<typename L>
+				static L Cos(L x)
+				{
+					L s, c;
+					SinCos(x, s, c);
+					return c;
+				}
+
+				template<typename L>
+				static L Tan(L x)
+				{
+					// tan(x) = -1 / tan(r) in odd quadrants.
+					L q = Round(Mul(x, Broadcast(0.636619772f, x)));
+					L t = K::TanPolynomial(K::Reduce(x, q));
+					L odd = Sub(q, Mul(Broadcast(2.0f, x), Floor(Mul(q, Broadcast(0.5f, x)))));
+					return Select(LessThan(Broadcast(0.5f, x), odd), Div(Broadcast(-1.0f, x), t), t);
+				}
+
+				template<typename L>
+				static L ASin(L x)
+				{
+					// Above 0.5 use asin(a) = pi / 2 - 2 * asin(sqrt((1 - a) / 2)).
+					L a = Abs(x);
+					auto big = LessThan(Broadcast(0.5f, x), a);
+					L zBig = Mul(Sub(Broadcast(1.0f, x), a), Broadcast(0.5f, x));
+					L z = Select(big, zBig, Mul(a, a));
+					L t = Select(big, Sqrt(zBig), a);
+					L p = K::ASinPolynomial(t, z);
+					p = Select(big, MulAdd(p, Broadcast(-2.0f, x), Broadcast(1.57079632679f, x)), p);
+					return FlipSign(p, SignOf(x));
+				}
+
+				template<typename L>
+				static L ACos(L x)
+				{
+					// Near +-1 go through the half-angle form so small results
+					// keep their relative precision.
+					L a = Abs(x);
+					auto big = LessThan(Broadcast(0.5f, x), a);
+					L zBig = Mul(Sub(Broadcast(1.0f, x), a), Broadcast(0.5f, x));
+					L z = Select(big, zBig, Mul(x, x));
+					L t = Select(big, Sqrt(zBig), x);
+					L p = K::ASinPolynomial(t, z);
+
+					L twice = Add(p, p);
+					L bigResult = Select(LessThan(x, Broadcast(0.0f, x)), Sub(Broadcast(3.14159265359f, x), twice), twice);
+					return Select(big, bigResult, Sub(Broadcast(1.57079632679f, x), p));
+				}
+
+				template<typename L>
+				static L ATan(L x)
+				{
+					// Fold |x| into [0, tan(pi / 8)] with atan(a) = pi / 2 + atan(-1 / a)
+					// and atan(a) = pi / 4 + atan((a - 1) / (a + 1)).
+					L a = Abs(x);
+					L one = Broadcast(1.0f, x);
+					auto big = LessThan(Broadcast(2.414213562373095f, x), a);
+					auto mid = LessThan(Broadcast(0.4142135623730950f, x), a);
+					L t = Select(big, Div(Broadcast(-1.0f, x), a), Select(mid, Div(Sub(a, one), Add(a, one)), a));
+					L offset = Select(big, Broadcast(1.57079632679f, x), Select(mid, Broadcast(0.785398163397f, x), Broadcast(0.0f, x)));
+					L p = Add(offset, K::ATanPolynomial(t, Mul(t, t)));
+					return FlipSign(p, SignOf(x));
+				}
+
+				template<typename L>
+				static L ATan2(L y, L x)
+				{
+					// A zero y goes through as itself, so it keeps its sign and
+					// 0 / 0 never makes a NaN; a zero x gives +-inf and +-pi / 2.
+					L r = ATan(Select(LessEqual(Abs(y), Broadcast(0.0f, y)), y, Div(y, x)));
+					// Where x's sign bit is set, -0 included, turn by pi towards
+					// y's side: atan2(+-0, -0) is +-pi as in libm.
+					return Select(SignBit(x), Add(r, FlipSign(Broadcast(3.14159265359f, x), SignOf(y))), r);
+				}
+			};
+
+			template<Precision P>
+			struct Trig : PolynomialTrig<AccurateKernel>
+			{
+			};
+
+			template<>
+			struct Trig<Precision::Fast> : PolynomialTrig<FastKernel>
+			{
+			};
+
+			template<>
+			struct Trig<Precision::Exact>
+			{
+				template<typename L>
+				static void SinCos(L x, L& s, L& c)
+				{
+					s = PerLane(x, sinf);
+					c = PerLane(x, cosf);
+				}
+
+				template<typename L> static L Sin(L x) { return PerLane(x, sinf); }
+				template<typename L> static L Cos(L x) { return PerLane(x, cosf); }
+				template<typename L> static L Tan(L x) { return PerLane(x, tanf); }
+				template<typename L> static L ASin(L x) { return PerLane(x, asinf); }
+				template<typename L> static L ACos(L x) { return PerLane(x, acosf); }
+				template<typename L> static L ATan(L x) { return PerLane(x, atanf); }
+				template<typename L> static L ATan2(L y, L x) { return PerLane(y, x, atan2f); }
+			};
+		}
+
 		//Trigonometric Functions
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float Sin(float fValue)
 		{
-			return (float)sin(fValue);
+			return Detail::Trig<P>::Sin(fValue);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float Cos(float fValue)
 		{
-			return (float)cos(fValue);
+			return Detail::Trig<P>::Cos(fValue);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float Tan(float fValue)
 		{
-			return (float)tan(fValue);
+			return Detail::Trig<P>::Tan(fValue);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline void SinCos(float fValue, float& fSin, float& fCos)
+		{
+			Detail::Trig<P>::SinCos(fValue, fSin, fCos);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float ASin(float fValue)
 		{
-			return (float)asin(fValue);
+			return Detail::Trig<P>::ASin(fValue);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float ACos(float fValue)
 		{
-			return (float)acos(fValue);
+			return Detail::Trig<P>::ACos(fValue);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
 		inline float ATan(float fValue)
 		{
-			return (float)atan(fValue);
+			return Detail::Trig<P>::ATan(fValue);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline float ATan2(float fY, float fX)
+		{
+			return Detail::Trig<P>::ATan2(fY, fX);
+		}
+
+		//Four lanes at a time
+#if USING_SSE
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 Sin(__m128 value)
+		{
+			return Detail::Trig<P>::Sin(value);
 		}
 
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 Cos(__m128 value)
+		{
+			return Detail::Trig<P>::Cos(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 Tan(__m128 value)
+		{
+			return Detail::Trig<P>::Tan(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 ASin(__m128 value)
+		{
+			return Detail::Trig<P>::ASin(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 ACos(__m128 value)
+		{
+			return Detail::Trig<P>::ACos(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 ATan(__m128 value)
+		{
+			return Detail::Trig<P>::ATan(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline void SinCos(__m128 value, __m128& sin, __m128& cos)
+		{
+			Detail::Trig<P>::SinCos(value, sin, cos);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m128 ATan2(__m128 y, __m128 x)
+		{
+			return Detail::Trig<P>::ATan2(y, x);
+		}
+#endif
+
+		//Eight lanes at a time
+#if USING_AVX2
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 Sin(__m256 value)
+		{
+			return Detail::Trig<P>::Sin(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 Cos(__m256 value)
+		{
+			return Detail::Trig<P>::Cos(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 Tan(__m256 value)
+		{
+			return Detail::Trig<P>::Tan(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 ASin(__m256 value)
+		{
+			return Detail::Trig<P>::ASin(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 ACos(__m256 value)
+		{
+			return Detail::Trig<P>::ACos(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 ATan(__m256 value)
+		{
+			return Detail::Trig<P>::ATan(value);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline void SinCos(__m256 value, __m256& sin, __m256& cos)
+		{
+			Detail::Trig<P>::SinCos(value, sin, cos);
+		}
+
+		template<Precision P = Precision::MATH_PRECISION>
+		inline __m256 ATan2(__m256 y, __m256 x)
+		{
+			return Detail::Trig<P>::ATan2(y, x);
+		}
+#endif
+
 		inline float Max(float fValueA, float fValueB)
 		{
 			return (fValueA > fValueB) ? fValueA : fValueB;
@@ -61,5 +518,3 @@ namespace Oblivion
 		}
 	}
 }
-
-
@@ -2,6 +2,7 @@
 //
 
 #include <iostream>
+#include <stdlib.h>
 #include "IO.h"
 
 using namespace Oblivion::Math;
@@ -18,7 +19,9 @@ int main()
     std::cout << "v1 * s = " << v1 * 2 << std::endl;
     std::cout << "v1 == v2 = " << (v1 != v2) << std::endl;
 
+#if defined(_WIN32)
 	system("PAUSE");
+#endif
 }
 
 // Run program: Ctrl + F5 or Debug > Start Without Debugging menu
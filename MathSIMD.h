@@ -0,0 +1,312 @@
+#pragma once
+
+// Compile-time SIMD backend selection.
+//
+// Define USING_SIMD to 0 before including any math header to force the scalar
+// reference paths. Otherwise the widest instruction set enabled for the
+// translation unit is used:
+//   USING_AVX2 - AVX2 (+FMA), e.g. -mavx2 -mfma or /arch:AVX2
+//   USING_SSE  - SSE4.1, e.g. -msse4.1 or /arch:AVX
+// USING_FMA is set alongside USING_AVX2 when fused multiply-add is available.
+#ifndef USING_SIMD
+#define USING_SIMD 1
+#endif
+
+#if USING_SIMD && defined(__AVX2__)
+#define USING_AVX2 1
+#else
+#define USING_AVX2 0
+#endif
+
+#if USING_SIMD && (defined(__SSE4_1__) || defined(__AVX__))
+#define USING_SSE 1
+#else
+#define USING_SSE 0
+#endif
+
+#if USING_AVX2 && (defined(__FMA__) || defined(_MSC_VER))
+#define USING_FMA 1
+#else
+#define USING_FMA 0
+#endif
+
+// Hardware half <-> float conversion. MSVC has no macro for it; AVX2 implies it.
+#if USING_AVX2 && (defined(__F16C__) || defined(_MSC_VER))
+#define USING_F16C 1
+#else
+#define USING_F16C 0
+#endif
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if USING_SSE
+#include <smmintrin.h>
+#endif
+
+#if USING_AVX2
+#include <immintrin.h>
+#endif
+
+namespace Oblivion {
+namespace Math {
+    namespace Detail {
+        // Storage for SIMD streams. Release with AlignedFree.
+        inline void* AlignedAlloc(size_t size, size_t alignment)
+        {
+#if defined(_WIN32)
+            return _aligned_malloc(size, alignment);
+#else
+            void* p = NULL;
+            return posix_memalign(&p, alignment, size) == 0 ? p : NULL;
+#endif
+        }
+
+        inline void AlignedFree(void* p)
+        {
+#if defined(_WIN32)
+            _aligned_free(p);
+#else
+            free(p);
+#endif
+        }
+
+        // std::vector allocator honouring alignof(T) beyond what operator new
+        // guarantees in C++14.
+        template <typename T>
+        struct AlignedAllocator {
+            typedef T value_type;
+
+            AlignedAllocator() {}
+            template <typename U>
+            AlignedAllocator(const AlignedAllocator<U>&) {}
+
+            T* allocate(size_t n)
+            {
+                void* p = AlignedAlloc(n * sizeof(T), alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T));
+                if (!p)
+                    throw std::bad_alloc();
+                return static_cast<T*>(p);
+            }
+
+            void deallocate(T* p, size_t) { AlignedFree(p); }
+
+            template <typename U>
+            bool operator==(const AlignedAllocator<U>&) const { return true; }
+            template <typename U>
+            bool operator!=(const AlignedAllocator<U>&) const { return false; }
+        };
+
+#if USING_SSE
+        // a * b + c
+        inline __m128 MulAdd(__m128 a, __m128 b, __m128 c)
+        {
+#if USING_FMA
+            return _mm_fmadd_ps(a, b, c);
+#else
+            return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+        }
+#endif
+
+#if USING_AVX2
+        // a * b + c
+        inline __m256 MulAdd(__m256 a, __m256 b, __m256 c)
+        {
+#if USING_FMA
+            return _mm256_fmadd_ps(a, b, c);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+        // _MM_TRANSPOSE4_PS applied to both 128-bit lanes independently.
+        inline void Transpose4InLanes(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+        {
+            __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+            __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+            __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+            __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+            r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+#endif
+
+        /********************************************************************
+        // LANE OPERATIONS
+        //
+        // The same operations on a float and on SSE / AVX2 registers, so
+        // kernels can be written once as templates on the lane type and run
+        // eight (or four) elements at a time with a scalar tail. Masks are
+        // bool for float lanes and all-ones bit patterns for registers.
+        // SignOf/FlipSign are a pair: FlipSign(x, SignOf(s)) negates x where
+        // s is negative. SignBit is the mask of lanes whose sign bit is set,
+        // -0 included. MoveMask packs a mask into one bit per lane.
+        ********************************************************************/
+        inline float Broadcast(float s, float) { return s; }
+        inline float Add(float a, float b) { return a + b; }
+        inline float Sub(float a, float b) { return a - b; }
+        inline float Mul(float a, float b) { return a * b; }
+        inline float Div(float a, float b) { return a / b; }
+        inline float MulAdd(float a, float b, float c) { return a * b + c; }
+        inline float Sqrt(float a) { return sqrtf(a); }
+        inline float Min(float a, float b) { return a < b ? a : b; }
+        inline float Max(float a, float b) { return a > b ? a : b; }
+        inline float Abs(float a) { return fabsf(a); }
+        inline float Floor(float a) { return floorf(a); }
+        inline float Round(float a) { return nearbyintf(a); }
+        inline bool LessThan(float a, float b) { return a < b; }
+        inline bool LessEqual(float a, float b) { return a <= b; }
+        inline bool And(bool a, bool b) { return a && b; }
+        inline float Select(bool mask, float a, float b) { return mask ? a : b; }
+        inline float NegateIf(bool mask, float x) { return mask ? -x : x; }
+        inline bool SignBit(float a) { return signbit(a) != 0; }
+        inline float SignOf(float a) { return signbit(a) ? -1.0f : 1.0f; }
+        inline float FlipSign(float x, float sign) { return x * sign; }
+        inline float LoadLanes(const float* p, float) { return *p; }
+        inline void StoreLanes(float* p, float a) { *p = a; }
+        inline int MoveMask(bool mask) { return mask ? 1 : 0; }
+
+        // value / len where len > 0, otherwise 0.
+        inline float DivideIfPositive(float value, float len)
+        {
+            return len > 0.0f ? value * (1.0f / len) : 0.0f;
+        }
+
+#if USING_SSE
+        inline __m128 Broadcast(float s, __m128) { return _mm_set1_ps(s); }
+        inline __m128 Add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        inline __m128 Sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+        inline __m128 Mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+        inline __m128 Div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+        inline __m128 Sqrt(__m128 a) { return _mm_sqrt_ps(a); }
+        inline __m128 Min(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+        inline __m128 Max(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+        inline __m128 Abs(__m128 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        inline __m128 Floor(__m128 a) { return _mm_floor_ps(a); }
+        inline __m128 Round(__m128 a) { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        inline __m128 LessThan(__m128 a, __m128 b) { return _mm_cmplt_ps(a, b); }
+        inline __m128 LessEqual(__m128 a, __m128 b) { return _mm_cmple_ps(a, b); }
+        inline __m128 And(__m128 a, __m128 b) { return _mm_and_ps(a, b); }
+        inline __m128 Select(__m128 mask, __m128 a, __m128 b) { return _mm_blendv_ps(b, a, mask); }
+        inline __m128 NegateIf(__m128 mask, __m128 x) { return _mm_xor_ps(x, _mm_and_ps(mask, _mm_set1_ps(-0.0f))); }
+        inline __m128 SignBit(__m128 a) { return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(a), 31)); }
+        inline __m128 SignOf(__m128 a) { return _mm_and_ps(a, _mm_set1_ps(-0.0f)); }
+        inline __m128 FlipSign(__m128 x, __m128 sign) { return _mm_xor_ps(x, sign); }
+        inline __m128 LoadLanes(const float* p, __m128) { return _mm_loadu_ps(p); }
+        inline void StoreLanes(float* p, __m128 a) { _mm_storeu_ps(p, a); }
+        inline int MoveMask(__m128 mask) { return _mm_movemask_ps(mask); }
+
+        inline __m128 DivideIfPositive(__m128 value, __m128 len)
+        {
+            __m128 mask = _mm_cmpgt_ps(len, _mm_setzero_ps());
+            return _mm_and_ps(_mm_mul_ps(value, _mm_div_ps(_mm_set1_ps(1.0f), len)), mask);
+        }
+#endif
+
+#if USING_AVX2
+        inline __m256 Broadcast(float s, __m256) { return _mm256_set1_ps(s); }
+        inline __m256 Add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+        inline __m256 Sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+        inline __m256 Mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+        inline __m256 Div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+        inline __m256 Sqrt(__m256 a) { return _mm256_sqrt_ps(a); }
+        inline __m256 Min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+        inline __m256 Max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+        inline __m256 Abs(__m256 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        inline __m256 Floor(__m256 a) { return _mm256_floor_ps(a); }
+        inline __m256 Round(__m256 a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        inline __m256 LessThan(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        inline __m256 LessEqual(__m256 a, __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        inline __m256 And(__m256 a, __m256 b) { return _mm256_and_ps(a, b); }
+        inline __m256 Select(__m256 mask, __m256 a, __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+        inline __m256 NegateIf(__m256 mask, __m256 x) { return _mm256_xor_ps(x, _mm256_and_ps(mask, _mm256_set1_ps(-0.0f))); }
+        inline __m256 SignBit(__m256 a) { return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(a), 31)); }
+        inline __m256 SignOf(__m256 a) { return _mm256_and_ps(a, _mm256_set1_ps(-0.0f)); }
+        inline __m256 FlipSign(__m256 x, __m256 sign) { return _mm256_xor_ps(x, sign); }
+        inline __m256 LoadLanes(const float* p, __m256) { return _mm256_loadu_ps(p); }
+        inline void StoreLanes(float* p, __m256 a) { _mm256_storeu_ps(p, a); }
+        inline int MoveMask(__m256 mask) { return _mm256_movemask_ps(mask); }
+
+        inline __m256 DivideIfPositive(__m256 value, __m256 len)
+        {
+            __m256 mask = _mm256_cmp_ps(len, _mm256_setzero_ps(), _CMP_GT_OQ);
+            return _mm256_and_ps(_mm256_mul_ps(value, _mm256_div_ps(_mm256_set1_ps(1.0f), len)), mask);
+        }
+#endif
+
+        /********************************************************************
+        // INDEX COMPACTION
+        //
+        // SelectIndices(score, count, out) writes, in order, the indices i
+        // with score(i, lanes) >= 0 and returns how many there are. score is
+        // called with a float, __m128 or __m256 lane tag and evaluates that
+        // many elements starting at i. out must have room for count indices.
+        ********************************************************************/
+        // Every lane index is written but the cursor only advances past the
+        // selected ones, so there are no branches; writes stay below
+        // i + lanes <= count.
+        template <typename F>
+        inline size_t AppendSelected(F score, size_t i, uint32_t* out, size_t n)
+        {
+            const int lanes = sizeof(F) / sizeof(float);
+            int rejected = MoveMask(LessThan(score, Broadcast(0.0f, score)));
+            for (int k = 0; k < lanes; ++k) {
+                out[n] = (uint32_t)(i + k);
+                n += ((rejected >> k) & 1) ^ 1;
+            }
+            return n;
+        }
+
+        template <typename Score>
+        size_t SelectIndices(const Score& score, size_t count, uint32_t* out)
+        {
+            size_t n = 0, i = 0;
+#if USING_AVX2
+            for (; i + 8 <= count; i += 8)
+                n = AppendSelected(score(i, _mm256_setzero_ps()), i, out, n);
+#elif USING_SSE
+            for (; i + 4 <= count; i += 4)
+                n = AppendSelected(score(i, _mm_setzero_ps()), i, out, n);
+#endif
+            for (; i < count; ++i)
+                n = AppendSelected(score(i, 0.0f), i, out, n);
+            return n;
+        }
+
+        // Drives score below zero in the lanes where size is negative, so
+        // empty volumes (negative radius or extent) are never selected.
+        template <typename F>
+        inline F RejectNegative(F size, F score)
+        {
+            return Select(LessThan(size, Broadcast(0.0f, size)), Broadcast(-1.0f, size), score);
+        }
+
+        // Runs kernel(i, lanes) over count elements: blocks of eight with
+        // AVX2 or four with SSE, then a scalar tail.
+        template <typename Kernel>
+        inline void ForEachLanes(size_t count, const Kernel& kernel)
+        {
+            size_t i = 0;
+#if USING_AVX2
+            for (; i + 8 <= count; i += 8)
+                kernel(i, _mm256_setzero_ps());
+#elif USING_SSE
+            for (; i + 4 <= count; i += 4)
+                kernel(i, _mm_setzero_ps());
+#endif
+            for (; i < count; ++i)
+                kernel(i, 0.0f);
+        }
+    } // end namespace Detail
+} // end namespace Math
+} // end namespace Oblivion
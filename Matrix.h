@@ -0,0 +1,344 @@
+#pragma once
+
+#include "Mat2x2.h"
+#include "Matrix44.h"
+#include "Vector.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // TEMPLATED MATRIX CORE
+    //
+    // Matrix<R, C, T> stores R rows of Vector<C, T>, so m[i][j] reads the
+    // same as in Mat3x3 and Matrix44. It follows the library's row-vector
+    // convention: M * v combines the rows of M weighted by the components
+    // of v, and the translation of a 4x4 transform lives in row 3.
+    //
+    // All operations except the legacy conversions are constexpr and are
+    // expanded per element at compile time. Matrix<4, 4, float> and
+    // Matrix<2, 2, float> convert implicitly to and from Matrix44 and
+    // Mat2x2, which keep the SIMD paths.
+    ********************************************************************/
+    template <int R, int C, typename T>
+    class Matrix;
+
+    namespace Detail {
+        template <int R, int C, typename T>
+        struct LegacyMatrix {
+            typedef void Type;
+        };
+
+        template <>
+        struct LegacyMatrix<2, 2, float> {
+            typedef Mat2x2 Type;
+        };
+
+        template <>
+        struct LegacyMatrix<4, 4, float> {
+            typedef Matrix44 Type;
+        };
+
+        template <int R, int C, typename T, typename M>
+        using EnableIfLegacyMatrix = typename std::enable_if<std::is_same<M, typename LegacyMatrix<R, C, T>::Type>::value>::type;
+
+        // Compile-time reductions over 0..K.
+        template <int K>
+        struct MatrixUnroll {
+            // Row i of a times column j of b.
+            template <int R, int N, int C, typename T>
+            static constexpr T RowColumn(const Matrix<R, N, T>& a, const Matrix<N, C, T>& b, int i, int j)
+            {
+                return MatrixUnroll<K - 1>::RowColumn(a, b, i, j) + a[i][K] * b[K][j];
+            }
+
+            // v times column j of m.
+            template <int R, int C, typename T>
+            static constexpr T VectorColumn(const Vector<R, T>& v, const Matrix<R, C, T>& m, int j)
+            {
+                return MatrixUnroll<K - 1>::VectorColumn(v, m, j) + v[K] * m[K][j];
+            }
+
+            template <int R, int C, typename T>
+            static constexpr bool Equal(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+            {
+                return MatrixUnroll<K - 1>::Equal(a, b) && a[K] == b[K];
+            }
+        };
+
+        template <>
+        struct MatrixUnroll<0> {
+            template <int R, int N, int C, typename T>
+            static constexpr T RowColumn(const Matrix<R, N, T>& a, const Matrix<N, C, T>& b, int i, int j)
+            {
+                return a[i][0] * b[0][j];
+            }
+
+            template <int R, int C, typename T>
+            static constexpr T VectorColumn(const Vector<R, T>& v, const Matrix<R, C, T>& m, int j)
+            {
+                return v[0] * m[0][j];
+            }
+
+            template <int R, int C, typename T>
+            static constexpr bool Equal(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+            {
+                return a[0] == b[0];
+            }
+        };
+
+        // Element generators for Generate().
+        template <int R, int N, int C, typename T>
+        struct MultiplyElement {
+            const Matrix<R, N, T>& a;
+            const Matrix<N, C, T>& b;
+
+            constexpr T operator()(int i, int j) const { return MatrixUnroll<N - 1>::RowColumn(a, b, i, j); }
+        };
+
+        template <int R, int C, typename T>
+        struct TransposeElement {
+            const Matrix<C, R, T>& a;
+
+            constexpr T operator()(int i, int j) const { return a[j][i]; }
+        };
+
+        template <typename T>
+        struct DiagonalElement {
+            T diagonal;
+
+            constexpr T operator()(int i, int j) const { return i == j ? diagonal : T(0); }
+        };
+
+        template <typename T, typename M>
+        struct LegacyElement {
+            const M& m;
+
+            T operator()(int i, int j) const { return static_cast<T>(m.m[i][j]); }
+        };
+
+        // Builds a matrix from f(i, j), one constructor argument per element.
+        template <int R, int C, typename T, typename F, size_t... I>
+        constexpr Matrix<R, C, T> Generate(const F& f, std::index_sequence<I...>);
+    } // end namespace Detail
+
+    template <int R, int C, typename T>
+    class Matrix {
+        static_assert(R >= 2 && C >= 2, "Matrix needs at least two rows and columns");
+
+    public:
+        typedef T ValueType;
+
+        Vector<C, T> m[R];
+
+        constexpr Matrix()
+            : m()
+        {
+        }
+
+        explicit constexpr Matrix(T diagonal)
+            : Matrix(Detail::Generate<R, C, T>(Detail::DiagonalElement<T>{ diagonal }, Detail::MakeIndices<R>()))
+        {
+        }
+
+        template <typename... RowTypes, typename = typename std::enable_if<sizeof...(RowTypes) == R && Detail::AllConvertible<Vector<C, T>, RowTypes...>::value>::type>
+        constexpr Matrix(const RowTypes&... rows)
+            : m{ Vector<C, T>(rows)... }
+        {
+        }
+
+        template <typename M, typename = Detail::EnableIfLegacyMatrix<R, C, T, M>>
+        Matrix(const M& legacy)
+            : Matrix(Detail::Generate<R, C, T>(Detail::LegacyElement<T, M>{ legacy }, Detail::MakeIndices<R>()))
+        {
+        }
+
+        // Precision conversion, e.g. Matrix<4, 4, float>(Matrix<4, 4, double>).
+        template <typename U, typename = typename std::enable_if<!std::is_same<T, U>::value>::type>
+        explicit Matrix(const Matrix<R, C, U>& other)
+            : Matrix(Detail::Generate<R, C, T>(Detail::LegacyElement<T, Matrix<R, C, U>>{ other }, Detail::MakeIndices<R>()))
+        {
+        }
+
+        template <typename M, typename = Detail::EnableIfLegacyMatrix<R, C, T, M>>
+        operator M() const
+        {
+            M result;
+            StoreLegacy(result, Detail::MakeIndices<R * C>());
+            return result;
+        }
+
+        static constexpr Matrix Identity()
+        {
+            static_assert(R == C, "Identity needs a square matrix");
+            return Matrix(T(1));
+        }
+
+        constexpr Vector<C, T>& operator[](int i) { return m[i]; }
+        constexpr const Vector<C, T>& operator[](int i) const { return m[i]; }
+
+        constexpr Vector<C, T> GetRow(int i) const
+        {
+            return m[i];
+        }
+
+        constexpr Vector<R, T> GetColumn(int j) const
+        {
+            return GetColumn(j, Detail::MakeIndices<R>());
+        }
+
+    private:
+        template <size_t... I>
+        constexpr Vector<R, T> GetColumn(int j, std::index_sequence<I...>) const
+        {
+            return Vector<R, T>(m[I][j]...);
+        }
+
+        template <typename M, size_t... I>
+        void StoreLegacy(M& out, std::index_sequence<I...>) const
+        {
+            int expand[] = { (out.m[I / C][I % C] = static_cast<float>(m[I / C][I % C]), 0)... };
+            (void)expand;
+        }
+    };
+
+    namespace Detail {
+        template <int C, typename T, typename F, size_t... J>
+        constexpr Vector<C, T> GenerateRow(const F& f, int i, std::index_sequence<J...>)
+        {
+            return Vector<C, T>(f(i, (int)J)...);
+        }
+
+        template <int R, int C, typename T, typename F, size_t... I>
+        constexpr Matrix<R, C, T> Generate(const F& f, std::index_sequence<I...>)
+        {
+            return Matrix<R, C, T>(GenerateRow<C, T>(f, (int)I, MakeIndices<C>())...);
+        }
+
+        template <int R, int C, typename T, size_t... I>
+        constexpr Matrix<R, C, T> AddRows(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b, std::index_sequence<I...>)
+        {
+            return Matrix<R, C, T>((a[(int)I] + b[(int)I])...);
+        }
+
+        template <int R, int C, typename T, size_t... I>
+        constexpr Matrix<R, C, T> SubtractRows(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b, std::index_sequence<I...>)
+        {
+            return Matrix<R, C, T>((a[(int)I] - b[(int)I])...);
+        }
+
+        template <int R, int C, typename T, size_t... I>
+        constexpr Matrix<R, C, T> ScaleRows(const Matrix<R, C, T>& a, T s, std::index_sequence<I...>)
+        {
+            return Matrix<R, C, T>((a[(int)I] * s)...);
+        }
+
+        template <int R, int C, typename T, size_t... J>
+        constexpr Vector<C, T> TransformRow(const Vector<R, T>& v, const Matrix<R, C, T>& m, std::index_sequence<J...>)
+        {
+            return Vector<C, T>(MatrixUnroll<R - 1>::VectorColumn(v, m, (int)J)...);
+        }
+    } // end namespace Detail
+
+    /********************************************************************
+    // MATRIX OPERATORS
+    ********************************************************************/
+    template <int R, int N, int C, typename T>
+    constexpr Matrix<R, C, T> operator*(const Matrix<R, N, T>& a, const Matrix<N, C, T>& b)
+    {
+        return Detail::Generate<R, C, T>(Detail::MultiplyElement<R, N, C, T>{ a, b }, Detail::MakeIndices<R>());
+    }
+
+    // Row vector times matrix.
+    template <int R, int C, typename T>
+    constexpr Vector<C, T> operator*(const Matrix<R, C, T>& m, const Vector<R, T>& v)
+    {
+        return Detail::TransformRow(v, m, Detail::MakeIndices<C>());
+    }
+
+    template <int R, int C, typename T>
+    constexpr Matrix<R, C, T> operator*(const Matrix<R, C, T>& m, typename Detail::NonDeduced<T>::Type s)
+    {
+        return Detail::ScaleRows(m, s, Detail::MakeIndices<R>());
+    }
+
+    template <int R, int C, typename T>
+    constexpr Matrix<R, C, T> operator*(typename Detail::NonDeduced<T>::Type s, const Matrix<R, C, T>& m)
+    {
+        return Detail::ScaleRows(m, s, Detail::MakeIndices<R>());
+    }
+
+    template <int R, int C, typename T>
+    constexpr Matrix<R, C, T> operator+(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+    {
+        return Detail::AddRows(a, b, Detail::MakeIndices<R>());
+    }
+
+    template <int R, int C, typename T>
+    constexpr Matrix<R, C, T> operator-(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+    {
+        return Detail::SubtractRows(a, b, Detail::MakeIndices<R>());
+    }
+
+    template <int N, typename T>
+    constexpr Matrix<N, N, T>& operator*=(Matrix<N, N, T>& a, const Matrix<N, N, T>& b)
+    {
+        return a = a * b;
+    }
+
+    template <int R, int C, typename T>
+    constexpr bool operator==(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+    {
+        return Detail::MatrixUnroll<R - 1>::Equal(a, b);
+    }
+
+    template <int R, int C, typename T>
+    constexpr bool operator!=(const Matrix<R, C, T>& a, const Matrix<R, C, T>& b)
+    {
+        return !(a == b);
+    }
+
+    /********************************************************************
+    // NON-MEMBER FUNCTIONS
+    ********************************************************************/
+    template <int R, int C, typename T>
+    constexpr Matrix<C, R, T> Transpose(const Matrix<R, C, T>& m)
+    {
+        return Detail::Generate<C, R, T>(Detail::TransposeElement<C, R, T>{ m }, Detail::MakeIndices<C>());
+    }
+
+    template <typename T>
+    constexpr T Determinant(const Matrix<2, 2, T>& m)
+    {
+        return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    }
+
+    template <typename T>
+    constexpr T Determinant(const Matrix<3, 3, T>& m)
+    {
+        return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+            - m[1][0] * (m[0][1] * m[2][2] - m[0][2] * m[2][1])
+            + m[2][0] * (m[0][1] * m[1][2] - m[0][2] * m[1][1]);
+    }
+
+    // Expansion over the 2x2 sub-determinants of the top and bottom row pairs.
+    template <typename T>
+    constexpr T Determinant(const Matrix<4, 4, T>& m)
+    {
+        T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+        T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+        T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+        T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+        T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+        T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+        T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+        T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+        T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+        T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+        T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+        T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+} // end namespace Math
+} // end namespace Oblivion
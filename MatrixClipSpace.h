@@ -1,14 +1,85 @@
 #pragma once
+#include "MathFunctions.h"
+#include "Matrix.h"
 #include "Matrix44.h"
 
 #define USING_OPENGL 1
 
 namespace Oblivion {
 namespace Math {
+    namespace Detail {
+        // tan(x) for |x| < pi / 2 from the sine and cosine series, so it can
+        // run at compile time. Accurate to a few ULP in double.
+        template <typename T>
+        constexpr T ConstexprTan(T x)
+        {
+            T x2 = x * x;
+            T sinTerm = x, cosTerm = T(1);
+            T sinSum = x, cosSum = T(1);
+            for (int n = 1; n <= 12; ++n) {
+                sinTerm = sinTerm * -x2 / T((2 * n) * (2 * n + 1));
+                cosTerm = cosTerm * -x2 / T((2 * n - 1) * (2 * n));
+                sinSum = sinSum + sinTerm;
+                cosSum = cosSum + cosTerm;
+            }
+            return sinSum / cosSum;
+        }
+    } // end namespace Detail
+
+    /********************************************************************
+    // CONSTEXPR PROJECTIONS
+    //
+    // Templated counterparts of Perspective and Orthographic below that
+    // build the same matrices on the templated core, so projections with
+    // known parameters fold to constants:
+    //
+    //     constexpr Matrix<4, 4, float> proj = MakePerspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+    ********************************************************************/
+    template <typename T>
+    constexpr Matrix<4, 4, T> MakePerspective(T fovY, T aspect, T nearZ, T farZ)
+    {
+        T zoom = Detail::ConstexprTan(fovY * T(0.5));
+
+#if USING_OPENGL == 0
+        // DirectX perspective projection matrix
+        return Matrix<4, 4, T>(
+            Vector<4, T>(T(1) / (zoom * aspect), T(0), T(0), T(0)),
+            Vector<4, T>(T(0), T(1) / zoom, T(0), T(0)),
+            Vector<4, T>(T(0), T(0), farZ / (farZ - nearZ), T(1)),
+            Vector<4, T>(T(0), T(0), (-nearZ * farZ) / (farZ - nearZ), T(0)));
+#else
+        // OpenGL perspective projection matrix
+        return Matrix<4, 4, T>(
+            Vector<4, T>(T(1) / (zoom * aspect), T(0), T(0), T(0)),
+            Vector<4, T>(T(0), T(1) / zoom, T(0), T(0)),
+            Vector<4, T>(T(0), T(0), -(farZ + nearZ) / (farZ - nearZ), T(-1)),
+            Vector<4, T>(T(0), T(0), (T(-2) * farZ * nearZ) / (farZ - nearZ), T(0)));
+#endif
+    }
+
+    template <typename T>
+    constexpr Matrix<4, 4, T> MakeOrthographic(T left, T right, T bottom, T top, T nearZ, T farZ)
+    {
+#if USING_OPENGL == 0
+        return Matrix<4, 4, T>(
+            Vector<4, T>(T(2) / (right - left), T(0), T(0), T(0)),
+            Vector<4, T>(T(0), T(2) / (top - bottom), T(0), T(0)),
+            Vector<4, T>(T(0), T(0), T(1) / (farZ - nearZ), T(0)),
+            Vector<4, T>((left + right) / (left - right), (top + bottom) / (bottom - top), nearZ / (nearZ - farZ), T(1)));
+#else
+        // OpenGL orthographic projection matrix
+        return Matrix<4, 4, T>(
+            Vector<4, T>(T(2) / (right - left), T(0), T(0), T(0)),
+            Vector<4, T>(T(0), T(2) / (top - bottom), T(0), T(0)),
+            Vector<4, T>(T(0), T(0), T(-2) / (farZ - nearZ), T(0)),
+            Vector<4, T>(-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farZ + nearZ) / (farZ - nearZ), T(1)));
+#endif
+    }
+
     inline Matrix44 Perspective(const float& fovY, const float& aspect, const float& nearZ, const float& farZ)
     {
         Matrix44 result;
-        float zoom = tan(fovY * 0.5f);
+        float zoom = Tan(fovY * 0.5f);
 
 #if USING_OPENGL == 0
         // DirectX perspective projection matrix
@@ -37,15 +108,18 @@ namespace Math {
         result[0][0] = 2.0f / (right - left);
         result[1][1] = 2.0f / (top - bottom);
         result[2][2] = 1.0f / (farZ - nearZ);
+        result[3][0] = (left + right) / (left - right);
+        result[3][1] = (top + bottom) / (bottom - top);
         result[3][2] = nearZ / (nearZ - farZ);
 #else
         // OpenGL orthographic projection matrix
         result[0][0] = 2.0f / (right - left);
         result[1][1] = 2.0f / (top - bottom);
         result[2][2] = -2.0f / (farZ - nearZ);
-        result[0][3] = -(right + left) / (right - left);
-        result[1][3] = -(top + bottom) / (top - bottom);
-        result[2][3] = -(farZ + nearZ) / (farZ - nearZ);
+        // Row vectors (clip = v * m), so the translation is the last row.
+        result[3][0] = -(right + left) / (right - left);
+        result[3][1] = -(top + bottom) / (top - bottom);
+        result[3][2] = -(farZ + nearZ) / (farZ - nearZ);
 #endif
 
         return result;
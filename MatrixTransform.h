@@ -58,8 +58,8 @@ namespace Math {
     {
         Normalize(v);
 
-        float sin = Sin(angle);
-        float cos = Cos(angle);
+        float sin, cos;
+        SinCos(angle, sin, cos);
         float tmp = 1.0f - cos;
 
         float axisX = v.x * tmp;
@@ -87,8 +87,8 @@ namespace Math {
 
     inline Matrix44 Rotate(const Matrix44& m, const float& angle, const int& axis)
     {
-        float cos = Cos(angle);
-        float sin = Sin(angle);
+        float sin, cos;
+        SinCos(angle, sin, cos);
 
         Matrix44 rotate(1.0f);
 
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "AABB.h"
+#include "Mat3x3.h"
+#include "Parallel.h"
+#include "Sphere.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // Oriented box: the points center + a * axes[0] + b * axes[1] +
+    // c * axes[2] with |a| <= extents.x, |b| <= extents.y, |c| <= extents.z.
+    // The rows of axes are orthonormal and right-handed, like a
+    // RotationMatrix taking box space to world space. The default box is
+    // empty (negative extents).
+    class OBB {
+    public:
+        Vector3 center;
+        Mat3x3<float> axes;
+        Vector3 extents;
+
+        OBB();
+        OBB(const Vector3& center, const Mat3x3<float>& axes, const Vector3& extents);
+        explicit OBB(const AABB& box);
+
+        bool IsEmpty() const { return extents.x < 0.0f; }
+        bool Contains(const Vector3& p) const;
+        // The smallest AABB containing the box.
+        AABB Bounds() const;
+    };
+
+    // Separating axis tests; touching boxes intersect.
+    bool Intersects(const OBB& a, const OBB& b);
+    bool Intersects(const OBB& a, const AABB& b);
+
+    // The box mapped by m, without going back to the points it was fitted
+    // to. Exact for rotations, translations and uniform scale; under
+    // non-uniform scale or shear the image is no longer a box, and the
+    // result is the box around it aligned with m's image of axes[0]. m
+    // must be invertible.
+    OBB TransformBounds(const OBB& box, const Matrix44& m);
+
+    // Box aligned with the principal axes of the points (the eigenvectors
+    // of their covariance, largest spread first) and just large enough to
+    // contain them, rounded outwards. Points may be a Vector3Stream, a
+    // Vector3StreamView or a Vector3ArrayView, as for BoundingBox; both
+    // passes over them run eight points at a time and split across threads
+    // above options.parallelThreshold, and the result does not depend on
+    // the thread count. Empty inputs give an empty box.
+    template <typename Points>
+    auto BoundingOrientedBox(const Points& points, const BoundsOptions& options = BoundsOptions()) -> decltype(Detail::StreamReader(points), OBB());
+
+    /********************************************************************
+    // BATCH OVERLAP TESTS
+    //
+    // One box against many, as for CollectOverlaps on AABBs: writes the
+    // indices of the boxes overlapping query to hits, in order, and returns
+    // how many there are. Eight boxes are tested at a time on the 15
+    // separating axes; a group stops once every box in it is separated, so
+    // boxes far from query cost only the first three axes. Empty boxes
+    // never overlap: they are skipped, and an empty query gives no hits.
+    ********************************************************************/
+    struct OBBStreamView {
+        Vector3StreamView center;
+        Vector3StreamView axes[3];
+        Vector3StreamView extents;
+        size_t count;
+
+        OBBStreamView(const Vector3StreamView& center, const Vector3StreamView& axisX, const Vector3StreamView& axisY, const Vector3StreamView& axisZ, const Vector3StreamView& extents)
+            : center(center)
+            , axes{ axisX, axisY, axisZ }
+            , extents(extents)
+            , count(center.count)
+        {
+        }
+    };
+
+    size_t CollectOverlaps(const OBB& query, const OBBStreamView& boxes, uint32_t* hits);
+    size_t CollectOverlaps(const OBB& query, const AABBStreamView& boxes, uint32_t* hits);
+
+    inline OBB::OBB()
+        : center(0.0f, 0.0f, 0.0f)
+        , axes(1.0f)
+        , extents(-1.0f, -1.0f, -1.0f)
+    {
+    }
+
+    inline OBB::OBB(const Vector3& center, const Mat3x3<float>& axes, const Vector3& extents)
+        : center(center)
+        , axes(axes)
+        , extents(extents)
+    {
+    }
+
+    inline OBB::OBB(const AABB& box)
+        : center(box.Center())
+        , axes(1.0f)
+        , extents(box.Extents())
+    {
+        if (box.IsEmpty())
+            *this = OBB();
+    }
+
+    inline bool OBB::Contains(const Vector3& p) const
+    {
+        Vector3 d = p - center;
+        const float* e = &extents.x;
+        for (int k = 0; k < 3; ++k)
+            if (!(fabsf(d.x * axes[k][0] + d.y * axes[k][1] + d.z * axes[k][2]) <= e[k]))
+                return false;
+        return true;
+    }
+
+    inline AABB OBB::Bounds() const
+    {
+        if (IsEmpty())
+            return AABB();
+        // Each axis adds |axis| * extent to the half size along x, y and z.
+        float half[3];
+        const float* e = &extents.x;
+        for (int j = 0; j < 3; ++j)
+            half[j] = fabsf(axes[0][j]) * e[0] + fabsf(axes[1][j]) * e[1] + fabsf(axes[2][j]) * e[2];
+        return AABB::FromCenterExtents(center, Vector3(half[0], half[1], half[2]));
+    }
+
+    namespace Detail {
+        /********************************************************************
+        // SEPARATING AXES
+        //
+        // The test of Gottschalk et al. with b expressed in a's frame:
+        // r[3 * i + j] = a's axis i . b's axis j, t = b's center - a's
+        // center in a's axes, ea and eb the extents. The score is >= 0
+        // where the boxes overlap. A little is added to |r| so that
+        // near-parallel edges, whose cross product is almost zero, do not
+        // separate boxes that touch.
+        ********************************************************************/
+        template <typename F>
+        inline F SeparatingAxisScore(const F* r, const F* t, const F* ea, const F* eb)
+        {
+            F absR[9];
+            for (int e = 0; e < 9; ++e)
+                absR[e] = Add(Abs(r[e]), Broadcast(1e-6f, r[e]));
+
+            // a's axes.
+            auto overlap = LessEqual(Abs(t[0]), Add(ea[0], MulAdd(eb[0], absR[0], MulAdd(eb[1], absR[1], Mul(eb[2], absR[2])))));
+            for (int i = 1; i < 3; ++i)
+                overlap = And(overlap, LessEqual(Abs(t[i]), Add(ea[i], MulAdd(eb[0], absR[3 * i], MulAdd(eb[1], absR[3 * i + 1], Mul(eb[2], absR[3 * i + 2]))))));
+            if (!MoveMask(overlap))
+                return Broadcast(-1.0f, t[0]);
+
+            // b's axes.
+            for (int j = 0; j < 3; ++j) {
+                F distance = Abs(MulAdd(t[0], r[j], MulAdd(t[1], r[3 + j], Mul(t[2], r[6 + j]))));
+                F radius = Add(eb[j], MulAdd(ea[0], absR[j], MulAdd(ea[1], absR[3 + j], Mul(ea[2], absR[6 + j]))));
+                overlap = And(overlap, LessEqual(distance, radius));
+            }
+            if (!MoveMask(overlap))
+                return Broadcast(-1.0f, t[0]);
+
+            // Cross products of an axis of a with an axis of b.
+            for (int i = 0; i < 3; ++i) {
+                int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+                for (int j = 0; j < 3; ++j) {
+                    int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                    F distance = Abs(Sub(Mul(t[i2], r[3 * i1 + j]), Mul(t[i1], r[3 * i2 + j])));
+                    F ra = MulAdd(ea[i1], absR[3 * i2 + j], Mul(ea[i2], absR[3 * i1 + j]));
+                    F rb = MulAdd(eb[j1], absR[3 * i + j2], Mul(eb[j2], absR[3 * i + j1]));
+                    overlap = And(overlap, LessEqual(distance, Add(ra, rb)));
+                }
+            }
+            return Select(overlap, Broadcast(1.0f, t[0]), Broadcast(-1.0f, t[0]));
+        }
+
+        // Score of a against boxes with center c, axes u (rows) and extents e.
+        template <typename F>
+        inline F OBBScore(const OBB& a, const F* c, const F* u, const F* e)
+        {
+            F au[9], ea[3], d[3], t[3], r[9];
+            for (int k = 0; k < 9; ++k)
+                au[k] = Broadcast(a.axes[k / 3][k % 3], c[0]);
+            for (int k = 0; k < 3; ++k) {
+                ea[k] = Broadcast((&a.extents.x)[k], c[0]);
+                d[k] = Sub(c[k], Broadcast((&a.center.x)[k], c[0]));
+            }
+            for (int i = 0; i < 3; ++i) {
+                t[i] = MulAdd(d[0], au[3 * i], MulAdd(d[1], au[3 * i + 1], Mul(d[2], au[3 * i + 2])));
+                for (int j = 0; j < 3; ++j)
+                    r[3 * i + j] = MulAdd(au[3 * i], u[3 * j], MulAdd(au[3 * i + 1], u[3 * j + 1], Mul(au[3 * i + 2], u[3 * j + 2])));
+            }
+            return SeparatingAxisScore(r, t, ea, e);
+        }
+
+        // Score of a against axis-aligned boxes with center c and extents e:
+        // b's axes are x, y and z, so r is a's axes themselves.
+        template <typename F>
+        inline F AABBScore(const OBB& a, const F* c, const F* e)
+        {
+            F r[9], ea[3], d[3], t[3];
+            for (int k = 0; k < 9; ++k)
+                r[k] = Broadcast(a.axes[k / 3][k % 3], c[0]);
+            for (int k = 0; k < 3; ++k) {
+                ea[k] = Broadcast((&a.extents.x)[k], c[0]);
+                d[k] = Sub(c[k], Broadcast((&a.center.x)[k], c[0]));
+            }
+            for (int i = 0; i < 3; ++i)
+                t[i] = MulAdd(d[0], r[3 * i], MulAdd(d[1], r[3 * i + 1], Mul(d[2], r[3 * i + 2])));
+            return SeparatingAxisScore(r, t, ea, e);
+        }
+
+        struct OBBOverlapScore {
+            const OBB& query;
+            const OBBStreamView& boxes;
+
+            OBBOverlapScore(const OBB& query, const OBBStreamView& boxes)
+                : query(query)
+                , boxes(boxes)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F c[3] = { LoadLanes(boxes.center.x + i, lanes), LoadLanes(boxes.center.y + i, lanes), LoadLanes(boxes.center.z + i, lanes) };
+                F e[3] = { LoadLanes(boxes.extents.x + i, lanes), LoadLanes(boxes.extents.y + i, lanes), LoadLanes(boxes.extents.z + i, lanes) };
+                F u[9];
+                for (int k = 0; k < 3; ++k) {
+                    u[3 * k] = LoadLanes(boxes.axes[k].x + i, lanes);
+                    u[3 * k + 1] = LoadLanes(boxes.axes[k].y + i, lanes);
+                    u[3 * k + 2] = LoadLanes(boxes.axes[k].z + i, lanes);
+                }
+                // An OBB is empty when its first extent is negative.
+                return RejectNegative(e[0], OBBScore(query, c, u, e));
+            }
+        };
+
+        struct OBBBoxScore {
+            const OBB& query;
+            const AABBStreamView& boxes;
+
+            OBBBoxScore(const OBB& query, const AABBStreamView& boxes)
+                : query(query)
+                , boxes(boxes)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F half = Broadcast(0.5f, lanes);
+                F lo[3] = { LoadLanes(boxes.minX + i, lanes), LoadLanes(boxes.minY + i, lanes), LoadLanes(boxes.minZ + i, lanes) };
+                F hi[3] = { LoadLanes(boxes.maxX + i, lanes), LoadLanes(boxes.maxY + i, lanes), LoadLanes(boxes.maxZ + i, lanes) };
+                F c[3], e[3];
+                for (int k = 0; k < 3; ++k) {
+                    c[k] = Mul(Add(lo[k], hi[k]), half);
+                    e[k] = Mul(Sub(hi[k], lo[k]), half);
+                }
+                // An inverted box (maximum below minimum on any axis) is empty.
+                return RejectNegative(Min(Min(e[0], e[1]), e[2]), AABBScore(query, c, e));
+            }
+        };
+    } // end namespace Detail
+
+    inline bool Intersects(const OBB& a, const OBB& b)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+            return false;
+        float u[9];
+        for (int k = 0; k < 9; ++k)
+            u[k] = b.axes[k / 3][k % 3];
+        return Detail::OBBScore(a, &b.center.x, u, &b.extents.x) >= 0.0f;
+    }
+
+    inline bool Intersects(const OBB& a, const AABB& b)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+            return false;
+        Vector3 c = b.Center(), e = b.Extents();
+        return Detail::AABBScore(a, &c.x, &e.x) >= 0.0f;
+    }
+
+    inline OBB TransformBounds(const OBB& box, const Matrix44& m)
+    {
+        if (box.IsEmpty())
+            return box;
+
+        // Images of the center and the axes (rows: row vectors times m).
+        float c[3], a[3][3];
+        for (int j = 0; j < 3; ++j) {
+            c[j] = box.center.x * m[0][j] + box.center.y * m[1][j] + box.center.z * m[2][j] + m[3][j];
+            for (int k = 0; k < 3; ++k)
+                a[k][j] = box.axes[k][0] * m[0][j] + box.axes[k][1] * m[1][j] + box.axes[k][2] * m[2][j];
+        }
+
+        // Gram-Schmidt on the images; the right-handed cross product for
+        // the third axis also undoes a mirroring m.
+        Vector3D<float> x = Normalize(Vector3D<float>(a[0][0], a[0][1], a[0][2]));
+        Vector3D<float> y(a[1][0], a[1][1], a[1][2]);
+        y = Normalize(y - x * (x * y));
+        Mat3x3<float> axes(x, y, x ^ y);
+
+        // The image of the edge half-vector j, a[j] * extent j, reaches
+        // |a[j] . axis k| * extent j along axis k.
+        const float* e = &box.extents.x;
+        float extents[3];
+        for (int k = 0; k < 3; ++k) {
+            extents[k] = 0.0f;
+            for (int j = 0; j < 3; ++j)
+                extents[k] += fabsf(a[j][0] * axes[k][0] + a[j][1] * axes[k][1] + a[j][2] * axes[k][2]) * e[j];
+        }
+        return OBB(Vector3(c[0], c[1], c[2]), axes, Vector3(extents[0], extents[1], extents[2]));
+    }
+
+    namespace Detail {
+#if USING_AVX2
+        inline double ReduceAdd(__m256 v)
+        {
+            __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+            return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+        }
+#endif
+
+        // Sums of p - origin and of the products of its coordinates
+        // (xx, xy, xz, yy, yz, zz) over some points.
+        struct PointMoments {
+            double sum[3];
+            double products[6];
+
+            PointMoments()
+            {
+                for (int k = 0; k < 3; ++k)
+                    sum[k] = 0.0;
+                for (int k = 0; k < 6; ++k)
+                    products[k] = 0.0;
+            }
+
+            void Merge(const PointMoments& m)
+            {
+                for (int k = 0; k < 3; ++k)
+                    sum[k] += m.sum[k];
+                for (int k = 0; k < 6; ++k)
+                    products[k] += m.products[k];
+            }
+        };
+
+        // Moments of points [begin, end). Sums run in float within the
+        // chunk, which is short enough to keep them accurate, and in double
+        // across chunks.
+        template <typename Reader>
+        inline PointMoments ChunkMoments(const Reader& points, size_t begin, size_t end, const float* origin)
+        {
+            PointMoments m;
+            size_t i = begin;
+#if USING_AVX2
+            if (i + 8 <= end) {
+                __m256 ox = _mm256_set1_ps(origin[0]), oy = _mm256_set1_ps(origin[1]), oz = _mm256_set1_ps(origin[2]);
+                __m256 sx = _mm256_setzero_ps(), sy = sx, sz = sx, xx = sx, xy = sx, xz = sx, yy = sx, yz = sx, zz = sx;
+                for (; i + 8 <= end; i += 8) {
+                    __m256 x, y, z;
+                    points.Load(i, x, y, z);
+                    x = Sub(x, ox);
+                    y = Sub(y, oy);
+                    z = Sub(z, oz);
+                    sx = Add(sx, x);
+                    sy = Add(sy, y);
+                    sz = Add(sz, z);
+                    xx = MulAdd(x, x, xx);
+                    xy = MulAdd(x, y, xy);
+                    xz = MulAdd(x, z, xz);
+                    yy = MulAdd(y, y, yy);
+                    yz = MulAdd(y, z, yz);
+                    zz = MulAdd(z, z, zz);
+                }
+                m.sum[0] = ReduceAdd(sx);
+                m.sum[1] = ReduceAdd(sy);
+                m.sum[2] = ReduceAdd(sz);
+                m.products[0] = ReduceAdd(xx);
+                m.products[1] = ReduceAdd(xy);
+                m.products[2] = ReduceAdd(xz);
+                m.products[3] = ReduceAdd(yy);
+                m.products[4] = ReduceAdd(yz);
+                m.products[5] = ReduceAdd(zz);
+            }
+#endif
+            for (; i < end; ++i) {
+                float p[3];
+                points.Load(i, p[0], p[1], p[2]);
+                double x = p[0] - origin[0], y = p[1] - origin[1], z = p[2] - origin[2];
+                m.sum[0] += x;
+                m.sum[1] += y;
+                m.sum[2] += z;
+                m.products[0] += x * x;
+                m.products[1] += x * y;
+                m.products[2] += x * z;
+                m.products[3] += y * y;
+                m.products[4] += y * z;
+                m.products[5] += z * z;
+            }
+            return m;
+        }
+
+        // Eigenvectors (the columns of v) and eigenvalues (the diagonal left
+        // in a) of a symmetric matrix, by cyclic Jacobi rotations.
+        inline void SymmetricEigen(double a[3][3], double v[3][3])
+        {
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    v[r][c] = r == c ? 1.0 : 0.0;
+
+            for (int sweep = 0; sweep < 32; ++sweep) {
+                double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+                double diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+                if (!(off > 1e-30 * diagonal))
+                    break;
+
+                for (int p = 0; p < 2; ++p) {
+                    for (int q = p + 1; q < 3; ++q) {
+                        if (a[p][q] == 0.0)
+                            continue;
+                        // The rotation that zeroes a[p][q].
+                        double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                        double t = (theta < 0.0 ? -1.0 : 1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                        double c = 1.0 / sqrt(t * t + 1.0), s = t * c;
+                        for (int k = 0; k < 3; ++k) {
+                            double kp = a[k][p], kq = a[k][q];
+                            a[k][p] = c * kp - s * kq;
+                            a[k][q] = s * kp + c * kq;
+                        }
+                        for (int k = 0; k < 3; ++k) {
+                            double pk = a[p][k], qk = a[q][k];
+                            a[p][k] = c * pk - s * qk;
+                            a[q][k] = s * pk + c * qk;
+                        }
+                        for (int k = 0; k < 3; ++k) {
+                            double kp = v[k][p], kq = v[k][q];
+                            v[k][p] = c * kp - s * kq;
+                            v[k][q] = s * kp + c * kq;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Points in the frame of axes: x, y and z become the dot products
+        // with its rows, so the min/max reduction finds the box extents.
+        template <typename Reader>
+        struct ProjectedReader {
+            const Reader& points;
+            float axes[3][3];
+            size_t count;
+
+            void Load(size_t i, float& a, float& b, float& c) const
+            {
+                float x, y, z;
+                points.Load(i, x, y, z);
+                a = x * axes[0][0] + y * axes[0][1] + z * axes[0][2];
+                b = x * axes[1][0] + y * axes[1][1] + z * axes[1][2];
+                c = x * axes[2][0] + y * axes[2][1] + z * axes[2][2];
+            }
+
+#if USING_AVX2
+            void Load(size_t i, __m256& a, __m256& b, __m256& c) const
+            {
+                __m256 x, y, z;
+                points.Load(i, x, y, z);
+                a = MulAdd(x, _mm256_set1_ps(axes[0][0]), MulAdd(y, _mm256_set1_ps(axes[0][1]), Mul(z, _mm256_set1_ps(axes[0][2]))));
+                b = MulAdd(x, _mm256_set1_ps(axes[1][0]), MulAdd(y, _mm256_set1_ps(axes[1][1]), Mul(z, _mm256_set1_ps(axes[1][2]))));
+                c = MulAdd(x, _mm256_set1_ps(axes[2][0]), MulAdd(y, _mm256_set1_ps(axes[2][1]), Mul(z, _mm256_set1_ps(axes[2][2]))));
+            }
+#endif
+        };
+
+        template <typename Reader>
+        inline OBB PrincipalBox(const Reader& points, const BoundsOptions& options)
+        {
+            if (points.count == 0)
+                return OBB();
+
+            // Moments relative to the first point, so a cloud far from the
+            // origin keeps its precision. Each chunk has its own slot and
+            // they are added up in order, so the sum does not depend on the
+            // threads.
+            const size_t chunk = 1024;
+            float origin[3];
+            points.Load(0, origin[0], origin[1], origin[2]);
+            std::vector<PointMoments> chunks((points.count + chunk - 1) / chunk);
+            ParallelRanges(chunks.size(), options.parallelThreshold / chunk, options.threadCount, [&](size_t begin, size_t end) {
+                for (size_t c = begin; c < end; ++c)
+                    chunks[c] = ChunkMoments(points, c * chunk, std::min(points.count, (c + 1) * chunk), origin);
+            });
+            PointMoments m;
+            for (size_t c = 0; c < chunks.size(); ++c)
+                m.Merge(chunks[c]);
+
+            double n = (double)points.count, mean[3];
+            for (int k = 0; k < 3; ++k)
+                mean[k] = m.sum[k] / n;
+            const int product[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+            double covariance[3][3], v[3][3];
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    covariance[r][c] = m.products[product[r][c]] / n - mean[r] * mean[c];
+            SymmetricEigen(covariance, v);
+
+            // Largest spread first; the third axis is the cross product, so
+            // the frame is right-handed.
+            int order[3] = { 0, 1, 2 };
+            for (int a = 0; a < 3; ++a)
+                for (int b = a + 1; b < 3; ++b)
+                    if (covariance[order[b]][order[b]] > covariance[order[a]][order[a]])
+                        std::swap(order[a], order[b]);
+            Vector3D<double> x(v[0][order[0]], v[1][order[0]], v[2][order[0]]);
+            Vector3D<double> y(v[0][order[1]], v[1][order[1]], v[2][order[1]]);
+            Vector3D<double> z = x ^ y;
+            Mat3x3<float> axes((float)x.x, (float)x.y, (float)x.z, (float)y.x, (float)y.y, (float)y.z, (float)z.x, (float)z.y, (float)z.z);
+
+            ProjectedReader<Reader> projected = { points, {}, points.count };
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    projected.axes[r][c] = axes[r][c];
+            PointExtremes e = FindExtremes(projected, false, options);
+
+            // The center is rebuilt from the box-space midpoint and every
+            // point is projected again by Contains, each with its own
+            // rounding; a few ulps of the projections cover both.
+            float mid[3], extents[3];
+            for (int k = 0; k < 3; ++k) {
+                mid[k] = (e.lo[k] + e.hi[k]) * 0.5f;
+                extents[k] = (e.hi[k] - e.lo[k]) * 0.5f + (fabsf(e.lo[k]) + fabsf(e.hi[k])) * 4.0f * FLT_EPSILON;
+            }
+            Vector3 center(
+                mid[0] * axes[0][0] + mid[1] * axes[1][0] + mid[2] * axes[2][0],
+                mid[0] * axes[0][1] + mid[1] * axes[1][1] + mid[2] * axes[2][1],
+                mid[0] * axes[0][2] + mid[1] * axes[1][2] + mid[2] * axes[2][2]);
+            return OBB(center, axes, Vector3(extents[0], extents[1], extents[2]));
+        }
+    } // end namespace Detail
+
+    template <typename Points>
+    inline auto BoundingOrientedBox(const Points& points, const BoundsOptions& options) -> decltype(Detail::StreamReader(points), OBB())
+    {
+        return Detail::PrincipalBox(Detail::StreamReader(points), options);
+    }
+
+    inline size_t CollectOverlaps(const OBB& query, const OBBStreamView& boxes, uint32_t* hits)
+    {
+        if (query.IsEmpty())
+            return 0;
+        return Detail::SelectIndices(Detail::OBBOverlapScore(query, boxes), boxes.count, hits);
+    }
+
+    inline size_t CollectOverlaps(const OBB& query, const AABBStreamView& boxes, uint32_t* hits)
+    {
+        if (query.IsEmpty())
+            return 0;
+        return Detail::SelectIndices(Detail::OBBBoxScore(query, boxes), boxes.count, hits);
+    }
+} // end namespace Math
+} // end namespace Oblivion
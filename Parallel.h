@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace Oblivion {
+namespace Math {
+    // Threading of the batch operations that take options derived from
+    // this: inputs with at least parallelThreshold elements are split over
+    // up to threadCount threads (0: one per hardware thread), smaller ones
+    // stay on the calling thread.
+    struct ParallelOptions {
+        size_t parallelThreshold;
+        unsigned threadCount;
+
+        explicit ParallelOptions(size_t parallelThreshold, unsigned threadCount = 0)
+            : parallelThreshold(parallelThreshold)
+            , threadCount(threadCount)
+        {
+        }
+    };
+
+    namespace Detail {
+        // The number of threads ParallelOptions asks for on count elements.
+        inline unsigned ThreadCount(size_t count, size_t parallelThreshold, unsigned threadCount)
+        {
+            // hardware_concurrency can cost microseconds; small inputs skip it.
+            if (count < parallelThreshold)
+                return 1;
+            return threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // fn(begin, end) over [0, count) in pieces that are multiples of
+        // eight, on the calling thread and up to ThreadCount - 1 more.
+        template <typename Fn>
+        inline void ParallelRanges(size_t count, size_t parallelThreshold, unsigned threadCount, Fn fn)
+        {
+            unsigned threads = ThreadCount(count, parallelThreshold, threadCount);
+            if (threads <= 1) {
+                fn((size_t)0, count);
+                return;
+            }
+
+            size_t step = ((count + threads - 1) / threads + 7) & ~(size_t)7;
+            std::vector<std::thread> workers;
+            for (size_t begin = step; begin < count; begin += step)
+                workers.push_back(std::thread(fn, begin, std::min(count, begin + step)));
+            fn((size_t)0, std::min(count, step));
+            for (size_t t = 0; t < workers.size(); ++t)
+                workers[t].join();
+        }
+    } // end namespace Detail
+} // end namespace Math
+} // end namespace Oblivion
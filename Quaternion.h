@@ -1,9 +1,31 @@
 #pragma once
 
+#include <assert.h>
+
+#include "Mat3x3.h"
+#include "MathFunctions.h"
 #include "Mappings.h"
 
 namespace Oblivion {
 namespace Math {
+    namespace Detail {
+        // Scalar trig for T = float or double: float goes through the
+        // library's own functions, double through libm so it keeps its
+        // precision.
+        inline float ScalarSin(float angle) { return Sin(angle); }
+        inline double ScalarSin(double angle) { return sin(angle); }
+        inline void ScalarSinCos(float angle, float& s, float& c) { SinCos(angle, s, c); }
+        inline void ScalarSinCos(double angle, double& s, double& c)
+        {
+            s = sin(angle);
+            c = cos(angle);
+        }
+        inline float ScalarACos(float x) { return ACos(x); }
+        inline double ScalarACos(double x) { return acos(x); }
+        inline float ScalarATan2(float y, float x) { return ATan2(y, x); }
+        inline double ScalarATan2(double y, double x) { return atan2(y, x); }
+    } // end namespace Detail
+
     template <typename T>
     class Quaternion {
     public:
@@ -15,11 +37,11 @@ namespace Math {
 		**********************************************************************/
 
         Quaternion()
-            : w(0.0f)
+            : w(T(0))
         {
         }
 
-        Quaternion(const float& w, const Vector3D<T>& v)
+        Quaternion(const T& w, const Vector3D<T>& v)
             : w(w)
             , v(v)
         {
@@ -43,8 +65,8 @@ namespace Math {
 
         inline Quaternion& SetIdentity()
         {
-            w = 1.0f;
-            v.x = v.y = v.z = 0.0f;
+            w = T(1);
+            v.x = v.y = v.z = T(0);
             return *this;
         }
 
@@ -87,7 +109,7 @@ namespace Math {
                     w * q2.v.z + v.z * q2.w + v.x * q2.v.y - v.y * q2.v.x));
         }
 
-        inline Quaternion operator*(const float& scalar) const
+        inline Quaternion operator*(const T& scalar) const
         {
             return Quaternion(w * scalar, v * scalar);
         }
@@ -104,31 +126,29 @@ namespace Math {
 
         inline T Magnitude() const
         {
-            return sqrt(w * w) + v.Magnitude();
+            return sqrt(w * w + v.x * v.x + v.y * v.y + v.z * v.z);
         }
 
-        // Can be further optimized
+        // This quaternion scaled to unit length; a zero quaternion asserts
+        // and gives the identity.
         inline Quaternion Normalize() const
         {
             T magnitude = Magnitude();
 
-            if (magnitude > 0.0f) {
-                T inverseMag = 1.0f / Magnitude();
-                return Quaternion(this * inverseMag);
-            } else {
-                assert(false);
-                SetIdentity();
-            }
+            if (magnitude > T(0))
+                return *this * (T(1) / magnitude);
+            assert(false);
+            return Quaternion().SetIdentity();
         }
 
-        // Can be further optimized
+        // conjugate / |q|^2, so non-unit quaternions invert too.
         inline Quaternion Inverse() const
         {
             Quaternion conjugate(w, Vector3D<T>(-(v.x), -(v.y), -(v.z)));
 
-            T inverseMag = 1.0f / Magnitude();
+            T inverseMagSquared = T(1) / DotProduct(*this, *this);
 
-            return Quaternion(conjugate * inverseMag);
+            return Quaternion(conjugate * inverseMagSquared);
         }
 
         inline Quaternion& Conjugated()
@@ -139,21 +159,60 @@ namespace Math {
             return *this;
         }
 
+        // v rotated by this unit quaternion, q * (0, v) * conjugate(q),
+        // expanded to two cross products: v + w * t + u x t, t = 2 * (u x v).
+        inline Vector3D<T> Rotate(const Vector3D<T>& p) const
+        {
+            Vector3D<T> t = (v ^ p) * T(2);
+            return p + t * w + (v ^ t);
+        }
+
+        // The rotation matrix of this unit quaternion for row vectors, so
+        // p * ToMat3x3() == Rotate(p). ToMatrix44 adds no translation.
+        inline Mat3x3<T> ToMat3x3() const
+        {
+            T xx = v.x * v.x, yy = v.y * v.y, zz = v.z * v.z;
+            T xy = v.x * v.y, xz = v.x * v.z, yz = v.y * v.z;
+            T wx = w * v.x, wy = w * v.y, wz = w * v.z;
+            return Mat3x3<T>(
+                T(1) - T(2) * (yy + zz), T(2) * (xy + wz), T(2) * (xz - wy),
+                T(2) * (xy - wz), T(1) - T(2) * (xx + zz), T(2) * (yz + wx),
+                T(2) * (xz + wy), T(2) * (yz - wx), T(1) - T(2) * (xx + yy));
+        }
+
+        inline Matrix44 ToMatrix44() const
+        {
+            Mat3x3<T> r = ToMat3x3();
+            return Matrix44(
+                float(r[0][0]), float(r[0][1]), float(r[0][2]), 0.0f,
+                float(r[1][0]), float(r[1][1]), float(r[1][2]), 0.0f,
+                float(r[2][0]), float(r[2][1]), float(r[2][2]), 0.0f,
+                0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        // The inverse of ToMat3x3 / ToMatrix44: the upper 3x3 of m must be a
+        // rotation, and the rest of a 4x4 matrix is ignored.
+        static Quaternion FromMatrix(const Mat3x3<T>& m) { return FromRotation(m); }
+        static Quaternion FromMatrix(const Mat4x4<T>& m) { return FromRotation(m); }
+        static Quaternion FromMatrix(const Matrix44& m) { return FromRotation(m); }
+
         inline T DotProduct(const Quaternion& q1, const Quaternion& q2) const
         {
             return q1.w * q2.w + q1.v.x * q2.v.x + q1.v.y * q2.v.y + q1.v.z * q2.v.z;
         }
 
-        inline Quaternion& Exp(const float scalar) const
+        inline Quaternion Exp(const T scalar) const
         {
-            if (fabs(w) < .9999f) {
-                float alpha = ACos(w);
-                float newAlpha = scalar * alpha;
-                float mult = Sin(newAlpha) / Sin(alpha);
+            if (fabs(w) < T(0.9999)) {
+                T alpha = Detail::ScalarACos(w);
+                T newAlpha = scalar * alpha;
+                T sinNew, cosNew;
+                Detail::ScalarSinCos(newAlpha, sinNew, cosNew);
+                T mult = sinNew / Detail::ScalarSin(alpha);
 
                 Quaternion result;
 
-                result.w = Cos(newAlpha);
+                result.w = cosNew;
                 result.v.x = v.x * mult;
                 result.v.y = v.y * mult;
                 result.v.z = v.z * mult;
@@ -164,53 +223,66 @@ namespace Math {
             return *this;
         }
 
-        inline Quaternion& Slerp(const Quaternion& q1, float t) const
+        // Scalar reference; SlerpMany in QuaternionStream.h blends whole arrays.
+        inline Quaternion Slerp(const Quaternion& q1, T t) const
         {
             // If interpolation parameter is out of bounds, return edge points.
-            if (t <= 0.0f)
+            if (t <= T(0))
                 return *this;
-            if (t >= 1.0f)
+            if (t >= T(1))
                 return q1;
 
-            float cosAngle = DotProduct(*this, q1);
+            // Take the shorter arc.
+            Quaternion target = q1;
+            T cosAngle = DotProduct(*this, q1);
 
-            if (cosAngle < 0.0f) {
-                q1.w = -q1.w;
-                q1.v.x = -q1.v.x;
-                q1.v.y = -q1.v.y;
-                q1.v.z = -q1.v.z;
+            if (cosAngle < T(0)) {
+                target.w = -target.w;
+                target.v.x = -target.v.x;
+                target.v.y = -target.v.y;
+                target.v.z = -target.v.z;
                 cosAngle = -cosAngle;
             }
 
-            float k0, k1 = 0.0f;
-            if (cosAngle > 0.9999f) {
-                k0 = 1.0f - t;
+            T k0, k1 = T(0);
+            if (cosAngle > T(0.9999)) {
+                k0 = T(1) - t;
                 k1 = t;
             } else {
-                float sinAngle = sqrt(1.0f - cosAngle * cosAngle);
-                float angle = atan2(sinAngle, cosAngle);
-                float invSinAngle = 1.0f / sinAngle;
+                T sinAngle = sqrt(T(1) - cosAngle * cosAngle);
+                T angle = Detail::ScalarATan2(sinAngle, cosAngle);
+                T invSinAngle = T(1) / sinAngle;
 
-                k0 = Sin((1.0f - t) * angle) * invSinAngle;
-                k1 = Sin(t * angle) * invSinAngle;
+                k0 = Detail::ScalarSin((T(1) - t) * angle) * invSinAngle;
+                k1 = Detail::ScalarSin(t * angle) * invSinAngle;
             }
 
             // Interpolate
             Quaternion result;
-            result.w = w * k0 + q1.w * k1;
-            result.v.x = v.x * k0 + q1.v.x * k1;
-            result.v.y = v.y * k0 + q1.v.y * k1;
-            result.v.z = v.z * k0 + q1.v.z * k1;
+            result.w = w * k0 + target.w * k1;
+            result.v.x = v.x * k0 + target.v.x * k1;
+            result.v.y = v.y * k0 + target.v.y * k1;
+            result.v.z = v.z * k0 + target.v.z * k1;
 
             return result;
         }
 
         inline Quaternion FromMatToQuat(const Mat4x4<T>& m)
         {
-            T wAbsVal = m[0][0] + m[1][1] + m[2][2];
-            T xAbsVal = m[0][0] - m[1][1] - m[2][2];
-            T yAbsVal = -m[0][0] + m[1][1] - m[2][2];
-            T zAbsVal = -m[0][0] - m[1][1] + m[2][2];
+            return FromMatrix(m);
+        }
+
+    private:
+        // Solves for the component of largest magnitude first, from the
+        // diagonal, and the others from the off-diagonal sums and
+        // differences divided by it.
+        template <typename M>
+        static Quaternion FromRotation(const M& m)
+        {
+            T wAbsVal = T(m[0][0]) + T(m[1][1]) + T(m[2][2]);
+            T xAbsVal = T(m[0][0]) - T(m[1][1]) - T(m[2][2]);
+            T yAbsVal = -T(m[0][0]) + T(m[1][1]) - T(m[2][2]);
+            T zAbsVal = -T(m[0][0]) - T(m[1][1]) + T(m[2][2]);
 
             int biggestComp = 0;
             T biggestAbsVal = wAbsVal;
@@ -227,35 +299,35 @@ namespace Math {
                 biggestComp = 3;
             }
 
-            T biggestVal = sqrt(biggestAbsVal + 1.0f) * 0.5f;
-            T multComp = 0.25f / biggestVal;
+            T biggestVal = sqrt(biggestAbsVal + T(1)) * T(0.5);
+            T multComp = T(0.25) / biggestVal;
 
             Quaternion result;
 
             switch (biggestComp) {
             case 0:
                 result.w = biggestVal;
-                result.v.x = m[1][2] - m[2][1] * multComp;
-                result.v.y = m[2][0] - m[0][2] * multComp;
-                result.v.z = m[0][1] - m[1][0] * multComp;
+                result.v.x = (T(m[1][2]) - T(m[2][1])) * multComp;
+                result.v.y = (T(m[2][0]) - T(m[0][2])) * multComp;
+                result.v.z = (T(m[0][1]) - T(m[1][0])) * multComp;
                 break;
             case 1:
                 result.v.x = biggestVal;
-                result.w = m[1][2] - m[2][1] * multComp;
-                result.v.y = m[0][1] + m[1][0] * multComp;
-                result.v.z = m[2][0] + m[0][2] * multComp;
+                result.w = (T(m[1][2]) - T(m[2][1])) * multComp;
+                result.v.y = (T(m[0][1]) + T(m[1][0])) * multComp;
+                result.v.z = (T(m[2][0]) + T(m[0][2])) * multComp;
                 break;
             case 2:
                 result.v.y = biggestVal;
-                result.w = m[2][0] - m[0][2] * multComp;
-                result.v.x = m[0][1] + m[1][0] * multComp;
-                result.v.z = m[1][2] + m[2][1] * multComp;
+                result.w = (T(m[2][0]) - T(m[0][2])) * multComp;
+                result.v.x = (T(m[0][1]) + T(m[1][0])) * multComp;
+                result.v.z = (T(m[1][2]) + T(m[2][1])) * multComp;
                 break;
             case 3:
                 result.v.z = biggestVal;
-                result.w = m[0][1] - m[1][0] * multComp;
-                result.v.x = m[2][0] + m[0][2] * multComp;
-                result.v.y = m[1][2] + m[2][1] * multComp;
+                result.w = (T(m[0][1]) - T(m[1][0])) * multComp;
+                result.v.x = (T(m[2][0]) + T(m[0][2])) * multComp;
+                result.v.y = (T(m[1][2]) + T(m[2][1])) * multComp;
                 break;
             }
 
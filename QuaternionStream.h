@@ -0,0 +1,756 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "Quaternion.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // Non-owning view of four component arrays.
+    struct QuaternionStreamView {
+        const float* w;
+        const float* x;
+        const float* y;
+        const float* z;
+        size_t count;
+
+        QuaternionStreamView(const float* w, const float* x, const float* y, const float* z, size_t count)
+            : w(w)
+            , x(x)
+            , y(y)
+            , z(z)
+            , count(count)
+        {
+        }
+    };
+
+    // Structure-of-arrays Quaternion<float> container, laid out like
+    // Vector3Stream: one 32-byte aligned block per component, padded to a
+    // multiple of BlockSize.
+    class QuaternionStream {
+    public:
+        static const size_t BlockSize = 8;
+        static const size_t Alignment = 32;
+
+        QuaternionStream();
+        explicit QuaternionStream(size_t count);
+        QuaternionStream(const Quaternion<float>* q, size_t count);
+        QuaternionStream(const QuaternionStream& s);
+        QuaternionStream(QuaternionStream&& s);
+        ~QuaternionStream();
+
+        QuaternionStream& operator=(const QuaternionStream& s);
+        QuaternionStream& operator=(QuaternionStream&& s);
+
+        size_t Size() const { return count; }
+        float* W() { return data; }
+        float* X() { return data + capacity; }
+        float* Y() { return data + 2 * capacity; }
+        float* Z() { return data + 3 * capacity; }
+        const float* W() const { return data; }
+        const float* X() const { return data + capacity; }
+        const float* Y() const { return data + 2 * capacity; }
+        const float* Z() const { return data + 3 * capacity; }
+
+        Quaternion<float> Get(size_t i) const;
+        void Set(size_t i, const Quaternion<float>& q);
+
+        // Preserves the first min(Size(), count) elements; new elements are zero.
+        void Resize(size_t count);
+        void Assign(const Quaternion<float>* q, size_t count);
+        void CopyTo(Quaternion<float>* out) const;
+
+        operator QuaternionStreamView() const { return QuaternionStreamView(W(), X(), Y(), Z(), count); }
+
+    private:
+        float* data;
+        size_t count;
+        size_t capacity;
+    };
+
+    typedef QuaternionStream QuaternionSoA;
+
+    // Accuracy tiers for SlerpMany, as the maximum absolute error per
+    // component for unit inputs:
+    //   Precise - polynomial acos and sin, below 1e-6.
+    //   Fast    - no trigonometry or division: the sin(t * angle) / sin(angle)
+    //             weights are a truncated series in cos(angle), about 1.2e-5.
+    enum class SlerpPrecision {
+        Precise,
+        Fast
+    };
+
+    /********************************************************************
+    // BATCH INTERPOLATION
+    //
+    // out[i] = Slerp/Nlerp(a[i], b[i], t[i]), taking the shorter arc as
+    // Quaternion<T>::Slerp does and clamping t to [0, 1]. t is either one
+    // value per element or a single value for all of them. Inputs must
+    // have equal counts; out is resized to fit and may be one of them.
+    ********************************************************************/
+    void SlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, const float* t, QuaternionStream& out, SlerpPrecision precision = SlerpPrecision::Precise);
+    void SlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, float t, QuaternionStream& out, SlerpPrecision precision = SlerpPrecision::Precise);
+    void NlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, const float* t, QuaternionStream& out);
+    void NlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, float t, QuaternionStream& out);
+
+    /********************************************************************
+    // BATCH ROTATION AND MATRIX CONVERSION
+    //
+    // Quaternion<T>::Rotate, ToMatrix44, ToMat3x3 and FromMatrix over
+    // arrays, eight (or four) elements at a time: out[i] is the result for
+    // element i. Quaternions must be unit length and matrices rotations;
+    // the translation row and last column of a Matrix44 input are
+    // ignored. Stream outputs are resized to fit.
+    ********************************************************************/
+    void RotateMany(const QuaternionStreamView& q, const Vector3StreamView& v, Vector3Stream& out);
+    void ToMatrix44Many(const QuaternionStreamView& q, Matrix44* out);
+    void ToMat3x3Many(const QuaternionStreamView& q, Mat3x3<float>* out);
+    void FromMatrixMany(const Matrix44* m, size_t count, QuaternionStream& out);
+    void FromMatrixMany(const Mat3x3<float>* m, size_t count, QuaternionStream& out);
+
+    namespace Detail {
+        // sin(x) for |x| <= pi / 2 (Taylor series to x^11, error below 6e-8).
+        template <typename F>
+        F SinPolynomial(F x)
+        {
+            F x2 = Mul(x, x);
+            F p = MulAdd(x2, Broadcast(-2.5052108e-8f, x), Broadcast(2.7557319e-6f, x));
+            p = MulAdd(x2, p, Broadcast(-1.9841270e-4f, x));
+            p = MulAdd(x2, p, Broadcast(8.3333333e-3f, x));
+            p = MulAdd(x2, p, Broadcast(-1.6666667e-1f, x));
+            return MulAdd(Mul(x, x2), p, x);
+        }
+
+        // acos(x) for 0 <= x <= 1 (Cephes asinf polynomial; above 0.5 it is
+        // evaluated at sqrt((1 - x) / 2) to keep the argument small).
+        template <typename F>
+        F ACosPolynomial(F x)
+        {
+            F half = Broadcast(0.5f, x);
+            auto upper = LessThan(half, x);
+            F z = Select(upper, Mul(half, Sub(Broadcast(1.0f, x), x)), Mul(x, x));
+            F s = Select(upper, Sqrt(z), x);
+
+            F p = MulAdd(z, Broadcast(4.2163199048e-2f, x), Broadcast(2.4181311049e-2f, x));
+            p = MulAdd(z, p, Broadcast(4.5470025998e-2f, x));
+            p = MulAdd(z, p, Broadcast(7.4953002686e-2f, x));
+            p = MulAdd(z, p, Broadcast(1.6666752422e-1f, x));
+            F asinS = MulAdd(Mul(s, z), p, s);
+
+            return Select(upper, Add(asinS, asinS), Sub(Broadcast(1.57079632679f, x), asinS));
+        }
+
+        // sin(t * angle) / sin(angle) as a series in (cos(angle) - 1):
+        // t * (1 + b1 * (1 + b2 * (...))), bi = (u_i t^2 - v_i) (cos - 1) with
+        // u_i = 1 / (i (2i + 1)) and v_i = i / (2i + 1). The last pair is
+        // scaled by 1 + mu (mu = 0.8659, fitted) to make up for the truncated
+        // terms; nine terms keep the error below 8.3e-6 for cos in [0, 1].
+        template <typename F>
+        F SlerpSeries(F t, F cosMinusOne)
+        {
+            static const int Terms = 9;
+            static const float U[Terms] = {
+                3.333333333e-01f, 1.000000000e-01f, 4.761904762e-02f,
+                2.777777778e-02f, 1.818181818e-02f, 1.282051282e-02f,
+                9.523809524e-03f, 7.352941176e-03f, 1.091169591e-02f
+            };
+            static const float V[Terms] = {
+                3.333333333e-01f, 4.000000000e-01f, 4.285714286e-01f,
+                4.444444444e-01f, 4.545454545e-01f, 4.615384615e-01f,
+                4.666666667e-01f, 4.705882353e-01f, 8.838473684e-01f
+            };
+
+            F one = Broadcast(1.0f, t);
+            F t2 = Mul(t, t);
+            F acc = one;
+            for (int i = Terms - 1; i >= 0; --i) {
+                F b = Mul(MulAdd(t2, Broadcast(U[i], t), Broadcast(-V[i], t)), cosMinusOne);
+                acc = MulAdd(b, acc, one);
+            }
+            return Mul(t, acc);
+        }
+
+        // Interpolation weights for the near and far quaternion, given the
+        // (non-negative) cosine of the angle between them.
+        struct SlerpPreciseWeights {
+            static const bool Normalize = false;
+
+            template <typename F>
+            void operator()(F cosAngle, F t, F& k0, F& k1) const
+            {
+                F one = Broadcast(1.0f, t);
+                F s = Sub(one, t);
+                F angle = ACosPolynomial(Min(cosAngle, one));
+
+                // Below ~1e-3 rad the weights are t and 1 - t to float precision.
+                auto tiny = LessThan(angle, Broadcast(1e-3f, t));
+                F invSin = Div(one, Select(tiny, one, SinPolynomial(angle)));
+                k0 = Select(tiny, s, Mul(SinPolynomial(Mul(s, angle)), invSin));
+                k1 = Select(tiny, t, Mul(SinPolynomial(Mul(t, angle)), invSin));
+            }
+        };
+
+        struct SlerpFastWeights {
+            static const bool Normalize = false;
+
+            template <typename F>
+            void operator()(F cosAngle, F t, F& k0, F& k1) const
+            {
+                F cosMinusOne = Sub(Min(cosAngle, Broadcast(1.0f, t)), Broadcast(1.0f, t));
+                k0 = SlerpSeries(Sub(Broadcast(1.0f, t), t), cosMinusOne);
+                k1 = SlerpSeries(t, cosMinusOne);
+            }
+        };
+
+        struct NlerpWeights {
+            static const bool Normalize = true;
+
+            template <typename F>
+            void operator()(F, F t, F& k0, F& k1) const
+            {
+                k0 = Sub(Broadcast(1.0f, t), t);
+                k1 = t;
+            }
+        };
+
+        struct PerElementT {
+            const float* t;
+
+            float Load(size_t i, float) const { return t[i]; }
+#if USING_SSE
+            __m128 Load(size_t i, __m128) const { return _mm_loadu_ps(t + i); }
+#endif
+#if USING_AVX2
+            __m256 Load(size_t i, __m256) const { return _mm256_loadu_ps(t + i); }
+#endif
+        };
+
+        struct UniformT {
+            float t;
+
+            float Load(size_t, float) const { return t; }
+#if USING_SSE
+            __m128 Load(size_t, __m128) const { return _mm_set1_ps(t); }
+#endif
+#if USING_AVX2
+            __m256 Load(size_t, __m256) const { return _mm256_set1_ps(t); }
+#endif
+        };
+
+        // r = blend of element(s) i of a and b, one lane type at a time.
+        template <typename F, typename TSource, typename Weights>
+        void BlendLanes(const QuaternionStreamView& a, const QuaternionStreamView& b, const TSource& ts, size_t i, F* r, Weights weights)
+        {
+            F aw = LoadLanes(a.w + i, r[0]), ax = LoadLanes(a.x + i, r[0]), ay = LoadLanes(a.y + i, r[0]), az = LoadLanes(a.z + i, r[0]);
+            F bw = LoadLanes(b.w + i, r[0]), bx = LoadLanes(b.x + i, r[0]), by = LoadLanes(b.y + i, r[0]), bz = LoadLanes(b.z + i, r[0]);
+            F zero = Broadcast(0.0f, aw);
+            F t = Min(Max(ts.Load(i, zero), zero), Broadcast(1.0f, aw));
+
+            // Take the shorter arc by flipping b where the dot product is negative.
+            F d = MulAdd(aw, bw, MulAdd(ax, bx, MulAdd(ay, by, Mul(az, bz))));
+            F sign = SignOf(d);
+            bw = FlipSign(bw, sign);
+            bx = FlipSign(bx, sign);
+            by = FlipSign(by, sign);
+            bz = FlipSign(bz, sign);
+
+            F k0, k1;
+            weights(Abs(d), t, k0, k1);
+
+            r[0] = MulAdd(aw, k0, Mul(bw, k1));
+            r[1] = MulAdd(ax, k0, Mul(bx, k1));
+            r[2] = MulAdd(ay, k0, Mul(by, k1));
+            r[3] = MulAdd(az, k0, Mul(bz, k1));
+
+            if (Weights::Normalize) {
+                F len = Sqrt(MulAdd(r[0], r[0], MulAdd(r[1], r[1], MulAdd(r[2], r[2], Mul(r[3], r[3])))));
+                for (int c = 0; c < 4; ++c)
+                    r[c] = DivideIfPositive(r[c], len);
+            }
+        }
+
+        template <typename TSource, typename Weights>
+        struct BlendKernel {
+            const QuaternionStreamView& a;
+            const QuaternionStreamView& b;
+            const TSource& ts;
+            Weights weights;
+            float* o[4];
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F r[4] = { lanes, lanes, lanes, lanes };
+                BlendLanes(a, b, ts, i, r, weights);
+                for (int c = 0; c < 4; ++c)
+                    StoreLanes(o[c] + i, r[c]);
+            }
+        };
+
+        template <typename TSource, typename Weights>
+        void Blend(const QuaternionStreamView& a, const QuaternionStreamView& b, const TSource& ts, QuaternionStream& out, Weights weights)
+        {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            BlendKernel<TSource, Weights> kernel = { a, b, ts, weights, { out.W(), out.X(), out.Y(), out.Z() } };
+            ForEachLanes(a.count, kernel);
+        }
+
+        static_assert(sizeof(Mat3x3<float>) == 9 * sizeof(float), "The batch kernels read a Mat3x3 as nine packed floats");
+
+        // Row-major rotation matrix r[3 * row + column] of unit q, as in
+        // Quaternion<T>::ToMat3x3.
+        template <typename F>
+        inline void RotationLanes(F w, F x, F y, F z, F* r)
+        {
+            F one = Broadcast(1.0f, w), two = Broadcast(2.0f, w);
+            F x2 = Mul(x, two), y2 = Mul(y, two), z2 = Mul(z, two);
+            F xx = Mul(x, x2), yy = Mul(y, y2), zz = Mul(z, z2);
+            F xy = Mul(x, y2), xz = Mul(x, z2), yz = Mul(y, z2);
+            F wx = Mul(w, x2), wy = Mul(w, y2), wz = Mul(w, z2);
+            r[0] = Sub(one, Add(yy, zz));
+            r[1] = Add(xy, wz);
+            r[2] = Sub(xz, wy);
+            r[3] = Sub(xy, wz);
+            r[4] = Sub(one, Add(xx, zz));
+            r[5] = Add(yz, wx);
+            r[6] = Add(xz, wy);
+            r[7] = Sub(yz, wx);
+            r[8] = Sub(one, Add(xx, yy));
+        }
+
+        // Where diagonal > big, replaces big and the row q.
+        template <typename F>
+        inline void SelectLargest(F diagonal, F w, F x, F y, F z, F& big, F* q)
+        {
+            auto pick = LessThan(big, diagonal);
+            big = Select(pick, diagonal, big);
+            q[0] = Select(pick, w, q[0]);
+            q[1] = Select(pick, x, q[1]);
+            q[2] = Select(pick, y, q[2]);
+            q[3] = Select(pick, z, q[3]);
+        }
+
+        // The inverse of RotationLanes without branches. 4 * c * c' is a
+        // sum or difference of two entries of r for every pair of
+        // components c, c', and the trace gives 4 * c * c - 1. The row of
+        // products for the largest c is picked per lane and scaled by
+        // 1 / (4 * |c|).
+        template <typename F>
+        inline void QuaternionLanes(const F* r, F* q)
+        {
+            F one = Broadcast(1.0f, r[0]);
+            F wx = Sub(r[5], r[7]), wy = Sub(r[6], r[2]), wz = Sub(r[1], r[3]);
+            F xy = Add(r[1], r[3]), xz = Add(r[6], r[2]), yz = Add(r[5], r[7]);
+            F ww = Add(one, Add(r[0], Add(r[4], r[8])));
+            F xx = Add(one, Sub(r[0], Add(r[4], r[8])));
+            F yy = Add(one, Sub(r[4], Add(r[0], r[8])));
+            F zz = Add(one, Sub(r[8], Add(r[0], r[4])));
+
+            F big = ww;
+            q[0] = ww;
+            q[1] = wx;
+            q[2] = wy;
+            q[3] = wz;
+            SelectLargest(xx, wx, xx, xy, xz, big, q);
+            SelectLargest(yy, wy, xy, yy, yz, big, q);
+            SelectLargest(zz, wz, xz, yz, zz, big, q);
+
+            F scale = Div(Broadcast(0.5f, big), Sqrt(big));
+            for (int c = 0; c < 4; ++c)
+                q[c] = Mul(q[c], scale);
+        }
+
+        // The rotation part of one matrix per lane in and out, row-major.
+        inline void StoreRotation(Matrix44* out, const float* r)
+        {
+            *out = Matrix44(r[0], r[1], r[2], 0.0f, r[3], r[4], r[5], 0.0f, r[6], r[7], r[8], 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+        }
+
+        inline void StoreRotation(Mat3x3<float>* out, const float* r)
+        {
+            *out = Mat3x3<float>(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8]);
+        }
+
+        inline void LoadRotation(const Matrix44* m, float* r)
+        {
+            for (int k = 0; k < 9; ++k)
+                r[k] = m->m[k / 3][k % 3];
+        }
+
+        inline void LoadRotation(const Mat3x3<float>* m, float* r)
+        {
+            for (int k = 0; k < 9; ++k)
+                r[k] = m->m[k / 3][k % 3];
+        }
+
+#if USING_SSE
+        // Four matrices: one 4x4 transpose per row (Matrix44), or per run
+        // of four of the nine packed floats (Mat3x3).
+        inline void StoreRotation(Matrix44* out, const __m128* r)
+        {
+            __m128 zero = _mm_setzero_ps();
+            for (int row = 0; row < 3; ++row) {
+                __m128 c0 = r[3 * row], c1 = r[3 * row + 1], c2 = r[3 * row + 2], c3 = zero;
+                _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                _mm_store_ps(out[0].m[row], c0);
+                _mm_store_ps(out[1].m[row], c1);
+                _mm_store_ps(out[2].m[row], c2);
+                _mm_store_ps(out[3].m[row], c3);
+            }
+            for (int k = 0; k < 4; ++k)
+                _mm_store_ps(out[k].m[3], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+        }
+
+        inline void StoreRotation(Mat3x3<float>* out, const __m128* r)
+        {
+            __m128 a0 = r[0], a1 = r[1], a2 = r[2], a3 = r[3];
+            __m128 b0 = r[4], b1 = r[5], b2 = r[6], b3 = r[7];
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+            __m128 a[4] = { a0, a1, a2, a3 }, b[4] = { b0, b1, b2, b3 };
+            float last[4];
+            _mm_storeu_ps(last, r[8]);
+            for (int k = 0; k < 4; ++k) {
+                float* p = &out[k].m[0][0];
+                _mm_storeu_ps(p, a[k]);
+                _mm_storeu_ps(p + 4, b[k]);
+                p[8] = last[k];
+            }
+        }
+
+        inline void LoadRotation(const Matrix44* m, __m128* r)
+        {
+            for (int row = 0; row < 3; ++row) {
+                __m128 c0 = _mm_load_ps(m[0].m[row]), c1 = _mm_load_ps(m[1].m[row]), c2 = _mm_load_ps(m[2].m[row]), c3 = _mm_load_ps(m[3].m[row]);
+                _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+                r[3 * row] = c0;
+                r[3 * row + 1] = c1;
+                r[3 * row + 2] = c2;
+            }
+        }
+
+        inline void LoadRotation(const Mat3x3<float>* m, __m128* r)
+        {
+            __m128 a0 = _mm_loadu_ps(&m[0].m[0][0]), a1 = _mm_loadu_ps(&m[1].m[0][0]), a2 = _mm_loadu_ps(&m[2].m[0][0]), a3 = _mm_loadu_ps(&m[3].m[0][0]);
+            __m128 b0 = _mm_loadu_ps(&m[0].m[1][1]), b1 = _mm_loadu_ps(&m[1].m[1][1]), b2 = _mm_loadu_ps(&m[2].m[1][1]), b3 = _mm_loadu_ps(&m[3].m[1][1]);
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+            r[0] = a0, r[1] = a1, r[2] = a2, r[3] = a3;
+            r[4] = b0, r[5] = b1, r[6] = b2, r[7] = b3;
+            r[8] = _mm_setr_ps(m[0].m[2][2], m[1].m[2][2], m[2].m[2][2], m[3].m[2][2]);
+        }
+#endif
+
+#if USING_AVX2
+        // Eight matrices: the SSE transposes in both 128-bit lanes, the low
+        // lane holding matrices 0-3 and the high lane 4-7.
+        inline void StoreRotation(Matrix44* out, const __m256* r)
+        {
+            __m256 zero = _mm256_setzero_ps();
+            for (int row = 0; row < 3; ++row) {
+                __m256 c[4] = { r[3 * row], r[3 * row + 1], r[3 * row + 2], zero };
+                Transpose4InLanes(c[0], c[1], c[2], c[3]);
+                for (int k = 0; k < 4; ++k) {
+                    _mm_store_ps(out[k].m[row], _mm256_castps256_ps128(c[k]));
+                    _mm_store_ps(out[k + 4].m[row], _mm256_extractf128_ps(c[k], 1));
+                }
+            }
+            for (int k = 0; k < 8; ++k)
+                _mm_store_ps(out[k].m[3], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+        }
+
+        inline void StoreRotation(Mat3x3<float>* out, const __m256* r)
+        {
+            __m256 a[4] = { r[0], r[1], r[2], r[3] }, b[4] = { r[4], r[5], r[6], r[7] };
+            Transpose4InLanes(a[0], a[1], a[2], a[3]);
+            Transpose4InLanes(b[0], b[1], b[2], b[3]);
+            float last[8];
+            _mm256_storeu_ps(last, r[8]);
+            for (int k = 0; k < 4; ++k) {
+                float* low = &out[k].m[0][0];
+                float* high = &out[k + 4].m[0][0];
+                _mm_storeu_ps(low, _mm256_castps256_ps128(a[k]));
+                _mm_storeu_ps(low + 4, _mm256_castps256_ps128(b[k]));
+                _mm_storeu_ps(high, _mm256_extractf128_ps(a[k], 1));
+                _mm_storeu_ps(high + 4, _mm256_extractf128_ps(b[k], 1));
+                low[8] = last[k];
+                high[8] = last[k + 4];
+            }
+        }
+
+        inline void LoadRotation(const Matrix44* m, __m256* r)
+        {
+            for (int row = 0; row < 3; ++row) {
+                __m256 c[4];
+                for (int k = 0; k < 4; ++k)
+                    c[k] = _mm256_set_m128(_mm_load_ps(m[k + 4].m[row]), _mm_load_ps(m[k].m[row]));
+                Transpose4InLanes(c[0], c[1], c[2], c[3]);
+                r[3 * row] = c[0];
+                r[3 * row + 1] = c[1];
+                r[3 * row + 2] = c[2];
+            }
+        }
+
+        inline void LoadRotation(const Mat3x3<float>* m, __m256* r)
+        {
+            __m256 a[4], b[4];
+            for (int k = 0; k < 4; ++k) {
+                a[k] = _mm256_set_m128(_mm_loadu_ps(&m[k + 4].m[0][0]), _mm_loadu_ps(&m[k].m[0][0]));
+                b[k] = _mm256_set_m128(_mm_loadu_ps(&m[k + 4].m[1][1]), _mm_loadu_ps(&m[k].m[1][1]));
+            }
+            Transpose4InLanes(a[0], a[1], a[2], a[3]);
+            Transpose4InLanes(b[0], b[1], b[2], b[3]);
+            for (int k = 0; k < 4; ++k) {
+                r[k] = a[k];
+                r[k + 4] = b[k];
+            }
+            r[8] = _mm256_setr_ps(m[0].m[2][2], m[1].m[2][2], m[2].m[2][2], m[3].m[2][2], m[4].m[2][2], m[5].m[2][2], m[6].m[2][2], m[7].m[2][2]);
+        }
+#endif
+
+        struct RotateKernel {
+            QuaternionStreamView q;
+            Vector3StreamView v;
+            float *x, *y, *z;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F w = LoadLanes(q.w + i, lanes), ux = LoadLanes(q.x + i, lanes), uy = LoadLanes(q.y + i, lanes), uz = LoadLanes(q.z + i, lanes);
+                F px = LoadLanes(v.x + i, lanes), py = LoadLanes(v.y + i, lanes), pz = LoadLanes(v.z + i, lanes);
+                F two = Broadcast(2.0f, lanes);
+                F tx = Mul(two, Sub(Mul(uy, pz), Mul(uz, py)));
+                F ty = Mul(two, Sub(Mul(uz, px), Mul(ux, pz)));
+                F tz = Mul(two, Sub(Mul(ux, py), Mul(uy, px)));
+                StoreLanes(x + i, Add(MulAdd(w, tx, px), Sub(Mul(uy, tz), Mul(uz, ty))));
+                StoreLanes(y + i, Add(MulAdd(w, ty, py), Sub(Mul(uz, tx), Mul(ux, tz))));
+                StoreLanes(z + i, Add(MulAdd(w, tz, pz), Sub(Mul(ux, ty), Mul(uy, tx))));
+            }
+        };
+
+        template <typename M>
+        struct ToMatrixKernel {
+            QuaternionStreamView q;
+            M* out;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F r[9];
+                RotationLanes(LoadLanes(q.w + i, lanes), LoadLanes(q.x + i, lanes), LoadLanes(q.y + i, lanes), LoadLanes(q.z + i, lanes), r);
+                StoreRotation(out + i, r);
+            }
+        };
+
+        template <typename M>
+        struct FromMatrixKernel {
+            const M* m;
+            float *w, *x, *y, *z;
+
+            template <typename F>
+            void operator()(size_t i, F) const
+            {
+                F r[9];
+                F q[4];
+                LoadRotation(m + i, r);
+                QuaternionLanes(r, q);
+                StoreLanes(w + i, q[0]);
+                StoreLanes(x + i, q[1]);
+                StoreLanes(y + i, q[2]);
+                StoreLanes(z + i, q[3]);
+            }
+        };
+    } // end namespace Detail
+
+    inline void SlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, const float* t, QuaternionStream& out, SlerpPrecision precision)
+    {
+        Detail::PerElementT ts = { t };
+        if (precision == SlerpPrecision::Fast)
+            Detail::Blend(a, b, ts, out, Detail::SlerpFastWeights());
+        else
+            Detail::Blend(a, b, ts, out, Detail::SlerpPreciseWeights());
+    }
+
+    inline void SlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, float t, QuaternionStream& out, SlerpPrecision precision)
+    {
+        Detail::UniformT ts = { t };
+        if (precision == SlerpPrecision::Fast)
+            Detail::Blend(a, b, ts, out, Detail::SlerpFastWeights());
+        else
+            Detail::Blend(a, b, ts, out, Detail::SlerpPreciseWeights());
+    }
+
+    inline void NlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, const float* t, QuaternionStream& out)
+    {
+        Detail::PerElementT ts = { t };
+        Detail::Blend(a, b, ts, out, Detail::NlerpWeights());
+    }
+
+    inline void NlerpMany(const QuaternionStreamView& a, const QuaternionStreamView& b, float t, QuaternionStream& out)
+    {
+        Detail::UniformT ts = { t };
+        Detail::Blend(a, b, ts, out, Detail::NlerpWeights());
+    }
+
+    inline void RotateMany(const QuaternionStreamView& q, const Vector3StreamView& v, Vector3Stream& out)
+    {
+        assert(q.count == v.count);
+        out.Resize(v.count);
+        Detail::RotateKernel kernel = { q, v, out.X(), out.Y(), out.Z() };
+        Detail::ForEachLanes(q.count, kernel);
+    }
+
+    inline void ToMatrix44Many(const QuaternionStreamView& q, Matrix44* out)
+    {
+        Detail::ToMatrixKernel<Matrix44> kernel = { q, out };
+        Detail::ForEachLanes(q.count, kernel);
+    }
+
+    inline void ToMat3x3Many(const QuaternionStreamView& q, Mat3x3<float>* out)
+    {
+        Detail::ToMatrixKernel<Mat3x3<float> > kernel = { q, out };
+        Detail::ForEachLanes(q.count, kernel);
+    }
+
+    inline void FromMatrixMany(const Matrix44* m, size_t count, QuaternionStream& out)
+    {
+        out.Resize(count);
+        Detail::FromMatrixKernel<Matrix44> kernel = { m, out.W(), out.X(), out.Y(), out.Z() };
+        Detail::ForEachLanes(count, kernel);
+    }
+
+    inline void FromMatrixMany(const Mat3x3<float>* m, size_t count, QuaternionStream& out)
+    {
+        out.Resize(count);
+        Detail::FromMatrixKernel<Mat3x3<float> > kernel = { m, out.W(), out.X(), out.Y(), out.Z() };
+        Detail::ForEachLanes(count, kernel);
+    }
+
+    /********************************************************************
+    // QUATERNIONSTREAM MEMBER FUNCTIONS
+    ********************************************************************/
+    inline QuaternionStream::QuaternionStream()
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+    }
+
+    inline QuaternionStream::QuaternionStream(size_t count)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Resize(count);
+    }
+
+    inline QuaternionStream::QuaternionStream(const Quaternion<float>* q, size_t count)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Assign(q, count);
+    }
+
+    inline QuaternionStream::QuaternionStream(const QuaternionStream& s)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        *this = s;
+    }
+
+    inline QuaternionStream::QuaternionStream(QuaternionStream&& s)
+        : data(s.data)
+        , count(s.count)
+        , capacity(s.capacity)
+    {
+        s.data = NULL;
+        s.count = s.capacity = 0;
+    }
+
+    inline QuaternionStream::~QuaternionStream()
+    {
+        Detail::AlignedFree(data);
+    }
+
+    inline QuaternionStream& QuaternionStream::operator=(const QuaternionStream& s)
+    {
+        if (this != &s) {
+            Resize(s.count);
+            memcpy(W(), s.W(), sizeof(float) * count);
+            memcpy(X(), s.X(), sizeof(float) * count);
+            memcpy(Y(), s.Y(), sizeof(float) * count);
+            memcpy(Z(), s.Z(), sizeof(float) * count);
+        }
+        return *this;
+    }
+
+    inline QuaternionStream& QuaternionStream::operator=(QuaternionStream&& s)
+    {
+        if (this != &s) {
+            Detail::AlignedFree(data);
+            data = s.data;
+            count = s.count;
+            capacity = s.capacity;
+            s.data = NULL;
+            s.count = s.capacity = 0;
+        }
+        return *this;
+    }
+
+    inline Quaternion<float> QuaternionStream::Get(size_t i) const
+    {
+        return Quaternion<float>(W()[i], Vector3D<float>(X()[i], Y()[i], Z()[i]));
+    }
+
+    inline void QuaternionStream::Set(size_t i, const Quaternion<float>& q)
+    {
+        W()[i] = q.w;
+        X()[i] = q.v.x;
+        Y()[i] = q.v.y;
+        Z()[i] = q.v.z;
+    }
+
+    inline void QuaternionStream::Resize(size_t newCount)
+    {
+        if (newCount > capacity) {
+            size_t newCapacity = (newCount + BlockSize - 1) / BlockSize * BlockSize;
+            float* newData = static_cast<float*>(Detail::AlignedAlloc(sizeof(float) * 4 * newCapacity, Alignment));
+            assert(newData != NULL);
+            memset(newData, 0, sizeof(float) * 4 * newCapacity);
+
+            if (data != NULL) {
+                for (size_t c = 0; c < 4; ++c)
+                    memcpy(newData + c * newCapacity, data + c * capacity, sizeof(float) * count);
+                Detail::AlignedFree(data);
+            }
+
+            data = newData;
+            capacity = newCapacity;
+        } else if (newCount > count) {
+            for (size_t c = 0; c < 4; ++c)
+                memset(data + c * capacity + count, 0, sizeof(float) * (newCount - count));
+        }
+
+        count = newCount;
+    }
+
+    inline void QuaternionStream::Assign(const Quaternion<float>* q, size_t newCount)
+    {
+        Resize(newCount);
+        for (size_t i = 0; i < count; ++i)
+            Set(i, q[i]);
+    }
+
+    inline void QuaternionStream::CopyTo(Quaternion<float>* out) const
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = Get(i);
+    }
+} // end namespace Math
+} // end namespace Oblivion
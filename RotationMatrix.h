@@ -1,20 +1,274 @@
 #pragma once
 
-#include "Quaternion.h"
+#include <stddef.h>
+#include <string.h>
+
+#include "EulerAngle.h"
 #include "Mat3x3.h"
+#include "Quaternion.h"
+#include "QuaternionStream.h"
 
 namespace Oblivion {
 namespace Math {
+    /********************************************************************
+    // ROTATION MATRIX
+    //
+    // A 3x3 matrix that is known to be orthonormal with determinant +1,
+    // for row vectors: the rows are the object's axes in inertial space,
+    // so p * m takes an object-space point to inertial space. Knowing
+    // that lets the inverse be the transpose, inertial-to-object use three
+    // dot products instead of an inverse, and compose rebuild its third
+    // row as a cross product.
+    //
+    // Products of rotations drift from orthonormal in long integrations;
+    // Orthonormalize and OrthonormalizeMany pull them back, either with
+    // Gram-Schmidt (keeps the direction of the first row exactly) or
+    // polar Newton-Schulz steps (moves all three rows equally, to the
+    // nearest rotation).
+    ********************************************************************/
+    enum class OrthonormalizeMethod {
+        GramSchmidt,
+        Polar
+    };
+
     template <typename T>
     class RotationMatrix {
     public:
-		RotationMatrix()
+        T m[3][3];
+
+        RotationMatrix()
         {
             memset(m, 0, sizeof(m[0][0]) * 3 * 3);
-            m[0][0] = m[1][1] = m[2][2] = 1.0f;
+            m[0][0] = m[1][1] = m[2][2] = T(1);
+        }
+
+        // rotation must be orthonormal; Orthonormalize it first if it has
+        // drifted.
+        explicit RotationMatrix(const Mat3x3<T>& rotation)
+        {
+            memcpy(m, rotation.m, sizeof(m));
+        }
+
+        explicit RotationMatrix(const Quaternion<T>& q)
+            : RotationMatrix(q.ToMat3x3())
+        {
         }
 
-        
+        explicit RotationMatrix(const EulerAngles<T>& angles)
+            : RotationMatrix(angles.ToMat3x3())
+        {
+        }
+
+        const T* operator[](uint8_t i) const { return m[i]; }
+
+        Mat3x3<T> ToMat3x3() const;
+        Matrix44 ToMatrix44() const;
+        Quaternion<T> ToQuaternion() const { return Quaternion<T>::FromMatrix(ToMat3x3()); }
+
+        // The inverse of a rotation is its transpose.
+        RotationMatrix Inverse() const;
+        RotationMatrix Transpose() const { return Inverse(); }
+
+        // p * m and p * transpose(m).
+        Vector3D<T> ObjectToInertial(const Vector3D<T>& p) const;
+        Vector3D<T> InertialToObject(const Vector3D<T>& p) const;
+
+        // This rotation, then r.
+        RotationMatrix operator*(const RotationMatrix& r) const;
+
+        bool operator==(const RotationMatrix& r) const { return memcmp(m, r.m, sizeof(m)) == 0; }
+        bool operator!=(const RotationMatrix& r) const { return !(*this == r); }
+
+        RotationMatrix& Orthonormalize(OrthonormalizeMethod method = OrthonormalizeMethod::GramSchmidt);
+
+    private:
+        Vector3D<T> Row(int i) const { return Vector3D<T>(m[i][0], m[i][1], m[i][2]); }
+        void SetRows(const Vector3D<T>& x, const Vector3D<T>& y, const Vector3D<T>& z);
     };
+
+    // Batch Orthonormalize, in place. The Mat3x3 overload is for rotations
+    // kept in general matrices.
+    void OrthonormalizeMany(RotationMatrix<float>* m, size_t count, OrthonormalizeMethod method = OrthonormalizeMethod::GramSchmidt);
+    void OrthonormalizeMany(Mat3x3<float>* m, size_t count, OrthonormalizeMethod method = OrthonormalizeMethod::GramSchmidt);
+
+    template <typename T>
+    inline Mat3x3<T> RotationMatrix<T>::ToMat3x3() const
+    {
+        return Mat3x3<T>(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2]);
+    }
+
+    template <typename T>
+    inline Matrix44 RotationMatrix<T>::ToMatrix44() const
+    {
+        return Matrix44(
+            float(m[0][0]), float(m[0][1]), float(m[0][2]), 0.0f,
+            float(m[1][0]), float(m[1][1]), float(m[1][2]), 0.0f,
+            float(m[2][0]), float(m[2][1]), float(m[2][2]), 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    template <typename T>
+    inline RotationMatrix<T> RotationMatrix<T>::Inverse() const
+    {
+        RotationMatrix result;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                result.m[r][c] = m[c][r];
+        return result;
+    }
+
+    template <typename T>
+    inline Vector3D<T> RotationMatrix<T>::ObjectToInertial(const Vector3D<T>& p) const
+    {
+        return Vector3D<T>(
+            p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0],
+            p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1],
+            p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2]);
+    }
+
+    template <typename T>
+    inline Vector3D<T> RotationMatrix<T>::InertialToObject(const Vector3D<T>& p) const
+    {
+        return Vector3D<T>(p * Row(0), p * Row(1), p * Row(2));
+    }
+
+    template <typename T>
+    inline RotationMatrix<T> RotationMatrix<T>::operator*(const RotationMatrix& r) const
+    {
+        // The third row of a rotation is the cross product of the first two.
+        Vector3D<T> x = r.ObjectToInertial(Row(0)), y = r.ObjectToInertial(Row(1));
+        RotationMatrix result;
+        result.SetRows(x, y, x ^ y);
+        return result;
+    }
+
+    template <typename T>
+    inline RotationMatrix<T>& RotationMatrix<T>::Orthonormalize(OrthonormalizeMethod method)
+    {
+        Vector3D<T> x = Row(0), y = Row(1), z = Row(2);
+        if (method == OrthonormalizeMethod::GramSchmidt) {
+            x = Normalize(x);
+            y = Normalize(y - x * (x * y));
+            SetRows(x, y, x ^ y);
+            return *this;
+        }
+
+        // Newton-Schulz: m <- (3 I - m * transpose(m)) / 2 * m converges
+        // quadratically to the polar factor; two steps take a drift of
+        // 1e-2 below float precision.
+        for (int step = 0; step < 2; ++step) {
+            T xy = x * y, xz = x * z, yz = y * z;
+            T xx = T(1.5) - T(0.5) * (x * x), yy = T(1.5) - T(0.5) * (y * y), zz = T(1.5) - T(0.5) * (z * z);
+            Vector3D<T> nx = x * xx - (y * xy + z * xz) * T(0.5);
+            Vector3D<T> ny = y * yy - (x * xy + z * yz) * T(0.5);
+            z = z * zz - (x * xz + y * yz) * T(0.5);
+            x = nx;
+            y = ny;
+        }
+        SetRows(x, y, z);
+        return *this;
+    }
+
+    template <typename T>
+    inline void RotationMatrix<T>::SetRows(const Vector3D<T>& x, const Vector3D<T>& y, const Vector3D<T>& z)
+    {
+        m[0][0] = x.x;
+        m[0][1] = x.y;
+        m[0][2] = x.z;
+        m[1][0] = y.x;
+        m[1][1] = y.y;
+        m[1][2] = y.z;
+        m[2][0] = z.x;
+        m[2][1] = z.y;
+        m[2][2] = z.z;
+    }
+
+    namespace Detail {
+        static_assert(sizeof(RotationMatrix<float>) == sizeof(Mat3x3<float>), "RotationMatrix<float> must be laid out like Mat3x3<float>");
+
+        template <typename F>
+        inline F Dot3(F ax, F ay, F az, F bx, F by, F bz)
+        {
+            return MulAdd(ax, bx, MulAdd(ay, by, Mul(az, bz)));
+        }
+
+        // Scales the three entries of one row to unit length.
+        template <typename F>
+        inline void NormalizeRow(F* row)
+        {
+            F scale = Div(Broadcast(1.0f, row[0]), Sqrt(Dot3(row[0], row[1], row[2], row[0], row[1], row[2])));
+            for (int c = 0; c < 3; ++c)
+                row[c] = Mul(row[c], scale);
+        }
+
+        template <typename F>
+        inline void GramSchmidtLanes(F* r)
+        {
+            NormalizeRow(r);
+            F d = Dot3(r[0], r[1], r[2], r[3], r[4], r[5]);
+            for (int c = 0; c < 3; ++c)
+                r[3 + c] = Sub(r[3 + c], Mul(d, r[c]));
+            NormalizeRow(r + 3);
+            r[6] = Sub(Mul(r[1], r[5]), Mul(r[2], r[4]));
+            r[7] = Sub(Mul(r[2], r[3]), Mul(r[0], r[5]));
+            r[8] = Sub(Mul(r[0], r[4]), Mul(r[1], r[3]));
+        }
+
+        // One Newton-Schulz step, as in RotationMatrix::Orthonormalize.
+        template <typename F>
+        inline void PolarStepLanes(F* r)
+        {
+            F minusHalf = Broadcast(-0.5f, r[0]), threeHalves = Broadcast(1.5f, r[0]);
+            // k[3 * a + b] = 3/2 [a == b] - <row a, row b> / 2.
+            F k[9];
+            for (int a = 0; a < 3; ++a)
+                for (int b = a; b < 3; ++b)
+                    k[3 * a + b] = k[3 * b + a] = Mul(minusHalf, Dot3(r[3 * a], r[3 * a + 1], r[3 * a + 2], r[3 * b], r[3 * b + 1], r[3 * b + 2]));
+            for (int a = 0; a < 3; ++a)
+                k[4 * a] = Add(k[4 * a], threeHalves);
+
+            F result[9];
+            for (int a = 0; a < 3; ++a)
+                for (int c = 0; c < 3; ++c)
+                    result[3 * a + c] = MulAdd(k[3 * a], r[c], MulAdd(k[3 * a + 1], r[3 + c], Mul(k[3 * a + 2], r[6 + c])));
+            for (int e = 0; e < 9; ++e)
+                r[e] = result[e];
+        }
+
+        template <OrthonormalizeMethod Method>
+        struct OrthonormalizeKernel {
+            Mat3x3<float>* m;
+
+            template <typename F>
+            void operator()(size_t i, F lanes) const
+            {
+                F r[9];
+                LoadRotation(m + i, r);
+                if (Method == OrthonormalizeMethod::GramSchmidt)
+                    GramSchmidtLanes(r);
+                else {
+                    PolarStepLanes(r);
+                    PolarStepLanes(r);
+                }
+                StoreRotation(m + i, r);
+            }
+        };
+    } // end namespace Detail
+
+    inline void OrthonormalizeMany(Mat3x3<float>* m, size_t count, OrthonormalizeMethod method)
+    {
+        if (method == OrthonormalizeMethod::GramSchmidt) {
+            Detail::OrthonormalizeKernel<OrthonormalizeMethod::GramSchmidt> kernel = { m };
+            Detail::ForEachLanes(count, kernel);
+        } else {
+            Detail::OrthonormalizeKernel<OrthonormalizeMethod::Polar> kernel = { m };
+            Detail::ForEachLanes(count, kernel);
+        }
+    }
+
+    inline void OrthonormalizeMany(RotationMatrix<float>* m, size_t count, OrthonormalizeMethod method)
+    {
+        OrthonormalizeMany(reinterpret_cast<Mat3x3<float>*>(m), count, method);
+    }
 } // end namespace Math
-} // enad namespace Oblivion
+} // end namespace Oblivion
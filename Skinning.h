@@ -0,0 +1,310 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DualQuaternion.h"
+#include "MathSIMD.h"
+#include "Matrix44.h"
+#include "Parallel.h"
+#include "Transform.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // Up to four bone influences per vertex, one index and one weight array
+    // per slot. Unused slots have weight 0 and any valid index. Weights
+    // are used as given, so they should sum to 1.
+    struct SkinWeightsView {
+        const uint16_t* bones[4];
+        const float* weights[4];
+        size_t count;
+
+        SkinWeightsView(const uint16_t* const bones[4], const float* const weights[4], size_t count)
+            : count(count)
+        {
+            for (int k = 0; k < 4; ++k) {
+                this->bones[k] = bones[k];
+                this->weights[k] = weights[k];
+            }
+        }
+    };
+
+    // parallelThreshold counts vertices.
+    struct SkinningOptions : ParallelOptions {
+        SkinningOptions()
+            : ParallelOptions(16384)
+        {
+        }
+    };
+
+    /********************************************************************
+    // DUAL QUATERNION SKINNING
+    //
+    // Each vertex is moved by the blend (DLB) of its bones' dual
+    // quaternions from palette. The bones of a vertex are summed in one
+    // register per vertex, then eight (or four) blends are transposed
+    // and normalized and applied to the positions (and normals) together.
+    // Inputs must have weights.count elements; outputs are resized to fit.
+    ********************************************************************/
+    void SkinDualQuaternion(const DualQuaternion<float>* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, Vector3Stream& outPositions, const SkinningOptions& options = SkinningOptions());
+    void SkinDualQuaternion(const DualQuaternion<float>* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, const Vector3StreamView& normals, Vector3Stream& outPositions, Vector3Stream& outNormals, const SkinningOptions& options = SkinningOptions());
+
+    /********************************************************************
+    // LINEAR BLEND SKINNING
+    //
+    // Each vertex is moved by the weighted sum of its bones' matrices
+    // from palette (row vectors, translation in row 3). The blend and its
+    // application stay in registers per vertex, so nothing is transposed
+    // or spilled. Normals go through the blended 3x3 part and are not
+    // renormalized. The overload without normals skips their loads and
+    // stores.
+    ********************************************************************/
+    void SkinLinearBlend(const Matrix44* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, Vector3Stream& outPositions, const SkinningOptions& options = SkinningOptions());
+    void SkinLinearBlend(const Matrix44* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, const Vector3StreamView& normals, Vector3Stream& outPositions, Vector3Stream& outNormals, const SkinningOptions& options = SkinningOptions());
+
+    namespace Detail {
+        static_assert(sizeof(DualQuaternion<float>) == 8 * sizeof(float), "SumBones reads a DualQuaternion as eight packed floats");
+
+        // The weighted sum of the bones of vertex i as eight floats, real
+        // then dual, each bone's sign matched to the first.
+        inline void SumBones(const DualQuaternion<float>* palette, const SkinWeightsView& weights, size_t i, float* out)
+        {
+            const float* b0 = &palette[weights.bones[0][i]].real.w;
+#if USING_AVX2
+            __m256 sum = _mm256_mul_ps(_mm256_set1_ps(weights.weights[0][i]), _mm256_loadu_ps(b0));
+#elif USING_SSE
+            __m128 w0 = _mm_set1_ps(weights.weights[0][i]);
+            __m128 real = _mm_mul_ps(w0, _mm_loadu_ps(b0)), dual = _mm_mul_ps(w0, _mm_loadu_ps(b0 + 4));
+#else
+            float sum[8];
+            for (int c = 0; c < 8; ++c)
+                sum[c] = weights.weights[0][i] * b0[c];
+#endif
+            for (int k = 1; k < 4; ++k) {
+                const float* b = &palette[weights.bones[k][i]].real.w;
+                float dot = b0[0] * b[0] + b0[1] * b[1] + b0[2] * b[2] + b0[3] * b[3];
+                float w = dot < 0.0f ? -weights.weights[k][i] : weights.weights[k][i];
+#if USING_AVX2
+                sum = MulAdd(_mm256_set1_ps(w), _mm256_loadu_ps(b), sum);
+#elif USING_SSE
+                real = MulAdd(_mm_set1_ps(w), _mm_loadu_ps(b), real);
+                dual = MulAdd(_mm_set1_ps(w), _mm_loadu_ps(b + 4), dual);
+#else
+                for (int c = 0; c < 8; ++c)
+                    sum[c] += w * b[c];
+#endif
+            }
+#if USING_AVX2
+            _mm256_storeu_ps(out, sum);
+#elif USING_SSE
+            _mm_storeu_ps(out, real);
+            _mm_storeu_ps(out + 4, dual);
+#else
+            for (int c = 0; c < 8; ++c)
+                out[c] = sum[c];
+#endif
+        }
+
+        // v rotated by the quaternion (w, u) / |(w, u)|, given
+        // inverseNorm2 = 1 / |(w, u)|^2: v + 2 * (w * c + u x c) / |q|^2
+        // with c = u x v, which needs no square root.
+        template <typename F>
+        inline void RotateLanes(F w, F ux, F uy, F uz, F twoInverseNorm2, F& x, F& y, F& z)
+        {
+            F cx = Sub(Mul(uy, z), Mul(uz, y));
+            F cy = Sub(Mul(uz, x), Mul(ux, z));
+            F cz = Sub(Mul(ux, y), Mul(uy, x));
+            F ex = MulAdd(w, cx, Sub(Mul(uy, cz), Mul(uz, cy)));
+            F ey = MulAdd(w, cy, Sub(Mul(uz, cx), Mul(ux, cz)));
+            F ez = MulAdd(w, cz, Sub(Mul(ux, cy), Mul(uy, cx)));
+            x = MulAdd(twoInverseNorm2, ex, x);
+            y = MulAdd(twoInverseNorm2, ey, y);
+            z = MulAdd(twoInverseNorm2, ez, z);
+        }
+
+        // Output component arrays; the normal pointers are null when only
+        // positions are skinned.
+        struct SkinOutput {
+            float *px, *py, *pz;
+            float *nx, *ny, *nz;
+        };
+
+#if USING_SSE
+        inline void StoreXYZ(float* x, float* y, float* z, size_t i, __m128 v)
+        {
+            x[i] = _mm_cvtss_f32(v);
+            y[i] = _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+            z[i] = _mm_cvtss_f32(_mm_movehl_ps(v, v));
+        }
+#endif
+
+        struct DualQuaternionSkin {
+            const DualQuaternion<float>* palette;
+            const SkinWeightsView* weights;
+
+            // Eight (or four) vertices at a time, with a scalar tail.
+            void operator()(size_t begin, size_t end, const Vector3StreamView& positions, const Vector3StreamView* normals, const SkinOutput& out) const
+            {
+                size_t i = begin;
+#if USING_AVX2
+                for (; i + 8 <= end; i += 8)
+                    Skin(i, _mm256_setzero_ps(), positions, normals, out);
+#elif USING_SSE
+                for (; i + 4 <= end; i += 4)
+                    Skin(i, _mm_setzero_ps(), positions, normals, out);
+#endif
+                for (; i < end; ++i)
+                    Skin(i, 0.0f, positions, normals, out);
+            }
+
+            // Skins the vertices i .. i + lanes - 1.
+            template <typename F>
+            void Skin(size_t i, F lanes, const Vector3StreamView& positions, const Vector3StreamView* normals, const SkinOutput& out) const
+            {
+                const int count = (int)(sizeof(F) / sizeof(float));
+                alignas(32) float sums[8 * 8];
+                for (int j = 0; j < count; ++j)
+                    SumBones(palette, *weights, i + j, sums + 8 * j);
+                F r[8];
+                LoadTransposed(sums, r);
+
+                // Normalizing the blend divides the rotation by |real|^2 and
+                // the translation 2 * (rw * d - dw * r + r x d) by the same.
+                F twoInverseNorm2 = Div(Broadcast(2.0f, lanes), MulAdd(r[0], r[0], MulAdd(r[1], r[1], MulAdd(r[2], r[2], Mul(r[3], r[3])))));
+                F tx = Mul(twoInverseNorm2, Add(Sub(Mul(r[0], r[5]), Mul(r[4], r[1])), Sub(Mul(r[2], r[7]), Mul(r[3], r[6]))));
+                F ty = Mul(twoInverseNorm2, Add(Sub(Mul(r[0], r[6]), Mul(r[4], r[2])), Sub(Mul(r[3], r[5]), Mul(r[1], r[7]))));
+                F tz = Mul(twoInverseNorm2, Add(Sub(Mul(r[0], r[7]), Mul(r[4], r[3])), Sub(Mul(r[1], r[6]), Mul(r[2], r[5]))));
+
+                F x = LoadLanes(positions.x + i, lanes), y = LoadLanes(positions.y + i, lanes), z = LoadLanes(positions.z + i, lanes);
+                RotateLanes(r[0], r[1], r[2], r[3], twoInverseNorm2, x, y, z);
+                StoreLanes(out.px + i, Add(x, tx));
+                StoreLanes(out.py + i, Add(y, ty));
+                StoreLanes(out.pz + i, Add(z, tz));
+
+                if (normals) {
+                    x = LoadLanes(normals->x + i, lanes), y = LoadLanes(normals->y + i, lanes), z = LoadLanes(normals->z + i, lanes);
+                    RotateLanes(r[0], r[1], r[2], r[3], twoInverseNorm2, x, y, z);
+                    StoreLanes(out.nx + i, x);
+                    StoreLanes(out.ny + i, y);
+                    StoreLanes(out.nz + i, z);
+                }
+            }
+        };
+
+        // One vertex at a time: the weighted rows of its four matrices are
+        // summed in pairs (two rows per register with AVX2), which keeps the
+        // dependency chain short, and applied without leaving registers.
+        struct LinearBlendSkin {
+            const Matrix44* palette;
+            const SkinWeightsView* weights;
+
+            void operator()(size_t begin, size_t end, const Vector3StreamView& positions, const Vector3StreamView* normals, const SkinOutput& out) const
+            {
+                for (size_t i = begin; i < end; ++i)
+                    Skin(i, positions, normals, out);
+            }
+
+            void Skin(size_t i, const Vector3StreamView& positions, const Vector3StreamView* normals, const SkinOutput& out) const
+            {
+                const Matrix44& m0 = palette[weights->bones[0][i]];
+                const Matrix44& m1 = palette[weights->bones[1][i]];
+                const Matrix44& m2 = palette[weights->bones[2][i]];
+                const Matrix44& m3 = palette[weights->bones[3][i]];
+#if USING_AVX2
+                __m256 w0 = _mm256_set1_ps(weights->weights[0][i]), w1 = _mm256_set1_ps(weights->weights[1][i]);
+                __m256 w2 = _mm256_set1_ps(weights->weights[2][i]), w3 = _mm256_set1_ps(weights->weights[3][i]);
+                __m256 rows01 = _mm256_add_ps(MulAdd(w0, _mm256_loadu_ps(m0[0]), _mm256_mul_ps(w1, _mm256_loadu_ps(m1[0]))), MulAdd(w2, _mm256_loadu_ps(m2[0]), _mm256_mul_ps(w3, _mm256_loadu_ps(m3[0]))));
+                __m256 rows23 = _mm256_add_ps(MulAdd(w0, _mm256_loadu_ps(m0[2]), _mm256_mul_ps(w1, _mm256_loadu_ps(m1[2]))), MulAdd(w2, _mm256_loadu_ps(m2[2]), _mm256_mul_ps(w3, _mm256_loadu_ps(m3[2]))));
+
+                // x * row0 + z * row2 in the low half, y * row1 + row3 in the high.
+                __m256 xy = _mm256_set_m128(_mm_set1_ps(positions.y[i]), _mm_set1_ps(positions.x[i]));
+                __m256 z1 = _mm256_set_m128(_mm_set1_ps(1.0f), _mm_set1_ps(positions.z[i]));
+                __m256 p = MulAdd(rows01, xy, _mm256_mul_ps(rows23, z1));
+                StoreXYZ(out.px, out.py, out.pz, i, _mm_add_ps(_mm256_castps256_ps128(p), _mm256_extractf128_ps(p, 1)));
+                if (normals) {
+                    xy = _mm256_set_m128(_mm_set1_ps(normals->y[i]), _mm_set1_ps(normals->x[i]));
+                    z1 = _mm256_set_m128(_mm_setzero_ps(), _mm_set1_ps(normals->z[i]));
+                    __m256 n = MulAdd(rows01, xy, _mm256_mul_ps(rows23, z1));
+                    StoreXYZ(out.nx, out.ny, out.nz, i, _mm_add_ps(_mm256_castps256_ps128(n), _mm256_extractf128_ps(n, 1)));
+                }
+#elif USING_SSE
+                __m128 w0 = _mm_set1_ps(weights->weights[0][i]), w1 = _mm_set1_ps(weights->weights[1][i]);
+                __m128 w2 = _mm_set1_ps(weights->weights[2][i]), w3 = _mm_set1_ps(weights->weights[3][i]);
+                __m128 r[4];
+                for (int row = 0; row < 4; ++row)
+                    r[row] = _mm_add_ps(MulAdd(w0, _mm_load_ps(m0[row]), _mm_mul_ps(w1, _mm_load_ps(m1[row]))), MulAdd(w2, _mm_load_ps(m2[row]), _mm_mul_ps(w3, _mm_load_ps(m3[row]))));
+
+                __m128 p = MulAdd(_mm_set1_ps(positions.x[i]), r[0], MulAdd(_mm_set1_ps(positions.y[i]), r[1], MulAdd(_mm_set1_ps(positions.z[i]), r[2], r[3])));
+                StoreXYZ(out.px, out.py, out.pz, i, p);
+                if (normals) {
+                    __m128 n = MulAdd(_mm_set1_ps(normals->x[i]), r[0], MulAdd(_mm_set1_ps(normals->y[i]), r[1], _mm_mul_ps(_mm_set1_ps(normals->z[i]), r[2])));
+                    StoreXYZ(out.nx, out.ny, out.nz, i, n);
+                }
+#else
+                float w0 = weights->weights[0][i], w1 = weights->weights[1][i], w2 = weights->weights[2][i], w3 = weights->weights[3][i];
+                float r[4][3];
+                for (int row = 0; row < 4; ++row)
+                    for (int c = 0; c < 3; ++c)
+                        r[row][c] = (w0 * m0[row][c] + w1 * m1[row][c]) + (w2 * m2[row][c] + w3 * m3[row][c]);
+
+                float x = positions.x[i], y = positions.y[i], z = positions.z[i];
+                out.px[i] = x * r[0][0] + y * r[1][0] + z * r[2][0] + r[3][0];
+                out.py[i] = x * r[0][1] + y * r[1][1] + z * r[2][1] + r[3][1];
+                out.pz[i] = x * r[0][2] + y * r[1][2] + z * r[2][2] + r[3][2];
+                if (normals) {
+                    x = normals->x[i], y = normals->y[i], z = normals->z[i];
+                    out.nx[i] = x * r[0][0] + y * r[1][0] + z * r[2][0];
+                    out.ny[i] = x * r[0][1] + y * r[1][1] + z * r[2][1];
+                    out.nz[i] = x * r[0][2] + y * r[1][2] + z * r[2][2];
+                }
+#endif
+            }
+        };
+
+        // Resizes the outputs and runs kernel(begin, end, ...) over
+        // parallel ranges of the vertices.
+        template <typename Kernel>
+        inline void Skin(const Kernel& kernel, size_t count, const Vector3StreamView& positions, const Vector3StreamView* normals, Vector3Stream& outPositions, Vector3Stream* outNormals, const SkinningOptions& options)
+        {
+            assert(positions.count == count && (!normals || normals->count == count));
+            outPositions.Resize(count);
+            if (outNormals)
+                outNormals->Resize(count);
+            SkinOutput out = { outPositions.X(), outPositions.Y(), outPositions.Z(), nullptr, nullptr, nullptr };
+            if (outNormals) {
+                out.nx = outNormals->X();
+                out.ny = outNormals->Y();
+                out.nz = outNormals->Z();
+            }
+
+            ParallelRanges(count, options.parallelThreshold, options.threadCount, [&](size_t begin, size_t end) { kernel(begin, end, positions, normals, out); });
+        }
+    } // end namespace Detail
+
+    inline void SkinDualQuaternion(const DualQuaternion<float>* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, Vector3Stream& outPositions, const SkinningOptions& options)
+    {
+        Detail::DualQuaternionSkin kernel = { palette, &weights };
+        Detail::Skin(kernel, weights.count, positions, nullptr, outPositions, nullptr, options);
+    }
+
+    inline void SkinDualQuaternion(const DualQuaternion<float>* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, const Vector3StreamView& normals, Vector3Stream& outPositions, Vector3Stream& outNormals, const SkinningOptions& options)
+    {
+        Detail::DualQuaternionSkin kernel = { palette, &weights };
+        Detail::Skin(kernel, weights.count, positions, &normals, outPositions, &outNormals, options);
+    }
+
+    inline void SkinLinearBlend(const Matrix44* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, Vector3Stream& outPositions, const SkinningOptions& options)
+    {
+        Detail::LinearBlendSkin kernel = { palette, &weights };
+        Detail::Skin(kernel, weights.count, positions, nullptr, outPositions, nullptr, options);
+    }
+
+    inline void SkinLinearBlend(const Matrix44* palette, const SkinWeightsView& weights, const Vector3StreamView& positions, const Vector3StreamView& normals, Vector3Stream& outPositions, Vector3Stream& outNormals, const SkinningOptions& options)
+    {
+        Detail::LinearBlendSkin kernel = { palette, &weights };
+        Detail::Skin(kernel, weights.count, positions, &normals, outPositions, &outNormals, options);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,645 @@
+#pragma once
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <vector>
+
+#include "3DParametric.h"
+#include "AABB.h"
+#include "Mappings.h"
+#include "Parallel.h"
+#include "Vector3Stream.h"
+
+namespace Oblivion {
+namespace Math {
+    // Solid sphere; points at exactly radius from the center are inside.
+    // The default sphere is empty (radius -1), so merging into it yields
+    // the other operand.
+    class Sphere {
+    public:
+        Vector3 center;
+        float radius;
+
+        Sphere();
+        Sphere(const Vector3& center, float radius);
+
+        bool IsEmpty() const { return radius < 0.0f; }
+        bool Contains(const Vector3& p) const;
+
+        // Grows to the smallest sphere containing this one and p (or s).
+        Sphere& Merge(const Vector3& p);
+        Sphere& Merge(const Sphere& s);
+    };
+
+    // Spheres that only touch intersect, as do a sphere and a box.
+    bool Intersects(const Sphere& a, const Sphere& b);
+    bool Intersects(const Sphere& sphere, const AABB& box);
+
+    /********************************************************************
+    // BOUNDING VOLUMES OF POINT SETS
+    //
+    // points may be a Vector3Stream, a Vector3StreamView or a
+    // Vector3ArrayView (so an importer's Vector3 array needs no copy).
+    //
+    // BoundingBox is a min/max reduction: eight points at a time in
+    // registers, split across threads for large inputs. The Ritter fit
+    // starts from the pair of axis-extreme points found by the same
+    // reduction and grows the sphere over everything still outside,
+    // testing eight points at a time; it is within a few percent of the
+    // minimum for typical meshes. The Welzl fit is the exact minimal
+    // sphere (randomized incremental, expected linear time, in double),
+    // for offline use. Points must be finite; empty inputs give empty
+    // volumes.
+    ********************************************************************/
+    enum class SphereFit {
+        Ritter,
+        Welzl
+    };
+
+    // parallelThreshold counts points.
+    struct BoundsOptions : ParallelOptions {
+        BoundsOptions()
+            : ParallelOptions(1 << 20)
+        {
+        }
+    };
+
+    template <typename Points>
+    auto BoundingBox(const Points& points, const BoundsOptions& options = BoundsOptions()) -> decltype(Detail::StreamReader(points), AABB());
+    template <typename Points>
+    auto BoundingSphere(const Points& points, SphereFit fit = SphereFit::Ritter, const BoundsOptions& options = BoundsOptions()) -> decltype(Detail::StreamReader(points), Sphere());
+
+    /********************************************************************
+    // BATCH OVERLAP TESTS
+    //
+    // Write the indices of the elements overlapping query to hits, in
+    // order, and return how many there are, like CollectOverlaps for
+    // boxes. hits must have room for every element.
+    ********************************************************************/
+    size_t CollectOverlaps(const Sphere& query, const SphereStreamView& spheres, uint32_t* hits);
+    size_t CollectOverlaps(const Sphere& query, const AABBStreamView& boxes, uint32_t* hits);
+    size_t CollectOverlaps(const AABB& query, const SphereStreamView& spheres, uint32_t* hits);
+
+    inline Sphere::Sphere()
+        : center(0.0f, 0.0f, 0.0f)
+        , radius(-1.0f)
+    {
+    }
+
+    inline Sphere::Sphere(const Vector3& center, float radius)
+        : center(center)
+        , radius(radius)
+    {
+    }
+
+    inline bool Sphere::Contains(const Vector3& p) const
+    {
+        Vector3 d = p - center;
+        return d * d <= radius * radius && !IsEmpty();
+    }
+
+    inline Sphere& Sphere::Merge(const Vector3& p)
+    {
+        if (IsEmpty())
+            return *this = Sphere(p, 0.0f);
+        Vector3 d = p - center;
+        float distance2 = d * d;
+        if (distance2 <= radius * radius)
+            return *this;
+
+        // Move the center towards p so the far side stays where it is.
+        float distance = sqrtf(distance2);
+        float grown = (radius + distance) * 0.5f;
+        center = center + d * ((grown - radius) / distance);
+        // Rounding could leave p just outside; the larger of the two keeps it in.
+        Vector3 e = p - center;
+        radius = Max(grown, sqrtf(e * e));
+        return *this;
+    }
+
+    inline Sphere& Sphere::Merge(const Sphere& s)
+    {
+        if (s.IsEmpty())
+            return *this;
+        if (IsEmpty())
+            return *this = s;
+        Vector3 d = s.center - center;
+        float distance = sqrtf(d * d);
+        if (distance + s.radius <= radius)
+            return *this;
+        if (distance + radius <= s.radius)
+            return *this = s;
+
+        float grown = (radius + distance + s.radius) * 0.5f;
+        center = center + d * ((grown - radius) / distance);
+        radius = grown;
+        return *this;
+    }
+
+    inline bool Intersects(const Sphere& a, const Sphere& b)
+    {
+        Vector3 d = b.center - a.center;
+        float r = a.radius + b.radius;
+        return d * d <= r * r && !a.IsEmpty() && !b.IsEmpty();
+    }
+
+    inline bool Intersects(const Sphere& sphere, const AABB& box)
+    {
+        // Squared distance from the center to the nearest point of the box.
+        const float* c = &sphere.center.x;
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        float distance2 = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            float gap = Max(Max(minimum[i] - c[i], c[i] - maximum[i]), 0.0f);
+            distance2 += gap * gap;
+        }
+        return distance2 <= sphere.radius * sphere.radius && !sphere.IsEmpty() && !box.IsEmpty();
+    }
+
+    namespace Detail {
+        // The smallest and largest x, y and z over a set of points, and
+        // the index of a point reaching each.
+        struct PointExtremes {
+            float lo[3], hi[3];
+            size_t loIndex[3], hiIndex[3];
+
+            PointExtremes()
+            {
+                for (int c = 0; c < 3; ++c) {
+                    lo[c] = INFINITY;
+                    hi[c] = -INFINITY;
+                    loIndex[c] = hiIndex[c] = 0;
+                }
+            }
+
+            // Ties keep the lower index, so the result does not depend on
+            // how the points were split between threads.
+            void Merge(const PointExtremes& e)
+            {
+                for (int c = 0; c < 3; ++c) {
+                    if (e.lo[c] < lo[c] || (e.lo[c] == lo[c] && e.loIndex[c] < loIndex[c])) {
+                        lo[c] = e.lo[c];
+                        loIndex[c] = e.loIndex[c];
+                    }
+                    if (e.hi[c] > hi[c] || (e.hi[c] == hi[c] && e.hiIndex[c] < hiIndex[c])) {
+                        hi[c] = e.hi[c];
+                        hiIndex[c] = e.hiIndex[c];
+                    }
+                }
+            }
+        };
+
+#if USING_AVX2
+        inline float ReduceMin(__m256 v)
+        {
+            __m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+            return _mm_cvtss_f32(_mm_min_ss(m, _mm_movehdup_ps(m)));
+        }
+
+        inline float ReduceMax(__m256 v)
+        {
+            __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+            return _mm_cvtss_f32(_mm_max_ss(m, _mm_movehdup_ps(m)));
+        }
+#endif
+
+        // Bounds of points [begin, end) into lo and hi.
+        template <typename Reader>
+        inline void ChunkBounds(const Reader& points, size_t begin, size_t end, float* lo, float* hi)
+        {
+            size_t i = begin;
+            for (int c = 0; c < 3; ++c) {
+                lo[c] = INFINITY;
+                hi[c] = -INFINITY;
+            }
+#if USING_AVX2
+            if (i + 8 <= end) {
+                __m256 loX = _mm256_set1_ps(INFINITY), loY = loX, loZ = loX;
+                __m256 hiX = _mm256_set1_ps(-INFINITY), hiY = hiX, hiZ = hiX;
+                for (; i + 8 <= end; i += 8) {
+                    __m256 x, y, z;
+                    points.Load(i, x, y, z);
+                    loX = Min(loX, x);
+                    loY = Min(loY, y);
+                    loZ = Min(loZ, z);
+                    hiX = Max(hiX, x);
+                    hiY = Max(hiY, y);
+                    hiZ = Max(hiZ, z);
+                }
+                lo[0] = ReduceMin(loX);
+                lo[1] = ReduceMin(loY);
+                lo[2] = ReduceMin(loZ);
+                hi[0] = ReduceMax(hiX);
+                hi[1] = ReduceMax(hiY);
+                hi[2] = ReduceMax(hiZ);
+            }
+#endif
+            for (; i < end; ++i) {
+                float p[3];
+                points.Load(i, p[0], p[1], p[2]);
+                for (int c = 0; c < 3; ++c) {
+                    lo[c] = Min(lo[c], p[c]);
+                    hi[c] = Max(hi[c], p[c]);
+                }
+            }
+        }
+
+        // Extremes of points [begin, end). The bounds are reduced in
+        // registers a chunk at a time, remembering which chunk set each
+        // extreme; with findIndices that chunk is searched again for the
+        // point itself, so the hot loop never tracks indices.
+        template <typename Reader>
+        inline PointExtremes FindExtremes(const Reader& points, size_t begin, size_t end, bool findIndices)
+        {
+            const size_t chunk = 1024;
+            PointExtremes e;
+            for (size_t first = begin; first < end; first += chunk) {
+                float lo[3], hi[3];
+                ChunkBounds(points, first, std::min(end, first + chunk), lo, hi);
+                for (int c = 0; c < 3; ++c) {
+                    if (lo[c] < e.lo[c]) {
+                        e.lo[c] = lo[c];
+                        e.loIndex[c] = first;
+                    }
+                    if (hi[c] > e.hi[c]) {
+                        e.hi[c] = hi[c];
+                        e.hiIndex[c] = first;
+                    }
+                }
+            }
+
+            for (int c = 0; findIndices && c < 3; ++c) {
+                for (size_t i = e.loIndex[c]; i < end; ++i) {
+                    float p[3];
+                    points.Load(i, p[0], p[1], p[2]);
+                    if (p[c] == e.lo[c]) {
+                        e.loIndex[c] = i;
+                        break;
+                    }
+                }
+                for (size_t i = e.hiIndex[c]; i < end; ++i) {
+                    float p[3];
+                    points.Load(i, p[0], p[1], p[2]);
+                    if (p[c] == e.hi[c]) {
+                        e.hiIndex[c] = i;
+                        break;
+                    }
+                }
+            }
+            return e;
+        }
+
+        template <typename Reader>
+        inline PointExtremes FindExtremes(const Reader& points, bool findIndices, const BoundsOptions& options)
+        {
+            PointExtremes result;
+            std::mutex lock;
+            ParallelRanges(points.count, options.parallelThreshold, options.threadCount, [&](size_t begin, size_t end) {
+                PointExtremes e = FindExtremes(points, begin, end, findIndices);
+                std::lock_guard<std::mutex> guard(lock);
+                result.Merge(e);
+            });
+            return result;
+        }
+
+        template <typename Reader>
+        inline Vector3 PointAt(const Reader& points, size_t i)
+        {
+            Vector3 p;
+            points.Load(i, p.x, p.y, p.z);
+            return p;
+        }
+
+        // Ritter's second pass: merges every point outside s into it, in
+        // order. Eight points are tested at a time and only a block with a
+        // point outside is walked one by one.
+        template <typename Reader>
+        inline void GrowToCover(const Reader& points, Sphere& s)
+        {
+            size_t i = 0;
+#if USING_AVX2
+            __m256 cx = _mm256_set1_ps(s.center.x), cy = _mm256_set1_ps(s.center.y), cz = _mm256_set1_ps(s.center.z);
+            __m256 r2 = _mm256_set1_ps(s.radius * s.radius);
+            for (; i + 8 <= points.count; i += 8) {
+                __m256 x, y, z;
+                points.Load(i, x, y, z);
+                __m256 dx = Sub(x, cx), dy = Sub(y, cy), dz = Sub(z, cz);
+                __m256 d2 = MulAdd(dz, dz, MulAdd(dy, dy, Mul(dx, dx)));
+                if (!MoveMask(LessThan(r2, d2)))
+                    continue;
+
+                for (size_t k = i; k < i + 8; ++k)
+                    s.Merge(PointAt(points, k));
+                cx = _mm256_set1_ps(s.center.x);
+                cy = _mm256_set1_ps(s.center.y);
+                cz = _mm256_set1_ps(s.center.z);
+                r2 = _mm256_set1_ps(s.radius * s.radius);
+            }
+#endif
+            for (; i < points.count; ++i)
+                s.Merge(PointAt(points, i));
+        }
+
+        // Contains and the batch tests compute |p - center|^2 in float, each
+        // rounding a little differently (FMA or not); a few ulps on the
+        // radius keep every fitted point inside whichever one runs.
+        inline Sphere PadForRounding(const Sphere& s)
+        {
+            return Sphere(s.center, s.radius + s.radius * 4.0f * FLT_EPSILON);
+        }
+
+        template <typename Reader>
+        inline Sphere RitterSphere(const Reader& points, const BoundsOptions& options)
+        {
+            if (points.count == 0)
+                return Sphere();
+
+            // Start from the axis whose extreme points are farthest apart.
+            PointExtremes e = FindExtremes(points, true, options);
+            Vector3 a, b;
+            float widest = -1.0f;
+            for (int c = 0; c < 3; ++c) {
+                Vector3 lo = PointAt(points, e.loIndex[c]), hi = PointAt(points, e.hiIndex[c]);
+                Vector3 d = hi - lo;
+                if (d * d > widest) {
+                    widest = d * d;
+                    a = lo;
+                    b = hi;
+                }
+            }
+
+            Sphere s((a + b) * 0.5f, sqrtf(widest) * 0.5f);
+            GrowToCover(points, s);
+            return PadForRounding(s);
+        }
+
+        /********************************************************************
+        // WELZL
+        ********************************************************************/
+        struct Ball {
+            Vector3d center;
+            double radius2;
+
+            // A little slack keeps rounding in the constructions below
+            // from making points on the boundary look outside.
+            bool Contains(const Vector3d& p) const
+            {
+                Vector3d d = p - center;
+                return d * d <= radius2 * (1.0 + 1e-9);
+            }
+        };
+
+        // The ball with center c through the given points (the largest
+        // distance, in case rounding put them at slightly different ones).
+        inline Ball BallThrough(const Vector3d& c, const Vector3d* p, int count)
+        {
+            Ball ball = { c, 0.0 };
+            for (int k = 0; k < count; ++k)
+                ball.radius2 = fmax(ball.radius2, (p[k] - c) * (p[k] - c));
+            return ball;
+        }
+
+        inline Ball BallOf(const Vector3d& a, const Vector3d& b)
+        {
+            const Vector3d p[2] = { a, b };
+            return BallThrough((a + b) * 0.5, p, 2);
+        }
+
+        // The smallest of the given balls containing all of p; the largest
+        // ball when rounding leaves none of them containing everything.
+        inline Ball SmallestContaining(const Ball* balls, int ballCount, const Vector3d* p, int count)
+        {
+            int best = -1, largest = 0;
+            for (int i = 0; i < ballCount; ++i) {
+                bool all = true;
+                for (int k = 0; k < count; ++k)
+                    all = all && balls[i].Contains(p[k]);
+                if (all && (best < 0 || balls[i].radius2 < balls[best].radius2))
+                    best = i;
+                if (balls[i].radius2 > balls[largest].radius2)
+                    largest = i;
+            }
+            return balls[best < 0 ? largest : best];
+        }
+
+        // The circumscribed circle of a triangle, or the smallest ball over
+        // a pair when the points are collinear.
+        inline Ball BallOf(const Vector3d& a, const Vector3d& b, const Vector3d& c)
+        {
+            const Vector3d p[3] = { a, b, c };
+            Vector3d u = b - a, v = c - a, w = u ^ v;
+            double ww = w * w;
+            if (!(ww > 1e-12 * (u * u) * (v * v))) {
+                const Ball pairs[3] = { BallOf(a, b), BallOf(a, c), BallOf(b, c) };
+                return SmallestContaining(pairs, 3, p, 3);
+            }
+            Vector3d offset = ((w ^ u) * (v * v) + (v ^ w) * (u * u)) * (0.5 / ww);
+            return BallThrough(a + offset, p, 3);
+        }
+
+        // The circumscribed sphere of a tetrahedron, or the smallest
+        // triangle ball when the points are coplanar.
+        inline Ball BallOf(const Vector3d& a, const Vector3d& b, const Vector3d& c, const Vector3d& d)
+        {
+            const Vector3d p[4] = { a, b, c, d };
+            Vector3d u = b - a, v = c - a, t = d - a;
+            double det = u * (v ^ t);
+            if (!(fabs(det) > 1e-9 * sqrt((u * u) * (v * v) * (t * t)))) {
+                const Ball triangles[4] = { BallOf(a, b, c), BallOf(a, b, d), BallOf(a, c, d), BallOf(b, c, d) };
+                return SmallestContaining(triangles, 4, p, 4);
+            }
+            Vector3d offset = ((v ^ t) * (u * u) + (t ^ u) * (v * v) + (u ^ v) * (t * t)) * (0.5 / det);
+            return BallThrough(a + offset, p, 4);
+        }
+
+        template <typename Reader>
+        inline Sphere WelzlSphere(const Reader& points)
+        {
+            if (points.count == 0)
+                return Sphere();
+            assert(points.count <= UINT32_MAX);
+
+            // The expected linear time needs the points in random order; a
+            // fixed seed keeps the result reproducible.
+            std::vector<uint32_t> order(points.count);
+            uint64_t state = 0x9E3779B97F4A7C15ull;
+            for (size_t i = 0; i < order.size(); ++i) {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                size_t j = (size_t)((state >> 33) % (i + 1));
+                order[i] = order[j];
+                order[j] = (uint32_t)i;
+            }
+            auto at = [&](size_t i) {
+                Vector3 p = PointAt(points, order[i]);
+                return Vector3d(p.x, p.y, p.z);
+            };
+
+            // Each loop level knows one more point on the boundary of the
+            // smallest ball over the points before it.
+            Ball ball = { at(0), 0.0 };
+            for (size_t i = 1; i < order.size(); ++i) {
+                Vector3d pi = at(i);
+                if (ball.Contains(pi))
+                    continue;
+                ball = Ball{ pi, 0.0 };
+                for (size_t j = 0; j < i; ++j) {
+                    Vector3d pj = at(j);
+                    if (ball.Contains(pj))
+                        continue;
+                    ball = BallOf(pi, pj);
+                    for (size_t k = 0; k < j; ++k) {
+                        Vector3d pk = at(k);
+                        if (ball.Contains(pk))
+                            continue;
+                        ball = BallOf(pi, pj, pk);
+                        for (size_t l = 0; l < k; ++l) {
+                            Vector3d pl = at(l);
+                            if (!ball.Contains(pl))
+                                ball = BallOf(pi, pj, pk, pl);
+                        }
+                    }
+                }
+            }
+
+            // Round the center, then take the radius from it in double and
+            // round that up, so every point is inside the float sphere.
+            Vector3 center((float)ball.center.x, (float)ball.center.y, (float)ball.center.z);
+            Vector3d c(center.x, center.y, center.z);
+            double radius2 = 0.0;
+            for (size_t i = 0; i < points.count; ++i) {
+                Vector3 p = PointAt(points, i);
+                Vector3d d = Vector3d(p.x, p.y, p.z) - c;
+                radius2 = fmax(radius2, d * d);
+            }
+            double radius = sqrt(radius2);
+            float r = (float)radius;
+            return PadForRounding(Sphere(center, (double)r < radius ? nextafterf(r, INFINITY) : r));
+        }
+    } // end namespace Detail
+
+    template <typename Points>
+    inline auto BoundingBox(const Points& points, const BoundsOptions& options) -> decltype(Detail::StreamReader(points), AABB())
+    {
+        Detail::PointExtremes e = Detail::FindExtremes(Detail::StreamReader(points), false, options);
+        return AABB(Vector3(e.lo[0], e.lo[1], e.lo[2]), Vector3(e.hi[0], e.hi[1], e.hi[2]));
+    }
+
+    template <typename Points>
+    inline auto BoundingSphere(const Points& points, SphereFit fit, const BoundsOptions& options) -> decltype(Detail::StreamReader(points), Sphere())
+    {
+        if (fit == SphereFit::Welzl)
+            return Detail::WelzlSphere(Detail::StreamReader(points));
+        return Detail::RitterSphere(Detail::StreamReader(points), options);
+    }
+
+    namespace Detail {
+        // (r + r_i)^2 - |c - c_i|^2: below zero where the spheres are apart.
+        struct SphereOverlapScore {
+            const Sphere& query;
+            const SphereStreamView& spheres;
+
+            SphereOverlapScore(const Sphere& query, const SphereStreamView& spheres)
+                : query(query)
+                , spheres(spheres)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F dx = Sub(LoadLanes(spheres.x + i, lanes), Broadcast(query.center.x, lanes));
+                F dy = Sub(LoadLanes(spheres.y + i, lanes), Broadcast(query.center.y, lanes));
+                F dz = Sub(LoadLanes(spheres.z + i, lanes), Broadcast(query.center.z, lanes));
+                F radius = LoadLanes(spheres.radius + i, lanes);
+                F r = Add(radius, Broadcast(query.radius, lanes));
+                return RejectNegative(radius, Sub(Mul(r, r), MulAdd(dz, dz, MulAdd(dy, dy, Mul(dx, dx)))));
+            }
+        };
+
+        // Squared distance from (x, y, z) to the box, per lane.
+        template <typename F>
+        inline F BoxDistance2(F x, F y, F z, F minX, F minY, F minZ, F maxX, F maxY, F maxZ)
+        {
+            F zero = Broadcast(0.0f, x);
+            F gx = Max(Max(Sub(minX, x), Sub(x, maxX)), zero);
+            F gy = Max(Max(Sub(minY, y), Sub(y, maxY)), zero);
+            F gz = Max(Max(Sub(minZ, z), Sub(z, maxZ)), zero);
+            return MulAdd(gz, gz, MulAdd(gy, gy, Mul(gx, gx)));
+        }
+
+        // r^2 minus the squared distance from the center to the box.
+        struct SphereBoxScore {
+            const Sphere& query;
+            const AABBStreamView& boxes;
+
+            SphereBoxScore(const Sphere& query, const AABBStreamView& boxes)
+                : query(query)
+                , boxes(boxes)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F minX = LoadLanes(boxes.minX + i, lanes), minY = LoadLanes(boxes.minY + i, lanes), minZ = LoadLanes(boxes.minZ + i, lanes);
+                F maxX = LoadLanes(boxes.maxX + i, lanes), maxY = LoadLanes(boxes.maxY + i, lanes), maxZ = LoadLanes(boxes.maxZ + i, lanes);
+                F d2 = BoxDistance2(Broadcast(query.center.x, lanes), Broadcast(query.center.y, lanes), Broadcast(query.center.z, lanes),
+                    minX, minY, minZ, maxX, maxY, maxZ);
+                // An inverted box (maximum below minimum on any axis) is empty.
+                F size = Min(Min(Sub(maxX, minX), Sub(maxY, minY)), Sub(maxZ, minZ));
+                return RejectNegative(size, Sub(Broadcast(query.radius * query.radius, lanes), d2));
+            }
+        };
+
+        struct BoxSphereScore {
+            const AABB& query;
+            const SphereStreamView& spheres;
+
+            BoxSphereScore(const AABB& query, const SphereStreamView& spheres)
+                : query(query)
+                , spheres(spheres)
+            {
+            }
+
+            template <typename F>
+            F operator()(size_t i, F lanes) const
+            {
+                F r = LoadLanes(spheres.radius + i, lanes);
+                F d2 = BoxDistance2(LoadLanes(spheres.x + i, lanes), LoadLanes(spheres.y + i, lanes), LoadLanes(spheres.z + i, lanes),
+                    Broadcast(query.minimum.x, lanes), Broadcast(query.minimum.y, lanes), Broadcast(query.minimum.z, lanes),
+                    Broadcast(query.maximum.x, lanes), Broadcast(query.maximum.y, lanes), Broadcast(query.maximum.z, lanes));
+                return RejectNegative(r, Sub(Mul(r, r), d2));
+            }
+        };
+    } // end namespace Detail
+
+    inline size_t CollectOverlaps(const Sphere& query, const SphereStreamView& spheres, uint32_t* hits)
+    {
+        if (query.IsEmpty())
+            return 0;
+        return Detail::SelectIndices(Detail::SphereOverlapScore(query, spheres), spheres.count, hits);
+    }
+
+    inline size_t CollectOverlaps(const Sphere& query, const AABBStreamView& boxes, uint32_t* hits)
+    {
+        if (query.IsEmpty())
+            return 0;
+        return Detail::SelectIndices(Detail::SphereBoxScore(query, boxes), boxes.count, hits);
+    }
+
+    inline size_t CollectOverlaps(const AABB& query, const SphereStreamView& spheres, uint32_t* hits)
+    {
+        if (query.IsEmpty())
+            return 0;
+        return Detail::SelectIndices(Detail::BoxSphereScore(query, spheres), spheres.count, hits);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <math.h>
+
+#include "MathSIMD.h"
+#include "Matrix44.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // TRANSFORM
+    //
+    // Rotation, translation and uniform scale in 32 bytes, half of a
+    // Matrix44. A point is scaled, then rotated, then translated, and
+    // a * b applies a first and then b, the same as the product of the
+    // two matrices. The scale is uniform so that products and inverses
+    // are exact transforms of the same form; a negative scale mirrors.
+    // The rotation must be unit length.
+    ********************************************************************/
+    class Transform {
+    public:
+        Quaternion<float> rotation;
+        Vector3 translation;
+        float scale;
+
+        Transform();
+        Transform(const Quaternion<float>& rotation, const Vector3& translation, float scale = 1.0f);
+
+        Vector3 TransformPoint(const Vector3& p) const;
+        // Rotated and scaled, not translated: the w = 0 row of the matrix.
+        Vector3 TransformDirection(const Vector3& d) const;
+
+        Transform Inverse() const;
+
+        Transform operator*(const Transform& t) const;
+        Transform& operator*=(const Transform& t);
+
+        Matrix44 ToMatrix44() const;
+        // m must be a rotation with uniform scale and a translation, as
+        // produced by ToMatrix44; round trips are exact up to rounding.
+        static Transform FromMatrix44(const Matrix44& m);
+    };
+
+    static_assert(sizeof(Transform) == 8 * sizeof(float), "The batch kernels read a Transform as eight packed floats");
+
+    // Translation and scale blended linearly, rotation by normalized lerp
+    // along the shorter arc.
+    Transform Lerp(const Transform& a, const Transform& b, float t);
+
+    // out[i] = a[i] * b[i] and out[i] = Lerp(a[i], b[i], t), eight (or four)
+    // transforms at a time. out may alias a or b.
+    void Compose(const Transform* a, const Transform* b, Transform* out, size_t count);
+    void Lerp(const Transform* a, const Transform* b, float t, Transform* out, size_t count);
+
+    // S * R * T for row vectors: the rows of the rotation matrix of q scaled
+    // by scale, then translation in row 3. q must be unit length.
+    Matrix44 LocalMatrix(const Quaternion<float>& q, const Vector3& translation, const Vector3& scale);
+
+    namespace Detail {
+        // Quaternion::Rotate for a Vector3.
+        inline Vector3 RotateVector(const Quaternion<float>& q, const Vector3& v)
+        {
+            Vector3D<float> r = q.Rotate(Vector3D<float>(v.x, v.y, v.z));
+            return Vector3(r.x, r.y, r.z);
+        }
+
+        // The eight floats of one transform per lane, in memory order.
+        template <typename F>
+        struct TransformLanes {
+            F w, x, y, z, tx, ty, tz, s;
+        };
+
+        // Eight floats per transform in, one register per component out,
+        // and back.
+        inline void LoadTransposed(const float* p, float* r)
+        {
+            for (int k = 0; k < 8; ++k)
+                r[k] = p[k];
+        }
+
+        inline void StoreTransposed(float* p, const float* r)
+        {
+            for (int k = 0; k < 8; ++k)
+                p[k] = r[k];
+        }
+
+#if USING_SSE
+        // Four transforms: the rotation and the translation / scale halves
+        // are each a 4x4 transpose.
+        inline void LoadTransposed(const float* p, __m128* r)
+        {
+            for (int k = 0; k < 4; ++k) {
+                r[k] = _mm_loadu_ps(p + 8 * k);
+                r[k + 4] = _mm_loadu_ps(p + 8 * k + 4);
+            }
+            _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+            _MM_TRANSPOSE4_PS(r[4], r[5], r[6], r[7]);
+        }
+
+        inline void StoreTransposed(float* p, const __m128* r)
+        {
+            __m128 r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3];
+            __m128 h0 = r[4], h1 = r[5], h2 = r[6], h3 = r[7];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+            _mm_storeu_ps(p, r0);
+            _mm_storeu_ps(p + 4, h0);
+            _mm_storeu_ps(p + 8, r1);
+            _mm_storeu_ps(p + 12, h1);
+            _mm_storeu_ps(p + 16, r2);
+            _mm_storeu_ps(p + 20, h2);
+            _mm_storeu_ps(p + 24, r3);
+            _mm_storeu_ps(p + 28, h3);
+        }
+#endif
+
+#if USING_AVX2
+        // Eight transforms, one per register: an in-lane transpose of each
+        // group of four, then the 128-bit lanes swapped into place.
+        inline void LoadTransposed(const float* p, __m256* r)
+        {
+            __m256 t[8];
+            for (int k = 0; k < 8; ++k)
+                t[k] = _mm256_loadu_ps(p + 8 * k);
+            Transpose4InLanes(t[0], t[1], t[2], t[3]);
+            Transpose4InLanes(t[4], t[5], t[6], t[7]);
+            for (int k = 0; k < 4; ++k) {
+                r[k] = _mm256_permute2f128_ps(t[k], t[k + 4], 0x20);
+                r[k + 4] = _mm256_permute2f128_ps(t[k], t[k + 4], 0x31);
+            }
+        }
+
+        inline void StoreTransposed(float* p, const __m256* r)
+        {
+            __m256 t[8];
+            for (int k = 0; k < 4; ++k) {
+                t[k] = _mm256_permute2f128_ps(r[k], r[k + 4], 0x20);
+                t[k + 4] = _mm256_permute2f128_ps(r[k], r[k + 4], 0x31);
+            }
+            Transpose4InLanes(t[0], t[1], t[2], t[3]);
+            Transpose4InLanes(t[4], t[5], t[6], t[7]);
+            for (int k = 0; k < 8; ++k)
+                _mm256_storeu_ps(p + 8 * k, t[k]);
+        }
+#endif
+
+        template <typename F>
+        inline TransformLanes<F> LoadTransforms(const Transform* t, F)
+        {
+            F r[8];
+            LoadTransposed(&t->rotation.w, r);
+            TransformLanes<F> l = { r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7] };
+            return l;
+        }
+
+        template <typename F>
+        inline void StoreTransforms(Transform* t, const TransformLanes<F>& l)
+        {
+            F r[8] = { l.w, l.x, l.y, l.z, l.tx, l.ty, l.tz, l.s };
+            StoreTransposed(&t->rotation.w, r);
+        }
+
+        // a * b: rotation b.q * a.q, translation b applied to a's, scales
+        // multiplied.
+        template <typename F>
+        inline TransformLanes<F> ComposeLanes(const TransformLanes<F>& a, const TransformLanes<F>& b)
+        {
+            TransformLanes<F> r;
+            r.w = Sub(Mul(b.w, a.w), MulAdd(b.x, a.x, MulAdd(b.y, a.y, Mul(b.z, a.z))));
+            r.x = Sub(MulAdd(b.w, a.x, MulAdd(b.x, a.w, Mul(b.y, a.z))), Mul(b.z, a.y));
+            r.y = Sub(MulAdd(b.w, a.y, MulAdd(b.y, a.w, Mul(b.z, a.x))), Mul(b.x, a.z));
+            r.z = Sub(MulAdd(b.w, a.z, MulAdd(b.z, a.w, Mul(b.x, a.y))), Mul(b.y, a.x));
+
+            F two = Broadcast(2.0f, a.w);
+            F tx = Mul(two, Sub(Mul(b.y, a.tz), Mul(b.z, a.ty)));
+            F ty = Mul(two, Sub(Mul(b.z, a.tx), Mul(b.x, a.tz)));
+            F tz = Mul(two, Sub(Mul(b.x, a.ty), Mul(b.y, a.tx)));
+            F px = Add(a.tx, MulAdd(b.w, tx, Sub(Mul(b.y, tz), Mul(b.z, ty))));
+            F py = Add(a.ty, MulAdd(b.w, ty, Sub(Mul(b.z, tx), Mul(b.x, tz))));
+            F pz = Add(a.tz, MulAdd(b.w, tz, Sub(Mul(b.x, ty), Mul(b.y, tx))));
+            r.tx = MulAdd(px, b.s, b.tx);
+            r.ty = MulAdd(py, b.s, b.ty);
+            r.tz = MulAdd(pz, b.s, b.tz);
+            r.s = Mul(a.s, b.s);
+            return r;
+        }
+
+        template <typename F>
+        inline TransformLanes<F> LerpLanes(const TransformLanes<F>& a, const TransformLanes<F>& b, F t)
+        {
+            F one = Broadcast(1.0f, t);
+            F dot = MulAdd(a.w, b.w, MulAdd(a.x, b.x, MulAdd(a.y, b.y, Mul(a.z, b.z))));
+            F wa = Sub(one, t);
+            F wb = NegateIf(LessThan(dot, Broadcast(0.0f, t)), t);
+
+            TransformLanes<F> r;
+            r.w = MulAdd(a.w, wa, Mul(b.w, wb));
+            r.x = MulAdd(a.x, wa, Mul(b.x, wb));
+            r.y = MulAdd(a.y, wa, Mul(b.y, wb));
+            r.z = MulAdd(a.z, wa, Mul(b.z, wb));
+            F inverseLength = Div(one, Sqrt(MulAdd(r.w, r.w, MulAdd(r.x, r.x, MulAdd(r.y, r.y, Mul(r.z, r.z))))));
+            r.w = Mul(r.w, inverseLength);
+            r.x = Mul(r.x, inverseLength);
+            r.y = Mul(r.y, inverseLength);
+            r.z = Mul(r.z, inverseLength);
+
+            r.tx = MulAdd(Sub(b.tx, a.tx), t, a.tx);
+            r.ty = MulAdd(Sub(b.ty, a.ty), t, a.ty);
+            r.tz = MulAdd(Sub(b.tz, a.tz), t, a.tz);
+            r.s = MulAdd(Sub(b.s, a.s), t, a.s);
+            return r;
+        }
+    } // end namespace Detail
+
+    inline Transform::Transform()
+        : rotation(1.0f, Vector3D<float>(0.0f, 0.0f, 0.0f))
+        , translation(0.0f, 0.0f, 0.0f)
+        , scale(1.0f)
+    {
+    }
+
+    inline Transform::Transform(const Quaternion<float>& rotation, const Vector3& translation, float scale)
+        : rotation(rotation)
+        , translation(translation)
+        , scale(scale)
+    {
+    }
+
+    inline Vector3 Transform::TransformPoint(const Vector3& p) const
+    {
+        Vector3 r = Detail::RotateVector(rotation, p);
+        return Vector3(r.x * scale + translation.x, r.y * scale + translation.y, r.z * scale + translation.z);
+    }
+
+    inline Vector3 Transform::TransformDirection(const Vector3& d) const
+    {
+        return Detail::RotateVector(rotation, d) * scale;
+    }
+
+    inline Transform Transform::Inverse() const
+    {
+        Quaternion<float> conjugate(rotation.w, Vector3D<float>(-rotation.v.x, -rotation.v.y, -rotation.v.z));
+        float inverseScale = 1.0f / scale;
+        return Transform(conjugate, Detail::RotateVector(conjugate, translation) * -inverseScale, inverseScale);
+    }
+
+    inline Transform Transform::operator*(const Transform& t) const
+    {
+        Transform result;
+        Detail::StoreTransforms(&result, Detail::ComposeLanes(Detail::LoadTransforms(this, 0.0f), Detail::LoadTransforms(&t, 0.0f)));
+        return result;
+    }
+
+    inline Transform& Transform::operator*=(const Transform& t)
+    {
+        *this = *this * t;
+        return *this;
+    }
+
+    inline Matrix44 Transform::ToMatrix44() const
+    {
+        return LocalMatrix(rotation, translation, Vector3(scale, scale, scale));
+    }
+
+    inline Transform Transform::FromMatrix44(const Matrix44& m)
+    {
+        // The rows are the scaled images of the axes; the sign of the
+        // determinant gives the sign of the scale.
+        float s = sqrtf(m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2]);
+        float det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+            - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+            + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        if (det < 0.0f)
+            s = -s;
+
+        // Dividing out the scale leaves the rotation ToMat3x3 would give.
+        float inverseScale = 1.0f / s;
+        Mat3x3<float> r(
+            m[0][0] * inverseScale, m[0][1] * inverseScale, m[0][2] * inverseScale,
+            m[1][0] * inverseScale, m[1][1] * inverseScale, m[1][2] * inverseScale,
+            m[2][0] * inverseScale, m[2][1] * inverseScale, m[2][2] * inverseScale);
+        Quaternion<float> q = Quaternion<float>::FromMatrix(r).Normalize();
+
+        return Transform(q, Vector3(m[3][0], m[3][1], m[3][2]), s);
+    }
+
+    inline Transform Lerp(const Transform& a, const Transform& b, float t)
+    {
+        Transform result;
+        Detail::StoreTransforms(&result, Detail::LerpLanes(Detail::LoadTransforms(&a, 0.0f), Detail::LoadTransforms(&b, 0.0f), t));
+        return result;
+    }
+
+    inline void Compose(const Transform* a, const Transform* b, Transform* out, size_t count)
+    {
+        size_t i = 0;
+#if USING_AVX2
+        for (; i + 8 <= count; i += 8)
+            Detail::StoreTransforms(out + i, Detail::ComposeLanes(Detail::LoadTransforms(a + i, __m256()), Detail::LoadTransforms(b + i, __m256())));
+#elif USING_SSE
+        for (; i + 4 <= count; i += 4)
+            Detail::StoreTransforms(out + i, Detail::ComposeLanes(Detail::LoadTransforms(a + i, __m128()), Detail::LoadTransforms(b + i, __m128())));
+#endif
+        for (; i < count; ++i)
+            out[i] = a[i] * b[i];
+    }
+
+    inline void Lerp(const Transform* a, const Transform* b, float t, Transform* out, size_t count)
+    {
+        size_t i = 0;
+#if USING_AVX2
+        __m256 t8 = _mm256_set1_ps(t);
+        for (; i + 8 <= count; i += 8)
+            Detail::StoreTransforms(out + i, Detail::LerpLanes(Detail::LoadTransforms(a + i, t8), Detail::LoadTransforms(b + i, t8), t8));
+#elif USING_SSE
+        __m128 t4 = _mm_set1_ps(t);
+        for (; i + 4 <= count; i += 4)
+            Detail::StoreTransforms(out + i, Detail::LerpLanes(Detail::LoadTransforms(a + i, t4), Detail::LoadTransforms(b + i, t4), t4));
+#endif
+        for (; i < count; ++i)
+            out[i] = Lerp(a[i], b[i], t);
+    }
+
+    inline Matrix44 LocalMatrix(const Quaternion<float>& q, const Vector3& translation, const Vector3& scale)
+    {
+        Mat3x3<float> r = q.ToMat3x3();
+        return Matrix44(
+            scale.x * r[0][0], scale.x * r[0][1], scale.x * r[0][2], 0.0f,
+            scale.y * r[1][0], scale.y * r[1][1], scale.y * r[1][2], 0.0f,
+            scale.z * r[2][0], scale.z * r[2][1], scale.z * r[2][2], 0.0f,
+            translation.x, translation.y, translation.z, 1.0f);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "Matrix44.h"
+#include "Parallel.h"
+#include "Quaternion.h"
+#include "Transform.h"
+
+namespace Oblivion {
+namespace Math {
+    // parallelThreshold counts nodes.
+    struct HierarchyUpdateOptions : ParallelOptions {
+        HierarchyUpdateOptions()
+            : ParallelOptions(8192)
+        {
+        }
+    };
+
+    /********************************************************************
+    // TRANSFORM HIERARCHY
+    //
+    // Parent indices and local rotation / translation / scale in flat
+    // arrays, parents before children. The local matrix applies scale,
+    // then rotation, then translation (row vectors), and
+    // world = local * world(parent).
+    //
+    // Setters only mark a node; Update recomputes, in one forward pass,
+    // the marked nodes and everything below them. Large hierarchies are
+    // split into independent subtrees that are updated on separate
+    // threads after the nodes above them.
+    ********************************************************************/
+    class TransformHierarchy {
+    public:
+        enum : uint32_t { NoParent = 0xffffffffu };
+
+        // parent is NoParent or an existing node; returns the new node.
+        uint32_t Add(uint32_t parent, const Quaternion<float>& rotation, const Vector3& translation, const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f));
+        void Reserve(size_t count);
+        size_t Size() const { return parents.size(); }
+
+        uint32_t Parent(uint32_t node) const { return parents[node]; }
+        const Quaternion<float>& Rotation(uint32_t node) const { return rotations[node]; }
+        const Vector3& Translation(uint32_t node) const { return translations[node]; }
+        const Vector3& Scale(uint32_t node) const { return scales[node]; }
+
+        void SetLocal(uint32_t node, const Quaternion<float>& rotation, const Vector3& translation, const Vector3& scale);
+        void SetRotation(uint32_t node, const Quaternion<float>& rotation);
+        void SetTranslation(uint32_t node, const Vector3& translation);
+        void SetScale(uint32_t node, const Vector3& scale);
+
+        // Valid after Update.
+        const Matrix44& World(uint32_t node) const { return world[node]; }
+        const Matrix44* WorldMatrices() const { return world.data(); }
+
+        void Update(const HierarchyUpdateOptions& options = HierarchyUpdateOptions());
+
+    private:
+        std::vector<uint32_t> parents;
+        std::vector<Quaternion<float> > rotations;
+        std::vector<Vector3> translations;
+        std::vector<Vector3> scales;
+        std::vector<Matrix44> world;
+        // Local transform set since the last Update / world recomputed in
+        // the current one.
+        std::vector<uint8_t> dirty;
+        std::vector<uint8_t> changed;
+
+        // Threaded split, rebuilt when nodes are added: the nodes updated
+        // first on the calling thread, then one node list per thread.
+        std::vector<uint32_t> trunk;
+        std::vector<std::vector<uint32_t> > partitions;
+        unsigned partitionThreads = 0;
+
+        void UpdateNode(uint32_t node);
+        void Partition(unsigned threads);
+    };
+
+    inline uint32_t TransformHierarchy::Add(uint32_t parent, const Quaternion<float>& rotation, const Vector3& translation, const Vector3& scale)
+    {
+        assert(parent == NoParent || parent < parents.size());
+        uint32_t node = (uint32_t)parents.size();
+        parents.push_back(parent);
+        rotations.push_back(rotation);
+        translations.push_back(translation);
+        scales.push_back(scale);
+        world.push_back(Matrix44());
+        dirty.push_back(1);
+        changed.push_back(0);
+        partitionThreads = 0;
+        return node;
+    }
+
+    inline void TransformHierarchy::Reserve(size_t count)
+    {
+        parents.reserve(count);
+        rotations.reserve(count);
+        translations.reserve(count);
+        scales.reserve(count);
+        world.reserve(count);
+        dirty.reserve(count);
+        changed.reserve(count);
+    }
+
+    inline void TransformHierarchy::SetLocal(uint32_t node, const Quaternion<float>& rotation, const Vector3& translation, const Vector3& scale)
+    {
+        rotations[node] = rotation;
+        translations[node] = translation;
+        scales[node] = scale;
+        dirty[node] = 1;
+    }
+
+    inline void TransformHierarchy::SetRotation(uint32_t node, const Quaternion<float>& rotation)
+    {
+        rotations[node] = rotation;
+        dirty[node] = 1;
+    }
+
+    inline void TransformHierarchy::SetTranslation(uint32_t node, const Vector3& translation)
+    {
+        translations[node] = translation;
+        dirty[node] = 1;
+    }
+
+    inline void TransformHierarchy::SetScale(uint32_t node, const Vector3& scale)
+    {
+        scales[node] = scale;
+        dirty[node] = 1;
+    }
+
+    inline void TransformHierarchy::UpdateNode(uint32_t node)
+    {
+        uint32_t parent = parents[node];
+        bool parentChanged = parent != NoParent && changed[parent];
+        changed[node] = dirty[node] | parentChanged;
+        if (!changed[node])
+            return;
+
+        dirty[node] = 0;
+        Matrix44 local = LocalMatrix(rotations[node], translations[node], scales[node]);
+        if (parent == NoParent)
+            world[node] = local;
+        else
+            world[node] = local * world[parent];
+    }
+
+    inline void TransformHierarchy::Partition(unsigned threads)
+    {
+        size_t count = parents.size();
+        trunk.clear();
+        partitions.assign(threads, std::vector<uint32_t>());
+        partitionThreads = threads;
+
+        std::vector<uint32_t> size(count, 1);
+        for (size_t i = count; i-- > 0;)
+            if (parents[i] != NoParent)
+                size[parents[i]] += size[i];
+
+        std::vector<std::vector<uint32_t> > children(count);
+        std::vector<uint32_t> tasks;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (parents[i] == NoParent)
+                tasks.push_back(i);
+            else
+                children[parents[i]].push_back(i);
+        }
+
+        // Open the largest subtree into the trunk until no task is more
+        // than a quarter of a thread's share.
+        const size_t limit = std::max<size_t>(1, count / (4 * threads));
+        std::vector<uint8_t> inTrunk(count, 0);
+        for (;;) {
+            std::vector<uint32_t>::iterator largest = std::max_element(tasks.begin(), tasks.end(), [&](uint32_t a, uint32_t b) { return size[a] < size[b]; });
+            if (largest == tasks.end() || size[*largest] <= limit)
+                break;
+            uint32_t node = *largest;
+            *largest = tasks.back();
+            tasks.pop_back();
+            inTrunk[node] = 1;
+            tasks.insert(tasks.end(), children[node].begin(), children[node].end());
+        }
+
+        // Largest task first onto the least loaded thread.
+        std::sort(tasks.begin(), tasks.end(), [&](uint32_t a, uint32_t b) { return size[a] > size[b]; });
+        std::vector<size_t> load(threads, 0);
+        std::vector<uint32_t> owner(count, 0);
+        for (size_t k = 0; k < tasks.size(); ++k) {
+            unsigned thread = (unsigned)(std::min_element(load.begin(), load.end()) - load.begin());
+            load[thread] += size[tasks[k]];
+            owner[tasks[k]] = thread;
+        }
+
+        // Parents come first, so one forward pass hands every node below a
+        // task to the task's thread, in update order.
+        for (uint32_t i = 0; i < count; ++i) {
+            if (inTrunk[i]) {
+                trunk.push_back(i);
+                continue;
+            }
+            uint32_t parent = parents[i];
+            if (parent != NoParent && !inTrunk[parent])
+                owner[i] = owner[parent];
+            partitions[owner[i]].push_back(i);
+        }
+    }
+
+    inline void TransformHierarchy::Update(const HierarchyUpdateOptions& options)
+    {
+        size_t count = parents.size();
+        unsigned threads = Detail::ThreadCount(count, options.parallelThreshold, options.threadCount);
+        if (threads <= 1) {
+            for (uint32_t i = 0; i < count; ++i)
+                UpdateNode(i);
+            return;
+        }
+
+        if (partitionThreads != threads)
+            Partition(threads);
+        for (size_t k = 0; k < trunk.size(); ++k)
+            UpdateNode(trunk[k]);
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t) {
+            workers.push_back(std::thread([this, t]() {
+                const std::vector<uint32_t>& nodes = partitions[t];
+                for (size_t k = 0; k < nodes.size(); ++k)
+                    UpdateNode(nodes[k]);
+            }));
+        }
+        for (size_t k = 0; k < partitions[0].size(); ++k)
+            UpdateNode(partitions[0][k]);
+        for (size_t t = 0; t < workers.size(); ++t)
+            workers[t].join();
+    }
+} // end namespace Math
+} // end namespace Oblivion
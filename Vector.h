@@ -0,0 +1,470 @@
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+
+#include "Half.h"
+#include "Vector2D.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // TEMPLATED VECTOR CORE
+    //
+    // Vector<N, T> is a fixed-size vector for float, double or Half
+    // components. Everything except the square-root based functions is
+    // constexpr, and every operation is expanded per component at compile
+    // time (index sequences and recursive unrolling) instead of looping
+    // over N.
+    //
+    // Two to four components are stored as named members x, y, z, w so the
+    // templated classes (Quaternion<T>, Mat3x3<T>) can use them directly.
+    // Vector<2|3|4, float> converts implicitly to and from the float types
+    // Vector2D, Vector3 and Vector4, which keep the SIMD paths. Other
+    // element types convert explicitly. Unlike Vector4, Vector<4, T>() is
+    // all zeros.
+    ********************************************************************/
+    template <int N, typename T>
+    class Vector;
+
+    namespace Detail {
+        template <typename T>
+        struct NonDeduced {
+            typedef T Type;
+        };
+
+        template <int N>
+        using MakeIndices = std::make_index_sequence<(size_t)N>;
+
+        template <typename T, typename... A>
+        struct AllConvertible : std::true_type {
+        };
+
+        template <typename T, typename A, typename... Rest>
+        struct AllConvertible<T, A, Rest...> : std::integral_constant<bool, std::is_convertible<A, T>::value && AllConvertible<T, Rest...>::value> {
+        };
+
+        inline float SquareRoot(float f) { return sqrtf(f); }
+        inline double SquareRoot(double d) { return sqrt(d); }
+
+        template <int N, typename T>
+        struct VectorStorage {
+            T e[N];
+
+            constexpr VectorStorage()
+                : e()
+            {
+            }
+
+            template <typename... A, typename = typename std::enable_if<sizeof...(A) == N>::type>
+            constexpr VectorStorage(A... a)
+                : e{ a... }
+            {
+            }
+
+            constexpr T& operator[](int i) { return e[i]; }
+            constexpr const T& operator[](int i) const { return e[i]; }
+        };
+
+        template <typename T>
+        struct VectorStorage<2, T> {
+            T x, y;
+
+            constexpr VectorStorage()
+                : x()
+                , y()
+            {
+            }
+
+            constexpr VectorStorage(T x, T y)
+                : x(x)
+                , y(y)
+            {
+            }
+
+            constexpr T& operator[](int i) { return i == 0 ? x : y; }
+            constexpr const T& operator[](int i) const { return i == 0 ? x : y; }
+        };
+
+        template <typename T>
+        struct VectorStorage<3, T> {
+            T x, y, z;
+
+            constexpr VectorStorage()
+                : x()
+                , y()
+                , z()
+            {
+            }
+
+            constexpr VectorStorage(T x, T y, T z)
+                : x(x)
+                , y(y)
+                , z(z)
+            {
+            }
+
+            constexpr T& operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+            constexpr const T& operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+        };
+
+        template <typename T>
+        struct VectorStorage<4, T> {
+            T x, y, z, w;
+
+            constexpr VectorStorage()
+                : x()
+                , y()
+                , z()
+                , w()
+            {
+            }
+
+            constexpr VectorStorage(T x, T y, T z, T w)
+                : x(x)
+                , y(y)
+                , z(z)
+                , w(w)
+            {
+            }
+
+            constexpr T& operator[](int i) { return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w)); }
+            constexpr const T& operator[](int i) const { return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w)); }
+        };
+
+        // The float vector each Vector<N, float> interoperates with.
+        template <int N, typename T>
+        struct LegacyVector {
+            typedef void Type;
+        };
+
+        template <>
+        struct LegacyVector<2, float> {
+            typedef Vector2D Type;
+        };
+
+        template <>
+        struct LegacyVector<3, float> {
+            typedef Vector3 Type;
+        };
+
+        template <>
+        struct LegacyVector<4, float> {
+            typedef Vector4 Type;
+        };
+
+        template <int N, typename T, typename V>
+        using EnableIfLegacy = typename std::enable_if<std::is_same<V, typename LegacyVector<N, T>::Type>::value>::type;
+
+        inline float LegacyComponent(const Vector2D& v, size_t i) { return i == 0 ? v.x : v.y; }
+        inline float LegacyComponent(const Vector3& v, size_t i) { return i == 0 ? v.x : (i == 1 ? v.y : v.z); }
+        inline float LegacyComponent(const Vector4& v, size_t i) { return i == 0 ? v.x : (i == 1 ? v.y : (i == 2 ? v.z : v.w)); }
+
+        // Compile-time reductions over components 0..I.
+        template <int I>
+        struct VectorUnroll {
+            template <int N, typename T>
+            static constexpr T Dot(const Vector<N, T>& a, const Vector<N, T>& b)
+            {
+                return VectorUnroll<I - 1>::Dot(a, b) + a[I] * b[I];
+            }
+
+            template <int N, typename T>
+            static constexpr bool Equal(const Vector<N, T>& a, const Vector<N, T>& b)
+            {
+                return VectorUnroll<I - 1>::Equal(a, b) && a[I] == b[I];
+            }
+        };
+
+        template <>
+        struct VectorUnroll<0> {
+            template <int N, typename T>
+            static constexpr T Dot(const Vector<N, T>& a, const Vector<N, T>& b)
+            {
+                return a[0] * b[0];
+            }
+
+            template <int N, typename T>
+            static constexpr bool Equal(const Vector<N, T>& a, const Vector<N, T>& b)
+            {
+                return a[0] == b[0];
+            }
+        };
+    } // end namespace Detail
+
+    template <int N, typename T>
+    class Vector : public Detail::VectorStorage<N, T> {
+        static_assert(N >= 2, "Vector needs at least two components");
+
+        typedef Detail::VectorStorage<N, T> Storage;
+
+    public:
+        typedef T ValueType;
+        static const int Size = N;
+
+        constexpr Vector()
+            : Storage()
+        {
+        }
+
+        template <typename... A, typename = typename std::enable_if<sizeof...(A) == N && Detail::AllConvertible<T, A...>::value>::type>
+        constexpr Vector(A... a)
+            : Storage(static_cast<T>(a)...)
+        {
+        }
+
+        template <typename V, typename = Detail::EnableIfLegacy<N, T, V>>
+        Vector(const V& v)
+            : Vector(v, Detail::MakeIndices<N>())
+        {
+        }
+
+        // Precision conversion, e.g. Vector<3, float>(Vector<3, double>).
+        template <typename U, typename = typename std::enable_if<!std::is_same<T, U>::value>::type>
+        explicit constexpr Vector(const Vector<N, U>& v)
+            : Vector(v, Detail::MakeIndices<N>())
+        {
+        }
+
+        template <typename V, typename = Detail::EnableIfLegacy<N, T, V>>
+        operator V() const
+        {
+            return ToLegacy<V>(Detail::MakeIndices<N>());
+        }
+
+        static constexpr Vector Splat(T s)
+        {
+            return Splat(s, Detail::MakeIndices<N>());
+        }
+
+        constexpr T SquaredMagnitude() const
+        {
+            return Detail::VectorUnroll<N - 1>::Dot(*this, *this);
+        }
+
+        T Magnitude() const
+        {
+            return Detail::SquareRoot(SquaredMagnitude());
+        }
+
+        Vector& MakeZero()
+        {
+            return *this = Vector();
+        }
+
+    private:
+        template <typename V, size_t... I>
+        Vector(const V& v, std::index_sequence<I...>)
+            : Storage(static_cast<T>(Detail::LegacyComponent(v, I))...)
+        {
+        }
+
+        template <typename U, size_t... I>
+        constexpr Vector(const Vector<N, U>& v, std::index_sequence<I...>)
+            : Storage(static_cast<T>(v[(int)I])...)
+        {
+        }
+
+        template <typename V, size_t... I>
+        V ToLegacy(std::index_sequence<I...>) const
+        {
+            return V(static_cast<float>((*this)[(int)I])...);
+        }
+
+        template <size_t... I>
+        static constexpr Vector Splat(T s, std::index_sequence<I...>)
+        {
+            return Vector(((void)I, s)...);
+        }
+    };
+
+    namespace Detail {
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Add(const Vector<N, T>& a, const Vector<N, T>& b, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] + b[(int)I])...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Subtract(const Vector<N, T>& a, const Vector<N, T>& b, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] - b[(int)I])...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Multiply(const Vector<N, T>& a, const Vector<N, T>& b, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] * b[(int)I])...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Divide(const Vector<N, T>& a, const Vector<N, T>& b, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] / b[(int)I])...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Scale(const Vector<N, T>& a, T s, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] * s)...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> DivideScalar(const Vector<N, T>& a, T s, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((a[(int)I] / s)...);
+        }
+
+        template <int N, typename T, size_t... I>
+        constexpr Vector<N, T> Negate(const Vector<N, T>& a, std::index_sequence<I...>)
+        {
+            return Vector<N, T>((-a[(int)I])...);
+        }
+    } // end namespace Detail
+
+    /********************************************************************
+    // VECTOR OPERATORS
+    //
+    // Same meaning as for Vector3: * between vectors is the dot product,
+    // ^ the cross product, *= and /= between vectors are per component.
+    ********************************************************************/
+    template <int N, typename T>
+    constexpr Vector<N, T> operator+(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return Detail::Add(a, b, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> operator-(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return Detail::Subtract(a, b, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> operator-(const Vector<N, T>& a)
+    {
+        return Detail::Negate(a, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> operator*(const Vector<N, T>& a, typename Detail::NonDeduced<T>::Type s)
+    {
+        return Detail::Scale(a, s, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> operator*(typename Detail::NonDeduced<T>::Type s, const Vector<N, T>& a)
+    {
+        return Detail::Scale(a, s, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> operator/(const Vector<N, T>& a, typename Detail::NonDeduced<T>::Type s)
+    {
+        return Detail::DivideScalar(a, s, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr T operator*(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return Detail::VectorUnroll<N - 1>::Dot(a, b);
+    }
+
+    template <typename T>
+    constexpr Vector<3, T> operator^(const Vector<3, T>& a, const Vector<3, T>& b)
+    {
+        return Vector<3, T>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    template <int N, typename T>
+    constexpr bool operator==(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return Detail::VectorUnroll<N - 1>::Equal(a, b);
+    }
+
+    template <int N, typename T>
+    constexpr bool operator!=(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return !(a == b);
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator+=(Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return a = a + b;
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator-=(Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return a = a - b;
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator*=(Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return a = Detail::Multiply(a, b, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator/=(Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return a = Detail::Divide(a, b, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator*=(Vector<N, T>& a, typename Detail::NonDeduced<T>::Type s)
+    {
+        return a = a * s;
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T>& operator/=(Vector<N, T>& a, typename Detail::NonDeduced<T>::Type s)
+    {
+        return a = a / s;
+    }
+
+    /********************************************************************
+    // NON-MEMBER FUNCTIONS
+    ********************************************************************/
+    template <int N, typename T>
+    constexpr T DotProduct(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return a * b;
+    }
+
+    template <typename T>
+    constexpr Vector<3, T> CrossProduct(const Vector<3, T>& a, const Vector<3, T>& b)
+    {
+        return a ^ b;
+    }
+
+    // Per-component product.
+    template <int N, typename T>
+    constexpr Vector<N, T> Multiply(const Vector<N, T>& a, const Vector<N, T>& b)
+    {
+        return Detail::Multiply(a, b, Detail::MakeIndices<N>());
+    }
+
+    template <int N, typename T>
+    constexpr Vector<N, T> Lerp(const Vector<N, T>& a, const Vector<N, T>& b, typename Detail::NonDeduced<T>::Type t)
+    {
+        return a + (b - a) * t;
+    }
+
+    // Returns the zero vector for a zero-length input.
+    template <int N, typename T>
+    inline Vector<N, T> Normalize(const Vector<N, T>& v)
+    {
+        T length = v.Magnitude();
+        if (length > T(0)) {
+            return v * (T(1) / length);
+        }
+        return Vector<N, T>();
+    }
+} // end namespace Math
+} // end namespace Oblivion
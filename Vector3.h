@@ -25,7 +25,7 @@ namespace Math {
         friend Vector3 operator/(const Vector3& v, const float s);
 
 		Vector3& MakeZero();
-		float Magnitude();
+		float Magnitude() const;
     };
 
     inline Vector3::Vector3()
@@ -69,7 +69,7 @@ namespace Math {
         return v;
     }
 
-    Vector3& operator/=(Vector3& v, const Vector3& v1)
+    inline Vector3& operator/=(Vector3& v, const Vector3& v1)
     {
         v.x /= v1.x;
         v.y /= v1.y;
@@ -124,7 +124,7 @@ namespace Math {
         return *this;
     }
 
-    inline float Vector3::Magnitude()
+    inline float Vector3::Magnitude() const
     {
         return sqrtf((x * x) + (y * y) + (z * z));
     }
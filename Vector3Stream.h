@@ -0,0 +1,472 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "BatchTransform.h"
+
+namespace Oblivion {
+namespace Math {
+    // Non-owning view of an existing Vector3 array. The bulk operations below read
+    // through it directly, deinterleaving eight vectors at a time in registers, so
+    // AoS data can be fed to them without first copying it into a stream.
+    struct Vector3ArrayView {
+        const Vector3* data;
+        size_t count;
+        size_t stride;
+
+        Vector3ArrayView(const Vector3* data, size_t count, size_t stride = sizeof(Vector3))
+            : data(data)
+            , count(count)
+            , stride(stride)
+        {
+        }
+    };
+
+    // Non-owning view of three component arrays.
+    struct Vector3StreamView {
+        const float* x;
+        const float* y;
+        const float* z;
+        size_t count;
+
+        Vector3StreamView(const float* x, const float* y, const float* z, size_t count)
+            : x(x)
+            , y(y)
+            , z(z)
+            , count(count)
+        {
+        }
+    };
+
+    // Structure-of-arrays Vector3 container. The x, y and z components live in
+    // separate 32-byte aligned blocks padded to a multiple of BlockSize, so the
+    // bulk operations can run a full AVX2 register per component.
+    class Vector3Stream {
+    public:
+        static const size_t BlockSize = 8;
+        static const size_t Alignment = 32;
+
+        Vector3Stream();
+        explicit Vector3Stream(size_t count);
+        explicit Vector3Stream(const Vector3ArrayView& v);
+        Vector3Stream(const Vector3Stream& s);
+        Vector3Stream(Vector3Stream&& s);
+        ~Vector3Stream();
+
+        Vector3Stream& operator=(const Vector3Stream& s);
+        Vector3Stream& operator=(Vector3Stream&& s);
+
+        size_t Size() const { return count; }
+        float* X() { return data; }
+        float* Y() { return data + capacity; }
+        float* Z() { return data + 2 * capacity; }
+        const float* X() const { return data; }
+        const float* Y() const { return data + capacity; }
+        const float* Z() const { return data + 2 * capacity; }
+
+        Vector3 Get(size_t i) const;
+        void Set(size_t i, const Vector3& v);
+
+        // Preserves the first min(Size(), count) elements; new elements are zero.
+        void Resize(size_t count);
+        void Assign(const Vector3ArrayView& v);
+        void CopyTo(Vector3* out, size_t stride = sizeof(Vector3)) const;
+
+        operator Vector3StreamView() const { return Vector3StreamView(X(), Y(), Z(), count); }
+
+    private:
+        float* data;
+        size_t count;
+        size_t capacity;
+    };
+
+    typedef Vector3Stream Vector3SoA;
+
+    namespace Detail {
+        struct SoAReader {
+            const float* x;
+            const float* y;
+            const float* z;
+            size_t count;
+
+            void Load(size_t i, float& vx, float& vy, float& vz) const
+            {
+                vx = x[i];
+                vy = y[i];
+                vz = z[i];
+            }
+
+#if USING_AVX2
+            void Load(size_t i, __m256& vx, __m256& vy, __m256& vz) const
+            {
+                vx = _mm256_loadu_ps(x + i);
+                vy = _mm256_loadu_ps(y + i);
+                vz = _mm256_loadu_ps(z + i);
+            }
+#endif
+        };
+
+        struct AoSReader {
+            const Vector3* data;
+            size_t stride;
+            size_t count;
+
+            void Load(size_t i, float& vx, float& vy, float& vz) const
+            {
+                const Vector3& v = StridedAt(data, i, stride);
+                vx = v.x;
+                vy = v.y;
+                vz = v.z;
+            }
+
+#if USING_AVX2
+            void Load(size_t i, __m256& vx, __m256& vy, __m256& vz) const
+            {
+                __m256 vw;
+                vx = _mm256_set_m128(LoadXYZ(StridedAt(data, i + 4, stride)), LoadXYZ(StridedAt(data, i + 0, stride)));
+                vy = _mm256_set_m128(LoadXYZ(StridedAt(data, i + 5, stride)), LoadXYZ(StridedAt(data, i + 1, stride)));
+                vz = _mm256_set_m128(LoadXYZ(StridedAt(data, i + 6, stride)), LoadXYZ(StridedAt(data, i + 2, stride)));
+                vw = _mm256_set_m128(LoadXYZ(StridedAt(data, i + 7, stride)), LoadXYZ(StridedAt(data, i + 3, stride)));
+                Transpose4InLanes(vx, vy, vz, vw);
+            }
+#endif
+        };
+
+        inline SoAReader StreamReader(const Vector3StreamView& v)
+        {
+            SoAReader r = { v.x, v.y, v.z, v.count };
+            return r;
+        }
+
+        inline SoAReader StreamReader(const Vector3Stream& s)
+        {
+            return StreamReader(static_cast<Vector3StreamView>(s));
+        }
+
+        inline AoSReader StreamReader(const Vector3ArrayView& v)
+        {
+            AoSReader r = { v.data, v.stride, v.count };
+            return r;
+        }
+
+        // Drivers: run op over blocks of eight with AVX2, then a scalar tail.
+        // Each op is a functor templated on the lane type (float or __m256).
+        template <typename A, typename B, typename Op>
+        void BinaryToVector(const A& a, const B& b, Vector3Stream& out, Op op)
+        {
+            assert(a.count == b.count);
+            out.Resize(a.count);
+            float* ox = out.X();
+            float* oy = out.Y();
+            float* oz = out.Z();
+            size_t i = 0;
+#if USING_AVX2
+            for (; i + 8 <= a.count; i += 8) {
+                __m256 ax, ay, az, bx, by, bz, rx, ry, rz;
+                a.Load(i, ax, ay, az);
+                b.Load(i, bx, by, bz);
+                op(ax, ay, az, bx, by, bz, rx, ry, rz);
+                _mm256_store_ps(ox + i, rx);
+                _mm256_store_ps(oy + i, ry);
+                _mm256_store_ps(oz + i, rz);
+            }
+#endif
+            for (; i < a.count; ++i) {
+                float ax, ay, az, bx, by, bz;
+                a.Load(i, ax, ay, az);
+                b.Load(i, bx, by, bz);
+                op(ax, ay, az, bx, by, bz, ox[i], oy[i], oz[i]);
+            }
+        }
+
+        template <typename A, typename B, typename Op>
+        void BinaryToScalar(const A& a, const B& b, float* out, Op op)
+        {
+            assert(a.count == b.count);
+            size_t i = 0;
+#if USING_AVX2
+            for (; i + 8 <= a.count; i += 8) {
+                __m256 ax, ay, az, bx, by, bz;
+                a.Load(i, ax, ay, az);
+                b.Load(i, bx, by, bz);
+                _mm256_storeu_ps(out + i, op(ax, ay, az, bx, by, bz));
+            }
+#endif
+            for (; i < a.count; ++i) {
+                float ax, ay, az, bx, by, bz;
+                a.Load(i, ax, ay, az);
+                b.Load(i, bx, by, bz);
+                out[i] = op(ax, ay, az, bx, by, bz);
+            }
+        }
+
+        struct AddOp {
+            template <typename F>
+            void operator()(F ax, F ay, F az, F bx, F by, F bz, F& rx, F& ry, F& rz) const
+            {
+                rx = Add(ax, bx);
+                ry = Add(ay, by);
+                rz = Add(az, bz);
+            }
+        };
+
+        struct SubtractOp {
+            template <typename F>
+            void operator()(F ax, F ay, F az, F bx, F by, F bz, F& rx, F& ry, F& rz) const
+            {
+                rx = Sub(ax, bx);
+                ry = Sub(ay, by);
+                rz = Sub(az, bz);
+            }
+        };
+
+        // Unary ops ignore their second operand; the stream is passed twice.
+        struct ScaleOp {
+            float s;
+
+            template <typename F>
+            void operator()(F ax, F ay, F az, F, F, F, F& rx, F& ry, F& rz) const
+            {
+                F sv = Broadcast(s, ax);
+                rx = Mul(ax, sv);
+                ry = Mul(ay, sv);
+                rz = Mul(az, sv);
+            }
+        };
+
+        struct CrossProductOp {
+            template <typename F>
+            void operator()(F ax, F ay, F az, F bx, F by, F bz, F& rx, F& ry, F& rz) const
+            {
+                rx = Sub(Mul(ay, bz), Mul(az, by));
+                ry = Sub(Mul(az, bx), Mul(ax, bz));
+                rz = Sub(Mul(ax, by), Mul(ay, bx));
+            }
+        };
+
+        struct NormalizeOp {
+            template <typename F>
+            void operator()(F ax, F ay, F az, F, F, F, F& rx, F& ry, F& rz) const
+            {
+                F len = Sqrt(MulAdd(az, az, MulAdd(ay, ay, Mul(ax, ax))));
+                rx = DivideIfPositive(ax, len);
+                ry = DivideIfPositive(ay, len);
+                rz = DivideIfPositive(az, len);
+            }
+        };
+
+        struct DotProductOp {
+            template <typename F>
+            F operator()(F ax, F ay, F az, F bx, F by, F bz) const
+            {
+                return MulAdd(az, bz, MulAdd(ay, by, Mul(ax, bx)));
+            }
+        };
+
+        struct MagnitudeOp {
+            template <typename F>
+            F operator()(F ax, F ay, F az, F, F, F) const
+            {
+                return Sqrt(MulAdd(az, az, MulAdd(ay, ay, Mul(ax, ax))));
+            }
+        };
+    } // end namespace Detail
+
+    /********************************************************************
+    // STREAM OPERATIONS
+    //
+    // Bulk counterparts of the Vector3 free functions. Inputs may be a
+    // Vector3Stream, a Vector3StreamView or a Vector3ArrayView and must
+    // have equal counts. Vector results are written to a stream (resized
+    // to fit, which may be one of the inputs); scalar results to an array
+    // of count floats.
+    ********************************************************************/
+    template <typename A, typename B>
+    inline auto Add(const A& a, const B& b, Vector3Stream& out) -> decltype(Detail::StreamReader(a), Detail::StreamReader(b), void())
+    {
+        Detail::BinaryToVector(Detail::StreamReader(a), Detail::StreamReader(b), out, Detail::AddOp());
+    }
+
+    template <typename A, typename B>
+    inline auto Subtract(const A& a, const B& b, Vector3Stream& out) -> decltype(Detail::StreamReader(a), Detail::StreamReader(b), void())
+    {
+        Detail::BinaryToVector(Detail::StreamReader(a), Detail::StreamReader(b), out, Detail::SubtractOp());
+    }
+
+    template <typename A>
+    inline auto Scale(const A& a, float s, Vector3Stream& out) -> decltype(Detail::StreamReader(a), void())
+    {
+        Detail::ScaleOp op = { s };
+        Detail::BinaryToVector(Detail::StreamReader(a), Detail::StreamReader(a), out, op);
+    }
+
+    template <typename A, typename B>
+    inline auto CrossProduct(const A& a, const B& b, Vector3Stream& out) -> decltype(Detail::StreamReader(a), Detail::StreamReader(b), void())
+    {
+        Detail::BinaryToVector(Detail::StreamReader(a), Detail::StreamReader(b), out, Detail::CrossProductOp());
+    }
+
+    // Zero-length vectors normalize to zero, as Normalize(Vector3&) does.
+    template <typename A>
+    inline auto Normalize(const A& a, Vector3Stream& out) -> decltype(Detail::StreamReader(a), void())
+    {
+        Detail::BinaryToVector(Detail::StreamReader(a), Detail::StreamReader(a), out, Detail::NormalizeOp());
+    }
+
+    template <typename A, typename B>
+    inline auto DotProduct(const A& a, const B& b, float* out) -> decltype(Detail::StreamReader(a), Detail::StreamReader(b), void())
+    {
+        Detail::BinaryToScalar(Detail::StreamReader(a), Detail::StreamReader(b), out, Detail::DotProductOp());
+    }
+
+    template <typename A>
+    inline auto Magnitude(const A& a, float* out) -> decltype(Detail::StreamReader(a), void())
+    {
+        Detail::BinaryToScalar(Detail::StreamReader(a), Detail::StreamReader(a), out, Detail::MagnitudeOp());
+    }
+
+    /********************************************************************
+    // VECTOR3STREAM MEMBER FUNCTIONS
+    ********************************************************************/
+    inline Vector3Stream::Vector3Stream()
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+    }
+
+    inline Vector3Stream::Vector3Stream(size_t count)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Resize(count);
+    }
+
+    inline Vector3Stream::Vector3Stream(const Vector3ArrayView& v)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        Assign(v);
+    }
+
+    inline Vector3Stream::Vector3Stream(const Vector3Stream& s)
+        : data(NULL)
+        , count(0)
+        , capacity(0)
+    {
+        *this = s;
+    }
+
+    inline Vector3Stream::Vector3Stream(Vector3Stream&& s)
+        : data(s.data)
+        , count(s.count)
+        , capacity(s.capacity)
+    {
+        s.data = NULL;
+        s.count = s.capacity = 0;
+    }
+
+    inline Vector3Stream::~Vector3Stream()
+    {
+        Detail::AlignedFree(data);
+    }
+
+    inline Vector3Stream& Vector3Stream::operator=(const Vector3Stream& s)
+    {
+        if (this != &s) {
+            Resize(s.count);
+            memcpy(X(), s.X(), sizeof(float) * count);
+            memcpy(Y(), s.Y(), sizeof(float) * count);
+            memcpy(Z(), s.Z(), sizeof(float) * count);
+        }
+        return *this;
+    }
+
+    inline Vector3Stream& Vector3Stream::operator=(Vector3Stream&& s)
+    {
+        if (this != &s) {
+            Detail::AlignedFree(data);
+            data = s.data;
+            count = s.count;
+            capacity = s.capacity;
+            s.data = NULL;
+            s.count = s.capacity = 0;
+        }
+        return *this;
+    }
+
+    inline Vector3 Vector3Stream::Get(size_t i) const
+    {
+        return Vector3(X()[i], Y()[i], Z()[i]);
+    }
+
+    inline void Vector3Stream::Set(size_t i, const Vector3& v)
+    {
+        X()[i] = v.x;
+        Y()[i] = v.y;
+        Z()[i] = v.z;
+    }
+
+    inline void Vector3Stream::Resize(size_t newCount)
+    {
+        if (newCount > capacity) {
+            size_t newCapacity = (newCount + BlockSize - 1) / BlockSize * BlockSize;
+            float* newData = static_cast<float*>(Detail::AlignedAlloc(sizeof(float) * 3 * newCapacity, Alignment));
+            assert(newData != NULL);
+            memset(newData, 0, sizeof(float) * 3 * newCapacity);
+
+            if (data != NULL) {
+                memcpy(newData, X(), sizeof(float) * count);
+                memcpy(newData + newCapacity, Y(), sizeof(float) * count);
+                memcpy(newData + 2 * newCapacity, Z(), sizeof(float) * count);
+                Detail::AlignedFree(data);
+            }
+
+            data = newData;
+            capacity = newCapacity;
+        } else if (newCount > count) {
+            memset(X() + count, 0, sizeof(float) * (newCount - count));
+            memset(Y() + count, 0, sizeof(float) * (newCount - count));
+            memset(Z() + count, 0, sizeof(float) * (newCount - count));
+        }
+
+        count = newCount;
+    }
+
+    inline void Vector3Stream::Assign(const Vector3ArrayView& v)
+    {
+        Resize(v.count);
+        Detail::AoSReader in = Detail::StreamReader(v);
+        float* x = X();
+        float* y = Y();
+        float* z = Z();
+        size_t i = 0;
+#if USING_AVX2
+        for (; i + 8 <= count; i += 8) {
+            __m256 vx, vy, vz;
+            in.Load(i, vx, vy, vz);
+            _mm256_store_ps(x + i, vx);
+            _mm256_store_ps(y + i, vy);
+            _mm256_store_ps(z + i, vz);
+        }
+#endif
+        for (; i < count; ++i) {
+            in.Load(i, x[i], y[i], z[i]);
+        }
+    }
+
+    inline void Vector3Stream::CopyTo(Vector3* out, size_t stride) const
+    {
+        for (size_t i = 0; i < count; ++i) {
+            Vector3& v = Detail::StridedAt(out, i, stride);
+            v.x = X()[i];
+            v.y = Y()[i];
+            v.z = Z()[i];
+        }
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -23,10 +23,10 @@ namespace Math {
         friend bool operator==(const Vector4& v, const Vector4& v1);
         friend bool operator!=(const Vector4& v, const Vector4& v1);
 
-		float Magnitude();
+		float Magnitude() const;
     };
 
-    Vector4::Vector4()
+    inline Vector4::Vector4()
         : x(0.0f)
         , y(0.0f)
         , z(0.0f)
@@ -34,7 +34,7 @@ namespace Math {
     {
     }
 
-    Vector4::Vector4(const float& x, const float& y, const float& z, const float& w)
+    inline Vector4::Vector4(const float& x, const float& y, const float& z, const float& w)
         : x(x)
         , y(y)
         , z(z)
@@ -42,7 +42,7 @@ namespace Math {
     {
     }
 
-    Vector4& operator+=(Vector4& v, const Vector4& v1)
+    inline Vector4& operator+=(Vector4& v, const Vector4& v1)
     {
         v.x += v1.x;
         v.y += v1.y;
@@ -52,7 +52,7 @@ namespace Math {
         return v;
     }
 
-    Vector4& operator-=(Vector4& v, const Vector4& v1)
+    inline Vector4& operator-=(Vector4& v, const Vector4& v1)
     {
         v.x -= v1.x;
         v.y -= v1.y;
@@ -62,7 +62,7 @@ namespace Math {
         return v;
     }
 
-    Vector4& operator*=(Vector4& v, const Vector4& v1)
+    inline Vector4& operator*=(Vector4& v, const Vector4& v1)
     {
         v.x *= v1.x;
         v.y *= v1.y;
@@ -72,7 +72,7 @@ namespace Math {
         return v;
     }
 
-    Vector4& operator/=(Vector4& v, const Vector4& v1)
+    inline Vector4& operator/=(Vector4& v, const Vector4& v1)
     {
         v.x /= v1.x;
         v.y /= v1.y;
@@ -82,42 +82,42 @@ namespace Math {
         return v;
     }
 
-    Vector4 operator+(const Vector4& v, const Vector4& v1)
+    inline Vector4 operator+(const Vector4& v, const Vector4& v1)
     {
         return Vector4(v.x + v1.x, v.y + v1.y, v.z + v1.z, v.w + v1.w);
     }
 
-    Vector4 operator-(const Vector4& v, const Vector4& v1)
+    inline Vector4 operator-(const Vector4& v, const Vector4& v1)
     {
         return Vector4(v.x - v1.x, v.y - v1.y, v.z - v1.z, v.w - v1.w);
     }
 
-    float operator*(const Vector4& v, const Vector4& v1)
+    inline float operator*(const Vector4& v, const Vector4& v1)
     {
         return (v.x * v1.x) + (v.y * v1.y) + (v.z * v1.z) + (v.w * v1.w);
     }
 
-    Vector4 operator*(const Vector4& v, const float scalar)
+    inline Vector4 operator*(const Vector4& v, const float scalar)
     {
         return Vector4(scalar * v.x, scalar * v.y, scalar * v.z, scalar * v.w);
     }
 
-    Vector4 operator^(const Vector4& v, const Vector4& v1)
+    inline Vector4 operator^(const Vector4& v, const Vector4& v1)
     {
         return Vector4(v.y * v1.z - v.z * v1.y, v.z * v1.x - v.x * v1.z, v.x * v1.y - v.y * v1.x, 0.0f);
     }
 
-    bool operator==(const Vector4& v, const Vector4& v1)
+    inline bool operator==(const Vector4& v, const Vector4& v1)
     {
         return (v.x == v1.x && v.y == v1.y && v.z == v1.z && v.w == v1.w);
     }
 
-    bool operator!=(const Vector4& v, const Vector4& v1)
+    inline bool operator!=(const Vector4& v, const Vector4& v1)
     {
         return (v.x != v1.x || v.y != v1.y || v.z != v1.z || v.w != v1.w);
     }
 
-    inline float Vector4::Magnitude()
+    inline float Vector4::Magnitude() const
     {
         return sqrtf((x * x) + (y * y) + (z * z) + (w * w));
     }
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "BatchTransform.h"
+#include "Vector3Stream.h"
+#include "Vector4.h"
+
+namespace Oblivion {
+namespace Math {
+    /********************************************************************
+    // LAZY VECTOR EXPRESSIONS
+    //
+    // Opt-in expression templates over Vector3 and Vector4. Lazy() wraps an
+    // operand; +, -, unary -, ^ (cross), * float and / float on wrapped
+    // operands build a tree of small nodes instead of temporaries, and the
+    // whole tree is evaluated in one pass when it is converted or stored:
+    //
+    //     Vector3 p1 = Lazy(p) + Lazy(v) * dt + Lazy(a) * (0.5f * dt * dt);
+    //     Evaluate(Lazy(a) + Lazy(b) * s, out);   // streams or arrays
+    //
+    // A plain Vector3 / Vector4 next to a wrapped operand joins the
+    // expression as a uniform value. Wrapped arrays (Vector3Stream, its
+    // views, Vector3ArrayView, Vector4 arrays) make an array expression,
+    // which Evaluate runs eight (AVX2) or four (SSE) elements at a time
+    // with a scalar tail and no intermediate buffers. All arrays in one
+    // expression must have the same count. The output may alias any input.
+    // Packed Vector3 arrays are split into components with shuffles; a
+    // purely component-wise expression over them (no ^) is one the compiler
+    // often vectorizes on its own, so streams are the better layout there.
+    //
+    // Each node applies the same float operation as the eager operator,
+    // so results match them up to FMA contraction by the compiler.
+    // Expressions hold pointers to array data and copies of uniform
+    // values; evaluate them before the arrays go away.
+    ********************************************************************/
+    template <typename E, int N>
+    struct VectorExpression;
+
+    // Uniform expressions convert to the vector type.
+    template <typename E>
+    struct VectorExpression<E, 3> {
+        const E& Self() const { return static_cast<const E&>(*this); }
+        operator Vector3() const;
+    };
+
+    template <typename E>
+    struct VectorExpression<E, 4> {
+        const E& Self() const { return static_cast<const E&>(*this); }
+        operator Vector4() const;
+    };
+
+    namespace Detail {
+        template <int N>
+        struct VectorOf;
+
+        template <>
+        struct VectorOf<3> {
+            typedef Vector3 Type;
+        };
+
+        template <>
+        struct VectorOf<4> {
+            typedef Vector4 Type;
+        };
+
+        // Elements are evaluated as N lane registers, one per component.
+        // Count() is 0 for uniform expressions.
+        template <int N>
+        struct UniformLeaf : VectorExpression<UniformLeaf<N>, N> {
+            static const bool IsArray = false;
+            float v[N];
+
+            explicit UniformLeaf(const Vector3& a)
+            {
+                const float c[4] = { a.x, a.y, a.z, 0.0f };
+                for (int k = 0; k < N; ++k)
+                    v[k] = c[k];
+            }
+
+            explicit UniformLeaf(const Vector4& a)
+            {
+                const float c[4] = { a.x, a.y, a.z, a.w };
+                for (int k = 0; k < N; ++k)
+                    v[k] = c[k];
+            }
+
+            size_t Count() const { return 0; }
+
+            template <typename F>
+            void Evaluate(size_t, F* r) const
+            {
+                for (int k = 0; k < N; ++k)
+                    r[k] = Broadcast(v[k], F());
+            }
+        };
+
+        struct StreamLeaf : VectorExpression<StreamLeaf, 3> {
+            static const bool IsArray = true;
+            const float* x;
+            const float* y;
+            const float* z;
+            size_t count;
+
+            explicit StreamLeaf(const Vector3StreamView& v)
+                : x(v.x)
+                , y(v.y)
+                , z(v.z)
+                , count(v.count)
+            {
+            }
+
+            size_t Count() const { return count; }
+
+            template <typename F>
+            void Evaluate(size_t i, F* r) const
+            {
+                r[0] = LoadLanes(x + i, F());
+                r[1] = LoadLanes(y + i, F());
+                r[2] = LoadLanes(z + i, F());
+            }
+        };
+
+        // One vector per lane of an AoS array, as x, y, z (and w) registers.
+        inline void LoadVectors(const Vector3* base, size_t i, size_t stride, float* r)
+        {
+            const Vector3& v = StridedAt(base, i, stride);
+            r[0] = v.x;
+            r[1] = v.y;
+            r[2] = v.z;
+        }
+
+        inline void LoadVectors(const Vector4* base, size_t i, size_t stride, float* r)
+        {
+            const Vector4& v = StridedAt(base, i, stride);
+            r[0] = v.x;
+            r[1] = v.y;
+            r[2] = v.z;
+            r[3] = v.w;
+        }
+
+        inline void StoreVectors(Vector3* base, size_t i, const float* r)
+        {
+            base[i] = Vector3(r[0], r[1], r[2]);
+        }
+
+        inline void StoreVectors(Vector4* base, size_t i, const float* r)
+        {
+            base[i] = Vector4(r[0], r[1], r[2], r[3]);
+        }
+
+#if USING_SSE
+        // Four packed Vector3 are three registers: (x0 y0 z0 x1) (y1 z1 x2 y2)
+        // (z2 x3 y3 z3). Five shuffles split them into x, y and z, and six
+        // pack them back, where gathering needs a load and a transpose per
+        // vector.
+        inline void Deinterleave3(__m128 m0, __m128 m1, __m128 m2, __m128* r)
+        {
+            __m128 xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+            __m128 yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+            r[0] = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            r[1] = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            r[2] = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline void Interleave3(const __m128* r, __m128& m0, __m128& m1, __m128& m2)
+        {
+            __m128 xy = _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 yz = _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 zx = _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 1, 2, 0));
+            m0 = _mm_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+            m1 = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            m2 = _mm_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        // Strided Vector3 and all Vector4: one load per vector and a
+        // transpose. w (r[3]) is only written for Vector4.
+        template <typename V>
+        inline void GatherVectors(const V* base, size_t i, size_t stride, __m128* r)
+        {
+            __m128 r0 = LoadXYZ(StridedAt(base, i, stride)), r1 = LoadXYZ(StridedAt(base, i + 1, stride));
+            __m128 r2 = LoadXYZ(StridedAt(base, i + 2, stride)), r3 = LoadXYZ(StridedAt(base, i + 3, stride));
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            const int N = sizeof(V) / sizeof(float);
+            r[0] = r0;
+            r[1] = r1;
+            r[2] = r2;
+            if (N == 4)
+                r[N - 1] = r3;
+        }
+
+        inline void LoadVectors(const Vector3* base, size_t i, size_t stride, __m128* r)
+        {
+            if (stride != sizeof(Vector3)) {
+                GatherVectors(base, i, stride, r);
+                return;
+            }
+            const float* p = &base[i].x;
+            Deinterleave3(_mm_loadu_ps(p), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), r);
+        }
+
+        inline void LoadVectors(const Vector4* base, size_t i, size_t stride, __m128* r)
+        {
+            GatherVectors(base, i, stride, r);
+        }
+
+        inline void StoreVectors(Vector3* base, size_t i, const __m128* r)
+        {
+            __m128 m0, m1, m2;
+            Interleave3(r, m0, m1, m2);
+            float* p = &base[i].x;
+            _mm_storeu_ps(p, m0);
+            _mm_storeu_ps(p + 4, m1);
+            _mm_storeu_ps(p + 8, m2);
+        }
+
+        inline void StoreVectors(Vector4* base, size_t i, const __m128* r)
+        {
+            __m128 r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(&base[i].x, r0);
+            _mm_storeu_ps(&base[i + 1].x, r1);
+            _mm_storeu_ps(&base[i + 2].x, r2);
+            _mm_storeu_ps(&base[i + 3].x, r3);
+        }
+#endif
+
+#if USING_AVX2
+        // The SSE versions in both 128-bit lanes at once: the low lane holds
+        // vectors i to i + 3 and the high lane i + 4 to i + 7.
+        inline void Deinterleave3(__m256 m0, __m256 m1, __m256 m2, __m256* r)
+        {
+            __m256 xy = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+            __m256 yz = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+            r[0] = _mm256_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+            r[1] = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            r[2] = _mm256_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+        }
+
+        inline void Interleave3(const __m256* r, __m256& m0, __m256& m1, __m256& m2)
+        {
+            __m256 xy = _mm256_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 yz = _mm256_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 zx = _mm256_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 1, 2, 0));
+            m0 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));
+            m1 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+            m2 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));
+        }
+
+        template <typename V>
+        inline void GatherVectors(const V* base, size_t i, size_t stride, __m256* r)
+        {
+            __m256 r0 = _mm256_set_m128(LoadXYZ(StridedAt(base, i + 4, stride)), LoadXYZ(StridedAt(base, i, stride)));
+            __m256 r1 = _mm256_set_m128(LoadXYZ(StridedAt(base, i + 5, stride)), LoadXYZ(StridedAt(base, i + 1, stride)));
+            __m256 r2 = _mm256_set_m128(LoadXYZ(StridedAt(base, i + 6, stride)), LoadXYZ(StridedAt(base, i + 2, stride)));
+            __m256 r3 = _mm256_set_m128(LoadXYZ(StridedAt(base, i + 7, stride)), LoadXYZ(StridedAt(base, i + 3, stride)));
+            Transpose4InLanes(r0, r1, r2, r3);
+            const int N = sizeof(V) / sizeof(float);
+            r[0] = r0;
+            r[1] = r1;
+            r[2] = r2;
+            if (N == 4)
+                r[N - 1] = r3;
+        }
+
+        inline void LoadVectors(const Vector3* base, size_t i, size_t stride, __m256* r)
+        {
+            if (stride != sizeof(Vector3)) {
+                GatherVectors(base, i, stride, r);
+                return;
+            }
+            const float* p = &base[i].x;
+            __m256 m0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 12), 1);
+            __m256 m1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+            __m256 m2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+            Deinterleave3(m0, m1, m2, r);
+        }
+
+        inline void LoadVectors(const Vector4* base, size_t i, size_t stride, __m256* r)
+        {
+            GatherVectors(base, i, stride, r);
+        }
+
+        inline void StoreVectors(Vector3* base, size_t i, const __m256* r)
+        {
+            __m256 m0, m1, m2;
+            Interleave3(r, m0, m1, m2);
+            float* p = &base[i].x;
+            _mm_storeu_ps(p, _mm256_castps256_ps128(m0));
+            _mm_storeu_ps(p + 4, _mm256_castps256_ps128(m1));
+            _mm_storeu_ps(p + 8, _mm256_castps256_ps128(m2));
+            _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m0, 1));
+            _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m1, 1));
+            _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m2, 1));
+        }
+
+        inline void StoreVectors(Vector4* base, size_t i, const __m256* r)
+        {
+            __m256 r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3];
+            Transpose4InLanes(r0, r1, r2, r3);
+            __m256 t[4] = { r0, r1, r2, r3 };
+            for (int k = 0; k < 4; ++k) {
+                _mm_storeu_ps(&base[i + k].x, _mm256_castps256_ps128(t[k]));
+                _mm_storeu_ps(&base[i + k + 4].x, _mm256_extractf128_ps(t[k], 1));
+            }
+        }
+#endif
+
+        template <typename V>
+        struct ArrayLeaf : VectorExpression<ArrayLeaf<V>, sizeof(V) / sizeof(float)> {
+            static const bool IsArray = true;
+            const V* data;
+            size_t count;
+            size_t stride;
+
+            ArrayLeaf(const V* data, size_t count, size_t stride)
+                : data(data)
+                , count(count)
+                , stride(stride)
+            {
+            }
+
+            size_t Count() const { return count; }
+
+            template <typename F>
+            void Evaluate(size_t i, F* r) const
+            {
+                LoadVectors(data, i, stride, r);
+            }
+        };
+
+        struct AddNode {
+            template <int N, typename F>
+            static void Apply(const F* a, const F* b, F* r)
+            {
+                for (int k = 0; k < N; ++k)
+                    r[k] = Add(a[k], b[k]);
+            }
+        };
+
+        struct SubtractNode {
+            template <int N, typename F>
+            static void Apply(const F* a, const F* b, F* r)
+            {
+                for (int k = 0; k < N; ++k)
+                    r[k] = Sub(a[k], b[k]);
+            }
+        };
+
+        // As operator^: w is 0 for Vector4.
+        struct CrossNode {
+            template <int N, typename F>
+            static void Apply(const F* a, const F* b, F* r)
+            {
+                r[0] = Sub(Mul(a[1], b[2]), Mul(a[2], b[1]));
+                r[1] = Sub(Mul(a[2], b[0]), Mul(a[0], b[2]));
+                r[2] = Sub(Mul(a[0], b[1]), Mul(a[1], b[0]));
+                if (N == 4)
+                    r[N - 1] = Broadcast(0.0f, a[0]);
+            }
+        };
+
+        template <typename A, typename B, typename Op, int N>
+        struct BinaryExpression : VectorExpression<BinaryExpression<A, B, Op, N>, N> {
+            static const bool IsArray = A::IsArray || B::IsArray;
+            A a;
+            B b;
+
+            BinaryExpression(const A& a, const B& b)
+                : a(a)
+                , b(b)
+            {
+                assert(!A::IsArray || !B::IsArray || a.Count() == b.Count());
+            }
+
+            size_t Count() const { return A::IsArray ? a.Count() : b.Count(); }
+
+            template <typename F>
+            void Evaluate(size_t i, F* r) const
+            {
+                F ra[N], rb[N];
+                a.Evaluate(i, ra);
+                b.Evaluate(i, rb);
+                Op::template Apply<N>(ra, rb, r);
+            }
+        };
+
+        // Every component times (or divided by) a uniform scalar.
+        template <typename A, bool Divide, int N>
+        struct ScalarExpression : VectorExpression<ScalarExpression<A, Divide, N>, N> {
+            static const bool IsArray = A::IsArray;
+            A a;
+            float s;
+
+            ScalarExpression(const A& a, float s)
+                : a(a)
+                , s(s)
+            {
+            }
+
+            size_t Count() const { return a.Count(); }
+
+            template <typename F>
+            void Evaluate(size_t i, F* r) const
+            {
+                a.Evaluate(i, r);
+                F scalar = Broadcast(s, r[0]);
+                for (int k = 0; k < N; ++k)
+                    r[k] = Divide ? Div(r[k], scalar) : Mul(scalar, r[k]);
+            }
+        };
+
+        template <typename A, int N>
+        struct NegateExpression : VectorExpression<NegateExpression<A, N>, N> {
+            static const bool IsArray = A::IsArray;
+            A a;
+
+            explicit NegateExpression(const A& a)
+                : a(a)
+            {
+            }
+
+            size_t Count() const { return a.Count(); }
+
+            template <typename F>
+            void Evaluate(size_t i, F* r) const
+            {
+                a.Evaluate(i, r);
+                for (int k = 0; k < N; ++k)
+                    r[k] = Sub(Broadcast(0.0f, r[k]), r[k]);
+            }
+        };
+
+        // Evaluates e into an SoA stream or an AoS array, element by element.
+        template <typename E, typename Out>
+        struct EvaluateKernel {
+            const E& e;
+            Out out;
+
+            template <typename F>
+            void operator()(size_t i, F) const
+            {
+                F r[4];
+                e.Evaluate(i, r);
+                Store(out, i, r);
+            }
+
+            template <typename F>
+            static void Store(float* const* xyz, size_t i, const F* r)
+            {
+                StoreLanes(xyz[0] + i, r[0]);
+                StoreLanes(xyz[1] + i, r[1]);
+                StoreLanes(xyz[2] + i, r[2]);
+            }
+
+            template <typename V, typename F>
+            static void Store(V* base, size_t i, const F* r)
+            {
+                StoreVectors(base, i, r);
+            }
+        };
+    } // end namespace Detail
+
+    inline Detail::UniformLeaf<3> Lazy(const Vector3& v) { return Detail::UniformLeaf<3>(v); }
+    inline Detail::UniformLeaf<4> Lazy(const Vector4& v) { return Detail::UniformLeaf<4>(v); }
+    inline Detail::StreamLeaf Lazy(const Vector3StreamView& v) { return Detail::StreamLeaf(v); }
+    inline Detail::StreamLeaf Lazy(const Vector3Stream& s) { return Detail::StreamLeaf(s); }
+    inline Detail::ArrayLeaf<Vector3> Lazy(const Vector3ArrayView& v) { return Detail::ArrayLeaf<Vector3>(v.data, v.count, v.stride); }
+    inline Detail::ArrayLeaf<Vector4> Lazy(const Vector4* data, size_t count, size_t stride = sizeof(Vector4)) { return Detail::ArrayLeaf<Vector4>(data, count, stride); }
+
+    template <typename A, typename B, int N>
+    inline Detail::BinaryExpression<A, B, Detail::AddNode, N> operator+(const VectorExpression<A, N>& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::BinaryExpression<A, B, Detail::AddNode, N>(a.Self(), b.Self());
+    }
+
+    template <typename A, int N>
+    inline Detail::BinaryExpression<A, Detail::UniformLeaf<N>, Detail::AddNode, N> operator+(const VectorExpression<A, N>& a, const typename Detail::VectorOf<N>::Type& b)
+    {
+        return a + Detail::UniformLeaf<N>(b);
+    }
+
+    template <typename B, int N>
+    inline Detail::BinaryExpression<Detail::UniformLeaf<N>, B, Detail::AddNode, N> operator+(const typename Detail::VectorOf<N>::Type& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::UniformLeaf<N>(a) + b;
+    }
+
+    template <typename A, typename B, int N>
+    inline Detail::BinaryExpression<A, B, Detail::SubtractNode, N> operator-(const VectorExpression<A, N>& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::BinaryExpression<A, B, Detail::SubtractNode, N>(a.Self(), b.Self());
+    }
+
+    template <typename A, int N>
+    inline Detail::BinaryExpression<A, Detail::UniformLeaf<N>, Detail::SubtractNode, N> operator-(const VectorExpression<A, N>& a, const typename Detail::VectorOf<N>::Type& b)
+    {
+        return a - Detail::UniformLeaf<N>(b);
+    }
+
+    template <typename B, int N>
+    inline Detail::BinaryExpression<Detail::UniformLeaf<N>, B, Detail::SubtractNode, N> operator-(const typename Detail::VectorOf<N>::Type& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::UniformLeaf<N>(a) - b;
+    }
+
+    template <typename A, typename B, int N>
+    inline Detail::BinaryExpression<A, B, Detail::CrossNode, N> operator^(const VectorExpression<A, N>& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::BinaryExpression<A, B, Detail::CrossNode, N>(a.Self(), b.Self());
+    }
+
+    template <typename A, int N>
+    inline Detail::BinaryExpression<A, Detail::UniformLeaf<N>, Detail::CrossNode, N> operator^(const VectorExpression<A, N>& a, const typename Detail::VectorOf<N>::Type& b)
+    {
+        return a ^ Detail::UniformLeaf<N>(b);
+    }
+
+    template <typename B, int N>
+    inline Detail::BinaryExpression<Detail::UniformLeaf<N>, B, Detail::CrossNode, N> operator^(const typename Detail::VectorOf<N>::Type& a, const VectorExpression<B, N>& b)
+    {
+        return Detail::UniformLeaf<N>(a) ^ b;
+    }
+
+    template <typename A, int N>
+    inline Detail::ScalarExpression<A, false, N> operator*(const VectorExpression<A, N>& a, float s)
+    {
+        return Detail::ScalarExpression<A, false, N>(a.Self(), s);
+    }
+
+    template <typename A, int N>
+    inline Detail::ScalarExpression<A, false, N> operator*(float s, const VectorExpression<A, N>& a)
+    {
+        return Detail::ScalarExpression<A, false, N>(a.Self(), s);
+    }
+
+    template <typename A, int N>
+    inline Detail::ScalarExpression<A, true, N> operator/(const VectorExpression<A, N>& a, float s)
+    {
+        return Detail::ScalarExpression<A, true, N>(a.Self(), s);
+    }
+
+    template <typename A, int N>
+    inline Detail::NegateExpression<A, N> operator-(const VectorExpression<A, N>& a)
+    {
+        return Detail::NegateExpression<A, N>(a.Self());
+    }
+
+    template <typename E>
+    inline VectorExpression<E, 3>::operator Vector3() const
+    {
+        static_assert(!E::IsArray, "array expressions are stored with Evaluate");
+        float r[4];
+        Self().Evaluate(0, r);
+        return Vector3(r[0], r[1], r[2]);
+    }
+
+    template <typename E>
+    inline VectorExpression<E, 4>::operator Vector4() const
+    {
+        static_assert(!E::IsArray, "array expressions are stored with Evaluate");
+        float r[4];
+        Self().Evaluate(0, r);
+        return Vector4(r[0], r[1], r[2], r[3]);
+    }
+
+    // Stores the Count() elements of an array expression to out, which is
+    // resized to match.
+    template <typename E>
+    inline void Evaluate(const VectorExpression<E, 3>& e, Vector3Stream& out)
+    {
+        static_assert(E::IsArray, "uniform expressions convert to Vector3");
+        out.Resize(e.Self().Count());
+        float* xyz[3] = { out.X(), out.Y(), out.Z() };
+        Detail::EvaluateKernel<E, float* const*> kernel = { e.Self(), xyz };
+        Detail::ForEachLanes(out.Size(), kernel);
+    }
+
+    // Stores the Count() elements of an array expression to out[0 .. Count()).
+    template <typename E>
+    inline void Evaluate(const VectorExpression<E, 3>& e, Vector3* out)
+    {
+        static_assert(E::IsArray, "uniform expressions convert to Vector3");
+        Detail::EvaluateKernel<E, Vector3*> kernel = { e.Self(), out };
+        Detail::ForEachLanes(e.Self().Count(), kernel);
+    }
+
+    template <typename E>
+    inline void Evaluate(const VectorExpression<E, 4>& e, Vector4* out)
+    {
+        static_assert(E::IsArray, "uniform expressions convert to Vector4");
+        Detail::EvaluateKernel<E, Vector4*> kernel = { e.Self(), out };
+        Detail::ForEachLanes(e.Self().Count(), kernel);
+    }
+} // end namespace Math
+} // end namespace Oblivion
@@ -0,0 +1,1216 @@
+// Microbenchmarks for every math kernel.
+//
+// Each case is run over batches of 1 to --max-batch elements (powers of ten)
+// and reported as ns/op, ops/sec and bytes/sec (input + output footprint).
+// Results are written as JSON so runs from different commits can be diffed.
+//
+// Usage: mathlib_bench [--max-batch N] [--max-bytes N] [--min-time-ms T]
+//                      [--filter SUBSTRING] [--out FILE]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "3DParametric.h"
+#include "AABB.h"
+#include "AABB2D.h"
+#include "Affine2D.h"
+#include "BVH.h"
+#include "BatchTransform.h"
+#include "EulerAngle.h"
+#include "Frustum.h"
+#include "LargeWorld.h"
+#include "Mat3x3Stream.h"
+#include "MathCommon.h"
+#include "MatrixTransform.h"
+#include "OBB.h"
+#include "QuaternionStream.h"
+#include "RotationMatrix.h"
+#include "Skinning.h"
+#include "Sphere.h"
+#include "Transform.h"
+#include "TransformHierarchy.h"
+#include "Vector3Stream.h"
+#include "VectorExpression.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifndef MATHLIB_REVISION
+#define MATHLIB_REVISION "unknown"
+#endif
+
+using namespace Oblivion::Math;
+
+namespace {
+    struct Options {
+        size_t maxBatch;
+        size_t maxBytes;
+        double minTimeMs;
+        const char* filter;
+        const char* out;
+    };
+
+    struct Result {
+        std::string name;
+        size_t batch;
+        uint64_t iterations;
+        double nsPerOp;
+        double opsPerSec;
+        double bytesPerSec;
+    };
+
+    // A kernel processes one whole batch per call. Case::make allocates the
+    // data for a batch size and returns a kernel that owns it.
+    typedef std::function<void()> Kernel;
+
+    struct Case {
+        std::string name;
+        size_t bytesPerOp;
+        std::function<Kernel(size_t)> make;
+    };
+
+    // Forces the compiler to assume all memory was read and written, so
+    // results stored by a kernel cannot be discarded.
+    inline void ClobberMemory()
+    {
+#if defined(_MSC_VER)
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    float RandomFloat(float lo = -1.0f, float hi = 1.0f)
+    {
+        return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+    }
+
+    void Fill(float& f) { f = RandomFloat(-4.0f, 4.0f); }
+    void Fill(Vector2D& v) { v = Vector2D(RandomFloat(), RandomFloat()); }
+    void Fill(Vector3& v) { v = Vector3(RandomFloat(), RandomFloat(), RandomFloat()); }
+    void Fill(Vector4& v) { v = Vector4(RandomFloat(), RandomFloat(), RandomFloat(), 1.0f); }
+    template <int N, typename T>
+    void Fill(Vector<N, T>& v)
+    {
+        for (int i = 0; i < N; ++i)
+            v[i] = T(RandomFloat());
+    }
+
+    template <int R, int C, typename T>
+    void Fill(Matrix<R, C, T>& m)
+    {
+        for (int i = 0; i < R; ++i)
+            for (int j = 0; j < C; ++j)
+                m[i][j] = T(RandomFloat() + (i == j ? 3.0f : 0.0f));
+    }
+
+    void Fill(Mat2x2& m) { m = Mat2x2(RandomFloat(2.0f, 3.0f), RandomFloat(), RandomFloat(), RandomFloat(2.0f, 3.0f)); }
+    void Fill(AABB2D& b) { b = AABB2D::FromCenterExtents(Vector2D(RandomFloat(-8.0f, 8.0f), RandomFloat(-8.0f, 8.0f)), Vector2D(RandomFloat(0.1f, 2.0f), RandomFloat(0.1f, 2.0f))); }
+
+    void Fill(Mat3x3<float>& m)
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                m[i][j] = RandomFloat() + (i == j ? 3.0f : 0.0f);
+    }
+
+    void Fill(Matrix44& m)
+    {
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = RandomFloat() + (i == j ? 3.0f : 0.0f);
+    }
+
+    void Fill(Quaternion<float>& q)
+    {
+        q.w = RandomFloat();
+        Fill(q.v);
+    }
+
+    void Fill(Transform& t)
+    {
+        Vector3 v(RandomFloat(), RandomFloat(), RandomFloat());
+        float w = RandomFloat(), length = sqrtf(w * w + v.x * v.x + v.y * v.y + v.z * v.z);
+        t = Transform(Quaternion<float>(w / length, Vector3D<float>(v.x / length, v.y / length, v.z / length)), v * 4.0f, RandomFloat(0.5f, 2.0f));
+    }
+
+    void Fill(AABB& b)
+    {
+        Vector3 c(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+        b = AABB::FromCenterExtents(c, Vector3(RandomFloat(0.1f, 2.0f), RandomFloat(0.1f, 2.0f), RandomFloat(0.1f, 2.0f)));
+    }
+
+    void Fill(OBB& b)
+    {
+        Quaternion<float> q(RandomFloat(), Vector3D<float>(RandomFloat(), RandomFloat(), RandomFloat()));
+        q = q * (1.0f / sqrtf(q.DotProduct(q, q)));
+        Vector3 c(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+        b = OBB(c, q.ToMat3x3(), Vector3(RandomFloat(0.1f, 2.0f), RandomFloat(0.1f, 2.0f), RandomFloat(0.1f, 2.0f)));
+    }
+
+    template <typename T>
+    std::shared_ptr<std::vector<T> > RandomArray(size_t count)
+    {
+        std::shared_ptr<std::vector<T> > data = std::make_shared<std::vector<T> >(count);
+        for (size_t i = 0; i < count; ++i)
+            Fill((*data)[i]);
+        return data;
+    }
+
+    // r[i] = fn(a[i])
+    template <typename A, typename R, typename Fn>
+    Case Unary(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = sizeof(A) + sizeof(R);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<std::vector<A> > a = RandomArray<A>(n);
+            std::shared_ptr<std::vector<R> > r = std::make_shared<std::vector<R> >(n);
+            return [fn, a, r, n]() {
+                const A* pa = a->data();
+                R* pr = r->data();
+                for (size_t i = 0; i < n; ++i)
+                    pr[i] = fn(pa[i]);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // r[i] = fn(a[i], b[i])
+    template <typename A, typename B, typename R, typename Fn>
+    Case Binary(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = sizeof(A) + sizeof(B) + sizeof(R);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<std::vector<A> > a = RandomArray<A>(n);
+            std::shared_ptr<std::vector<B> > b = RandomArray<B>(n);
+            std::shared_ptr<std::vector<R> > r = std::make_shared<std::vector<R> >(n);
+            return [fn, a, b, r, n]() {
+                const A* pa = a->data();
+                const B* pb = b->data();
+                R* pr = r->data();
+                for (size_t i = 0; i < n; ++i)
+                    pr[i] = fn(pa[i], pb[i]);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // One call of fn(in, out, n) over whole arrays, for the batch APIs.
+    template <typename A, typename R, typename Fn>
+    Case Batch(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = sizeof(A) + sizeof(R);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<std::vector<A> > a = RandomArray<A>(n);
+            std::shared_ptr<std::vector<R> > r = std::make_shared<std::vector<R> >(n);
+            return [fn, a, r, n]() {
+                fn(a->data(), r->data(), n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Vector3Stream operations: fn(a, b, out) over streams of n elements.
+    template <typename Fn>
+    Case Stream(const char* name, size_t bytesPerOp, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = bytesPerOp;
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<std::vector<Vector3> > aos = RandomArray<Vector3>(n);
+            std::shared_ptr<Vector3Stream> a = std::make_shared<Vector3Stream>(Vector3ArrayView(aos->data(), n));
+            std::shared_ptr<Vector3Stream> b = std::make_shared<Vector3Stream>(Vector3ArrayView(aos->data(), n));
+            std::shared_ptr<Vector3Stream> out = std::make_shared<Vector3Stream>(n);
+            std::shared_ptr<std::vector<float> > scalars = std::make_shared<std::vector<float> >(n + 1);
+            return [fn, aos, a, b, out, scalars, n]() {
+                fn(*aos, *a, *b, *out, scalars->data(), n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Quaternion blends: fn(data) over n unit quaternion pairs, in both layouts.
+    struct BlendData {
+        std::vector<Quaternion<float> > aosA, aosB, aosOut;
+        QuaternionStream a, b, out;
+        std::vector<float> t;
+    };
+
+    template <typename Fn>
+    Case Blend(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 13 * sizeof(float);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<BlendData> data = std::make_shared<BlendData>();
+            for (size_t i = 0; i < n; ++i) {
+                Quaternion<float> q[2];
+                for (int k = 0; k < 2; ++k) {
+                    Fill(q[k]);
+                    q[k] = q[k] * (1.0f / sqrtf(q[k].DotProduct(q[k], q[k])));
+                }
+                data->aosA.push_back(q[0]);
+                data->aosB.push_back(q[1]);
+                data->t.push_back(RandomFloat(0.0f, 1.0f));
+            }
+            data->aosOut.resize(n);
+            data->a.Assign(data->aosA.data(), n);
+            data->b.Assign(data->aosB.data(), n);
+            data->out.Resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Orientations: fn(data, n) over n unit quaternions, their matrices
+    // and one point each.
+    struct OrientationData {
+        std::vector<Quaternion<float> > aos, aosOut;
+        std::vector<Matrix44> matrices;
+        std::vector<Mat3x3<float> > mat3x3;
+        std::vector<EulerAngles<float> > euler;
+        std::vector<RotationMatrix<float> > rotations;
+        QuaternionStream q, out;
+        Vector3Stream points, rotated, angles;
+    };
+
+    template <typename Fn>
+    Case Orientations(const char* name, size_t bytesPerOp, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = bytesPerOp;
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<OrientationData> data = std::make_shared<OrientationData>();
+            data->points.Resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                Quaternion<float> q;
+                Fill(q);
+                q = q * (1.0f / sqrtf(q.DotProduct(q, q)));
+                data->aos.push_back(q);
+                data->matrices.push_back(q.ToMatrix44());
+                data->mat3x3.push_back(q.ToMat3x3());
+                data->rotations.push_back(RotationMatrix<float>(q));
+                Vector3 v;
+                Fill(v);
+                data->points.Set(i, v);
+            }
+            data->aosOut.resize(n);
+            data->q.Assign(data->aos.data(), n);
+            QuaternionToEulerMany(data->q, EulerOrder::ZYX, data->angles);
+            for (size_t i = 0; i < n; ++i) {
+                Vector3 e = data->angles.Get(i);
+                data->euler.push_back(EulerAngles<float>(e.x, e.y, e.z, EulerOrder::ZYX));
+            }
+            data->out.Resize(n);
+            data->rotated.Resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Frustum culling: fn(data, n) over n boxes / spheres, about half visible.
+    struct CullData {
+        Frustum frustum;
+        std::vector<float> minX, minY, minZ, maxX, maxY, maxZ, radius;
+        std::vector<uint32_t> visible;
+
+        AABBStreamView Boxes() const { return AABBStreamView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), minX.size()); }
+        SphereStreamView Spheres() const { return SphereStreamView(minX.data(), minY.data(), minZ.data(), radius.data(), minX.size()); }
+    };
+
+    template <typename Fn>
+    Case Cull(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 6 * sizeof(float) + sizeof(uint32_t);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<CullData> data = std::make_shared<CullData>();
+            data->frustum = Frustum::FromMatrix(Perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f));
+            for (size_t i = 0; i < n; ++i) {
+                Vector3 center(RandomFloat(-60.0f, 60.0f), RandomFloat(-40.0f, 40.0f), RandomFloat(-100.0f, 20.0f));
+                float extent = RandomFloat(0.1f, 2.0f);
+                data->minX.push_back(center.x - extent);
+                data->minY.push_back(center.y - extent);
+                data->minZ.push_back(center.z - extent);
+                data->maxX.push_back(center.x + extent);
+                data->maxY.push_back(center.y + extent);
+                data->maxZ.push_back(center.z + extent);
+                data->radius.push_back(extent);
+            }
+            data->visible.resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Batch 3x3 inverses: fn(data, n) over n general matrices, in both
+    // layouts, and n world matrices for normal matrices.
+    struct InverseData {
+        std::vector<Mat3x3<float> > aos, aosOut;
+        Mat3x3Stream soa, soaOut;
+        std::vector<Matrix44> world;
+        Vector3Stream b, x;
+        std::vector<uint8_t> singular;
+    };
+
+    template <typename Fn>
+    Case Inverses(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 2 * sizeof(Mat3x3<float>) + sizeof(uint8_t);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<InverseData> data = std::make_shared<InverseData>();
+            data->aos = *RandomArray<Mat3x3<float> >(n);
+            data->aosOut.resize(n);
+            data->soa.Assign(data->aos.data(), n);
+            data->world = *RandomArray<Matrix44>(n);
+            data->b = Vector3Stream(Vector3ArrayView(RandomArray<Vector3>(n)->data(), n));
+            data->singular.resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Oriented boxes: fn(data, n) over n boxes, in both layouts, and a query
+    // overlapping a few percent of them.
+    struct OBBData {
+        OBB query;
+        std::vector<OBB> aos;
+        Vector3Stream center, axes[3], extents;
+        std::vector<uint32_t> hits;
+
+        OBBStreamView Boxes() const { return OBBStreamView(center, axes[0], axes[1], axes[2], extents); }
+    };
+
+    template <typename Fn>
+    Case OrientedBoxes(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = sizeof(OBB) + 15 * sizeof(float) + sizeof(uint32_t);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<OBBData> data = std::make_shared<OBBData>();
+            data->aos = *RandomArray<OBB>(n);
+            data->query = OBB(Vector3(0.0f, 0.0f, 0.0f), Quaternion<float>(0.8f, Vector3D<float>(0.6f, 0.0f, 0.0f)).ToMat3x3(), Vector3(4.0f, 2.0f, 1.0f));
+            data->center.Resize(n);
+            data->extents.Resize(n);
+            for (int k = 0; k < 3; ++k)
+                data->axes[k].Resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                const OBB& b = data->aos[i];
+                data->center.Set(i, b.center);
+                data->extents.Set(i, b.extents);
+                for (int k = 0; k < 3; ++k)
+                    data->axes[k].Set(i, Vector3(b.axes[k][0], b.axes[k][1], b.axes[k][2]));
+            }
+            data->hits.resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Ray kernels: fn(data, n) with n triangles / spheres / boxes and n rays.
+    struct RayData {
+        Ray ray;
+        std::vector<Vector3> v0, v1, v2, origins, directions;
+        std::vector<float> x[3], y[3], z[3], radius, rayX[2], rayY[2], rayZ[2], t;
+
+        TriangleStreamView Triangles() const
+        {
+            return TriangleStreamView(Vector3StreamView(x[0].data(), y[0].data(), z[0].data(), t.size()), Vector3StreamView(x[1].data(), y[1].data(), z[1].data(), t.size()),
+                Vector3StreamView(x[2].data(), y[2].data(), z[2].data(), t.size()));
+        }
+        SphereStreamView Spheres() const { return SphereStreamView(x[0].data(), y[0].data(), z[0].data(), radius.data(), t.size()); }
+        AABBStreamView Boxes() const { return AABBStreamView(x[0].data(), y[0].data(), z[0].data(), x[1].data(), y[1].data(), z[1].data(), t.size()); }
+        RayStreamView Rays() const { return RayStreamView(rayX[0].data(), rayY[0].data(), rayZ[0].data(), rayX[1].data(), rayY[1].data(), rayZ[1].data(), t.size()); }
+    };
+
+    template <typename Fn>
+    Case Rays(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 9 * sizeof(float) + sizeof(float);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<RayData> data = std::make_shared<RayData>();
+            data->ray = Ray(Vector3(0.0f, 0.0f, -20.0f), Vector3(0.01f, -0.02f, 1.0f));
+            for (size_t i = 0; i < n; ++i) {
+                // Primitives around the ray, so about a third are hit. For
+                // boxes, corner 0 is the minimum and corner 1 the maximum.
+                Vector3 center(RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f), RandomFloat(-10.0f, 30.0f));
+                Vector3 corner[3] = { center + Vector3(RandomFloat(-2.0f, 0.0f), RandomFloat(-2.0f, 0.0f), RandomFloat(-2.0f, 0.0f)),
+                    center + Vector3(RandomFloat(0.0f, 2.0f), RandomFloat(0.0f, 2.0f), RandomFloat(0.0f, 2.0f)),
+                    center + Vector3(RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f), RandomFloat(-2.0f, 2.0f)) };
+                data->v0.push_back(corner[0]);
+                data->v1.push_back(corner[1]);
+                data->v2.push_back(corner[2]);
+                for (int k = 0; k < 3; ++k) {
+                    data->x[k].push_back(corner[k].x);
+                    data->y[k].push_back(corner[k].y);
+                    data->z[k].push_back(corner[k].z);
+                }
+                data->radius.push_back(RandomFloat(0.1f, 1.5f));
+                Vector3 origin(RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f), RandomFloat(-10.0f, 10.0f));
+                Vector3 direction = Vector3(RandomFloat(-0.5f, 0.5f), RandomFloat(-0.5f, 0.5f), RandomFloat(-0.5f, 0.5f)) - origin * 0.1f;
+                data->origins.push_back(origin);
+                data->directions.push_back(direction);
+                data->rayX[0].push_back(origin.x);
+                data->rayY[0].push_back(origin.y);
+                data->rayZ[0].push_back(origin.z);
+                data->rayX[1].push_back(direction.x);
+                data->rayY[1].push_back(direction.y);
+                data->rayZ[1].push_back(direction.z);
+            }
+            data->t.resize(n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Transform hierarchies: fn(hierarchy, out, n) over n nodes in trees of
+    // about 100, each parent a few nodes before its children.
+    template <typename Fn>
+    Case Hierarchy(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 2 * sizeof(Matrix44);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<TransformHierarchy> h = std::make_shared<TransformHierarchy>();
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t parent = i % 100 == 0 ? (uint32_t)TransformHierarchy::NoParent : (uint32_t)(i - 1 - (i * 7919) % std::min<size_t>(i % 100, 4));
+                Quaternion<float> q;
+                Fill(q);
+                q = q * (1.0f / sqrtf(q.DotProduct(q, q)));
+                Vector3 t;
+                Fill(t);
+                h->Add(parent, q, t);
+            }
+            h->Update();
+            std::shared_ptr<std::vector<Matrix44> > out = std::make_shared<std::vector<Matrix44> >(n);
+            return [fn, h, out, n]() {
+                fn(*h, out->data(), n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // Skinning: fn(data, n) over n vertices with four bones each from a
+    // palette of 64.
+    struct SkinData {
+        std::vector<DualQuaternion<float> > dualQuaternions;
+        std::vector<Matrix44> matrices;
+        std::vector<uint16_t> bones[4];
+        std::vector<float> weights[4];
+        Vector3Stream positions, normals, outPositions, outNormals;
+
+        SkinWeightsView Weights() const
+        {
+            const uint16_t* b[4] = { bones[0].data(), bones[1].data(), bones[2].data(), bones[3].data() };
+            const float* w[4] = { weights[0].data(), weights[1].data(), weights[2].data(), weights[3].data() };
+            return SkinWeightsView(b, w, positions.Size());
+        }
+    };
+
+    template <typename Fn>
+    Case Skin(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = 4 * (sizeof(uint16_t) + sizeof(float)) + 4 * sizeof(Vector3);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<SkinData> data = std::make_shared<SkinData>();
+            for (int b = 0; b < 64; ++b) {
+                Quaternion<float> q;
+                Fill(q);
+                Vector3D<float> t;
+                Fill(t);
+                data->dualQuaternions.push_back(DualQuaternion<float>(q * (1.0f / sqrtf(q.DotProduct(q, q))), t));
+                data->matrices.push_back(data->dualQuaternions.back().ToMatrix44());
+            }
+            data->positions.Resize(n);
+            data->normals.Resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                for (int k = 0; k < 4; ++k) {
+                    data->bones[k].push_back((uint16_t)(rand() % 64));
+                    data->weights[k].push_back(k == 0 ? 0.4f : 0.2f);
+                }
+                Vector3 v;
+                Fill(v);
+                data->positions.Set(i, v);
+                Fill(v);
+                data->normals.Set(i, v);
+            }
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    // BVH: fn(data, n) over a tree of n boxes, with n rays crossing it.
+    struct SceneData {
+        std::vector<AABB> boxes;
+        std::vector<Vector3> origins, directions;
+        std::vector<float> t;
+        BVH bvh;
+    };
+
+    template <typename Fn>
+    Case Scene(const char* name, Fn fn)
+    {
+        Case c;
+        c.name = name;
+        c.bytesPerOp = sizeof(AABB) + 2 * sizeof(Vector3) + sizeof(float);
+        c.make = [fn](size_t n) -> Kernel {
+            std::shared_ptr<SceneData> data = std::make_shared<SceneData>();
+            // About one box per 16 cubic units, whatever n.
+            float half = 0.5f * cbrtf(16.0f * n);
+            for (size_t i = 0; i < n; ++i) {
+                Vector3 center(RandomFloat(-half, half), RandomFloat(-half, half), RandomFloat(-half, half));
+                data->boxes.push_back(AABB::FromCenterExtents(center, Vector3(RandomFloat(0.1f, 1.0f), RandomFloat(0.1f, 1.0f), RandomFloat(0.1f, 1.0f))));
+                Vector3 from(RandomFloat(-half, half), RandomFloat(-half, half), RandomFloat(-half, half));
+                Vector3 to(RandomFloat(-half, half), RandomFloat(-half, half), RandomFloat(-half, half));
+                data->origins.push_back(from);
+                data->directions.push_back(to - from);
+            }
+            data->t.resize(n);
+            data->bvh.Build(data->boxes.data(), n);
+            return [fn, data, n]() {
+                fn(*data, n);
+                ClobberMemory();
+            };
+        };
+        return c;
+    }
+
+    std::vector<Case> AllCases()
+    {
+        std::vector<Case> cases;
+
+        // Vector2D
+        cases.push_back(Binary<Vector2D, Vector2D, Vector2D>("Vector2D/Add", [](const Vector2D& a, const Vector2D& b) { return a + b; }));
+        cases.push_back(Binary<Vector2D, Vector2D, float>("Vector2D/Dot", [](const Vector2D& a, const Vector2D& b) { return a * b; }));
+        cases.push_back(Unary<Vector2D, float>("Vector2D/Magnitude", [](const Vector2D& a) { return a.Magnitude(); }));
+
+        // Vector3
+        cases.push_back(Binary<Vector3, Vector3, Vector3>("Vector3/Add", [](const Vector3& a, const Vector3& b) { return a + b; }));
+        cases.push_back(Binary<Vector3, Vector3, Vector3>("Vector3/Subtract", [](const Vector3& a, const Vector3& b) { return a - b; }));
+        cases.push_back(Unary<Vector3, Vector3>("Vector3/Scale", [](const Vector3& a) { return a * 1.5f; }));
+        cases.push_back(Binary<Vector3, Vector3, float>("Vector3/DotProduct", [](const Vector3& a, const Vector3& b) { return DotProduct(a, b); }));
+        cases.push_back(Binary<Vector3, Vector3, Vector3>("Vector3/CrossProduct", [](const Vector3& a, const Vector3& b) { return CrossProduct(a, b); }));
+        cases.push_back(Unary<Vector3, float>("Vector3/Magnitude", [](const Vector3& a) { return a.Magnitude(); }));
+        cases.push_back(Unary<Vector3, Vector3>("Vector3/Normalize", [](Vector3 a) { return Normalize(a); }));
+
+        // Vector4
+        cases.push_back(Binary<Vector4, Vector4, Vector4>("Vector4/Add", [](const Vector4& a, const Vector4& b) { return a + b; }));
+        cases.push_back(Unary<Vector4, Vector4>("Vector4/Scale", [](const Vector4& a) { return a * 1.5f; }));
+        cases.push_back(Binary<Vector4, Vector4, float>("Vector4/DotProduct", [](const Vector4& a, const Vector4& b) { return DotProduct(a, b); }));
+        cases.push_back(Unary<Vector4, float>("Vector4/Magnitude", [](const Vector4& a) { return a.Magnitude(); }));
+
+        // Mat2x2
+        cases.push_back(Binary<Mat2x2, Mat2x2, Mat2x2>("Mat2x2/Multiply", [](const Mat2x2& a, const Mat2x2& b) { return a * b; }));
+        cases.push_back(Unary<Mat2x2, Mat2x2>("Mat2x2/Inverse", [](const Mat2x2& a) { return inverse(a); }));
+
+        // Mat3x3
+        cases.push_back(Binary<Mat3x3<float>, Mat3x3<float>, Mat3x3<float> >("Mat3x3/Multiply", [](const Mat3x3<float>& a, const Mat3x3<float>& b) { return a * b; }));
+        cases.push_back(Binary<Mat3x3<float>, Vector3, Vector3>("Mat3x3/TransformVector3", [](const Mat3x3<float>& a, const Vector3& v) { return a * v; }));
+        cases.push_back(Unary<Mat3x3<float>, float>("Mat3x3/Determinant", [](const Mat3x3<float>& a) { return a.Determinant(); }));
+        cases.push_back(Unary<Mat3x3<float>, Mat3x3<float> >("Mat3x3/Inverse", [](const Mat3x3<float>& a) { return a.Inverse(); }));
+        cases.push_back(Inverses("Mat3x3/Inverse/Loop", [](InverseData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                bool singular;
+                d.aosOut[i] = d.aos[i].Inverse(&singular);
+                d.singular[i] = singular;
+            }
+        }));
+        cases.push_back(Inverses("Mat3x3/InverseMany", [](InverseData& d, size_t n) { InverseMany(d.aos.data(), n, d.aosOut.data(), d.singular.data()); }));
+        cases.push_back(Inverses("Mat3x3/InverseMany/Stream", [](InverseData& d, size_t) { InverseMany(d.soa, d.soaOut, d.singular.data()); }));
+        cases.push_back(Inverses("Mat3x3/SolveMany/Stream", [](InverseData& d, size_t) { SolveMany(d.soa, d.b, d.x, d.singular.data()); }));
+        cases.push_back(Inverses("Matrix44/NormalMatrix/Loop", [](InverseData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                bool singular;
+                d.aosOut[i] = NormalMatrixFromMatrix44(d.world[i], &singular);
+                d.singular[i] = singular;
+            }
+        }));
+        cases.push_back(Inverses("Matrix44/NormalMatrixMany", [](InverseData& d, size_t n) { NormalMatrixMany(d.world.data(), n, d.aosOut.data(), d.singular.data()); }));
+        cases.push_back(Inverses("Matrix44/NormalMatrixMany/Stream", [](InverseData& d, size_t n) { NormalMatrixMany(d.world.data(), n, d.soaOut, d.singular.data()); }));
+
+        // Matrix44
+        cases.push_back(Binary<Matrix44, Matrix44, Matrix44>("Matrix44/Multiply", [](const Matrix44& a, const Matrix44& b) { return a * b; }));
+        cases.push_back(Binary<Matrix44, Matrix44, Matrix44>("Matrix44/MultiplyReference", [](const Matrix44& a, const Matrix44& b) { return MultiplyReference(a, b); }));
+        cases.push_back(Binary<Matrix44, Matrix44, Matrix44>("Matrix44/MultiplyAssign", [](Matrix44 a, const Matrix44& b) { return a *= b; }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/MultiplyScalar", [](const Matrix44& a) { return a * 1.5f; }));
+        cases.push_back(Binary<Matrix44, Vector4, Vector4>("Matrix44/TransformVector4", [](const Matrix44& a, const Vector4& v) { return a * v; }));
+        cases.push_back(Binary<Matrix44, Vector4, Vector4>("Matrix44/TransformReference", [](const Matrix44& a, const Vector4& v) { return TransformReference(a, v); }));
+        cases.push_back(Binary<Matrix44, Vector3, Vector3>("Matrix44/TransformVector3", [](const Matrix44& a, const Vector3& v) { return a * v; }));
+        cases.push_back(Unary<Matrix44, float>("Matrix44/Determinant", [](const Matrix44& a) { return a.Determinant(); }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/Transpose", [](const Matrix44& a) { return Transpose(a); }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/Inverse", [](const Matrix44& a) { return a.Inverse(); }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/InverseReference", [](const Matrix44& a) { return InverseReference(a); }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/InverseAffine", [](const Matrix44& a) { return a.InverseAffine(); }));
+        cases.push_back(Unary<Matrix44, Matrix44>("Matrix44/InverseOrthonormal", [](const Matrix44& a) { return a.InverseOrthonormal(); }));
+
+        // Quaternion
+        cases.push_back(Binary<Quaternion<float>, Quaternion<float>, Quaternion<float> >("Quaternion/Add", [](const Quaternion<float>& a, const Quaternion<float>& b) { return a + b; }));
+        cases.push_back(Binary<Quaternion<float>, Quaternion<float>, Quaternion<float> >("Quaternion/Multiply", [](const Quaternion<float>& a, const Quaternion<float>& b) { return a * b; }));
+        cases.push_back(Binary<Quaternion<float>, Quaternion<float>, float>("Quaternion/DotProduct", [](const Quaternion<float>& a, const Quaternion<float>& b) { return a.DotProduct(a, b); }));
+        cases.push_back(Unary<Quaternion<float>, float>("Quaternion/Magnitude", [](const Quaternion<float>& a) { return a.Magnitude(); }));
+        cases.push_back(Unary<Quaternion<float>, Quaternion<float> >("Quaternion/Inverse", [](const Quaternion<float>& a) { return a.Inverse(); }));
+        cases.push_back(Unary<Matrix44, Quaternion<float> >("Quaternion/FromMatToQuat", [](const Matrix44& m) { return Quaternion<float>().FromMatToQuat(m); }));
+
+        // Templated core
+        cases.push_back(Binary<Vector<3, double>, Vector<3, double>, double>("Vector3d/DotProduct", [](const Vector<3, double>& a, const Vector<3, double>& b) { return DotProduct(a, b); }));
+        cases.push_back(Binary<Vector<3, double>, Vector<3, double>, Vector<3, double> >("Vector3d/CrossProduct", [](const Vector<3, double>& a, const Vector<3, double>& b) { return CrossProduct(a, b); }));
+        cases.push_back(Binary<Vector<3, Half>, Vector<3, Half>, Vector<3, Half> >("Vector3h/Add", [](const Vector<3, Half>& a, const Vector<3, Half>& b) { return a + b; }));
+        cases.push_back(Binary<Matrix<4, 4, float>, Matrix<4, 4, float>, Matrix<4, 4, float> >("Matrix4f/Multiply", [](const Matrix<4, 4, float>& a, const Matrix<4, 4, float>& b) { return a * b; }));
+        cases.push_back(Binary<Matrix<4, 4, double>, Matrix<4, 4, double>, Matrix<4, 4, double> >("Matrix4d/Multiply", [](const Matrix<4, 4, double>& a, const Matrix<4, 4, double>& b) { return a * b; }));
+        cases.push_back(Binary<Matrix<4, 4, double>, Vector<4, double>, Vector<4, double> >("Matrix4d/TransformVector4", [](const Matrix<4, 4, double>& a, const Vector<4, double>& v) { return a * v; }));
+        cases.push_back(Unary<Matrix<4, 4, double>, double>("Matrix4d/Determinant", [](const Matrix<4, 4, double>& a) { return Determinant(a); }));
+
+        // Trigonometry
+        cases.push_back(Unary<float, float>("Trig/Sin/Exact", [](float x) { return Sin<Precision::Exact>(x); }));
+        cases.push_back(Unary<float, float>("Trig/Sin/Accurate", [](float x) { return Sin<Precision::Accurate>(x); }));
+        cases.push_back(Unary<float, float>("Trig/Sin/Fast", [](float x) { return Sin<Precision::Fast>(x); }));
+        cases.push_back(Unary<float, Vector2D>("Trig/SinCos/Exact", [](float x) { Vector2D r; SinCos<Precision::Exact>(x, r.x, r.y); return r; }));
+        cases.push_back(Unary<float, Vector2D>("Trig/SinCos/Accurate", [](float x) { Vector2D r; SinCos<Precision::Accurate>(x, r.x, r.y); return r; }));
+        cases.push_back(Unary<float, float>("Trig/Tan/Exact", [](float x) { return Tan<Precision::Exact>(x); }));
+        cases.push_back(Unary<float, float>("Trig/Tan/Accurate", [](float x) { return Tan<Precision::Accurate>(x); }));
+        cases.push_back(Unary<float, float>("Trig/ACos/Exact", [](float x) { return ACos<Precision::Exact>(x * 0.25f); }));
+        cases.push_back(Unary<float, float>("Trig/ACos/Accurate", [](float x) { return ACos<Precision::Accurate>(x * 0.25f); }));
+        cases.push_back(Unary<float, float>("Trig/ATan/Exact", [](float x) { return ATan<Precision::Exact>(x); }));
+        cases.push_back(Unary<float, float>("Trig/ATan/Accurate", [](float x) { return ATan<Precision::Accurate>(x); }));
+#if USING_AVX2
+        cases.push_back(Batch<float, float>("Trig/Sin/Accurate/AVX2", [](const float* in, float* out, size_t n) {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(out + i, Sin<Precision::Accurate>(_mm256_loadu_ps(in + i)));
+            for (; i < n; ++i)
+                out[i] = Sin<Precision::Accurate>(in[i]);
+        }));
+        cases.push_back(Batch<float, float>("Trig/Sin/Fast/AVX2", [](const float* in, float* out, size_t n) {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+                _mm256_storeu_ps(out + i, Sin<Precision::Fast>(_mm256_loadu_ps(in + i)));
+            for (; i < n; ++i)
+                out[i] = Sin<Precision::Fast>(in[i]);
+        }));
+#endif
+        cases.push_back(Unary<float, Matrix44>("Matrix44/Rotate", [](float angle) { Vector3 axis(0.0f, 0.6f, 0.8f); return Rotate(Matrix44(1.0f), angle, axis); }));
+        cases.push_back(Unary<float, Matrix44>("Matrix44/Perspective", [](float fov) { return Perspective(1.0f + fov * 0.1f, 1.5f, 0.1f, 100.0f); }));
+        cases.push_back(Unary<Quaternion<float>, Quaternion<float> >("Quaternion/Exp", [](const Quaternion<float>& q) { return q.Exp(0.5f); }));
+
+        // Quaternion rotation and matrix conversion
+        const size_t quaternionBytes = sizeof(Quaternion<float>);
+        cases.push_back(Orientations("Quaternion/Rotate", quaternionBytes + 2 * sizeof(Vector3), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                Vector3 p = d.points.Get(i);
+                Vector3D<float> r = d.aos[i].Rotate(Vector3D<float>(p.x, p.y, p.z));
+                d.rotated.Set(i, Vector3(r.x, r.y, r.z));
+            }
+        }));
+        cases.push_back(Orientations("QuaternionStream/RotateMany", quaternionBytes + 2 * sizeof(Vector3), [](OrientationData& d, size_t) { RotateMany(d.q, d.points, d.rotated); }));
+        cases.push_back(Orientations("Quaternion/ToMatrix44", quaternionBytes + sizeof(Matrix44), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.matrices[i] = d.aos[i].ToMatrix44();
+        }));
+        cases.push_back(Orientations("QuaternionStream/ToMatrix44Many", quaternionBytes + sizeof(Matrix44), [](OrientationData& d, size_t) { ToMatrix44Many(d.q, d.matrices.data()); }));
+        cases.push_back(Orientations("QuaternionStream/ToMat3x3Many", quaternionBytes + sizeof(Mat3x3<float>), [](OrientationData& d, size_t) { ToMat3x3Many(d.q, d.mat3x3.data()); }));
+        cases.push_back(Orientations("Quaternion/FromMatrix", quaternionBytes + sizeof(Matrix44), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.aosOut[i] = Quaternion<float>::FromMatrix(d.matrices[i]);
+        }));
+        cases.push_back(Orientations("QuaternionStream/FromMatrixMany", quaternionBytes + sizeof(Matrix44), [](OrientationData& d, size_t n) { FromMatrixMany(d.matrices.data(), n, d.out); }));
+        cases.push_back(Orientations("QuaternionStream/FromMatrixMany/Mat3x3", quaternionBytes + sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) { FromMatrixMany(d.mat3x3.data(), n, d.out); }));
+
+        // Rotation matrices; all of them act in place.
+        cases.push_back(Orientations("Mat3x3/Inverse", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.mat3x3[i] = d.mat3x3[i].Inverse();
+        }));
+        cases.push_back(Orientations("RotationMatrix/Inverse", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.rotations[i] = d.rotations[i].Inverse();
+        }));
+        cases.push_back(Orientations("RotationMatrix/Orthonormalize", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.rotations[i].Orthonormalize();
+        }));
+        cases.push_back(Orientations("RotationMatrix/OrthonormalizeMany", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) { OrthonormalizeMany(d.rotations.data(), n); }));
+        cases.push_back(Orientations("RotationMatrix/Orthonormalize/Polar", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.rotations[i].Orthonormalize(OrthonormalizeMethod::Polar);
+        }));
+        cases.push_back(Orientations("RotationMatrix/OrthonormalizeMany/Polar", 2 * sizeof(Mat3x3<float>), [](OrientationData& d, size_t n) { OrthonormalizeMany(d.rotations.data(), n, OrthonormalizeMethod::Polar); }));
+
+        // Euler angles (ZYX)
+        cases.push_back(Orientations("EulerAngles/ToQuaternion", quaternionBytes + sizeof(Vector3), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.aosOut[i] = d.euler[i].ToQuaternion();
+        }));
+        cases.push_back(Orientations("EulerAngles/ToQuaternionMany", quaternionBytes + sizeof(Vector3), [](OrientationData& d, size_t) { EulerToQuaternionMany(d.angles, EulerOrder::ZYX, d.out); }));
+        cases.push_back(Orientations("EulerAngles/ToMatrix44Many", sizeof(Matrix44) + sizeof(Vector3), [](OrientationData& d, size_t) { EulerToMatrix44Many(d.angles, EulerOrder::ZYX, d.matrices.data()); }));
+        cases.push_back(Orientations("EulerAngles/FromQuaternion", quaternionBytes + sizeof(Vector3), [](OrientationData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                d.euler[i] = EulerAngles<float>::FromQuaternion(d.aos[i], EulerOrder::ZYX);
+        }));
+        cases.push_back(Orientations("EulerAngles/FromQuaternionMany", quaternionBytes + sizeof(Vector3), [](OrientationData& d, size_t) { QuaternionToEulerMany(d.q, EulerOrder::ZYX, d.rotated); }));
+
+        // Quaternion blending
+        cases.push_back(Blend("Quaternion/Slerp", [](BlendData& d, size_t n) { for (size_t i = 0; i < n; ++i) d.aosOut[i] = d.aosA[i].Slerp(d.aosB[i], d.t[i]); }));
+        cases.push_back(Blend("QuaternionStream/SlerpMany", [](BlendData& d, size_t) { SlerpMany(d.a, d.b, d.t.data(), d.out); }));
+        cases.push_back(Blend("QuaternionStream/SlerpMany/Fast", [](BlendData& d, size_t) { SlerpMany(d.a, d.b, d.t.data(), d.out, SlerpPrecision::Fast); }));
+        cases.push_back(Blend("QuaternionStream/NlerpMany", [](BlendData& d, size_t) { NlerpMany(d.a, d.b, d.t.data(), d.out); }));
+
+        // AABB
+        cases.push_back(Binary<AABB, Matrix44, AABB>("AABB/Transform", [](const AABB& b, const Matrix44& m) { return TransformBounds(b, m); }));
+        cases.push_back(Binary<AABB, Matrix44, AABB>("AABB/TransformCorners", [](const AABB& b, const Matrix44& m) {
+            AABB result;
+            for (int corner = 0; corner < 8; ++corner) {
+                Vector4 p = m * Vector4((corner & 1) ? b.maximum.x : b.minimum.x, (corner & 2) ? b.maximum.y : b.minimum.y, (corner & 4) ? b.maximum.z : b.minimum.z, 1.0f);
+                result.Merge(Vector3(p.x, p.y, p.z));
+            }
+            return result;
+        }));
+        cases.push_back(Binary<AABB, AABB, AABB>("AABB/Union", [](const AABB& a, const AABB& b) { return Union(a, b); }));
+        cases.push_back(Binary<AABB, AABB, uint8_t>("AABB/Intersects", [](const AABB& a, const AABB& b) { return (uint8_t)Intersects(a, b); }));
+        cases.push_back(Binary<AABB, Vector3, float>("AABB/IntersectRay", [](const AABB& b, const Vector3& d) {
+            float t = -1.0f;
+            IntersectRay(b, Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z), 100.0f, t);
+            return t;
+        }));
+        cases.push_back(Batch<AABB, AABB>("AABB/Union/Batch", [](const AABB* in, AABB* out, size_t n) { out[0] = Union(in, n); }));
+        cases.push_back(Batch<AABB, uint32_t>("AABB/CollectOverlaps", [](const AABB* in, uint32_t* out, size_t n) { CollectOverlaps(AABB(Vector3(-4.0f, -4.0f, -4.0f), Vector3(4.0f, 4.0f, 4.0f)), in, n, out); }));
+        cases.push_back(Batch<AABB2D, AABB2D>("AABB2D/Union/Batch", [](const AABB2D* in, AABB2D* out, size_t n) { out[0] = Union(in, n); }));
+        cases.push_back(Batch<AABB2D, AABB2D>("AABB2D/Intersection/Batch", [](const AABB2D* in, AABB2D* out, size_t n) { Intersection(in, out, out, n); }));
+        cases.push_back(Batch<AABB2D, uint32_t>("AABB2D/CollectOverlaps", [](const AABB2D* in, uint32_t* out, size_t n) { CollectOverlaps(AABB2D(Vector2D(-4.0f, -4.0f), Vector2D(4.0f, 4.0f)), in, n, out); }));
+        cases.push_back(Batch<AABB2D, uint32_t>("AABB2D/CollectOverlaps/Loop", [](const AABB2D* in, uint32_t* out, size_t n) {
+            AABB2D query(Vector2D(-4.0f, -4.0f), Vector2D(4.0f, 4.0f));
+            size_t hits = 0;
+            for (size_t i = 0; i < n; ++i)
+                if (Intersects(query, in[i]))
+                    out[hits++] = (uint32_t)i;
+        }));
+        cases.push_back(Batch<Vector2D, AABB2D>("AABB2D/BoundingBox", [](const Vector2D* in, AABB2D* out, size_t n) { out[0] = BoundingBox(in, n); }));
+        cases.push_back(Cull("AABB/CollectOverlaps/Stream", [](CullData& d, size_t) { CollectOverlaps(AABB(Vector3(-4.0f, -4.0f, -4.0f), Vector3(4.0f, 4.0f, 4.0f)), d.Boxes(), d.visible.data()); }));
+        cases.push_back(OrientedBoxes("OBB/Intersects/Loop", [](OBBData& d, size_t n) {
+            size_t hits = 0;
+            for (size_t i = 0; i < n; ++i)
+                if (Intersects(d.query, d.aos[i]))
+                    d.hits[hits++] = (uint32_t)i;
+        }));
+        cases.push_back(OrientedBoxes("OBB/CollectOverlaps", [](OBBData& d, size_t) { CollectOverlaps(d.query, d.Boxes(), d.hits.data()); }));
+        cases.push_back(Cull("OBB/CollectOverlaps/AABBs", [](CullData& d, size_t) {
+            OBB query(Vector3(0.0f, 0.0f, -40.0f), Quaternion<float>(0.8f, Vector3D<float>(0.6f, 0.0f, 0.0f)).ToMat3x3(), Vector3(30.0f, 20.0f, 10.0f));
+            CollectOverlaps(query, d.Boxes(), d.visible.data());
+        }));
+        cases.push_back(Cull("Sphere/CollectOverlaps/Spheres", [](CullData& d, size_t) { CollectOverlaps(Sphere(Vector3(0.0f, 0.0f, -40.0f), 30.0f), d.Spheres(), d.visible.data()); }));
+        cases.push_back(Cull("Sphere/CollectOverlaps/AABBs", [](CullData& d, size_t) { CollectOverlaps(Sphere(Vector3(0.0f, 0.0f, -40.0f), 30.0f), d.Boxes(), d.visible.data()); }));
+
+        // Bounding volumes of n points; the merge loop and the centroid
+        // sphere are the straightforward baselines.
+        cases.push_back(Stream("Bounds/AABB/Merge", sizeof(Vector3), [](const std::vector<Vector3>& aos, const Vector3Stream&, const Vector3Stream&, Vector3Stream&, float* s, size_t n) {
+            AABB box;
+            for (size_t i = 0; i < n; ++i)
+                box.Merge(aos[i]);
+            s[0] = box.maximum.x;
+        }));
+        cases.push_back(Stream("Bounds/BoundingBox", sizeof(Vector3), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream&, float* s, size_t) { s[0] = BoundingBox(a).maximum.x; }));
+        cases.push_back(Stream("Bounds/BoundingBox/ArrayView", sizeof(Vector3), [](const std::vector<Vector3>& aos, const Vector3Stream&, const Vector3Stream&, Vector3Stream&, float* s, size_t n) {
+            s[0] = BoundingBox(Vector3ArrayView(aos.data(), n)).maximum.x;
+        }));
+        cases.push_back(Stream("Bounds/BoundingSphere/Centroid", sizeof(Vector3), [](const std::vector<Vector3>& aos, const Vector3Stream&, const Vector3Stream&, Vector3Stream&, float* s, size_t n) {
+            Vector3 center(0.0f, 0.0f, 0.0f);
+            for (size_t i = 0; i < n; ++i)
+                center = center + aos[i];
+            center = center * (1.0f / (float)n);
+            float radius2 = 0.0f;
+            for (size_t i = 0; i < n; ++i)
+                radius2 = Max(radius2, (aos[i] - center) * (aos[i] - center));
+            s[0] = sqrtf(radius2);
+        }));
+        cases.push_back(Stream("Bounds/BoundingOrientedBox", sizeof(Vector3), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream&, float* s, size_t) {
+            s[0] = BoundingOrientedBox(a).extents.x;
+        }));
+        cases.push_back(Stream("Bounds/BoundingSphere/Ritter", sizeof(Vector3), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream&, float* s, size_t) { s[0] = BoundingSphere(a).radius; }));
+        cases.push_back(Stream("Bounds/BoundingSphere/Welzl", sizeof(Vector3), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream&, float* s, size_t) {
+            s[0] = BoundingSphere(a, SphereFit::Welzl).radius;
+        }));
+
+        // Ray intersection
+        cases.push_back(Rays("Ray/IntersectTriangle", [](RayData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                float t = INFINITY;
+                IntersectRay(d.ray, d.v0[i], d.v1[i], d.v2[i], 40.0f, t);
+                d.t[i] = t;
+            }
+        }));
+        cases.push_back(Rays("Ray/IntersectTriangles", [](RayData& d, size_t) { IntersectTriangles(d.ray, d.Triangles(), 40.0f, d.t.data()); }));
+        cases.push_back(Rays("Ray/IntersectSphere", [](RayData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                float t = INFINITY;
+                IntersectRay(d.ray, d.v0[i], d.radius[i], 40.0f, t);
+                d.t[i] = t;
+            }
+        }));
+        cases.push_back(Rays("Ray/IntersectSpheres", [](RayData& d, size_t) { IntersectSpheres(d.ray, d.Spheres(), 40.0f, d.t.data()); }));
+        cases.push_back(Rays("Ray/IntersectAABB", [](RayData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                float t = INFINITY;
+                IntersectRay(d.ray, AABB(d.v0[i], d.v1[i]), 40.0f, t);
+                d.t[i] = t;
+            }
+        }));
+        cases.push_back(Rays("Ray/IntersectAABBs", [](RayData& d, size_t) { IntersectAABBs(d.ray, d.Boxes(), 40.0f, d.t.data()); }));
+        cases.push_back(Rays("Ray/IntersectRays/Triangle", [](RayData& d, size_t) { IntersectRays(d.Rays(), d.v0[0], d.v1[0], d.v2[0], 40.0f, d.t.data()); }));
+        cases.push_back(Rays("Ray/IntersectRays/AABB", [](RayData& d, size_t) { IntersectRays(d.Rays(), AABB(d.v0[0], d.v1[0]), 40.0f, d.t.data()); }));
+
+        // Transform
+        cases.push_back(Binary<Transform, Transform, Transform>("Transform/Compose", [](const Transform& a, const Transform& b) { return a * b; }));
+        cases.push_back(Unary<Transform, Transform>("Transform/Inverse", [](const Transform& t) { return t.Inverse(); }));
+        cases.push_back(Binary<Transform, Vector3, Vector3>("Transform/TransformPoint", [](const Transform& t, const Vector3& p) { return t.TransformPoint(p); }));
+        cases.push_back(Binary<Transform, Transform, Transform>("Transform/Lerp", [](const Transform& a, const Transform& b) { return Lerp(a, b, 0.3f); }));
+        cases.push_back(Batch<Transform, Transform>("Transform/Compose/Batch", [](const Transform* in, Transform* out, size_t n) { Compose(in, in, out, n); }));
+        cases.push_back(Batch<Transform, Transform>("Transform/Lerp/Batch", [](const Transform* in, Transform* out, size_t n) { Lerp(in, in, 0.3f, out, n); }));
+        cases.push_back(Unary<Transform, Matrix44>("Transform/ToMatrix44", [](const Transform& t) { return t.ToMatrix44(); }));
+        cases.push_back(Unary<Transform, Transform>("Transform/FromMatrix44", [](const Transform& t) { return Transform::FromMatrix44(t.ToMatrix44()); }));
+
+        // Camera-relative conversion
+        static const CameraRelativeOrigin origin(Vector3d(412345.678, -98765.4321, 250001.25));
+        cases.push_back(Unary<Vector3d, Vector3>("LargeWorld/ToRelative/Point", [](const Vector3d& p) { return origin.ToRelative(p); }));
+        cases.push_back(Batch<Vector3d, Vector3>("LargeWorld/ToRelative/Points", [](const Vector3d* in, Vector3*, size_t n) {
+            static Vector3Stream out;
+            origin.ToRelative(in, n, out);
+        }));
+        cases.push_back(Unary<Matrix44d, Matrix44>("LargeWorld/ToRelative/Matrix", [](const Matrix44d& m) { return origin.ToRelative(m); }));
+        cases.push_back(Batch<Matrix44d, Matrix44>("LargeWorld/ToRelative/Matrices", [](const Matrix44d* in, Matrix44* out, size_t n) { origin.ToRelative(in, out, n); }));
+        cases.push_back(Batch<Matrix44d, Matrix44>("LargeWorld/ToRelative/Matrices/Scalar", [](const Matrix44d* in, Matrix44* out, size_t n) {
+            // What the batch replaces: element-wise rounding after subtracting.
+            const Vector3d& o = origin.GetOrigin();
+            for (size_t i = 0; i < n; ++i)
+                for (int r = 0; r < 4; ++r)
+                    for (int c = 0; c < 4; ++c)
+                        out[i].m[r][c] = float(in[i][r][c] - (r == 3 && c < 3 ? o[c] : 0.0));
+        }));
+
+        // Transform hierarchy
+        cases.push_back(Hierarchy("TransformHierarchy/Update", [](TransformHierarchy& h, Matrix44*, size_t n) {
+            for (uint32_t i = 0; i < n; i += 100)
+                h.SetTranslation(i, h.Translation(i));
+            h.Update();
+        }));
+        cases.push_back(Hierarchy("TransformHierarchy/UpdateClean", [](TransformHierarchy& h, Matrix44*, size_t) { h.Update(); }));
+        cases.push_back(Hierarchy("TransformHierarchy/Recursive", [](TransformHierarchy& h, Matrix44* out, size_t n) {
+            // What the hierarchy replaces: each world matrix rebuilt by
+            // walking up to the root.
+            for (uint32_t i = 0; i < n; ++i) {
+                Matrix44 m = LocalMatrix(h.Rotation(i), h.Translation(i), h.Scale(i));
+                for (uint32_t p = h.Parent(i); p != TransformHierarchy::NoParent; p = h.Parent(p))
+                    m = m * LocalMatrix(h.Rotation(p), h.Translation(p), h.Scale(p));
+                out[i] = m;
+            }
+        }));
+
+        // Skinning
+        cases.push_back(Skin("Skinning/DualQuaternion", [](SkinData& d, size_t) { SkinDualQuaternion(d.dualQuaternions.data(), d.Weights(), d.positions, d.normals, d.outPositions, d.outNormals); }));
+        cases.push_back(Skin("Skinning/DualQuaternion/Blend", [](SkinData& d, size_t n) {
+            // What the kernel replaces: Blend and transform one vertex at a time.
+            d.outPositions.Resize(n);
+            d.outNormals.Resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                DualQuaternion<float> dq[4];
+                float w[4];
+                for (int k = 0; k < 4; ++k) {
+                    dq[k] = d.dualQuaternions[d.bones[k][i]];
+                    w[k] = d.weights[k][i];
+                }
+                DualQuaternion<float> blend = Blend(dq, w, 4);
+                Vector3 p = d.positions.Get(i), nrm = d.normals.Get(i);
+                Vector3D<float> sp = blend.TransformPoint(Vector3D<float>(p.x, p.y, p.z));
+                Vector3D<float> sn = blend.TransformDirection(Vector3D<float>(nrm.x, nrm.y, nrm.z));
+                d.outPositions.Set(i, Vector3(sp.x, sp.y, sp.z));
+                d.outNormals.Set(i, Vector3(sn.x, sn.y, sn.z));
+            }
+        }));
+
+        cases.push_back(Skin("Skinning/LinearBlend", [](SkinData& d, size_t) { SkinLinearBlend(d.matrices.data(), d.Weights(), d.positions, d.normals, d.outPositions, d.outNormals); }));
+        cases.push_back(Skin("Skinning/LinearBlend/Positions", [](SkinData& d, size_t) { SkinLinearBlend(d.matrices.data(), d.Weights(), d.positions, d.outPositions); }));
+        cases.push_back(Skin("Skinning/LinearBlend/PerInfluence", [](SkinData& d, size_t n) {
+            // What the kernel replaces: one Matrix44 * Vector4 per influence.
+            d.outPositions.Resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                Vector4 p(d.positions.X()[i], d.positions.Y()[i], d.positions.Z()[i], 1.0f), sum(0.0f, 0.0f, 0.0f, 0.0f);
+                for (int k = 0; k < 4; ++k) {
+                    Vector4 s = d.matrices[d.bones[k][i]] * p;
+                    float w = d.weights[k][i];
+                    sum = Vector4(sum.x + s.x * w, sum.y + s.y * w, sum.z + s.z * w, 1.0f);
+                }
+                d.outPositions.X()[i] = sum.x;
+                d.outPositions.Y()[i] = sum.y;
+                d.outPositions.Z()[i] = sum.z;
+            }
+        }));
+
+        // BVH
+        cases.push_back(Scene("BVH/Build", [](SceneData& d, size_t n) { d.bvh.Build(d.boxes.data(), n); }));
+        cases.push_back(Scene("BVH/Refit", [](SceneData& d, size_t) { d.bvh.Refit(d.boxes.data()); }));
+        cases.push_back(Scene("BVH/Raycast", [](SceneData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                const Vector3 &o = d.origins[i], &dir = d.directions[i];
+                Vector3 inv(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+                float tMax = 1.0f;
+                d.bvh.Raycast(o, dir, tMax, [&](uint32_t p, float& tClosest) {
+                    float t;
+                    if (!IntersectRay(d.boxes[p], o, inv, tClosest, t))
+                        return false;
+                    tClosest = t;
+                    return true;
+                });
+                d.t[i] = tMax;
+            }
+        }));
+        cases.push_back(Scene("BVH/QueryOverlaps", [](SceneData& d, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t found = 0;
+                d.bvh.QueryOverlaps(AABB::FromCenterExtents(d.origins[i], Vector3(2.0f, 2.0f, 2.0f)), [&](uint32_t) { ++found; });
+                d.t[i] = (float)found;
+            }
+        }));
+
+        // Frustum culling
+        cases.push_back(Cull("Frustum/Intersects/AABB", [](CullData& d, size_t n) {
+            size_t visible = 0;
+            for (size_t i = 0; i < n; ++i)
+                if (d.frustum.Intersects(Vector3(d.minX[i], d.minY[i], d.minZ[i]), Vector3(d.maxX[i], d.maxY[i], d.maxZ[i])))
+                    d.visible[visible++] = (uint32_t)i;
+        }));
+        cases.push_back(Cull("Frustum/CullAABBs", [](CullData& d, size_t) { CullAABBs(d.frustum, d.Boxes(), d.visible.data()); }));
+        cases.push_back(Cull("Frustum/CullSpheres", [](CullData& d, size_t) { CullSpheres(d.frustum, d.Spheres(), d.visible.data()); }));
+
+        // Batch transforms
+        cases.push_back(Batch<Vector3, Vector3>("Batch/TransformPoints/Vector3", [](const Vector3* in, Vector3* out, size_t n) { TransformPoints(Matrix44(1.5f), in, out, n); }));
+        cases.push_back(Batch<Vector4, Vector4>("Batch/TransformPoints/Vector4", [](const Vector4* in, Vector4* out, size_t n) { TransformPoints(Matrix44(1.5f), in, out, n); }));
+        cases.push_back(Batch<Vector3, Vector3>("Batch/TransformDirections/Vector3", [](const Vector3* in, Vector3* out, size_t n) { TransformDirections(Matrix44(1.5f), in, out, n); }));
+
+        cases.push_back(Batch<Vector2D, Vector2D>("Batch/TransformPoints/Vector2D", [](const Vector2D* in, Vector2D* out, size_t n) { TransformPoints(Affine2D::FromTRS(Vector2D(1.0f, 2.0f), 0.5f, Vector2D(1.5f, 1.5f)), in, out, n); }));
+        cases.push_back(Batch<Vector2D, Vector2D>("Batch/TransformPoints/Vector2D/Loop", [](const Vector2D* in, Vector2D* out, size_t n) {
+            Affine2D m = Affine2D::FromTRS(Vector2D(1.0f, 2.0f), 0.5f, Vector2D(1.5f, 1.5f));
+            for (size_t i = 0; i < n; ++i)
+                out[i] = m.TransformPoint(in[i]);
+        }));
+        cases.push_back(Batch<float, Mat2x2>("Batch/RotationMany/Mat2x2", [](const float* in, Mat2x2* out, size_t n) { RotationMany(in, n, out); }));
+        cases.push_back(Batch<float, Mat2x2>("Batch/RotationMany/Mat2x2/Loop", [](const float* in, Mat2x2* out, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = Affine2D::Rotation(in[i]).linear;
+        }));
+
+        // Vector3Stream
+        cases.push_back(Stream("Vector3Stream/Add", 9 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out, float*, size_t) { Add(a, b, out); }));
+        cases.push_back(Stream("Vector3Stream/Scale", 6 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream& out, float*, size_t) { Scale(a, 1.5f, out); }));
+        // Lazy expressions: out = a + b * s in one pass, against the two-pass
+        // stream calls with a temporary and the eager AoS loop.
+        cases.push_back(Stream("Expression/AddScaled/Lazy", 9 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out, float*, size_t) { Evaluate(Lazy(a) + Lazy(b) * 1.5f, out); }));
+        cases.push_back(Stream("Expression/AddScaled/TwoPass", 9 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out, float*, size_t) {
+            static Vector3Stream scaled;
+            Scale(b, 1.5f, scaled);
+            Add(a, scaled, out);
+        }));
+        cases.push_back(Batch<Vector3, Vector3>("Expression/AddScaled/AoS/Lazy", [](const Vector3* in, Vector3* out, size_t n) { Evaluate(Lazy(Vector3ArrayView(in, n)) + Lazy(Vector3ArrayView(in, n)) * 1.5f, out); }));
+        cases.push_back(Batch<Vector3, Vector3>("Expression/AddScaled/AoS/Eager", [](const Vector3* in, Vector3* out, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = in[i] + in[i] * 1.5f;
+        }));
+        cases.push_back(Batch<Vector3, Vector3>("Expression/CrossAdd/AoS/Lazy", [](const Vector3* in, Vector3* out, size_t n) { Evaluate((Lazy(Vector3ArrayView(in, n)) ^ Vector3(0.0f, 1.0f, 0.0f)) + Lazy(Vector3ArrayView(in, n)), out); }));
+        cases.push_back(Batch<Vector3, Vector3>("Expression/CrossAdd/AoS/Eager", [](const Vector3* in, Vector3* out, size_t n) {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = (in[i] ^ Vector3(0.0f, 1.0f, 0.0f)) + in[i];
+        }));
+        cases.push_back(Binary<Vector3, Vector3, Vector3>("Expression/Integrate/Lazy", [](const Vector3& p, const Vector3& v) { return Vector3(Lazy(p) + Lazy(v) * 0.016f + Lazy(v) * (0.5f * 0.016f * 0.016f)); }));
+        cases.push_back(Binary<Vector3, Vector3, Vector3>("Expression/Integrate/Eager", [](const Vector3& p, const Vector3& v) { return p + v * 0.016f + v * (0.5f * 0.016f * 0.016f); }));
+        cases.push_back(Stream("Vector3Stream/DotProduct", 7 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream& b, Vector3Stream&, float* out, size_t) { DotProduct(a, b, out); }));
+        cases.push_back(Stream("Vector3Stream/CrossProduct", 9 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out, float*, size_t) { CrossProduct(a, b, out); }));
+        cases.push_back(Stream("Vector3Stream/Magnitude", 4 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream&, float* out, size_t) { Magnitude(a, out); }));
+        cases.push_back(Stream("Vector3Stream/Normalize", 6 * sizeof(float), [](const std::vector<Vector3>&, const Vector3Stream& a, const Vector3Stream&, Vector3Stream& out, float*, size_t) { Normalize(a, out); }));
+        cases.push_back(Stream("Vector3Stream/Normalize/ArrayView", 6 * sizeof(float), [](const std::vector<Vector3>& aos, const Vector3Stream&, const Vector3Stream&, Vector3Stream& out, float*, size_t n) { Normalize(Vector3ArrayView(aos.data(), n), out); }));
+
+        return cases;
+    }
+
+    // Doubles the repetition count until one timed run lasts at least minTimeMs.
+    Result Measure(const Case& c, size_t batch, double minTimeMs)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        Kernel kernel = c.make(batch);
+        kernel();
+
+        uint64_t repetitions = 1;
+        double elapsedNs = 0.0;
+        for (;;) {
+            Clock::time_point start = Clock::now();
+            for (uint64_t r = 0; r < repetitions; ++r)
+                kernel();
+            elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+            if (elapsedNs >= minTimeMs * 1e6 || repetitions >= (1ull << 40))
+                break;
+            repetitions *= 2;
+        }
+
+        Result result;
+        result.name = c.name;
+        result.batch = batch;
+        result.iterations = repetitions * batch;
+        result.nsPerOp = elapsedNs / (double)result.iterations;
+        result.opsPerSec = result.nsPerOp > 0.0 ? 1e9 / result.nsPerOp : 0.0;
+        result.bytesPerSec = result.opsPerSec * (double)c.bytesPerOp;
+        return result;
+    }
+
+    const char* SimdBackend()
+    {
+        return USING_AVX2 ? (USING_FMA ? "avx2+fma" : "avx2") : (USING_SSE ? "sse4.1" : "scalar");
+    }
+
+    const char* Compiler()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc";
+#else
+        return "unknown";
+#endif
+    }
+
+    void WriteJson(FILE* f, const Options& options, const std::vector<Result>& results)
+    {
+        fprintf(f, "{\n");
+        fprintf(f, "  \"revision\": \"%s\",\n", MATHLIB_REVISION);
+        fprintf(f, "  \"compiler\": \"%s\",\n", Compiler());
+        fprintf(f, "  \"simd\": \"%s\",\n", SimdBackend());
+        fprintf(f, "  \"min_time_ms\": %g,\n", options.minTimeMs);
+        fprintf(f, "  \"results\": [\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            fprintf(f, "    {\"name\": \"%s\", \"batch\": %llu, \"iterations\": %llu, \"ns_per_op\": %.4f, \"ops_per_sec\": %.1f, \"bytes_per_sec\": %.1f}%s\n",
+                r.name.c_str(), (unsigned long long)r.batch, (unsigned long long)r.iterations,
+                r.nsPerOp, r.opsPerSec, r.bytesPerSec, i + 1 < results.size() ? "," : "");
+        }
+        fprintf(f, "  ]\n");
+        fprintf(f, "}\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--max-batch") == 0 && hasValue) {
+                options.maxBatch = (size_t)strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "--max-bytes") == 0 && hasValue) {
+                options.maxBytes = (size_t)strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(argv[i], "--min-time-ms") == 0 && hasValue) {
+                options.minTimeMs = atof(argv[++i]);
+            } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+                options.filter = argv[++i];
+            } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+                options.out = argv[++i];
+            } else {
+                fprintf(stderr, "usage: %s [--max-batch N] [--max-bytes N] [--min-time-ms T] [--filter SUBSTRING] [--out FILE]\n", argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    options.maxBatch = 10000000;
+    options.maxBytes = (size_t)1 << 30;
+    options.minTimeMs = 100.0;
+    options.filter = NULL;
+    options.out = NULL;
+
+    if (!ParseOptions(argc, argv, options))
+        return EXIT_FAILURE;
+
+    srand(1);
+    std::vector<Case> cases = AllCases();
+    std::vector<Result> results;
+
+    for (size_t c = 0; c < cases.size(); ++c) {
+        if (options.filter != NULL && cases[c].name.find(options.filter) == std::string::npos)
+            continue;
+
+        for (size_t batch = 1; batch <= options.maxBatch; batch *= 10) {
+            // Keep the largest batches of the bigger types within the memory budget.
+            if (batch * cases[c].bytesPerOp > options.maxBytes) {
+                fprintf(stderr, "skipping %s at batch %llu (exceeds --max-bytes)\n", cases[c].name.c_str(), (unsigned long long)batch);
+                break;
+            }
+
+            results.push_back(Measure(cases[c], batch, options.minTimeMs));
+            fprintf(stderr, "%-40s %10llu %12.3f ns/op\n", cases[c].name.c_str(), (unsigned long long)batch, results.back().nsPerOp);
+        }
+    }
+
+    FILE* f = options.out != NULL ? fopen(options.out, "w") : stdout;
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s\n", options.out);
+        return EXIT_FAILURE;
+    }
+    WriteJson(f, options, results);
+    if (f != stdout)
+        fclose(f);
+
+    return EXIT_SUCCESS;
+}
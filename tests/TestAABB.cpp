@@ -0,0 +1,175 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "AABB.h"
+#include "MatrixTransform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    AABB RandomBox(float range)
+    {
+        return AABB::FromCenterExtents(Test::RandomVector(range), Vector3(Test::Random(0.0f, 2.0f), Test::Random(0.0f, 2.0f), Test::Random(0.0f, 2.0f)));
+    }
+
+    // Bounds of the eight transformed corners.
+    AABB TransformCorners(const AABB& box, const Matrix44& m)
+    {
+        AABB result;
+        for (int corner = 0; corner < 8; ++corner) {
+            Vector3 p((corner & 1) ? box.maximum.x : box.minimum.x, (corner & 2) ? box.maximum.y : box.minimum.y, (corner & 4) ? box.maximum.z : box.minimum.z);
+            Vector4 q = m * Vector4(p.x, p.y, p.z, 1.0f);
+            result.Merge(Vector3(q.x, q.y, q.z));
+        }
+        return result;
+    }
+
+    // Brute-force ray march in double for the slab test.
+    bool ReferenceHit(const AABB& box, const Vector3& o, const Vector3& d, float tMax, double& tEntry)
+    {
+        double lo = 0.0, hi = tMax;
+        const float* origin = &o.x;
+        const float* direction = &d.x;
+        const float* minimum = &box.minimum.x;
+        const float* maximum = &box.maximum.x;
+        for (int i = 0; i < 3; ++i) {
+            if (direction[i] == 0.0f) {
+                if (origin[i] < minimum[i] || origin[i] > maximum[i])
+                    return false;
+                continue;
+            }
+            double t0 = (minimum[i] - (double)origin[i]) / direction[i];
+            double t1 = (maximum[i] - (double)origin[i]) / direction[i];
+            lo = fmax(lo, fmin(t0, t1));
+            hi = fmin(hi, fmax(t0, t1));
+        }
+        tEntry = lo;
+        return lo <= hi;
+    }
+}
+
+TEST_CASE(AABBMergeAndUnion)
+{
+    AABB empty;
+    CHECK(empty.IsEmpty());
+    CHECK(Union(empty, empty).IsEmpty());
+    CHECK(TransformBounds(empty, Matrix44(2.0f)).IsEmpty());
+
+    AABB box(Vector3(-1.0f, 0.0f, 2.0f), Vector3(1.0f, 3.0f, 4.0f));
+    CHECK(Union(empty, box).minimum == box.minimum && Union(box, empty).maximum == box.maximum);
+    CHECK_NEAR(box.SurfaceArea(), 2.0 * (6.0 + 6.0 + 4.0), 1e-6);
+    CHECK(box.Contains(Vector3(1.0f, 3.0f, 2.0f)) && !box.Contains(Vector3(1.5f, 0.0f, 3.0f)));
+
+    box.Merge(Vector3(5.0f, -2.0f, 3.0f));
+    CHECK(box.minimum == Vector3(-1.0f, -2.0f, 2.0f) && box.maximum == Vector3(5.0f, 3.0f, 4.0f));
+
+    std::vector<AABB> boxes, pairwise(101);
+    for (int i = 0; i < 101; ++i)
+        boxes.push_back(RandomBox(50.0f));
+    AABB expected;
+    for (size_t i = 0; i < boxes.size(); ++i)
+        expected.Merge(boxes[i]);
+    AABB all = Union(boxes.data(), boxes.size());
+    CHECK(all.minimum == expected.minimum && all.maximum == expected.maximum);
+    CHECK(Union(boxes.data(), 0).IsEmpty());
+
+    Union(boxes.data(), boxes.data() + 1, pairwise.data(), 100);
+    for (int i = 0; i < 100; ++i) {
+        AABB u = Union(boxes[i], boxes[i + 1]);
+        CHECK(pairwise[i].minimum == u.minimum && pairwise[i].maximum == u.maximum);
+    }
+
+    // In place, with a tail shorter than a SIMD group and an empty box.
+    std::vector<AABB> inPlace(boxes.begin(), boxes.begin() + 7);
+    inPlace[3] = AABB();
+    Union(inPlace.data(), boxes.data() + 50, inPlace.data(), 7);
+    for (int i = 0; i < 7; ++i) {
+        AABB u = Union(i == 3 ? AABB() : boxes[i], boxes[50 + i]);
+        CHECK(inPlace[i].minimum == u.minimum && inPlace[i].maximum == u.maximum);
+    }
+}
+
+TEST_CASE(AABBTransformMatchesCorners)
+{
+    for (int n = 0; n < 200; ++n) {
+        Vector3 axis = Test::RandomVector(1.0f);
+        Matrix44 m = Rotate(Matrix44(Test::Random(0.5f, 2.0f)), Test::Random(-3.0f, 3.0f), axis);
+        m.SetTranslation(Test::RandomVector(10.0f));
+        AABB box = RandomBox(5.0f);
+
+        AABB fast = TransformBounds(box, m), expected = TransformCorners(box, m);
+        CHECK_NEAR(fast.minimum.x, expected.minimum.x, 1e-4);
+        CHECK_NEAR(fast.minimum.y, expected.minimum.y, 1e-4);
+        CHECK_NEAR(fast.minimum.z, expected.minimum.z, 1e-4);
+        CHECK_NEAR(fast.maximum.x, expected.maximum.x, 1e-4);
+        CHECK_NEAR(fast.maximum.y, expected.maximum.y, 1e-4);
+        CHECK_NEAR(fast.maximum.z, expected.maximum.z, 1e-4);
+    }
+}
+
+TEST_CASE(AABBRaySlab)
+{
+    AABB box(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+    float t = -1.0f;
+    CHECK(IntersectRay(box, Vector3(-5.0f, 0.0f, 0.0f), Vector3(1.0f, INFINITY, INFINITY), 100.0f, t));
+    CHECK_NEAR(t, 4.0, 1e-6);
+    CHECK(!IntersectRay(box, Vector3(-5.0f, 0.0f, 0.0f), Vector3(1.0f, INFINITY, INFINITY), 3.0f, t));
+    CHECK(!IntersectRay(box, Vector3(-5.0f, 2.0f, 0.0f), Vector3(1.0f, INFINITY, INFINITY), 100.0f, t));
+    CHECK(IntersectRay(box, Vector3(0.0f, 0.0f, 0.0f), Vector3(-1.0f, 1.0f, 1.0f), 100.0f, t) && t == 0.0f);
+    // Starting on a face plane, parallel to it.
+    CHECK(IntersectRay(box, Vector3(-5.0f, 0.0f, 1.0f), Vector3(1.0f, INFINITY, INFINITY), 100.0f, t));
+
+    int hits = 0;
+    for (int n = 0; n < 2000; ++n) {
+        AABB b = RandomBox(3.0f);
+        // Aimed near the box so a good share of the rays hit.
+        Vector3 o = Test::RandomVector(6.0f), d = b.Center() - o + Test::RandomVector(3.0f);
+        if (n % 5 == 0)
+            d.y = 0.0f;
+        Vector3 inv(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+
+        double expectedT = 0.0;
+        bool expected = ReferenceHit(b, o, d, 20.0f, expectedT);
+        bool hit = IntersectRay(b, o, inv, 20.0f, t);
+        CHECK(hit == expected);
+        if (hit && expected) {
+            CHECK_NEAR(t, expectedT, 1e-4 * (1.0 + expectedT));
+            ++hits;
+        }
+    }
+    CHECK(hits > 200);
+}
+
+TEST_CASE(AABBCollectOverlaps)
+{
+    const size_t count = 301;
+    std::vector<AABB> boxes;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    for (size_t i = 0; i < count; ++i) {
+        AABB b = RandomBox(10.0f);
+        boxes.push_back(b);
+        minX.push_back(b.minimum.x);
+        minY.push_back(b.minimum.y);
+        minZ.push_back(b.minimum.z);
+        maxX.push_back(b.maximum.x);
+        maxY.push_back(b.maximum.y);
+        maxZ.push_back(b.maximum.z);
+    }
+    AABB query(Vector3(-4.0f, -4.0f, -4.0f), Vector3(4.0f, 4.0f, 4.0f));
+
+    std::vector<uint32_t> expected, aos(count), soa(count);
+    for (size_t i = 0; i < count; ++i)
+        if (Intersects(query, boxes[i]))
+            expected.push_back((uint32_t)i);
+
+    size_t aosCount = CollectOverlaps(query, boxes.data(), count, aos.data());
+    size_t soaCount = CollectOverlaps(query, AABBStreamView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), count), soa.data());
+    CHECK(aosCount == expected.size() && soaCount == expected.size());
+    CHECK(expected.size() > 0 && expected.size() < count);
+    for (size_t i = 0; i < expected.size() && i < aosCount && i < soaCount; ++i)
+        CHECK(aos[i] == expected[i] && soa[i] == expected[i]);
+
+    // Touching boxes intersect.
+    CHECK(Intersects(AABB(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f)), AABB(Vector3(1.0f, 0.0f, 0.0f), Vector3(2.0f, 1.0f, 1.0f))));
+}
@@ -0,0 +1,90 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "AABB2D.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector2D RandomPoint(float lo, float hi)
+    {
+        return Vector2D(Test::Random(lo, hi), Test::Random(lo, hi));
+    }
+
+    AABB2D RandomBox()
+    {
+        return AABB2D::FromCenterExtents(RandomPoint(-10.0f, 10.0f), RandomPoint(0.1f, 2.0f));
+    }
+
+    bool Same(const AABB2D& a, const AABB2D& b)
+    {
+        return a.minimum == b.minimum && a.maximum == b.maximum;
+    }
+}
+
+TEST_CASE(AABB2DMergeAndIntersect)
+{
+    AABB2D box;
+    CHECK(box.IsEmpty());
+    box.Merge(Vector2D(1.0f, 2.0f)).Merge(Vector2D(-1.0f, 4.0f));
+    CHECK(box.minimum == Vector2D(-1.0f, 2.0f) && box.maximum == Vector2D(1.0f, 4.0f));
+    CHECK(box.Area() == 4.0f && box.Center() == Vector2D(0.0f, 3.0f));
+
+    AABB2D other(Vector2D(0.0f, 3.5f), Vector2D(5.0f, 5.0f));
+    CHECK(Intersects(box, other));
+    CHECK(Same(Intersection(box, other), AABB2D(Vector2D(0.0f, 3.5f), Vector2D(1.0f, 4.0f))));
+    CHECK(Same(Union(box, other), AABB2D(Vector2D(-1.0f, 2.0f), Vector2D(5.0f, 5.0f))));
+
+    // Touching boxes intersect; disjoint ones give an empty intersection.
+    CHECK(Intersects(box, AABB2D(Vector2D(1.0f, 0.0f), Vector2D(2.0f, 2.0f))));
+    CHECK(Intersection(box, AABB2D(Vector2D(3.0f, 0.0f), Vector2D(4.0f, 1.0f))).IsEmpty());
+    CHECK(!Intersects(box, AABB2D()));
+
+    // A quarter turn about the origin.
+    AABB2D turned = TransformBounds(box, Affine2D::FromTRS(Vector2D(10.0f, 0.0f), PI * 0.5f, Vector2D(1.0f, 1.0f)));
+    CHECK_NEAR(turned.minimum.x, 6.0f, 1e-5);
+    CHECK_NEAR(turned.maximum.x, 8.0f, 1e-5);
+    CHECK_NEAR(turned.minimum.y, -1.0f, 1e-5);
+    CHECK_NEAR(turned.maximum.y, 1.0f, 1e-5);
+    CHECK(TransformBounds(AABB2D(), Affine2D()).IsEmpty());
+}
+
+TEST_CASE(AABB2DBatchMatchesScalar)
+{
+    // Odd count to cover the scalar tails.
+    const size_t count = 45;
+    std::vector<Vector2D> points(count);
+    std::vector<AABB2D> a(count), b(count), unions(count), intersections(count);
+    AABB2D expectedBounds, expectedUnion;
+    for (size_t i = 0; i < count; ++i) {
+        points[i] = RandomPoint(-50.0f, 50.0f);
+        a[i] = RandomBox();
+        b[i] = i % 5 == 3 ? AABB2D() : RandomBox();
+        expectedBounds.Merge(points[i]);
+        expectedUnion.Merge(a[i]);
+    }
+    for (size_t n = 0; n <= count; n += count) {
+        AABB2D bounds = BoundingBox(points.data(), n), all = Union(a.data(), n);
+        CHECK(n == 0 ? bounds.IsEmpty() && all.IsEmpty() : Same(bounds, expectedBounds) && Same(all, expectedUnion));
+    }
+
+    Union(a.data(), b.data(), unions.data(), count);
+    Intersection(a.data(), b.data(), intersections.data(), count);
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        ok = ok && Same(unions[i], Union(a[i], b[i])) && Same(intersections[i], Intersection(a[i], b[i]));
+        ok = ok && intersections[i].IsEmpty() == !Intersects(a[i], b[i]);
+    }
+    CHECK(ok);
+
+    for (int n = 0; n < 10; ++n) {
+        AABB2D query = AABB2D::FromCenterExtents(RandomPoint(-8.0f, 8.0f), RandomPoint(1.0f, 6.0f));
+        std::vector<uint32_t> hits(count), expected;
+        hits.resize(CollectOverlaps(query, b.data(), count, hits.data()));
+        for (uint32_t i = 0; i < count; ++i)
+            if (Intersects(query, b[i]))
+                expected.push_back(i);
+        CHECK(hits == expected);
+    }
+}
@@ -0,0 +1,104 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Affine2D.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector2D RandomPoint(float lo, float hi)
+    {
+        return Vector2D(Test::Random(lo, hi), Test::Random(lo, hi));
+    }
+
+    bool Near(const Vector2D& a, const Vector2D& b, float tolerance)
+    {
+        return fabsf(a.x - b.x) <= tolerance && fabsf(a.y - b.y) <= tolerance;
+    }
+}
+
+TEST_CASE(Affine2DComposeAndInvert)
+{
+    Affine2D rotation = Affine2D::Rotation(PI * 0.5f);
+    CHECK(Near(rotation.TransformPoint(Vector2D(1.0f, 0.0f)), Vector2D(0.0f, 1.0f), 1e-6f));
+
+    // Scale, then rotate, then translate.
+    Affine2D trs = Affine2D::FromTRS(Vector2D(5.0f, -2.0f), PI * 0.5f, Vector2D(2.0f, 3.0f));
+    Affine2D composed = Affine2D::Scale(Vector2D(2.0f, 3.0f)) * rotation * Affine2D::Translation(Vector2D(5.0f, -2.0f));
+    Vector2D p(1.0f, 1.0f);
+    CHECK(Near(trs.TransformPoint(p), Vector2D(2.0f, 0.0f), 1e-5f));
+    CHECK(Near(composed.TransformPoint(p), trs.TransformPoint(p), 1e-5f));
+    CHECK(Near(trs.TransformDirection(p), Vector2D(-3.0f, 2.0f), 1e-5f));
+
+    bool singular = true;
+    Affine2D inverse = trs.Inverse(&singular);
+    CHECK(!singular);
+    CHECK(Near(inverse.TransformPoint(trs.TransformPoint(p)), p, 1e-5f));
+    CHECK(Near((trs * inverse).TransformPoint(Vector2D(-4.0f, 7.0f)), Vector2D(-4.0f, 7.0f), 1e-5f));
+
+    Affine2D flat = Affine2D::Scale(Vector2D(1.0f, 0.0f));
+    CHECK(flat.Inverse(&singular).TransformPoint(p) == p);
+    CHECK(singular);
+}
+
+TEST_CASE(TransformPointsMatchesScalar)
+{
+    // Odd counts cover the SSE block and the scalar tail.
+    Affine2D m = Affine2D::FromTRS(Vector2D(3.0f, -1.0f), 0.7f, Vector2D(1.5f, -0.5f));
+    for (size_t count = 0; count < 30; count += 7) {
+        std::vector<Vector2D> in(count), points(count), directions(count);
+        for (size_t i = 0; i < count; ++i)
+            in[i] = RandomPoint(-10.0f, 10.0f);
+        TransformPoints(m, in.data(), points.data(), count);
+        TransformDirections(m, in.data(), directions.data(), count);
+
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i) {
+            ok = ok && Near(points[i], m.TransformPoint(in[i]), 1e-5f);
+            ok = ok && Near(directions[i], m.TransformDirection(in[i]), 1e-5f);
+        }
+        CHECK(ok);
+
+        // In place.
+        TransformPoints(m, in.data(), in.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ok = ok && in[i] == points[i];
+        CHECK(ok);
+    }
+}
+
+TEST_CASE(RotationManyMatchesScalar)
+{
+    const size_t count = 37;
+    std::vector<float> angles(count);
+    std::vector<Vector2D> in(count), rotated(count);
+    for (size_t i = 0; i < count; ++i) {
+        angles[i] = Test::Random(-20.0f, 20.0f);
+        in[i] = RandomPoint(-5.0f, 5.0f);
+    }
+    std::vector<Mat2x2> matrices(count);
+    RotationMany(angles.data(), count, matrices.data());
+    RotateMany(in.data(), angles.data(), count, rotated.data());
+
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        Affine2D expected = Affine2D::Rotation(angles[i]);
+        ok = ok && Near(matrices[i].getColumn(0), expected.linear.getColumn(0), 1e-6f);
+        ok = ok && Near(matrices[i].getColumn(1), expected.linear.getColumn(1), 1e-6f);
+        ok = ok && Near(rotated[i], expected.TransformPoint(in[i]), 1e-5f);
+    }
+    CHECK(ok);
+
+    // The exact tier agrees with the C library.
+    RotationMany<Precision::Exact>(angles.data(), count, matrices.data());
+    for (size_t i = 0; i < count; ++i)
+        ok = ok && matrices[i].m[0][0] == cosf(angles[i]) && matrices[i].m[1][0] == sinf(angles[i]) && matrices[i].m[0][1] == -sinf(angles[i]);
+    CHECK(ok);
+
+    // In place.
+    RotateMany(in.data(), angles.data(), count, in.data());
+    for (size_t i = 0; i < count; ++i)
+        ok = ok && in[i] == rotated[i];
+    CHECK(ok);
+}
@@ -0,0 +1,194 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "BVH.h"
+#include "MatrixTransform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    std::vector<AABB> RandomBoxes(size_t count, float range)
+    {
+        std::vector<AABB> boxes;
+        for (size_t i = 0; i < count; ++i)
+            boxes.push_back(AABB::FromCenterExtents(Test::RandomVector(range), Vector3(Test::Random(0.0f, 1.0f), Test::Random(0.0f, 1.0f), Test::Random(0.0f, 1.0f))));
+        return boxes;
+    }
+
+    bool Encloses(const AABB& outer, const AABB& inner)
+    {
+        return outer.minimum.x <= inner.minimum.x && outer.minimum.y <= inner.minimum.y && outer.minimum.z <= inner.minimum.z
+            && outer.maximum.x >= inner.maximum.x && outer.maximum.y >= inner.maximum.y && outer.maximum.z >= inner.maximum.z;
+    }
+
+    // Every primitive appears once, and each node's slot bounds enclose
+    // what is below them.
+    bool IsValid(const BVH& bvh, const std::vector<AABB>& boxes)
+    {
+        const BVHNodeArray& nodes = bvh.Nodes();
+        std::vector<int> seen(boxes.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (int k = 0; k < 4; ++k) {
+                const BVHNode& n = nodes[i];
+                if (n.IsEmpty(k))
+                    continue;
+                AABB slot = n.Bounds(k);
+                if (n.IsLeaf(k)) {
+                    for (uint32_t j = n.child[k]; j < n.child[k] + n.count[k]; ++j) {
+                        uint32_t p = bvh.Primitives()[j];
+                        ++seen[p];
+                        if (!Encloses(slot, boxes[p]))
+                            return false;
+                    }
+                } else {
+                    if (n.child[k] <= i)
+                        return false;
+                    for (int j = 0; j < 4; ++j)
+                        if (!nodes[n.child[k]].IsEmpty(j) && !Encloses(slot, nodes[n.child[k]].Bounds(j)))
+                            return false;
+                }
+            }
+        }
+        for (size_t p = 0; p < seen.size(); ++p)
+            if (seen[p] != 1)
+                return false;
+        return true;
+    }
+
+    bool SameSet(std::vector<uint32_t> a, std::vector<uint32_t> b)
+    {
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        return a == b;
+    }
+
+    // Queries agree with a linear scan over boxes.
+    void CheckQueries(const BVH& bvh, const std::vector<AABB>& boxes)
+    {
+        for (int n = 0; n < 50; ++n) {
+            AABB query = AABB::FromCenterExtents(Test::RandomVector(20.0f), Vector3(3.0f, 2.0f, 4.0f));
+            std::vector<uint32_t> expected, found;
+            for (size_t i = 0; i < boxes.size(); ++i)
+                if (Intersects(query, boxes[i]))
+                    expected.push_back((uint32_t)i);
+            CHECK(bvh.CollectOverlaps(query, found) == expected.size());
+            CHECK(SameSet(found, expected));
+
+            Vector3 center = Test::RandomVector(20.0f);
+            float radius = Test::Random(0.5f, 5.0f);
+            expected.clear();
+            found.clear();
+            for (size_t i = 0; i < boxes.size(); ++i)
+                if (Detail::SquaredDistance(boxes[i], center) <= radius * radius)
+                    expected.push_back((uint32_t)i);
+            bvh.CollectOverlaps(center, radius, found);
+            CHECK(SameSet(found, expected));
+        }
+
+        for (int n = 0; n < 200; ++n) {
+            Vector3 o = Test::RandomVector(30.0f), d = Test::RandomVector(10.0f) - o;
+            if (n % 7 == 0)
+                d.z = 0.0f;
+            Vector3 inv(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+
+            // The primitive is its box: the closest entry point wins.
+            float expectedT = 2.0f, t;
+            int expectedHit = -1;
+            for (size_t i = 0; i < boxes.size(); ++i) {
+                if (IntersectRay(boxes[i], o, inv, expectedT, t) && t < expectedT) {
+                    expectedT = t;
+                    expectedHit = (int)i;
+                }
+            }
+
+            float tMax = 2.0f;
+            bool any = bvh.Raycast(o, d, tMax, [&](uint32_t p, float& tClosest) {
+                float tEntry;
+                if (!IntersectRay(boxes[p], o, inv, tClosest, tEntry) || tEntry >= tClosest)
+                    return false;
+                tClosest = tEntry;
+                return true;
+            });
+            CHECK(any == (expectedHit >= 0));
+            if (any && expectedHit >= 0)
+                CHECK_NEAR(tMax, expectedT, 1e-6);
+        }
+    }
+}
+
+TEST_CASE(BVHQueriesMatchLinearScan)
+{
+    std::vector<AABB> boxes = RandomBoxes(3000, 25.0f);
+    BVH bvh;
+    bvh.Build(boxes.data(), boxes.size());
+    CHECK(IsValid(bvh, boxes));
+    CheckQueries(bvh, boxes);
+
+    // Same answers from a tree built on several threads.
+    BVHBuildOptions options;
+    options.parallelThreshold = 256;
+    options.threadCount = 4;
+    options.maxLeafSize = 2;
+    BVH threaded;
+    threaded.Build(boxes.data(), boxes.size(), options);
+    CHECK(IsValid(threaded, boxes));
+    CheckQueries(threaded, boxes);
+}
+
+TEST_CASE(BVHDegenerateInputs)
+{
+    BVH bvh;
+    bvh.Build(NULL, 0);
+    CHECK(bvh.IsEmpty() && bvh.Bounds().IsEmpty());
+    float tMax = 10.0f;
+    CHECK(!bvh.Raycast(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), tMax, [](uint32_t, float&) { return true; }));
+
+    // Fewer primitives than a leaf holds, and many identical ones.
+    std::vector<AABB> boxes = RandomBoxes(3, 5.0f);
+    bvh.Build(boxes.data(), boxes.size());
+    CHECK(IsValid(bvh, boxes) && bvh.Nodes().size() == 1);
+    CheckQueries(bvh, boxes);
+
+    boxes.assign(500, AABB(Vector3(1.0f, 1.0f, 1.0f), Vector3(2.0f, 2.0f, 2.0f)));
+    bvh.Build(boxes.data(), boxes.size());
+    CHECK(IsValid(bvh, boxes));
+    std::vector<uint32_t> found;
+    CHECK(bvh.CollectOverlaps(AABB(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f)), found) == 500);
+}
+
+TEST_CASE(BVHRefitAfterTransforms)
+{
+    const size_t count = 2000;
+    std::vector<AABB> local = RandomBoxes(count, 1.0f), world(count);
+    std::vector<Matrix44> transforms(count);
+    for (size_t i = 0; i < count; ++i)
+        transforms[i].SetTranslation(Test::RandomVector(25.0f));
+    TransformBounds(local.data(), transforms.data(), world.data(), count);
+
+    BVH bvh;
+    bvh.Build(world.data(), count);
+
+    // Move everything: full refit.
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 axis = Test::RandomVector(1.0f);
+        transforms[i] = Rotate(transforms[i], Test::Random(-1.0f, 1.0f), axis);
+        transforms[i].SetTranslation(transforms[i].GetTranslation() + Test::RandomVector(2.0f));
+    }
+    TransformBounds(local.data(), transforms.data(), world.data(), count);
+    bvh.Refit(world.data());
+    CHECK(IsValid(bvh, world));
+    CheckQueries(bvh, world);
+
+    // Move a few: incremental refit.
+    std::vector<uint32_t> changed;
+    for (uint32_t i = 0; i < count; i += 37) {
+        transforms[i].SetTranslation(Test::RandomVector(25.0f));
+        world[i] = TransformBounds(local[i], transforms[i]);
+        changed.push_back(i);
+    }
+    bvh.Refit(world.data(), changed.data(), changed.size());
+    CHECK(IsValid(bvh, world));
+    CheckQueries(bvh, world);
+}
@@ -0,0 +1,96 @@
+#include "TestFramework.h"
+
+#include "BatchTransform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    struct Vertex {
+        Vector3 position;
+        float u, v;
+    };
+
+    Matrix44 RandomMatrix()
+    {
+        Matrix44 m;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = Test::Random(-2.0f, 2.0f);
+        return m;
+    }
+}
+
+// Counts straddle the 8- and 4-wide blocks and the scalar tail.
+TEST_CASE(TransformPointsMatchesOperator)
+{
+    Matrix44 m = RandomMatrix();
+    const size_t counts[] = { 0, 1, 3, 4, 7, 8, 9, 31 };
+
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        size_t count = counts[c];
+        std::vector<Vector3> in3(count), out3(count);
+        std::vector<Vector4> in4(count), out4(count);
+        for (size_t i = 0; i < count; ++i) {
+            in3[i] = Vector3(Test::Random(), Test::Random(), Test::Random());
+            in4[i] = Vector4(in3[i].x, in3[i].y, in3[i].z, 0.5f);
+        }
+
+        TransformPoints(m, in3.data(), out3.data(), count);
+        TransformPoints(m, in4.data(), out4.data(), count);
+
+        for (size_t i = 0; i < count; ++i) {
+            Vector4 expected = m * in4[i];
+            CHECK_NEAR(out3[i].x, expected.x, 1e-5);
+            CHECK_NEAR(out3[i].y, expected.y, 1e-5);
+            CHECK_NEAR(out3[i].z, expected.z, 1e-5);
+            CHECK_NEAR(out4[i].x, expected.x, 1e-5);
+            CHECK_NEAR(out4[i].z, expected.z, 1e-5);
+            CHECK(out4[i].w == 1.0f);
+        }
+    }
+}
+
+TEST_CASE(TransformDirectionsIgnoresTranslation)
+{
+    Matrix44 m = RandomMatrix();
+    std::vector<Vector3> in(13), out(13);
+    std::vector<Vector4> in4(13), out4(13);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = Vector3(Test::Random(), Test::Random(), Test::Random());
+        in4[i] = Vector4(in[i].x, in[i].y, in[i].z, 1.0f);
+    }
+
+    TransformDirections(m, in.data(), out.data(), in.size());
+    TransformDirections(m, in4.data(), out4.data(), in4.size());
+
+    for (size_t i = 0; i < in.size(); ++i) {
+        Vector3 expected = m * in[i];
+        CHECK_NEAR(out[i].x, expected.x, 1e-5);
+        CHECK_NEAR(out[i].y, expected.y, 1e-5);
+        CHECK_NEAR(out[i].z, expected.z, 1e-5);
+        CHECK_NEAR(out4[i].y, expected.y, 1e-5);
+        CHECK(out4[i].w == 0.0f);
+    }
+}
+
+TEST_CASE(TransformPointsStridedInPlace)
+{
+    Matrix44 m = RandomMatrix();
+    std::vector<Vertex> vertices(21);
+    std::vector<Vector3> original(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        original[i] = Vector3(Test::Random(), Test::Random(), Test::Random());
+        vertices[i].position = original[i];
+        vertices[i].u = vertices[i].v = 7.0f;
+    }
+
+    TransformPoints(m, &vertices[0].position, &vertices[0].position, vertices.size(), sizeof(Vertex), sizeof(Vertex));
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Vector4 expected = m * Vector4(original[i].x, original[i].y, original[i].z, 1.0f);
+        CHECK_NEAR(vertices[i].position.x, expected.x, 1e-5);
+        CHECK_NEAR(vertices[i].position.y, expected.y, 1e-5);
+        CHECK_NEAR(vertices[i].position.z, expected.z, 1e-5);
+        CHECK(vertices[i].u == 7.0f && vertices[i].v == 7.0f);
+    }
+}
@@ -0,0 +1,87 @@
+#include "TestFramework.h"
+
+#include "DualQuaternion.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector3D<float> RandomVector(float range)
+    {
+        return Vector3D<float>(Test::Random(-range, range), Test::Random(-range, range), Test::Random(-range, range));
+    }
+
+    Vector3D<float> ToVector3D(const Vector3& v)
+    {
+        return Vector3D<float>(v.x, v.y, v.z);
+    }
+
+    void CheckPoint(const Vector3D<float>& a, const Vector3D<float>& b, double tolerance)
+    {
+        CHECK_NEAR(a.x, b.x, tolerance);
+        CHECK_NEAR(a.y, b.y, tolerance);
+        CHECK_NEAR(a.z, b.z, tolerance);
+    }
+}
+
+TEST_CASE(DualQuaternionMatchesTransform)
+{
+    for (int n = 0; n < 100; ++n) {
+        Transform t(Test::RandomUnitQuaternion(), Vector3(Test::Random(-5.0f, 5.0f), Test::Random(-5.0f, 5.0f), Test::Random(-5.0f, 5.0f)));
+        DualQuaternion<float> dq = DualQuaternion<float>::FromTransform(t);
+        Vector3D<float> p = RandomVector(3.0f);
+        Vector3 pv(p.x, p.y, p.z);
+
+        CheckPoint(dq.Translation(), ToVector3D(t.translation), 1e-5);
+        CheckPoint(dq.TransformPoint(p), ToVector3D(t.TransformPoint(pv)), 1e-4);
+        CheckPoint(dq.TransformDirection(p), ToVector3D(t.TransformDirection(pv)), 1e-4);
+
+        // Round trips through Transform and Matrix44.
+        Transform back = DualQuaternion<float>::FromMatrix44(dq.ToMatrix44()).ToTransform();
+        CheckPoint(ToVector3D(back.TransformPoint(pv)), ToVector3D(t.TransformPoint(pv)), 1e-4);
+    }
+}
+
+TEST_CASE(DualQuaternionProductAndInverse)
+{
+    for (int n = 0; n < 100; ++n) {
+        DualQuaternion<float> a(Test::RandomUnitQuaternion(), RandomVector(5.0f)), b(Test::RandomUnitQuaternion(), RandomVector(5.0f));
+        Vector3D<float> p = RandomVector(3.0f);
+
+        // Like quaternions, a * b applies b first.
+        CheckPoint((a * b).TransformPoint(p), a.TransformPoint(b.TransformPoint(p)), 1e-4);
+        CheckPoint(a.Conjugate().TransformPoint(a.TransformPoint(p)), p, 1e-4);
+
+        DualQuaternion<float> scaled = (a * 3.0f).Normalized();
+        CheckPoint(scaled.TransformPoint(p), a.TransformPoint(p), 1e-4);
+    }
+}
+
+TEST_CASE(DualQuaternionBlend)
+{
+    DualQuaternion<float> dq[3] = {
+        DualQuaternion<float>(Test::RandomUnitQuaternion(), RandomVector(2.0f)),
+        DualQuaternion<float>(Test::RandomUnitQuaternion(), RandomVector(2.0f)),
+        DualQuaternion<float>(Test::RandomUnitQuaternion(), RandomVector(2.0f))
+    };
+    float weights[3] = { 1.0f, 0.0f, 0.0f };
+    Vector3D<float> p = RandomVector(1.0f);
+    CheckPoint(Blend(dq, weights, 3).TransformPoint(p), dq[0].TransformPoint(p), 1e-5);
+
+    // Either sign of a bone's dual quaternion blends the same.
+    weights[0] = 0.5f;
+    weights[1] = 0.3f;
+    weights[2] = 0.2f;
+    DualQuaternion<float> blend = Blend(dq, weights, 3);
+    dq[1] = dq[1] * -1.0f;
+    CheckPoint(Blend(dq, weights, 3).TransformPoint(p), blend.TransformPoint(p), 1e-5);
+
+    // The result is a unit dual quaternion.
+    CHECK_NEAR(Detail::Dot(blend.real, blend.real), 1.0, 1e-5);
+    CHECK_NEAR(Detail::Dot(blend.real, blend.dual), 0.0, 1e-5);
+
+    // Two bones with the same rotation blend their translations linearly.
+    Quaternion<float> q = Test::RandomUnitQuaternion();
+    DualQuaternion<float> pair[2] = { DualQuaternion<float>(q, Vector3D<float>(0.0f, 0.0f, 0.0f)), DualQuaternion<float>(q, Vector3D<float>(4.0f, 0.0f, 0.0f)) };
+    float half[2] = { 0.75f, 0.25f };
+    CheckPoint(Blend(pair, half, 2).Translation(), Vector3D<float>(1.0f, 0.0f, 0.0f), 1e-5);
+}
@@ -0,0 +1,187 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "EulerAngle.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    const EulerOrder orders[] = {
+        EulerOrder::XYZ, EulerOrder::XZY, EulerOrder::YXZ, EulerOrder::YZX, EulerOrder::ZXY, EulerOrder::ZYX,
+        EulerOrder::XYX, EulerOrder::XZX, EulerOrder::YXY, EulerOrder::YZY, EulerOrder::ZXZ, EulerOrder::ZYZ
+    };
+    const char* const names[] = { "XYZ", "XZY", "YXZ", "YZX", "ZXY", "ZYX", "XYX", "XZX", "YXY", "YZY", "ZXZ", "ZYZ" };
+    const double pi = 3.14159265358979323846;
+
+    template <typename T>
+    Quaternion<T> AxisRotation(char axis, T angle)
+    {
+        Vector3D<T> v(axis == 'X' ? T(1) : T(0), axis == 'Y' ? T(1) : T(0), axis == 'Z' ? T(1) : T(0));
+        return Quaternion<T>(T(cos(angle * 0.5)), v * T(sin(angle * 0.5)));
+    }
+
+    // One rotation after another about the fixed axes the name spells.
+    template <typename T>
+    Quaternion<T> Reference(int order, T first, T second, T third)
+    {
+        const char* axes = names[order];
+        return AxisRotation(axes[2], third) * AxisRotation(axes[1], second) * AxisRotation(axes[0], first);
+    }
+
+    template <typename T>
+    double Distance(const Quaternion<T>& a, const Quaternion<T>& b)
+    {
+        // 1 - |cos(half the angle between them)|, blind to the sign of q.
+        return 1.0 - fabs(double(a.w * b.w + a.v.x * b.v.x + a.v.y * b.v.y + a.v.z * b.v.z));
+    }
+
+    bool IsProper(int order) { return order >= 6; }
+
+    // Random angles; every fourth set sits exactly on a gimbal lock.
+    void RandomAngles(int order, size_t i, double& first, double& second, double& third)
+    {
+        first = Test::Random(-3.0f, 3.0f);
+        second = IsProper(order) ? Test::Random(0.05f, 3.0f) : Test::Random(-1.5f, 1.5f);
+        third = Test::Random(-3.0f, 3.0f);
+        if (i % 4 == 1)
+            second = IsProper(order) ? 0.0 : pi / 2;
+        if (i % 4 == 3)
+            second = IsProper(order) ? pi : -pi / 2;
+    }
+}
+
+TEST_CASE(EulerOrdersComposeAxisRotations)
+{
+    for (int o = 0; o < 12; ++o) {
+        double worst = 0.0, worstFloat = 0.0;
+        for (int n = 0; n < 50; ++n) {
+            double a = Test::Random(-4.0f, 4.0f), b = Test::Random(-4.0f, 4.0f), c = Test::Random(-4.0f, 4.0f);
+            EulerAngles<double> e(a, b, c, orders[o]);
+            worst = fmax(worst, Distance(e.ToQuaternion(), Reference(o, a, b, c)));
+            EulerAngles<float> f(float(a), float(b), float(c), orders[o]);
+            worstFloat = fmax(worstFloat, Distance(f.ToQuaternion(), Reference(o, float(a), float(b), float(c))));
+        }
+        CHECK(worst < 1e-14);
+        CHECK(worstFloat < 1e-6);
+        if (!(worst < 1e-14 && worstFloat < 1e-6))
+            printf("    order %s\n", names[o]);
+    }
+
+    // XYZ for row vectors: x first, so rotating (0, 1, 0) a quarter turn
+    // about x gives (0, 0, 1), and then a quarter turn about z leaves it.
+    Vector3D<double> p = EulerAngles<double>(pi / 2, 0.0, pi / 2).ToQuaternion().Rotate(Vector3D<double>(0.0, 1.0, 0.0));
+    CHECK_NEAR(p.x, 0.0, 1e-15);
+    CHECK_NEAR(p.y, 0.0, 1e-15);
+    CHECK_NEAR(p.z, 1.0, 1e-15);
+}
+
+TEST_CASE(EulerRoundTripsAndGimbalLock)
+{
+    for (int o = 0; o < 12; ++o) {
+        bool ok = true;
+        for (size_t n = 0; n < 64; ++n) {
+            double a, b, c;
+            RandomAngles(o, n, a, b, c);
+            Quaternion<double> q = EulerAngles<double>(a, b, c, orders[o]).ToQuaternion();
+            EulerAngles<double> e = EulerAngles<double>::FromQuaternion(q * -2.5, orders[o]);
+            ok = ok && e.order == orders[o] && Distance(e.ToQuaternion(), q) < 1e-14;
+            ok = ok && fabs(e.first) <= pi && fabs(e.third) <= pi;
+            ok = ok && (IsProper(o) ? e.second >= 0.0 && e.second <= pi : fabs(e.second) <= pi / 2 + 1e-12);
+            if (n % 2 == 0)
+                // Away from the lock and inside the canonical ranges the
+                // angles themselves come back.
+                ok = ok && fabs(e.first - a) < 1e-12 && fabs(e.second - b) < 1e-12 && fabs(e.third - c) < 1e-12;
+            else
+                ok = ok && e.third == 0.0;
+
+            EulerAngles<float> f = EulerAngles<float>::FromQuaternion(Quaternion<float>(float(q.w), Vector3D<float>(float(q.v.x), float(q.v.y), float(q.v.z))), orders[o]);
+            Quaternion<double> fq(f.ToQuaternion().w, Vector3D<double>(f.ToQuaternion().v.x, f.ToQuaternion().v.y, f.ToQuaternion().v.z));
+            ok = ok && Distance(fq, q) < 1e-6;
+        }
+        CHECK(ok);
+        if (!ok)
+            printf("    order %s\n", names[o]);
+    }
+
+    // A quarter turn about y lines the x and z rotations up, so only
+    // their combination is defined and it all goes into first.
+    EulerAngles<double> locked = EulerAngles<double>::FromQuaternion(EulerAngles<double>(0.3, pi / 2, 0.4).ToQuaternion(), EulerOrder::XYZ);
+    CHECK_NEAR(locked.second, pi / 2, 1e-7);
+    CHECK(locked.third == 0.0);
+    CHECK(Distance(locked.ToQuaternion(), EulerAngles<double>(0.3, pi / 2, 0.4).ToQuaternion()) < 1e-14);
+}
+
+TEST_CASE(EulerMatrixConversions)
+{
+    for (int o = 0; o < 12; ++o) {
+        bool ok = true;
+        for (size_t n = 0; n < 16; ++n) {
+            double a, b, c;
+            RandomAngles(o, n, a, b, c);
+            EulerAngles<float> e(float(a), float(b), float(c), orders[o]);
+            Quaternion<float> q = e.ToQuaternion();
+            Mat3x3<float> m = e.ToMat3x3();
+            Matrix44 m44 = e.ToMatrix44();
+
+            // Row vectors: p * M rotates p like q does.
+            Vector3D<float> p(0.3f, -0.7f, 0.5f), r = q.Rotate(p);
+            for (int k = 0; k < 3; ++k) {
+                float x = p.x * m[0][k] + p.y * m[1][k] + p.z * m[2][k];
+                ok = ok && fabs(x - (&r.x)[k]) < 1e-5 && m44[0][k] == m[0][k] && m44[2][k] == m[2][k];
+            }
+            ok = ok && m44[3][3] == 1.0f && m44[3][0] == 0.0f;
+
+            ok = ok && Distance(EulerAngles<float>::FromMatrix(m, orders[o]).ToQuaternion(), q) < 1e-6;
+            ok = ok && Distance(EulerAngles<float>::FromMatrix(m44, orders[o]).ToQuaternion(), q) < 1e-6;
+        }
+        CHECK(ok);
+        if (!ok)
+            printf("    order %s\n", names[o]);
+    }
+}
+
+TEST_CASE(EulerBatchMatchesScalar)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 45;
+    for (int o = 0; o < 12; ++o) {
+        Vector3Stream angles(count);
+        std::vector<EulerAngles<float> > scalar;
+        for (size_t i = 0; i < count; ++i) {
+            double a, b, c;
+            RandomAngles(o, i, a, b, c);
+            angles.Set(i, Vector3(float(a), float(b), float(c)));
+            scalar.push_back(EulerAngles<float>(float(a), float(b), float(c), orders[o]));
+        }
+
+        QuaternionStream q;
+        std::vector<Matrix44> matrices(count);
+        Vector3Stream back;
+        EulerToQuaternionMany(angles, orders[o], q);
+        EulerToMatrix44Many(angles, orders[o], matrices.data());
+        QuaternionToEulerMany(q, orders[o], back);
+        CHECK(q.Size() == count && back.Size() == count);
+
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i) {
+            Quaternion<float> expected = scalar[i].ToQuaternion(), got = q.Get(i);
+            ok = ok && fabs(got.w - expected.w) < 1e-6 && fabs(got.v.x - expected.v.x) < 1e-6 && fabs(got.v.y - expected.v.y) < 1e-6 && fabs(got.v.z - expected.v.z) < 1e-6;
+
+            Matrix44 m = scalar[i].ToMatrix44();
+            for (int r = 0; r < 4; ++r)
+                for (int c = 0; c < 4; ++c)
+                    ok = ok && fabs(matrices[i][r][c] - m[r][c]) < 1e-5;
+
+            // Angles may differ from the scalar ones by 2 pi or at the
+            // lock, so compare the rotations they make.
+            Vector3 e = back.Get(i);
+            EulerAngles<float> s = EulerAngles<float>::FromQuaternion(got, orders[o]);
+            ok = ok && Distance(EulerAngles<float>(e.x, e.y, e.z, orders[o]).ToQuaternion(), got) < 1e-6;
+            ok = ok && fabs(e.y - s.second) < 1e-5 && (i % 2 == 0 || e.z == 0.0f);
+        }
+        CHECK(ok);
+        if (!ok)
+            printf("    order %s\n", names[o]);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Quaternion.h"
+#include "Vector3.h"
+
+// Minimal self-registering test harness. Each TEST_CASE is run by TestMain.cpp;
+// a failed CHECK reports the location and marks the case as failed but keeps
+// running so one run shows every mismatch.
+namespace Test {
+    typedef void (*TestFunction)();
+
+    struct TestCase {
+        const char* name;
+        TestFunction function;
+    };
+
+    inline std::vector<TestCase>& Registry()
+    {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+
+    inline int& FailureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, TestFunction function)
+        {
+            TestCase testCase = { name, function };
+            Registry().push_back(testCase);
+        }
+    };
+
+    inline void Fail(const char* file, int line, const char* expression)
+    {
+        printf("    %s:%d: CHECK(%s) failed\n", file, line, expression);
+        ++FailureCount();
+    }
+
+    // Reset before every case, so a case's random data does not depend on
+    // which cases ran before it.
+    inline unsigned int& RandomState()
+    {
+        static unsigned int state = 0x12345678u;
+        return state;
+    }
+
+    // Deterministic pseudo-random floats in [lo, hi] so failures are reproducible.
+    inline float Random(float lo = -1.0f, float hi = 1.0f)
+    {
+        unsigned int& state = RandomState();
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * ((state >> 8) * (1.0f / 16777216.0f));
+    }
+
+    inline Oblivion::Math::Vector3 RandomVector(float range)
+    {
+        return Oblivion::Math::Vector3(Random(-range, range), Random(-range, range), Random(-range, range));
+    }
+
+    // A random rotation: a random quaternion scaled to unit length.
+    inline Oblivion::Math::Quaternion<float> RandomUnitQuaternion()
+    {
+        Oblivion::Math::Quaternion<float> q(Random(), Oblivion::Math::Vector3D<float>(Random(), Random(), Random()));
+        float length = sqrtf(q.DotProduct(q, q));
+        return q * (1.0f / length);
+    }
+} // end namespace Test
+
+#define TEST_CASE(name)                                            \
+    static void name();                                            \
+    static Test::Registrar name##Registrar(#name, name);           \
+    static void name()
+
+#define CHECK(expression)                                          \
+    do {                                                           \
+        if (!(expression))                                         \
+            Test::Fail(__FILE__, __LINE__, #expression);           \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(fabs((double)(a) - (double)(b)) <= (tolerance))
@@ -0,0 +1,121 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Frustum.h"
+#include "MatrixTransform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // 90 degree square frustum looking down the view direction, near 1, far 100.
+    Frustum MakeFrustum()
+    {
+        return Frustum::FromMatrix(Perspective(PI / 2.0f, 1.0f, 1.0f, 100.0f));
+    }
+
+    // Views into the arrays of a set of random boxes and spheres.
+    struct Volumes {
+        std::vector<float> minX, minY, minZ, maxX, maxY, maxZ, radius;
+
+        explicit Volumes(size_t count)
+        {
+            for (size_t i = 0; i < count; ++i) {
+                float x = Test::Random(-150.0f, 150.0f), y = Test::Random(-150.0f, 150.0f), z = Test::Random(-150.0f, 150.0f);
+                float ex = Test::Random(0.0f, 10.0f), ey = Test::Random(0.0f, 10.0f), ez = Test::Random(0.0f, 10.0f);
+                minX.push_back(x - ex);
+                minY.push_back(y - ey);
+                minZ.push_back(z - ez);
+                maxX.push_back(x + ex);
+                maxY.push_back(y + ey);
+                maxZ.push_back(z + ez);
+                radius.push_back(ex);
+            }
+        }
+
+        AABBStreamView Boxes() const { return AABBStreamView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), minX.size()); }
+        SphereStreamView Spheres() const { return SphereStreamView(minX.data(), minY.data(), minZ.data(), radius.data(), minX.size()); }
+    };
+}
+
+TEST_CASE(PlaneFromPoints)
+{
+    Plane p = Plane::FromPoints(Vector3(0.0f, 0.0f, 2.0f), Vector3(1.0f, 0.0f, 2.0f), Vector3(0.0f, 1.0f, 2.0f));
+    CHECK_NEAR(p.normal.z, 1.0, 1e-6);
+    CHECK_NEAR(p.SignedDistance(Vector3(5.0f, -3.0f, 5.0f)), 3.0, 1e-6);
+
+    Plane q(0.0f, 2.0f, 0.0f, 4.0f);
+    q.Normalize();
+    CHECK_NEAR(q.SignedDistance(Vector3(0.0f, 0.0f, 0.0f)), 2.0, 1e-6);
+}
+
+TEST_CASE(FrustumFromPerspective)
+{
+    Frustum f = MakeFrustum();
+    for (int i = 0; i < Frustum::PlaneCount; ++i)
+        CHECK_NEAR(f.planes[i].normal.Magnitude(), 1.0, 1e-6);
+
+    // The view direction is +z for DirectX and -z for OpenGL.
+    float forward = USING_OPENGL ? -1.0f : 1.0f;
+    CHECK(f.Contains(Vector3(0.0f, 0.0f, 10.0f * forward)));
+    CHECK(f.Contains(Vector3(9.0f, -9.0f, 10.0f * forward)));
+    CHECK(!f.Contains(Vector3(11.0f, 0.0f, 10.0f * forward)));
+    CHECK(!f.Contains(Vector3(0.0f, 0.0f, 0.5f * forward)));
+    CHECK(!f.Contains(Vector3(0.0f, 0.0f, 101.0f * forward)));
+    CHECK(!f.Contains(Vector3(0.0f, 0.0f, -10.0f * forward)));
+    CHECK_NEAR(f.planes[Frustum::Near].SignedDistance(Vector3(0.0f, 0.0f, 3.0f * forward)), 2.0, 1e-4);
+
+    CHECK(f.Intersects(Vector3(10.5f, -1.0f, 10.0f * forward - 1.0f), Vector3(12.0f, 1.0f, 10.0f * forward + 1.0f)));
+    CHECK(!f.Intersects(Vector3(11.5f, -1.0f, 10.0f * forward - 1.0f), Vector3(12.0f, 1.0f, 10.0f * forward + 1.0f)));
+    CHECK(f.Intersects(Vector3(0.0f, 0.0f, 0.5f * forward), 0.6f));
+    CHECK(!f.Intersects(Vector3(0.0f, 0.0f, 0.5f * forward), 0.4f));
+}
+
+TEST_CASE(FrustumFromOrthographic)
+{
+    Frustum f = Frustum::FromMatrix(Orthographic(0.0f, 10.0f, 0.0f, 10.0f, 1.0f, 100.0f));
+
+    float forward = USING_OPENGL ? -1.0f : 1.0f;
+    CHECK(f.Contains(Vector3(5.0f, 5.0f, 50.0f * forward)));
+    CHECK(f.Contains(Vector3(9.5f, 0.5f, 2.0f * forward)));
+    CHECK(!f.Contains(Vector3(-20.0f, 5.0f, 50.0f * forward)));
+    CHECK(!f.Contains(Vector3(11.0f, 5.0f, 50.0f * forward)));
+    CHECK(!f.Contains(Vector3(5.0f, -1.0f, 50.0f * forward)));
+    CHECK(!f.Contains(Vector3(5.0f, 5.0f, 0.5f * forward)));
+    CHECK(!f.Contains(Vector3(5.0f, 5.0f, 101.0f * forward)));
+    CHECK_NEAR(f.planes[Frustum::Left].SignedDistance(Vector3(3.0f, 5.0f, 50.0f * forward)), 3.0, 1e-4);
+}
+
+TEST_CASE(CullMatchesScalarTests)
+{
+    // A rotated, translated camera so no plane is axis aligned.
+    Vector3 axis(0.3f, 1.0f, 0.2f);
+    Matrix44 view = Rotate(Matrix44(1.0f), 0.7f, axis);
+    view.SetTranslation(Vector3(3.0f, -2.0f, 5.0f));
+    Frustum f = Frustum::FromMatrix(view * Perspective(1.1f, 1.5f, 0.5f, 120.0f));
+
+    const size_t count = 2003;
+    Volumes volumes(count);
+    std::vector<uint32_t> visible(count);
+
+    size_t boxCount = CullAABBs(f, volumes.Boxes(), visible.data());
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < count; ++i)
+        if (f.Intersects(Vector3(volumes.minX[i], volumes.minY[i], volumes.minZ[i]), Vector3(volumes.maxX[i], volumes.maxY[i], volumes.maxZ[i])))
+            expected.push_back((uint32_t)i);
+    CHECK(boxCount == expected.size());
+    CHECK(boxCount > 0 && boxCount < count);
+    for (size_t i = 0; i < boxCount && i < expected.size(); ++i)
+        CHECK(visible[i] == expected[i]);
+
+    size_t sphereCount = CullSpheres(f, volumes.Spheres(), visible.data());
+    expected.clear();
+    for (size_t i = 0; i < count; ++i)
+        if (f.Intersects(Vector3(volumes.minX[i], volumes.minY[i], volumes.minZ[i]), volumes.radius[i]))
+            expected.push_back((uint32_t)i);
+    CHECK(sphereCount == expected.size());
+    for (size_t i = 0; i < sphereCount && i < expected.size(); ++i)
+        CHECK(visible[i] == expected[i]);
+
+    CHECK(CullAABBs(f, AABBStreamView(NULL, NULL, NULL, NULL, NULL, NULL, 0), visible.data()) == 0);
+}
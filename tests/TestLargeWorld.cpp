@@ -0,0 +1,114 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "LargeWorld.h"
+#include "Mat3x3.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // Far enough out that float world coordinates are only good to ~0.03.
+    const Vector3d camera(412345.678, -98765.4321, 250001.25);
+
+    Vector3d NearCamera(double range)
+    {
+        return camera + Vector3d(Test::Random(-1.0f, 1.0f) * range, Test::Random(-1.0f, 1.0f) * range, Test::Random(-1.0f, 1.0f) * range);
+    }
+
+    Matrix44d RandomTransform()
+    {
+        Matrix44d m(Vector4d(0.0, 0.8, -0.6, 0.0), Vector4d(-1.0, 0.0, 0.0, 0.0), Vector4d(0.0, 0.6, 0.8, 0.0), Vector4d(0.0, 0.0, 0.0, 1.0));
+        Vector3d t = NearCamera(50.0);
+        m[3] = Vector4d(t.x, t.y, t.z, 1.0);
+        return m;
+    }
+}
+
+TEST_CASE(PrecisionConversions)
+{
+    Vector3d d(1.0 / 3.0, 2.0, -4.5);
+    Vector<3, float> f(d);
+    CHECK(f.x == 1.0f / 3.0f && f.y == 2.0f && f.z == -4.5f);
+    CHECK(Vector3d(f).z == -4.5);
+
+    Matrix<4, 4, float> m(Matrix44d::Identity() * 2.0);
+    CHECK(m[0][0] == 2.0f && m[3][3] == 2.0f && m[1][0] == 0.0f);
+
+    // Mat3x3<double> keeps double precision through the inverse.
+    Mat3x3<double> a(3.0, 0.0, 0.0, 0.0, 7.0, 0.0, 0.0, 0.0, 1.0);
+    CHECK_NEAR((a.Inverse() * a.Determinant())[0][0], 7.0, 1e-14);
+    CHECK_NEAR(a.Inverse()[1][1], 1.0 / 7.0, 1e-16);
+}
+
+TEST_CASE(CameraRelativePoints)
+{
+    CameraRelativeOrigin origin(camera);
+    Vector3d p = camera + Vector3d(1.0e-3, -2.5e-3, 0.25);
+    Vector3 r = origin.ToRelative(p);
+    // Millimetres survive, which they would not as float world coordinates.
+    CHECK_NEAR(r.x, 1.0e-3, 1e-9);
+    CHECK_NEAR(r.y, -2.5e-3, 1e-9);
+    CHECK(r.z == 0.25f);
+    CHECK_NEAR(origin.ToWorld(r).y, p.y, 1e-9);
+
+    // Odd count to cover the scalar tail.
+    const size_t count = 103;
+    std::vector<Vector3d> world;
+    for (size_t i = 0; i < count; ++i)
+        world.push_back(NearCamera(1000.0));
+    Vector3Stream relative;
+    origin.ToRelative(world.data(), count, relative);
+    CHECK(relative.Size() == count);
+    bool same = true;
+    for (size_t i = 0; i < count; ++i)
+        same = same && relative.Get(i) == origin.ToRelative(world[i]);
+    CHECK(same);
+
+    origin.SetOrigin(world[7]);
+    CHECK(origin.ToRelative(world[7]) == Vector3(0.0f, 0.0f, 0.0f));
+}
+
+TEST_CASE(CameraRelativeMatrices)
+{
+    CameraRelativeOrigin origin(camera);
+    const size_t count = 9;
+    std::vector<Matrix44d> world;
+    for (size_t i = 0; i < count; ++i)
+        world.push_back(RandomTransform());
+    std::vector<Matrix44> relative(count);
+    origin.ToRelative(world.data(), relative.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        Matrix44 single = origin.ToRelative(world[i]);
+        CHECK(single == relative[i]);
+        CHECK(relative[i][0][1] == 0.8f && relative[i][2][2] == 0.8f && relative[i][3][3] == 1.0f);
+
+        // A local point lands at its world position minus the origin.
+        Vector4d local(0.5, -1.5, 2.0, 1.0);
+        Vector4d w = world[i] * local;
+        Vector4 r = relative[i] * Vector4(0.5f, -1.5f, 2.0f, 1.0f);
+        CHECK_NEAR(r.x, w.x - camera.x, 1e-5);
+        CHECK_NEAR(r.y, w.y - camera.y, 1e-5);
+        CHECK_NEAR(r.z, w.z - camera.z, 1e-5);
+    }
+
+    // A view looking from the camera: rotation R, translation -camera * R.
+    Matrix44d view = RandomTransform();
+    Vector4d t = -(view[0] * camera.x + view[1] * camera.y + view[2] * camera.z);
+    view[3] = Vector4d(t.x, t.y, t.z, 1.0);
+    Matrix44 relativeView = origin.ToRelativeView(view);
+    CHECK_NEAR(relativeView[3][0], 0.0, 1e-9);
+    CHECK_NEAR(relativeView[3][1], 0.0, 1e-9);
+    CHECK_NEAR(relativeView[3][2], 0.0, 1e-9);
+
+    // Relative points through the relative view match world points through
+    // the double view.
+    Vector3d p = NearCamera(10.0);
+    Vector3 rp = origin.ToRelative(p);
+    Vector4 v = relativeView * Vector4(rp.x, rp.y, rp.z, 1.0f);
+    Vector4d e = view * Vector4d(p.x, p.y, p.z, 1.0);
+    CHECK_NEAR(v.x, e.x, 1e-5);
+    CHECK_NEAR(v.y, e.y, 1e-5);
+    CHECK_NEAR(v.z, e.z, 1e-5);
+}
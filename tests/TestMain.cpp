@@ -0,0 +1,23 @@
+#include "TestFramework.h"
+
+#include "MathSIMD.h"
+
+int main()
+{
+    const char* backend = USING_AVX2 ? (USING_FMA ? "avx2+fma" : "avx2") : (USING_SSE ? "sse4.1" : "scalar");
+    printf("Running %u test cases (%s)\n", (unsigned)Test::Registry().size(), backend);
+
+    int failedCases = 0;
+    for (size_t i = 0; i < Test::Registry().size(); ++i) {
+        const Test::TestCase& testCase = Test::Registry()[i];
+        int before = Test::FailureCount();
+        Test::RandomState() = 0x12345678u;
+        testCase.function();
+        bool passed = Test::FailureCount() == before;
+        printf("[%s] %s\n", passed ? " OK " : "FAIL", testCase.name);
+        failedCases += passed ? 0 : 1;
+    }
+
+    printf("%d of %u test cases failed\n", failedCases, (unsigned)Test::Registry().size());
+    return failedCases == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Mat3x3Stream.h"
+#include "Transform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Mat3x3<float> RandomMatrix()
+    {
+        Mat3x3<float> m;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                m[r][c] = Test::Random(-1.0f, 1.0f) + (r == c ? 2.0f : 0.0f);
+        return m;
+    }
+
+    // Every few matrices has no inverse: a zero row, a zero column, a
+    // determinant below the float range, or a NaN.
+    Mat3x3<float> MaybeSingular(size_t i)
+    {
+        Mat3x3<float> m = RandomMatrix();
+        if (i % 9 == 2)
+            m[1][0] = m[1][1] = m[1][2] = 0.0f;
+        if (i % 9 == 5)
+            m[0][2] = m[1][2] = m[2][2] = 0.0f;
+        if (i % 11 == 7)
+            m = Mat3x3<float>(1e-15f);
+        if (i % 13 == 12)
+            m[2][1] = NAN;
+        return m;
+    }
+
+    double MaxDifference(const Mat3x3<float>& a, const Mat3x3<float>& b)
+    {
+        double error = 0.0;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                error = fmax(error, fabs(double(a[r][c]) - b[r][c]));
+        return error;
+    }
+}
+
+TEST_CASE(Mat3x3InverseReportsSingular)
+{
+    bool singular = true;
+    Mat3x3<float> m = RandomMatrix();
+    CHECK(MaxDifference(m * m.Inverse(&singular), Mat3x3<float>(1.0f)) < 1e-5);
+    CHECK(!singular);
+
+    Mat3x3<float> flat(1.0f, 2.0f, 3.0f, 0.0f, 0.0f, 0.0f, 4.0f, 5.0f, 6.0f);
+    CHECK(flat.Inverse(&singular) == Mat3x3<float>(1.0f));
+    CHECK(singular);
+    CHECK(Mat3x3<float>(1e-15f).Inverse(&singular) == Mat3x3<float>(1.0f) && singular);
+    // Representable in double, so not singular there.
+    CHECK_NEAR(Mat3x3<double>(1e-15).Inverse(&singular)[0][0] * 1e-15, 1.0, 1e-12);
+    CHECK(!singular);
+
+    // x * m = b.
+    Vector3D<float> b(0.5f, -1.0f, 2.0f), x = m.Solve(b, &singular);
+    Vector3D<float> back = m * x;
+    CHECK(!singular);
+    CHECK_NEAR(back.x, b.x, 1e-5);
+    CHECK_NEAR(back.y, b.y, 1e-5);
+    CHECK_NEAR(back.z, b.z, 1e-5);
+}
+
+TEST_CASE(InverseManyMatchesScalar)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 45;
+    std::vector<Mat3x3<float> > m, aos(count);
+    for (size_t i = 0; i < count; ++i)
+        m.push_back(MaybeSingular(i));
+    Mat3x3Stream soa(m.data(), count), inverse;
+    std::vector<uint8_t> singular(count, 2), aosSingular(count, 2);
+
+    size_t singularCount = InverseMany(soa, inverse, singular.data());
+    CHECK(InverseMany(m.data(), count, aos.data(), aosSingular.data()) == singularCount);
+    CHECK(inverse.Size() == count);
+    CHECK(InverseMany(soa, inverse) == singularCount);
+
+    size_t expectedCount = 0;
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        bool s;
+        Mat3x3<float> expected = m[i].Inverse(&s);
+        expectedCount += s;
+        ok = ok && singular[i] == (s ? 1 : 0) && aosSingular[i] == singular[i];
+        ok = ok && MaxDifference(inverse.Get(i), expected) < 1e-5 && inverse.Get(i) == aos[i];
+    }
+    CHECK(ok);
+    CHECK(singularCount == expectedCount && expectedCount > 4);
+}
+
+TEST_CASE(SolveManyAndNormalMatrices)
+{
+    const size_t count = 29;
+    std::vector<Mat3x3<float> > a;
+    Vector3Stream b(count), x;
+    for (size_t i = 0; i < count; ++i) {
+        a.push_back(MaybeSingular(i));
+        b.Set(i, Vector3(Test::Random(-2.0f, 2.0f), Test::Random(-2.0f, 2.0f), Test::Random(-2.0f, 2.0f)));
+    }
+    std::vector<uint8_t> singular(count);
+    size_t singularCount = SolveMany(Mat3x3Stream(a.data(), count), b, x, singular.data());
+    CHECK(x.Size() == count && singularCount > 2);
+
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 bi = b.Get(i), xi = x.Get(i);
+        Vector3D<float> expected = a[i].Solve(Vector3D<float>(bi.x, bi.y, bi.z));
+        ok = ok && fabsf(xi.x - expected.x) < 1e-5f && fabsf(xi.y - expected.y) < 1e-5f && fabsf(xi.z - expected.z) < 1e-5f;
+        if (singular[i])
+            ok = ok && xi == bi;
+    }
+    CHECK(ok);
+
+    // Normals stay perpendicular to the surface under non-uniform scale.
+    std::vector<Matrix44> world;
+    for (size_t i = 0; i < count; ++i) {
+        Quaternion<float> q(Test::Random(-1.0f, 1.0f), Vector3D<float>(Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f)));
+        q = q * (1.0f / sqrtf(q.DotProduct(q, q)));
+        Vector3 scale(Test::Random(0.2f, 3.0f), Test::Random(0.2f, 3.0f), i % 10 == 3 ? 0.0f : Test::Random(0.2f, 3.0f));
+        world.push_back(LocalMatrix(q, Vector3(1.0f, 2.0f, 3.0f), scale));
+    }
+    Mat3x3Stream normals;
+    std::vector<Mat3x3<float> > aosNormals(count);
+    std::vector<uint8_t> aosSingular(count);
+    singularCount = NormalMatrixMany(world.data(), count, normals, singular.data());
+    CHECK(NormalMatrixMany(world.data(), count, aosNormals.data(), aosSingular.data()) == singularCount);
+    CHECK(singularCount == 3);
+
+    for (size_t i = 0; i < count; ++i) {
+        bool s;
+        Mat3x3<float> n = normals.Get(i), expected = NormalMatrixFromMatrix44(world[i], &s);
+        ok = ok && singular[i] == (s ? 1 : 0) && aosSingular[i] == singular[i] && n == aosNormals[i];
+        ok = ok && MaxDifference(n, expected) < 1e-4;
+        if (s)
+            continue;
+
+        // A tangent t and normal v of a surface: t * m stays perpendicular
+        // to v * n.
+        Vector3D<float> v(0.3f, -0.5f, 0.8f), t(0.5f, 0.3f, 0.0f);
+        Mat3x3<float> upper(world[i][0][0], world[i][0][1], world[i][0][2], world[i][1][0], world[i][1][1], world[i][1][2], world[i][2][0], world[i][2][1], world[i][2][2]);
+        ok = ok && fabsf((upper * t) * (n * v)) < 1e-4f;
+    }
+    CHECK(ok);
+
+    // The scalar version agrees with the inverse transpose.
+    Matrix44 m = world[0];
+    Mat3x3<float> upper(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2], m[2][0], m[2][1], m[2][2]);
+    CHECK(MaxDifference(NormalMatrixFromMatrix44(m), upper.Inverse().Transpose()) == 0.0);
+}
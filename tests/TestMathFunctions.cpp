@@ -0,0 +1,149 @@
+#include "TestFramework.h"
+
+#include "MathFunctions.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // Distance from the double reference in units of the float spacing there.
+    double Ulps(float got, double expected)
+    {
+        float rounded = (float)fabs(expected);
+        double ulp = (double)nextafterf(rounded, INFINITY) - rounded;
+        return fabs(got - expected) / ulp;
+    }
+
+    struct Errors {
+        double sinCos, tan, inverse, fast;
+
+        Errors() : sinCos(0.0), tan(0.0), inverse(0.0), fast(0.0) {}
+    };
+
+    template <Precision P>
+    void Accumulate(Errors& e, float x, float unit)
+    {
+        float s, c;
+        SinCos<P>(x, s, c);
+        if (P == Precision::Fast) {
+            e.fast = fmax(e.fast, fmax(fabs(s - sin((double)x)), fabs(c - cos((double)x))));
+            e.fast = fmax(e.fast, fabs(ASin<P>(unit) - asin((double)unit)));
+            e.fast = fmax(e.fast, fabs(ACos<P>(unit) - acos((double)unit)));
+            e.fast = fmax(e.fast, fabs(ATan<P>(x) - atan((double)x)));
+            return;
+        }
+        e.sinCos = fmax(e.sinCos, fmax(Ulps(s, sin((double)x)), Ulps(c, cos((double)x))));
+        e.sinCos = fmax(e.sinCos, fmax(Ulps(Sin<P>(x), sin((double)x)), Ulps(Cos<P>(x), cos((double)x))));
+        e.tan = fmax(e.tan, Ulps(Tan<P>(x), tan((double)x)));
+        e.inverse = fmax(e.inverse, Ulps(ASin<P>(unit), asin((double)unit)));
+        e.inverse = fmax(e.inverse, Ulps(ACos<P>(unit), acos((double)unit)));
+        e.inverse = fmax(e.inverse, Ulps(ATan<P>(x), atan((double)x)));
+    }
+}
+
+TEST_CASE(AccurateTrigWithinThreeUlps)
+{
+    Errors accurate, fast;
+    for (int n = 0; n < 200000; ++n) {
+        float x = n < 100000 ? Test::Random(-8.0f, 8.0f) : Test::Random(-8192.0f, 8192.0f);
+        float unit = Test::Random(-1.0f, 1.0f);
+        Accumulate<Precision::Accurate>(accurate, x, unit);
+        Accumulate<Precision::Fast>(fast, x, unit);
+    }
+    CHECK(accurate.sinCos <= 3.0);
+    CHECK(accurate.tan <= 4.0);
+    CHECK(accurate.inverse <= 3.0);
+    CHECK(fast.fast < 5e-5);
+
+    // Quadrant edges and exact values.
+    CHECK(Sin(0.0f) == 0.0f && Cos(0.0f) == 1.0f);
+    CHECK(Ulps(Cos(PI / 2.0f), cos((double)(PI / 2.0f))) <= 3.0);
+    CHECK(Ulps(Sin(PI), sin((double)PI)) <= 3.0);
+    CHECK(ACos(1.0f) == 0.0f && ASin(1.0f) == asinf(1.0f));
+    CHECK_NEAR(ATan2(1.0f, -1.0f), 3.0 * atan(1.0), 1e-6);
+    CHECK_NEAR(ATan2(-1.0f, -1.0f), -3.0 * atan(1.0), 1e-6);
+    CHECK_NEAR(ATan2(2.0f, 0.0f), 2.0 * atan(1.0), 1e-6);
+}
+
+TEST_CASE(ATan2ZerosMatchLibm)
+{
+    // Every signed-zero quadrant and both axes, as atan2f defines them.
+    const float y[16] = { 0.0f, -0.0f, 0.0f, -0.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f, -0.0f, 0.0f, -0.0f, 2.0f, -2.0f, 0.0f, -0.0f };
+    const float x[16] = { 0.0f, 0.0f, -0.0f, -0.0f, 0.0f, 0.0f, -0.0f, -0.0f, 1.0f, 1.0f, -1.0f, -1.0f, -0.0f, 0.0f, -3.0f, 3.0f };
+    for (int i = 0; i < 16; ++i) {
+        float expected = atan2f(y[i], x[i]);
+        float accurate = ATan2(y[i], x[i]), fast = ATan2<Precision::Fast>(y[i], x[i]);
+        CHECK_NEAR(accurate, expected, 1e-6);
+        CHECK_NEAR(fast, expected, 1e-6);
+        CHECK(signbit(accurate) == signbit(expected) && signbit(fast) == signbit(expected));
+    }
+
+#if USING_SSE
+    float out[8];
+    for (int i = 0; i < 16; i += 4) {
+        _mm_storeu_ps(out, ATan2(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+        for (int k = 0; k < 4; ++k)
+            CHECK(out[k] == ATan2(y[i + k], x[i + k]) && signbit(out[k]) == signbit(atan2f(y[i + k], x[i + k])));
+    }
+#endif
+#if USING_AVX2
+    for (int i = 0; i < 16; i += 8) {
+        _mm256_storeu_ps(out, ATan2(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+        for (int k = 0; k < 8; ++k)
+            CHECK(out[k] == ATan2(y[i + k], x[i + k]) && signbit(out[k]) == signbit(atan2f(y[i + k], x[i + k])));
+    }
+#endif
+}
+
+TEST_CASE(ExactTrigMatchesLibm)
+{
+    for (int n = 0; n < 1000; ++n) {
+        float x = Test::Random(-100.0f, 100.0f);
+        CHECK(Sin<Precision::Exact>(x) == sinf(x));
+        CHECK(Cos<Precision::Exact>(x) == cosf(x));
+        CHECK(ATan2<Precision::Exact>(x, 3.0f) == atan2f(x, 3.0f));
+    }
+}
+
+TEST_CASE(SimdTrigMatchesScalar)
+{
+#if USING_SSE || USING_AVX2
+    float in[8], unit[8], out[8], sinOut[8], cosOut[8];
+    for (int n = 0; n < 100; ++n) {
+        for (int i = 0; i < 8; ++i) {
+            in[i] = Test::Random(-50.0f, 50.0f);
+            unit[i] = Test::Random(-1.0f, 1.0f);
+        }
+
+#if USING_SSE
+        _mm_storeu_ps(out, Sin(_mm_loadu_ps(in)));
+        for (int i = 0; i < 4; ++i)
+            CHECK_NEAR(out[i], Sin(in[i]), 1e-7);
+        _mm_storeu_ps(out, ACos<Precision::Fast>(_mm_loadu_ps(unit)));
+        for (int i = 0; i < 4; ++i)
+            CHECK_NEAR(out[i], ACos<Precision::Fast>(unit[i]), 1e-6);
+#endif
+
+#if USING_AVX2
+        __m256 s, c;
+        SinCos(_mm256_loadu_ps(in), s, c);
+        _mm256_storeu_ps(sinOut, s);
+        _mm256_storeu_ps(cosOut, c);
+        for (int i = 0; i < 8; ++i) {
+            CHECK_NEAR(sinOut[i], Sin(in[i]), 1e-7);
+            CHECK_NEAR(cosOut[i], Cos(in[i]), 1e-7);
+        }
+        _mm256_storeu_ps(out, Tan(_mm256_loadu_ps(unit)));
+        for (int i = 0; i < 8; ++i)
+            CHECK_NEAR(out[i], Tan(unit[i]), 1e-6);
+        _mm256_storeu_ps(out, ATan2(_mm256_loadu_ps(unit), _mm256_loadu_ps(in)));
+        for (int i = 0; i < 8; ++i)
+            CHECK_NEAR(out[i], ATan2(unit[i], in[i]), 1e-6);
+        _mm256_storeu_ps(out, ASin<Precision::Exact>(_mm256_loadu_ps(unit)));
+        for (int i = 0; i < 8; ++i)
+            CHECK(out[i] == asinf(unit[i]));
+#endif
+    }
+    (void)sinOut;
+    (void)cosOut;
+#endif
+}
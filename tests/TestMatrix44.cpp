@@ -0,0 +1,155 @@
+#include "TestFramework.h"
+
+#include <float.h>
+
+#include "MatrixTransform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Matrix44 RandomMatrix(float lo = -4.0f, float hi = 4.0f)
+    {
+        Matrix44 m;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = Test::Random(lo, hi);
+        return m;
+    }
+
+    // Diagonally dominant, so comfortably invertible.
+    Matrix44 RandomInvertible()
+    {
+        Matrix44 m = RandomMatrix(-1.0f, 1.0f);
+        for (int i = 0; i < 4; ++i)
+            m[i][i] += 4.0f;
+        return m;
+    }
+
+    Matrix44 RandomRigid()
+    {
+        Vector3 axis(Test::Random(), Test::Random(), Test::Random() + 2.0f);
+        Vector3 unitAxis = Normalize(axis);
+        Matrix44 m = Rotate(Matrix44(1.0f), Test::Random(-PI, PI), unitAxis);
+        m.SetTranslation(Vector3(Test::Random(-50.0f, 50.0f), Test::Random(-50.0f, 50.0f), Test::Random(-50.0f, 50.0f)));
+        return m;
+    }
+
+    float MaxIdentityError(const Matrix44& m)
+    {
+        float error = 0.0f;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                error = Max(error, fabsf(m[i][j] - (i == j ? 1.0f : 0.0f)));
+        return error;
+    }
+
+    float MaxDifference(const Matrix44& a, const Matrix44& b)
+    {
+        float error = 0.0f;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                error = Max(error, fabsf(a[i][j] - b[i][j]));
+        return error;
+    }
+}
+
+// The documented bound: 2 ULP of the sum of absolute products per element.
+TEST_CASE(Matrix44MultiplyMatchesReference)
+{
+    for (int n = 0; n < 1000; ++n) {
+        Matrix44 a = RandomMatrix();
+        Matrix44 b = RandomMatrix();
+        Matrix44 simd = a * b;
+        Matrix44 reference = MultiplyReference(a, b);
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                float magnitude = 0.0f;
+                for (int k = 0; k < 4; ++k)
+                    magnitude += fabsf(a[i][k] * b[k][j]);
+                CHECK_NEAR(simd[i][j], reference[i][j], 2.0f * FLT_EPSILON * magnitude);
+            }
+        }
+    }
+}
+
+// Exact equality cannot be required: with FMA contraction enabled the compiler
+// may fuse the two call sites differently.
+TEST_CASE(Matrix44MultiplyAssignInPlace)
+{
+    Matrix44 a = RandomMatrix();
+    Matrix44 b = RandomMatrix();
+    Matrix44 product = a * b;
+    a *= b;
+    CHECK(MaxDifference(a, product) < 1e-4f);
+
+    Matrix44 c = RandomMatrix();
+    Matrix44 square = c * c;
+    c *= c;
+    CHECK(MaxDifference(c, square) < 1e-4f);
+}
+
+TEST_CASE(Matrix44TransformPoint)
+{
+    Matrix44 m = RandomMatrix();
+    for (int n = 0; n < 100; ++n) {
+        Vector4 v(Test::Random(), Test::Random(), Test::Random(), Test::Random());
+        Vector4 r = m * v;
+        Vector4 reference = TransformReference(m, v);
+        CHECK_NEAR(r.x, reference.x, 1e-5);
+        CHECK_NEAR(r.y, reference.y, 1e-5);
+        CHECK_NEAR(r.z, reference.z, 1e-5);
+        CHECK(r.w == 1.0f);
+    }
+}
+
+TEST_CASE(Matrix44InverseMatchesReference)
+{
+    for (int n = 0; n < 1000; ++n) {
+        Matrix44 m = RandomInvertible();
+        bool singular = true;
+        Matrix44 inverse = m.Inverse(&singular);
+        CHECK(!singular);
+        CHECK(MaxIdentityError(m * inverse) < 1e-5f);
+        CHECK(MaxDifference(inverse, InverseReference(m)) < 1e-5f);
+    }
+}
+
+TEST_CASE(Matrix44InverseReportsSingular)
+{
+    bool singular = false;
+    Matrix44 inverse = Matrix44().Inverse(&singular);
+    CHECK(singular);
+    CHECK(inverse == Matrix44(1.0f));
+
+    singular = false;
+    InverseReference(Matrix44(), &singular);
+    CHECK(singular);
+
+    singular = false;
+    Matrix44().InverseAffine(&singular);
+    CHECK(singular);
+
+    // A determinant of 1e-39 is not zero, but its reciprocal overflows.
+    Matrix44 tiny(1.0f);
+    tiny.m[0][0] = tiny.m[1][1] = tiny.m[2][2] = 1e-13f;
+    singular = false;
+    CHECK(tiny.Inverse(&singular) == Matrix44(1.0f) && singular);
+    singular = false;
+    CHECK(InverseReference(tiny, &singular) == Matrix44(1.0f) && singular);
+    singular = false;
+    CHECK(tiny.InverseAffine(&singular) == Matrix44(1.0f) && singular);
+}
+
+TEST_CASE(Matrix44FastInversesMatchGeneral)
+{
+    for (int n = 0; n < 1000; ++n) {
+        Matrix44 rigid = RandomRigid();
+        CHECK(MaxDifference(rigid.InverseOrthonormal(), rigid.Inverse()) < 1e-4f);
+        CHECK(MaxDifference(rigid.InverseAffine(), rigid.Inverse()) < 1e-4f);
+
+        Matrix44 scaled = Scale(rigid, Vector3(Test::Random(0.5f, 2.0f), Test::Random(0.5f, 2.0f), Test::Random(0.5f, 2.0f)));
+        scaled.SetTranslation(rigid.GetTranslation());
+        CHECK(MaxDifference(scaled.InverseAffine(), scaled.Inverse()) < 1e-4f);
+    }
+}
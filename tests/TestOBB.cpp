@@ -0,0 +1,304 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "OBB.h"
+#include "Transform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector3 RandomPoint(float lo, float hi)
+    {
+        return Vector3(Test::Random(lo, hi), Test::Random(lo, hi), Test::Random(lo, hi));
+    }
+
+    OBB RandomBox(float spread)
+    {
+        return OBB(RandomPoint(-spread, spread), Test::RandomUnitQuaternion().ToMat3x3(), RandomPoint(0.1f, 2.0f));
+    }
+
+    // center + sum of s_k * extent k * axis k, s in [-1, 1]^3.
+    Vector3 BoxPoint(const OBB& box, float sx, float sy, float sz)
+    {
+        const float s[3] = { sx * box.extents.x, sy * box.extents.y, sz * box.extents.z };
+        Vector3 p = box.center;
+        for (int k = 0; k < 3; ++k)
+            p = p + Vector3(box.axes[k][0], box.axes[k][1], box.axes[k][2]) * s[k];
+        return p;
+    }
+
+    Vector3 Corner(const OBB& box, int c)
+    {
+        return BoxPoint(box, c & 1 ? 1.0f : -1.0f, c & 2 ? 1.0f : -1.0f, c & 4 ? 1.0f : -1.0f);
+    }
+
+    Vector3 TransformPoint(const Matrix44& m, const Vector3& p)
+    {
+        Vector3 out;
+        TransformPoints(m, &p, &out, 1);
+        return out;
+    }
+
+    // Largest gap between the corner projections of a and b over the 15
+    // candidate axes, in double: positive where an axis separates them.
+    double SeparatingGap(const OBB& a, const OBB& b)
+    {
+        Vector3D<double> axes[15];
+        for (int k = 0; k < 3; ++k) {
+            axes[k] = Vector3D<double>(a.axes[k][0], a.axes[k][1], a.axes[k][2]);
+            axes[3 + k] = Vector3D<double>(b.axes[k][0], b.axes[k][1], b.axes[k][2]);
+        }
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                axes[6 + 3 * i + j] = axes[i] ^ axes[3 + j];
+
+        double gap = -INFINITY;
+        for (int n = 0; n < 15; ++n) {
+            double length = sqrt(axes[n] * axes[n]);
+            if (length < 1e-9)
+                continue;
+            double lo[2] = { INFINITY, INFINITY }, hi[2] = { -INFINITY, -INFINITY };
+            for (int c = 0; c < 8; ++c) {
+                Vector3 pa = Corner(a, c), pb = Corner(b, c);
+                double da = (pa.x * axes[n].x + pa.y * axes[n].y + pa.z * axes[n].z) / length;
+                double db = (pb.x * axes[n].x + pb.y * axes[n].y + pb.z * axes[n].z) / length;
+                lo[0] = fmin(lo[0], da);
+                hi[0] = fmax(hi[0], da);
+                lo[1] = fmin(lo[1], db);
+                hi[1] = fmax(hi[1], db);
+            }
+            gap = fmax(gap, fmax(lo[1] - hi[0], lo[0] - hi[1]));
+        }
+        return gap;
+    }
+
+    struct Boxes {
+        Vector3Stream center, axes[3], extents;
+        std::vector<OBB> boxes;
+
+        void Add(const OBB& box)
+        {
+            boxes.push_back(box);
+            size_t i = boxes.size() - 1;
+            center.Resize(i + 1);
+            extents.Resize(i + 1);
+            center.Set(i, box.center);
+            extents.Set(i, box.extents);
+            for (int k = 0; k < 3; ++k) {
+                axes[k].Resize(i + 1);
+                axes[k].Set(i, Vector3(box.axes[k][0], box.axes[k][1], box.axes[k][2]));
+            }
+        }
+
+        OBBStreamView View() const { return OBBStreamView(center, axes[0], axes[1], axes[2], extents); }
+    };
+}
+
+TEST_CASE(OBBContainsBoundsAndTransform)
+{
+    for (int n = 0; n < 20; ++n) {
+        OBB box = RandomBox(5.0f);
+        AABB bounds = box.Bounds();
+        bool ok = box.Contains(box.center);
+        for (int c = 0; c < 8; ++c) {
+            ok = ok && box.Contains(BoxPoint(box, c & 1 ? 0.99f : -0.99f, c & 2 ? 0.99f : -0.99f, c & 4 ? 0.99f : -0.99f));
+            ok = ok && !box.Contains(BoxPoint(box, c & 1 ? 1.01f : -1.01f, 0.0f, 0.0f));
+            Vector3 corner = Corner(box, c);
+            ok = ok && corner.x >= bounds.minimum.x - 1e-5f && corner.x <= bounds.maximum.x + 1e-5f;
+            ok = ok && corner.y >= bounds.minimum.y - 1e-5f && corner.y <= bounds.maximum.y + 1e-5f;
+            ok = ok && corner.z >= bounds.minimum.z - 1e-5f && corner.z <= bounds.maximum.z + 1e-5f;
+        }
+        CHECK(ok);
+
+        // Rotation, translation and uniform scale map the box exactly.
+        float scale = Test::Random(0.5f, 3.0f);
+        Matrix44 rigid = LocalMatrix(Test::RandomUnitQuaternion(), RandomPoint(-10.0f, 10.0f), Vector3(scale, scale, scale));
+        OBB moved = TransformBounds(box, rigid);
+        CHECK_NEAR(moved.extents.x, box.extents.x * scale, 1e-4);
+        CHECK_NEAR(moved.extents.y, box.extents.y * scale, 1e-4);
+        CHECK_NEAR(moved.extents.z, box.extents.z * scale, 1e-4);
+        Vector3 center = TransformPoint(rigid, box.center);
+        CHECK(fabsf(moved.center.x - center.x) < 1e-4f && fabsf(moved.center.y - center.y) < 1e-4f && fabsf(moved.center.z - center.z) < 1e-4f);
+
+        // Any other map still gives a box around the image.
+        Matrix44 skewed = LocalMatrix(Test::RandomUnitQuaternion(), RandomPoint(-10.0f, 10.0f), RandomPoint(0.5f, 3.0f)) * LocalMatrix(Test::RandomUnitQuaternion(), Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 2.0f, 0.5f));
+        OBB image = TransformBounds(box, skewed);
+        for (int c = 0; c < 8; ++c) {
+            Vector3 p = TransformPoint(rigid, BoxPoint(box, c & 1 ? 0.999f : -0.999f, c & 2 ? 0.999f : -0.999f, c & 4 ? 0.999f : -0.999f));
+            Vector3 q = TransformPoint(skewed, BoxPoint(box, c & 1 ? 0.999f : -0.999f, c & 2 ? 0.999f : -0.999f, c & 4 ? 0.999f : -0.999f));
+            ok = ok && moved.Contains(p) && image.Contains(q);
+        }
+        CHECK(ok);
+    }
+
+    OBB empty;
+    CHECK(empty.IsEmpty() && empty.Bounds().IsEmpty() && OBB(AABB()).IsEmpty());
+    CHECK(TransformBounds(empty, Matrix44(2.0f)).IsEmpty());
+    CHECK(!Intersects(empty, OBB(AABB(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f)))));
+}
+
+TEST_CASE(OBBIntersectsMatchesCornerProjections)
+{
+    int separated = 0, overlapping = 0;
+    bool ok = true;
+    for (int n = 0; n < 2000; ++n) {
+        OBB a = RandomBox(3.0f), b = RandomBox(3.0f);
+        double gap = SeparatingGap(a, b);
+        // Within rounding of touching either answer is fine.
+        if (fabs(gap) < 1e-4)
+            continue;
+        ok = ok && Intersects(a, b) == (gap < 0.0);
+        (gap < 0.0 ? overlapping : separated)++;
+
+        AABB box = OBB(a.Bounds()).Bounds();
+        double boxGap = SeparatingGap(b, OBB(box));
+        if (fabs(boxGap) >= 1e-4)
+            ok = ok && Intersects(b, box) == (boxGap < 0.0);
+    }
+    CHECK(ok);
+    CHECK(separated > 100 && overlapping > 100);
+
+    // Two unit cubes, one turned 45 degrees about z: an edge of the turned
+    // one reaches sqrt(2) along x.
+    Mat3x3<float> turned = Quaternion<float>(cosf(0.3926991f), Vector3D<float>(0.0f, 0.0f, sinf(0.3926991f))).ToMat3x3();
+    OBB cube(Vector3(0.0f, 0.0f, 0.0f), Mat3x3<float>(1.0f), Vector3(1.0f, 1.0f, 1.0f));
+    CHECK(Intersects(cube, OBB(Vector3(2.4f, 0.0f, 0.0f), turned, Vector3(1.0f, 1.0f, 1.0f))));
+    CHECK(!Intersects(cube, OBB(Vector3(2.45f, 0.0f, 0.0f), turned, Vector3(1.0f, 1.0f, 1.0f))));
+    // Parallel boxes sharing a face touch.
+    CHECK(Intersects(cube, OBB(Vector3(0.0f, 2.0f, 0.0f), Mat3x3<float>(1.0f), Vector3(1.0f, 1.0f, 1.0f))));
+}
+
+TEST_CASE(OBBCollectOverlapsMatchesScalar)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 203;
+    Boxes boxes;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::vector<AABB> aabbs;
+    for (size_t i = 0; i < count; ++i) {
+        boxes.Add(RandomBox(10.0f));
+        AABB box = AABB::FromCenterExtents(RandomPoint(-10.0f, 10.0f), RandomPoint(0.1f, 2.0f));
+        aabbs.push_back(box);
+        minX.push_back(box.minimum.x);
+        minY.push_back(box.minimum.y);
+        minZ.push_back(box.minimum.z);
+        maxX.push_back(box.maximum.x);
+        maxY.push_back(box.maximum.y);
+        maxZ.push_back(box.maximum.z);
+    }
+    AABBStreamView aabbView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), count);
+
+    for (int n = 0; n < 10; ++n) {
+        OBB query(RandomPoint(-8.0f, 8.0f), Test::RandomUnitQuaternion().ToMat3x3(), RandomPoint(1.0f, 5.0f));
+        std::vector<uint32_t> hits(count), aabbHits(count);
+        hits.resize(CollectOverlaps(query, boxes.View(), hits.data()));
+        aabbHits.resize(CollectOverlaps(query, aabbView, aabbHits.data()));
+
+        std::vector<uint32_t> expected, expectedAABB;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (Intersects(query, boxes.boxes[i]))
+                expected.push_back(i);
+            if (Intersects(query, aabbs[i]))
+                expectedAABB.push_back(i);
+        }
+        CHECK(hits == expected);
+        CHECK(aabbHits == expectedAABB);
+    }
+}
+
+TEST_CASE(BoundingOrientedBoxFindsPrincipalAxes)
+{
+    // Points filling a turned 8 x 3 x 1 box, so the principal axes are
+    // the box's own.
+    const size_t count = 5003;
+    Quaternion<float> q = Test::RandomUnitQuaternion();
+    OBB truth(Vector3(20.0f, -5.0f, 3.0f), q.ToMat3x3(), Vector3(8.0f, 3.0f, 1.0f));
+    Vector3Stream points(count);
+    std::vector<Vector3> aos(count);
+    for (size_t i = 0; i < count; ++i) {
+        aos[i] = BoxPoint(truth, Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f));
+        points.Set(i, aos[i]);
+    }
+
+    OBB box = BoundingOrientedBox(points);
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i)
+        ok = ok && box.Contains(aos[i]);
+    CHECK(ok);
+    for (int k = 0; k < 3; ++k) {
+        double d = box.axes[k][0] * truth.axes[k][0] + box.axes[k][1] * truth.axes[k][1] + box.axes[k][2] * truth.axes[k][2];
+        CHECK(fabs(d) > 0.999);
+    }
+    // The covariance of a sample tilts the axes a little; the box stays close.
+    CHECK(box.extents.x < 8.1f && box.extents.y < 3.1f && box.extents.z < 1.1f);
+    CHECK(box.extents.x > 7.9f && box.extents.y > 2.9f && box.extents.z > 0.9f);
+    // The axes are a right-handed rotation.
+    Vector3D<float> x = box.axes.GetRow(0), y = box.axes.GetRow(1), z = box.axes.GetRow(2);
+    CHECK_NEAR((x ^ y) * z, 1.0f, 1e-5);
+
+    // Strided views and threads give the same box.
+    BoundsOptions threaded;
+    threaded.parallelThreshold = 0;
+    threaded.threadCount = 3;
+    OBB fromArray = BoundingOrientedBox(Vector3ArrayView(aos.data(), count)), fromThreads = BoundingOrientedBox(points, threaded);
+    CHECK(memcmp(&fromArray, &box, sizeof(OBB)) == 0);
+    CHECK(memcmp(&fromThreads, &box, sizeof(OBB)) == 0);
+
+    // Degenerate inputs.
+    CHECK(BoundingOrientedBox(Vector3Stream()).IsEmpty());
+    Vector3Stream single(1), line(10);
+    single.Set(0, Vector3(1.0f, 2.0f, 3.0f));
+    for (size_t i = 0; i < line.Size(); ++i)
+        line.Set(i, Vector3(float(i), float(i), 0.0f));
+    OBB point = BoundingOrientedBox(single), segment = BoundingOrientedBox(line);
+    CHECK(!point.IsEmpty() && point.Contains(Vector3(1.0f, 2.0f, 3.0f)));
+    CHECK_NEAR(segment.extents.x, 9.0f * sqrtf(2.0f) * 0.5f, 1e-4);
+    CHECK(segment.extents.y < 1e-4f && segment.extents.z < 1e-4f);
+    for (size_t i = 0; i < line.Size(); ++i)
+        ok = ok && segment.Contains(line.Get(i));
+    CHECK(ok);
+}
+
+TEST_CASE(OBBCollectOverlapsSkipsEmpty)
+{
+    // Every third box is empty but would overlap by its centre and the
+    // other extents; nine boxes cover both the lane blocks and the tail.
+    const size_t count = 9;
+    Boxes boxes;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::vector<AABB> aabbs;
+    for (size_t i = 0; i < count; ++i) {
+        bool empty = i % 3 == 1;
+        boxes.Add(OBB(Vector3(0.5f, 0.0f, 0.0f), Mat3x3<float>(1.0f), Vector3(empty ? -0.1f : 0.5f, 2.0f, 2.0f)));
+        AABB box = empty ? AABB(Vector3(0.5f, 0.0f, 0.0f), Vector3(1.0f, -0.5f, 0.5f)) : AABB(Vector3(0.5f, 0.0f, 0.0f), Vector3(1.0f, 0.5f, 0.5f));
+        aabbs.push_back(box);
+        minX.push_back(box.minimum.x);
+        minY.push_back(box.minimum.y);
+        minZ.push_back(box.minimum.z);
+        maxX.push_back(box.maximum.x);
+        maxY.push_back(box.maximum.y);
+        maxZ.push_back(box.maximum.z);
+    }
+    AABBStreamView aabbView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), count);
+
+    OBB query(Vector3(0.0f, 0.0f, 0.0f), Mat3x3<float>(1.0f), Vector3(1.0f, 1.0f, 1.0f));
+    std::vector<uint32_t> hits(count), aabbHits(count), expected, expectedAABB;
+    hits.resize(CollectOverlaps(query, boxes.View(), hits.data()));
+    aabbHits.resize(CollectOverlaps(query, aabbView, aabbHits.data()));
+    for (uint32_t i = 0; i < count; ++i) {
+        if (Intersects(query, boxes.boxes[i]))
+            expected.push_back(i);
+        if (Intersects(query, aabbs[i]))
+            expectedAABB.push_back(i);
+    }
+    CHECK(expected.size() == 6 && expectedAABB.size() == 6);
+    CHECK(hits == expected);
+    CHECK(aabbHits == expectedAABB);
+
+    // An empty query overlaps nothing.
+    OBB emptyQuery(Vector3(0.0f, 0.0f, 0.0f), Mat3x3<float>(1.0f), Vector3(-0.1f, 1.0f, 1.0f));
+    hits.resize(count);
+    CHECK(CollectOverlaps(emptyQuery, boxes.View(), hits.data()) == 0);
+    CHECK(CollectOverlaps(emptyQuery, aabbView, hits.data()) == 0);
+}
@@ -0,0 +1,204 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "3DParametric.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    struct Components {
+        std::vector<float> x, y, z;
+
+        void Push(const Vector3& v)
+        {
+            x.push_back(v.x);
+            y.push_back(v.y);
+            z.push_back(v.z);
+        }
+
+        Vector3StreamView View() const { return Vector3StreamView(x.data(), y.data(), z.data(), x.size()); }
+    };
+
+    // Batch and single tests hit the same elements, at distances equal up
+    // to FMA rounding.
+    int CountMismatches(const std::vector<float>& batch, const std::vector<float>& single)
+    {
+        int mismatches = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            bool batchHit = batch[i] < INFINITY, singleHit = single[i] < INFINITY;
+            if (batchHit != singleHit || (batchHit && fabsf(batch[i] - single[i]) > 1e-4f * (1.0f + single[i])))
+                ++mismatches;
+        }
+        return mismatches;
+    }
+
+    bool HitsEvenElements(const std::vector<float>& t)
+    {
+        bool ok = true;
+        for (size_t i = 0; i < t.size(); ++i)
+            ok = ok && (t[i] < INFINITY) == (i % 2 == 0);
+        return ok;
+    }
+
+    size_t CountHits(const std::vector<float>& t)
+    {
+        size_t hits = 0;
+        for (size_t i = 0; i < t.size(); ++i)
+            hits += t[i] < INFINITY;
+        return hits;
+    }
+}
+
+TEST_CASE(LineSegmentClosestPoints)
+{
+    Line line = Line::FromPoints(Vector3(0.0f, 0.0f, 0.0f), Vector3(2.0f, 0.0f, 0.0f));
+    CHECK(line.ClosestPoint(Vector3(-3.0f, 4.0f, 0.0f)) == Vector3(-3.0f, 0.0f, 0.0f));
+    CHECK_NEAR(line.Distance(Vector3(5.0f, 3.0f, 4.0f)), 5.0, 1e-6);
+
+    Segment segment(Vector3(0.0f, 0.0f, 0.0f), Vector3(2.0f, 0.0f, 0.0f));
+    CHECK(segment.ClosestPoint(Vector3(-3.0f, 4.0f, 0.0f)) == Vector3(0.0f, 0.0f, 0.0f));
+    CHECK(segment.ClosestPoint(Vector3(1.0f, 4.0f, 0.0f)) == Vector3(1.0f, 0.0f, 0.0f));
+    CHECK_NEAR(segment.Distance(Vector3(5.0f, 4.0f, 0.0f)), 5.0, 1e-6);
+    CHECK_NEAR(segment.Length(), 2.0, 1e-6);
+    CHECK(Segment(Vector3(1.0f, 1.0f, 1.0f), Vector3(1.0f, 1.0f, 1.0f)).ClosestPoint(Vector3(0.0f, 0.0f, 0.0f)) == Vector3(1.0f, 1.0f, 1.0f));
+
+    Ray ray(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 2.0f));
+    CHECK(ray.At(1.5f) == Vector3(0.0f, 0.0f, 3.0f));
+    CHECK(ray.ClosestPoint(Vector3(1.0f, 0.0f, -5.0f)) == Vector3(0.0f, 0.0f, 0.0f));
+}
+
+TEST_CASE(RayIntersectionSingle)
+{
+    Ray ray(Vector3(0.0f, 0.0f, -5.0f), Vector3(0.0f, 0.0f, 1.0f));
+    float t = -1.0f;
+
+    CHECK(IntersectRay(ray, Plane(0.0f, 0.0f, 1.0f, -1.0f), 100.0f, t));
+    CHECK_NEAR(t, 6.0, 1e-6);
+    CHECK(!IntersectRay(ray, Plane(0.0f, 0.0f, 1.0f, -1.0f), 5.0f, t));
+    CHECK(!IntersectRay(ray, Plane(1.0f, 0.0f, 0.0f, -1.0f), 100.0f, t));
+    CHECK(!IntersectRay(ray, Plane(0.0f, 0.0f, 1.0f, 10.0f), 100.0f, t));
+
+    CHECK(IntersectRay(ray, Vector3(0.0f, 0.5f, 0.0f), 1.0f, 100.0f, t));
+    CHECK_NEAR(t, 5.0 - sqrt(0.75), 1e-5);
+    CHECK(!IntersectRay(ray, Vector3(0.0f, 1.5f, 0.0f), 1.0f, 100.0f, t));
+    CHECK(!IntersectRay(ray, Vector3(0.0f, 0.0f, -8.0f), 1.0f, 100.0f, t));
+    CHECK(IntersectRay(ray, Vector3(0.0f, 0.0f, -5.5f), 1.0f, 100.0f, t) && t == 0.0f);
+
+    CHECK(IntersectRay(ray, AABB(Vector3(-1.0f, -1.0f, 1.0f), Vector3(1.0f, 1.0f, 2.0f)), 100.0f, t));
+    CHECK_NEAR(t, 6.0, 1e-6);
+
+    Vector3 v0(-1.0f, -1.0f, 2.0f), v1(1.0f, -1.0f, 2.0f), v2(0.0f, 1.0f, 2.0f);
+    CHECK(IntersectRay(ray, v0, v1, v2, 100.0f, t));
+    CHECK_NEAR(t, 7.0, 1e-6);
+    // Two-sided, and a ray in the triangle's plane misses.
+    CHECK(IntersectRay(ray, v0, v2, v1, 100.0f, t));
+    CHECK(!IntersectRay(Ray(Vector3(0.0f, 0.0f, 5.0f), Vector3(0.0f, 0.0f, 1.0f)), v0, v1, v2, 100.0f, t));
+    CHECK(!IntersectRay(Ray(Vector3(0.9f, 0.9f, -5.0f), Vector3(0.0f, 0.0f, 1.0f)), v0, v1, v2, 100.0f, t));
+    CHECK(!IntersectRay(Ray(Vector3(-5.0f, 0.0f, 2.0f), Vector3(1.0f, 0.0f, 0.0f)), v0, v1, v2, 100.0f, t));
+}
+
+TEST_CASE(RayIntersectionBatches)
+{
+    // Even elements are built to be hit and odd ones to be missed, well
+    // clear of any edge, so the hit sets do not depend on the random data.
+    const size_t count = 403;
+    Ray ray(Vector3(0.0f, 0.0f, -20.0f), Vector3(0.01f, -0.02f, 1.0f));
+
+    Components v[3], sphereCenter, boxMin, boxMax, normal;
+    std::vector<float> radius, d;
+    for (size_t i = 0; i < count; ++i) {
+        bool hit = i % 2 == 0;
+        // On the ray, or 10 to the side of it (every primitive is smaller).
+        Vector3 c = ray.At(Test::Random(2.0f, 35.0f)) + Vector3(hit ? 0.0f : 10.0f, 0.0f, 0.0f);
+        // A triangle across the ray with its centroid at c.
+        Vector3 a(Test::Random(1.0f, 2.0f), Test::Random(-0.5f, 0.5f), Test::Random(-0.5f, 0.5f));
+        Vector3 b(Test::Random(-0.5f, 0.5f), Test::Random(1.0f, 2.0f), Test::Random(-0.5f, 0.5f));
+        v[0].Push(c + a);
+        v[1].Push(c + b);
+        v[2].Push(c - a - b);
+        sphereCenter.Push(c);
+        radius.push_back(Test::Random(0.1f, 2.0f));
+        Vector3 e(Test::Random(0.1f, 2.0f), Test::Random(0.1f, 2.0f), Test::Random(0.1f, 2.0f));
+        boxMin.Push(c - e);
+        boxMax.Push(c + e);
+        // Planes facing the ray through a point on it, beyond tMax for misses.
+        Vector3 n = Test::RandomVector(1.0f) + Vector3(0.0f, 0.0f, 2.0f);
+        n = Normalize(n);
+        normal.Push(n);
+        d.push_back(-DotProduct(n, ray.At(hit ? Test::Random(2.0f, 35.0f) : Test::Random(45.0f, 60.0f))));
+    }
+
+    std::vector<float> batch(count), single(count);
+    float t;
+
+    TriangleStreamView triangles(v[0].View(), v[1].View(), v[2].View());
+    size_t hits = IntersectTriangles(ray, triangles, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(ray, Vector3(v[0].x[i], v[0].y[i], v[0].z[i]), Vector3(v[1].x[i], v[1].y[i], v[1].z[i]), Vector3(v[2].x[i], v[2].y[i], v[2].z[i]), 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    hits = IntersectSpheres(ray, SphereStreamView(sphereCenter.x.data(), sphereCenter.y.data(), sphereCenter.z.data(), radius.data(), count), 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(ray, Vector3(sphereCenter.x[i], sphereCenter.y[i], sphereCenter.z[i]), radius[i], 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    AABBStreamView boxes(boxMin.x.data(), boxMin.y.data(), boxMin.z.data(), boxMax.x.data(), boxMax.y.data(), boxMax.z.data(), count);
+    hits = IntersectAABBs(ray, boxes, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(ray, AABB(Vector3(boxMin.x[i], boxMin.y[i], boxMin.z[i]), Vector3(boxMax.x[i], boxMax.y[i], boxMax.z[i])), 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    hits = IntersectPlanes(ray, PlaneStreamView(normal.x.data(), normal.y.data(), normal.z.data(), d.data(), count), 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(ray, Plane(normal.x[i], normal.y[i], normal.z[i], d[i]), 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    // Many rays against one primitive. Every primitive contains the
+    // triangle's centroid g and the origins are at least 6 from it, outside
+    // all of them and off the triangle's plane: rays towards g hit, rays
+    // pointing away from it miss.
+    Vector3 v0(-3.0f, -3.0f, 1.0f), v1(3.0f, -2.0f, 0.0f), v2(0.0f, 4.0f, -1.0f);
+    AABB box(Vector3(-2.0f, -1.0f, -2.0f), Vector3(2.0f, 1.0f, 3.0f));
+    Plane plane = Plane::FromPoints(v0, v1, v2);
+    Vector3 g = (v0 + v1 + v2) * (1.0f / 3.0f);
+    Components origin, direction;
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 u = Test::RandomVector(1.0f);
+        float along = DotProduct(u, plane.normal);
+        u = u + plane.normal * ((along < 0.0f ? -0.5f : 0.5f) - along);
+        u = Normalize(u);
+        Vector3 o = g + u * Test::Random(6.0f, 12.0f);
+        origin.Push(o);
+        direction.Push((i % 2 == 0 ? g - o : o - g) * Test::Random(0.5f, 2.0f));
+    }
+    RayStreamView rays(origin.x.data(), origin.y.data(), origin.z.data(), direction.x.data(), direction.y.data(), direction.z.data(), count);
+
+    hits = IntersectRays(rays, v0, v1, v2, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(Ray(Vector3(origin.x[i], origin.y[i], origin.z[i]), Vector3(direction.x[i], direction.y[i], direction.z[i])), v0, v1, v2, 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    hits = IntersectRays(rays, Vector3(1.0f, 0.0f, 0.0f), 2.5f, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(Ray(Vector3(origin.x[i], origin.y[i], origin.z[i]), Vector3(direction.x[i], direction.y[i], direction.z[i])), Vector3(1.0f, 0.0f, 0.0f), 2.5f, 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    hits = IntersectRays(rays, box, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(Ray(Vector3(origin.x[i], origin.y[i], origin.z[i]), Vector3(direction.x[i], direction.y[i], direction.z[i])), box, 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+
+    hits = IntersectRays(rays, plane, 40.0f, batch.data());
+    for (size_t i = 0; i < count; ++i)
+        single[i] = IntersectRay(Ray(Vector3(origin.x[i], origin.y[i], origin.z[i]), Vector3(direction.x[i], direction.y[i], direction.z[i])), plane, 40.0f, t) ? t : INFINITY;
+    CHECK(hits == CountHits(batch) && HitsEvenElements(batch));
+    CHECK(CountMismatches(batch, single) == 0);
+}
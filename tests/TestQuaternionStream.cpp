@@ -0,0 +1,272 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "QuaternionStream.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // Double-precision slerp along the shorter arc.
+    void ReferenceSlerp(const Quaternion<float>& a, const Quaternion<float>& b, double t, double out[4])
+    {
+        double qa[4] = { a.w, a.v.x, a.v.y, a.v.z };
+        double qb[4] = { b.w, b.v.x, b.v.y, b.v.z };
+        double d = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        double sign = d < 0.0 ? -1.0 : 1.0;
+        double angle = acos(fmin(fabs(d), 1.0));
+        double k0 = 1.0 - t, k1 = t;
+        if (angle > 1e-9) {
+            k0 = sin((1.0 - t) * angle) / sin(angle);
+            k1 = sin(t * angle) / sin(angle);
+        }
+        for (int c = 0; c < 4; ++c)
+            out[c] = qa[c] * k0 + sign * qb[c] * k1;
+    }
+
+    double MaxError(const QuaternionStream& s, size_t i, const double expected[4])
+    {
+        Quaternion<float> q = s.Get(i);
+        double got[4] = { q.w, q.v.x, q.v.y, q.v.z };
+        double error = 0.0;
+        for (int c = 0; c < 4; ++c)
+            error = fmax(error, fabs(got[c] - expected[c]));
+        return error;
+    }
+
+    struct BlendData {
+        std::vector<Quaternion<float> > a, b;
+        std::vector<float> t;
+
+        // Random pairs plus the awkward ones: equal, opposite, nearly equal.
+        explicit BlendData(size_t count)
+        {
+            for (size_t i = 0; i < count; ++i) {
+                Quaternion<float> qa = Test::RandomUnitQuaternion(), qb = Test::RandomUnitQuaternion();
+                if (i % 7 == 1)
+                    qb = qa;
+                if (i % 7 == 2)
+                    qb = qa * -1.0f;
+                if (i % 7 == 3)
+                    qb = Quaternion<float>(qa.w + 1e-4f, qa.v);
+                a.push_back(qa);
+                b.push_back(qb);
+                t.push_back(Test::Random(-0.1f, 1.1f));
+            }
+        }
+    };
+}
+
+TEST_CASE(SlerpManyMatchesReference)
+{
+    const size_t count = 203;
+    BlendData data(count);
+    QuaternionStream a(data.a.data(), count), b(data.b.data(), count), precise, fast;
+
+    SlerpMany(a, b, data.t.data(), precise);
+    SlerpMany(a, b, data.t.data(), fast, SlerpPrecision::Fast);
+    CHECK(precise.Size() == count && fast.Size() == count);
+
+    double preciseError = 0.0, fastError = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double expected[4];
+        ReferenceSlerp(data.a[i], data.b[i], fmin(fmax(data.t[i], 0.0), 1.0), expected);
+        preciseError = fmax(preciseError, MaxError(precise, i, expected));
+        fastError = fmax(fastError, MaxError(fast, i, expected));
+    }
+    CHECK(preciseError < 2e-6);
+    CHECK(fastError < 2e-5);
+}
+
+TEST_CASE(SlerpManyUniformT)
+{
+    const size_t count = 37;
+    BlendData data(count);
+    QuaternionStream a(data.a.data(), count), b(data.b.data(), count);
+
+    // In place: the output is one of the inputs.
+    SlerpMany(a, b, 0.25f, a);
+    for (size_t i = 0; i < count; ++i) {
+        double expected[4];
+        ReferenceSlerp(data.a[i], data.b[i], 0.25, expected);
+        CHECK(MaxError(a, i, expected) < 2e-6);
+    }
+}
+
+TEST_CASE(ScalarSlerpMatchesReference)
+{
+    for (int n = 0; n < 100; ++n) {
+        Quaternion<float> qa = Test::RandomUnitQuaternion(), qb = Test::RandomUnitQuaternion();
+        float t = Test::Random(0.0f, 1.0f);
+        Quaternion<float> q = qa.Slerp(qb, t);
+
+        double expected[4];
+        ReferenceSlerp(qa, qb, t, expected);
+        CHECK_NEAR(q.w, expected[0], 1e-5);
+        CHECK_NEAR(q.v.x, expected[1], 1e-5);
+        CHECK_NEAR(q.v.y, expected[2], 1e-5);
+        CHECK_NEAR(q.v.z, expected[3], 1e-5);
+    }
+}
+
+TEST_CASE(ScalarNormalizeAndDoublePrecision)
+{
+    Quaternion<float> q(1.0f, Vector3D<float>(2.0f, 2.0f, 4.0f));
+    CHECK_NEAR(q.Magnitude(), 5.0, 1e-6);
+    Quaternion<float> unit = q.Normalize();
+    CHECK_NEAR(unit.w, 0.2, 1e-7);
+    CHECK_NEAR(unit.v.z, 0.8, 1e-7);
+    CHECK_NEAR(unit.Magnitude(), 1.0, 1e-6);
+    CHECK(q.w == 1.0f && q.v.z == 4.0f);
+
+    // Quaternion<double> keeps double precision through Slerp and Exp.
+    for (int n = 0; n < 100; ++n) {
+        Quaternion<float> fa = Test::RandomUnitQuaternion(), fb = Test::RandomUnitQuaternion();
+        Quaternion<double> qa(fa.w, Vector3D<double>(fa.v.x, fa.v.y, fa.v.z));
+        Quaternion<double> qb(fb.w, Vector3D<double>(fb.v.x, fb.v.y, fb.v.z));
+        double t = Test::Random(0.0f, 1.0f);
+        Quaternion<double> slerp = qa.Slerp(qb, t);
+        double expected[4];
+        ReferenceSlerp(fa, fb, t, expected);
+        CHECK_NEAR(slerp.w, expected[0], 1e-12);
+        CHECK_NEAR(slerp.v.x, expected[1], 1e-12);
+        CHECK_NEAR(slerp.v.y, expected[2], 1e-12);
+        CHECK_NEAR(slerp.v.z, expected[3], 1e-12);
+
+        // A unit (cos a, sin a * axis) raised to s is (cos sa, sin sa * axis).
+        double angle = acos(qa.w), s = Test::Random(0.0f, 2.0f);
+        Quaternion<double> power = qa.Exp(s);
+        double scale = sin(s * angle) / sin(angle);
+        CHECK_NEAR(power.w, cos(s * angle), 1e-12);
+        CHECK_NEAR(power.v.x, qa.v.x * scale, 1e-12);
+        CHECK_NEAR(power.v.z, qa.v.z * scale, 1e-12);
+    }
+
+    // Inverse divides by |q|^2, so a non-unit quaternion times its inverse is identity.
+    Quaternion<double> scaled(3.0, Vector3D<double>(-1.5, 0.25, 2.0));
+    Quaternion<double> product = scaled * scaled.Inverse();
+    CHECK_NEAR(product.w, 1.0, 1e-15);
+    CHECK_NEAR(product.v.x, 0.0, 1e-15);
+    CHECK_NEAR(product.v.y, 0.0, 1e-15);
+    CHECK_NEAR(product.v.z, 0.0, 1e-15);
+}
+
+TEST_CASE(NlerpManyNormalizes)
+{
+    const size_t count = 29;
+    BlendData data(count);
+    QuaternionStream a(data.a.data(), count), b(data.b.data(), count), out;
+
+    NlerpMany(a, b, data.t.data(), out);
+    for (size_t i = 0; i < count; ++i) {
+        Quaternion<float> qa = data.a[i], qb = data.b[i];
+        float t = fminf(fmaxf(data.t[i], 0.0f), 1.0f);
+        if (qa.DotProduct(qa, qb) < 0.0f)
+            qb = qb * -1.0f;
+        Quaternion<float> lerp = qa * (1.0f - t) + qb * t;
+        Quaternion<float> expected = lerp * (1.0f / sqrtf(lerp.DotProduct(lerp, lerp)));
+
+        Quaternion<float> q = out.Get(i);
+        CHECK_NEAR(q.w, expected.w, 1e-6);
+        CHECK_NEAR(q.v.x, expected.v.x, 1e-6);
+        CHECK_NEAR(q.v.y, expected.v.y, 1e-6);
+        CHECK_NEAR(q.v.z, expected.v.z, 1e-6);
+    }
+}
+
+TEST_CASE(ScalarRotateAndMatrices)
+{
+    for (int n = 0; n < 100; ++n) {
+        Quaternion<float> q = Test::RandomUnitQuaternion();
+        Vector3D<float> p(Test::Random(), Test::Random(), Test::Random());
+
+        // Rotate is q * (0, p) * conjugate(q), and the matrices agree with it.
+        Quaternion<float> conjugate(q.w, Vector3D<float>(-q.v.x, -q.v.y, -q.v.z));
+        Vector3D<float> expected = (q * Quaternion<float>(0.0f, p) * conjugate).v;
+        Vector3D<float> r = q.Rotate(p);
+        Vector3D<float> m = q.ToMat3x3() * p;
+        Vector4 m4 = q.ToMatrix44() * Vector4(p.x, p.y, p.z, 1.0f);
+        for (int c = 0; c < 3; ++c) {
+            CHECK_NEAR(r[c], expected[c], 1e-5);
+            CHECK_NEAR(m[c], expected[c], 1e-5);
+        }
+        CHECK_NEAR(m4.x, expected.x, 1e-5);
+        CHECK_NEAR(m4.z, expected.z, 1e-5);
+
+        // q and -q are the same rotation.
+        Quaternion<float> back = Quaternion<float>::FromMatrix(q.ToMat3x3());
+        float sign = back.DotProduct(back, q) < 0.0f ? -1.0f : 1.0f;
+        CHECK_NEAR(back.w * sign, q.w, 1e-5);
+        CHECK_NEAR(back.v.x * sign, q.v.x, 1e-5);
+        CHECK_NEAR(back.v.y * sign, q.v.y, 1e-5);
+        CHECK_NEAR(back.v.z * sign, q.v.z, 1e-5);
+        back = Quaternion<float>::FromMatrix(q.ToMatrix44());
+        CHECK_NEAR(fabs(back.DotProduct(back, q)), 1.0, 1e-5);
+        back = q.FromMatToQuat(Mat4x4<float>(q.ToMatrix44()));
+        CHECK_NEAR(fabs(back.DotProduct(back, q)), 1.0, 1e-5);
+    }
+
+    // Half turns make each component the largest in turn.
+    for (int axis = 0; axis < 3; ++axis) {
+        Vector3D<double> v(0.0, 0.0, 0.0);
+        v[axis] = 1.0;
+        Quaternion<double> q(0.0, v);
+        Quaternion<double> back = Quaternion<double>::FromMatrix(q.ToMat3x3());
+        CHECK_NEAR(fabs(back.v[axis]), 1.0, 1e-12);
+        CHECK(back.Rotate(v) == v);
+    }
+}
+
+TEST_CASE(BatchRotateAndMatrices)
+{
+    // Odd count to cover the scalar tail; the half turns take every branch.
+    const size_t count = 45;
+    std::vector<Quaternion<float> > q;
+    for (size_t i = 0; i < count; ++i) {
+        Quaternion<float> r = Test::RandomUnitQuaternion();
+        if (i % 5 < 3) {
+            Vector3D<float> v(0.0f, 0.0f, 0.0f);
+            v[(int)(i % 5)] = 1.0f;
+            r = Quaternion<float>(0.01f * Test::Random(), v);
+            r = r * (1.0f / sqrtf(r.DotProduct(r, r)));
+        }
+        q.push_back(r);
+    }
+    QuaternionStream stream(q.data(), count);
+    Vector3Stream points(count), rotated;
+    for (size_t i = 0; i < count; ++i)
+        points.Set(i, Vector3(Test::Random(), Test::Random(), Test::Random()));
+
+    RotateMany(stream, points, rotated);
+    std::vector<Matrix44> m44(count);
+    std::vector<Mat3x3<float> > m33(count);
+    ToMatrix44Many(stream, m44.data());
+    ToMat3x3Many(stream, m33.data());
+    QuaternionStream from44, from33;
+    FromMatrixMany(m44.data(), count, from44);
+    FromMatrixMany(m33.data(), count, from33);
+    CHECK(rotated.Size() == count && from44.Size() == count && from33.Size() == count);
+
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 p = points.Get(i);
+        Vector3D<float> expected = q[i].Rotate(Vector3D<float>(p.x, p.y, p.z));
+        Vector3 r = rotated.Get(i);
+        CHECK_NEAR(r.x, expected.x, 1e-6);
+        CHECK_NEAR(r.y, expected.y, 1e-6);
+        CHECK_NEAR(r.z, expected.z, 1e-6);
+
+        Matrix44 e44 = q[i].ToMatrix44();
+        Mat3x3<float> e33 = q[i].ToMat3x3();
+        for (int row = 0; row < 4; ++row)
+            for (int c = 0; c < 4; ++c)
+                CHECK_NEAR(m44[i][row][c], e44[row][c], 1e-6);
+        for (int row = 0; row < 3; ++row)
+            for (int c = 0; c < 3; ++c)
+                CHECK_NEAR(m33[i][row][c], e33[row][c], 1e-6);
+
+        Quaternion<float> a = from44.Get(i), b = from33.Get(i);
+        CHECK_NEAR(fabs(a.DotProduct(a, q[i])), 1.0, 2e-6);
+        CHECK_NEAR(fabs(b.DotProduct(b, q[i])), 1.0, 2e-6);
+        CHECK_NEAR(a.DotProduct(a, a), 1.0, 2e-6);
+    }
+}
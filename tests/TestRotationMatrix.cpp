@@ -0,0 +1,162 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "RotationMatrix.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // Largest entry of m * transpose(m) - I.
+    template <typename M>
+    double OrthonormalError(const M& m)
+    {
+        double error = 0.0;
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < 3; ++b) {
+                double d = double(m[a][0]) * m[b][0] + double(m[a][1]) * m[b][1] + double(m[a][2]) * m[b][2];
+                error = fmax(error, fabs(d - (a == b ? 1.0 : 0.0)));
+            }
+        return error;
+    }
+
+    double SquaredDistance(const RotationMatrix<float>& a, const RotationMatrix<float>& b)
+    {
+        double sum = 0.0;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                sum += (double(a[r][c]) - b[r][c]) * (double(a[r][c]) - b[r][c]);
+        return sum;
+    }
+
+    template <typename M>
+    double MaxDifference(const M& a, const RotationMatrix<float>& b)
+    {
+        double error = 0.0;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                error = fmax(error, fabs(double(a[r][c]) - b[r][c]));
+        return error;
+    }
+
+    // A rotation pushed off orthonormal by up to drift per entry.
+    RotationMatrix<float> Drifted(float drift)
+    {
+        RotationMatrix<float> m(Test::RandomUnitQuaternion());
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                m.m[r][c] += Test::Random(-drift, drift);
+        return m;
+    }
+}
+
+TEST_CASE(RotationMatrixFastPaths)
+{
+    for (int n = 0; n < 20; ++n) {
+        Quaternion<float> qa = Test::RandomUnitQuaternion(), qb = Test::RandomUnitQuaternion();
+        RotationMatrix<float> a(qa), b(qb);
+        Mat3x3<float> general = qa.ToMat3x3();
+        CHECK(OrthonormalError(a) < 1e-6);
+
+        // Inverse is the transpose, and matches the general inverse.
+        CHECK(a.Inverse() == a.Transpose());
+        CHECK(MaxDifference(general.Inverse(), a.Inverse()) < 1e-5);
+        CHECK(MaxDifference(general * b.ToMat3x3(), a * b) < 1e-5);
+        CHECK(MaxDifference(Mat3x3<float>(1.0f), a * a.Inverse()) < 1e-5);
+
+        // Object to inertial rotates like the quaternion; inertial to
+        // object undoes it.
+        Vector3D<float> p(Test::Random(), Test::Random(), Test::Random());
+        Vector3D<float> inertial = a.ObjectToInertial(p), expected = qa.Rotate(p);
+        Vector3D<float> back = a.InertialToObject(inertial);
+        CHECK_NEAR(inertial.x, expected.x, 1e-5);
+        CHECK_NEAR(inertial.y, expected.y, 1e-5);
+        CHECK_NEAR(inertial.z, expected.z, 1e-5);
+        CHECK_NEAR(back.x, p.x, 1e-5);
+        CHECK_NEAR(back.y, p.y, 1e-5);
+        CHECK_NEAR(back.z, p.z, 1e-5);
+
+        // a * b applies a first.
+        Vector3D<float> composed = (a * b).ObjectToInertial(p), twice = qb.Rotate(qa.Rotate(p));
+        CHECK_NEAR(composed.x, twice.x, 1e-5);
+        CHECK_NEAR(composed.y, twice.y, 1e-5);
+        CHECK_NEAR(composed.z, twice.z, 1e-5);
+
+        Quaternion<float> q = a.ToQuaternion();
+        CHECK(fabs(fabs(q.DotProduct(q, qa)) - 1.0f) < 1e-5);
+    }
+
+    RotationMatrix<float> identity;
+    Matrix44 expected;
+    CHECK(identity.ToMatrix44() == expected.SetIdentity());
+    RotationMatrix<double> euler(EulerAngles<double>(0.3, -0.2, 1.1, EulerOrder::ZYX));
+    CHECK(OrthonormalError(euler) < 1e-15);
+}
+
+TEST_CASE(RotationMatrixOrthonormalize)
+{
+    for (int n = 0; n < 20; ++n) {
+        RotationMatrix<float> drifted = Drifted(1e-2f);
+        CHECK(OrthonormalError(drifted) > 1e-4);
+
+        RotationMatrix<float> gramSchmidt = drifted, polar = drifted;
+        gramSchmidt.Orthonormalize();
+        polar.Orthonormalize(OrthonormalizeMethod::Polar);
+        CHECK(OrthonormalError(gramSchmidt) < 1e-6);
+        CHECK(OrthonormalError(polar) < 1e-6);
+        CHECK(MaxDifference(gramSchmidt, drifted) < 0.05);
+        CHECK(MaxDifference(polar, drifted) < 0.05);
+
+        // Gram-Schmidt keeps the first row's direction.
+        Vector3D<float> x(drifted[0][0], drifted[0][1], drifted[0][2]);
+        x = Normalize(x);
+        CHECK(fabs(gramSchmidt[0][0] - x.x) < 1e-6 && fabs(gramSchmidt[0][1] - x.y) < 1e-6 && fabs(gramSchmidt[0][2] - x.z) < 1e-6);
+        // The polar factor is the nearest rotation (Frobenius norm).
+        CHECK(SquaredDistance(polar, drifted) <= SquaredDistance(gramSchmidt, drifted) + 1e-9);
+    }
+
+    // A long chain of small steps drifts; a correction every so often
+    // keeps it a rotation.
+    RotationMatrix<float> step(EulerAngles<float>(0.01f, 0.02f, -0.015f)), chain;
+    for (int n = 0; n < 5000; ++n) {
+        chain = chain * step;
+        if (n % 100 == 99)
+            chain.Orthonormalize(OrthonormalizeMethod::Polar);
+    }
+    CHECK(OrthonormalError(chain) < 1e-5);
+
+    RotationMatrix<double> precise(Mat3x3<double>(1.001, 0.01, 0.0, -0.01, 0.998, 0.002, 0.0, 0.0, 1.0));
+    precise.Orthonormalize(OrthonormalizeMethod::Polar);
+    CHECK(OrthonormalError(precise) < 1e-9);
+    // Each call squares the remaining error.
+    precise.Orthonormalize(OrthonormalizeMethod::Polar);
+    CHECK(OrthonormalError(precise) < 1e-15);
+}
+
+TEST_CASE(RotationMatrixOrthonormalizeMany)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 37;
+    std::vector<RotationMatrix<float> > drifted;
+    for (size_t i = 0; i < count; ++i)
+        drifted.push_back(Drifted(5e-3f));
+
+    for (int method = 0; method < 2; ++method) {
+        OrthonormalizeMethod m = method == 0 ? OrthonormalizeMethod::GramSchmidt : OrthonormalizeMethod::Polar;
+        std::vector<RotationMatrix<float> > batch = drifted;
+        std::vector<Mat3x3<float> > general;
+        for (size_t i = 0; i < count; ++i)
+            general.push_back(drifted[i].ToMat3x3());
+        OrthonormalizeMany(batch.data(), count, m);
+        OrthonormalizeMany(general.data(), count, m);
+
+        bool ok = true;
+        for (size_t i = 0; i < count; ++i) {
+            RotationMatrix<float> scalar = drifted[i];
+            scalar.Orthonormalize(m);
+            ok = ok && OrthonormalError(batch[i]) < 1e-6 && MaxDifference(scalar, batch[i]) < 1e-6;
+            ok = ok && MaxDifference(general[i], batch[i]) == 0.0;
+        }
+        CHECK(ok);
+    }
+}
@@ -0,0 +1,151 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Skinning.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    bool Near(const Vector3& a, const Vector3& b)
+    {
+        return fabsf(a.x - b.x) <= 1e-5f && fabsf(a.y - b.y) <= 1e-5f && fabsf(a.z - b.z) <= 1e-5f;
+    }
+
+    struct Mesh {
+        std::vector<uint16_t> bones[4];
+        std::vector<float> weights[4];
+        Vector3Stream positions, normals;
+
+        explicit Mesh(size_t count, size_t boneCount)
+            : positions(count)
+            , normals(count)
+        {
+            for (size_t i = 0; i < count; ++i) {
+                float w[4], sum = 0.0f;
+                for (int k = 0; k < 4; ++k) {
+                    // Some vertices use fewer than four bones.
+                    w[k] = k > 0 && i % (k + 2) == 0 ? 0.0f : Test::Random(0.1f, 1.0f);
+                    sum += w[k];
+                }
+                for (int k = 0; k < 4; ++k) {
+                    bones[k].push_back((uint16_t)Test::Random(0.0f, (float)boneCount - 0.5f));
+                    weights[k].push_back(w[k] / sum);
+                }
+                positions.Set(i, Vector3(Test::Random(-2.0f, 2.0f), Test::Random(-2.0f, 2.0f), Test::Random(-2.0f, 2.0f)));
+                Vector3 n(Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f));
+                normals.Set(i, n * (1.0f / sqrtf(DotProduct(n, n))));
+            }
+        }
+
+        SkinWeightsView Weights() const
+        {
+            const uint16_t* b[4] = { bones[0].data(), bones[1].data(), bones[2].data(), bones[3].data() };
+            const float* w[4] = { weights[0].data(), weights[1].data(), weights[2].data(), weights[3].data() };
+            return SkinWeightsView(b, w, positions.Size());
+        }
+    };
+}
+
+TEST_CASE(SkinDualQuaternionMatchesBlend)
+{
+    const size_t boneCount = 20, count = 1003;
+    std::vector<DualQuaternion<float> > palette;
+    for (size_t b = 0; b < boneCount; ++b) {
+        DualQuaternion<float> dq(Test::RandomUnitQuaternion(), Vector3D<float>(Test::Random(-3.0f, 3.0f), Test::Random(-3.0f, 3.0f), Test::Random(-3.0f, 3.0f)));
+        // Both signs appear in real palettes.
+        palette.push_back(b % 3 == 0 ? dq * -1.0f : dq);
+    }
+    Mesh mesh(count, boneCount);
+
+    Vector3Stream positions, normals;
+    SkinDualQuaternion(palette.data(), mesh.Weights(), mesh.positions, mesh.normals, positions, normals);
+    CHECK(positions.Size() == count && normals.Size() == count);
+
+    for (size_t i = 0; i < count; ++i) {
+        DualQuaternion<float> dq[4];
+        float w[4];
+        for (int k = 0; k < 4; ++k) {
+            dq[k] = palette[mesh.bones[k][i]];
+            w[k] = mesh.weights[k][i];
+        }
+        DualQuaternion<float> blend = Blend(dq, w, 4);
+        Vector3 p = mesh.positions.Get(i), n = mesh.normals.Get(i);
+        Vector3D<float> ep = blend.TransformPoint(Vector3D<float>(p.x, p.y, p.z));
+        Vector3D<float> en = blend.TransformDirection(Vector3D<float>(n.x, n.y, n.z));
+        Vector3 sp = positions.Get(i), sn = normals.Get(i);
+        CHECK_NEAR(sp.x, ep.x, 1e-4);
+        CHECK_NEAR(sp.y, ep.y, 1e-4);
+        CHECK_NEAR(sp.z, ep.z, 1e-4);
+        CHECK_NEAR(sn.x, en.x, 1e-5);
+        CHECK_NEAR(sn.y, en.y, 1e-5);
+        CHECK_NEAR(sn.z, en.z, 1e-5);
+    }
+
+    // Threaded runs split the mesh without changing the result beyond
+    // FMA contraction.
+    SkinningOptions options;
+    options.parallelThreshold = 1;
+    options.threadCount = 3;
+    Vector3Stream threaded, threadedNormals;
+    SkinDualQuaternion(palette.data(), mesh.Weights(), mesh.positions, mesh.normals, threaded, threadedNormals, options);
+    bool same = true;
+    for (size_t i = 0; i < count; ++i)
+        same = same && Near(threaded.Get(i), positions.Get(i)) && Near(threadedNormals.Get(i), normals.Get(i));
+    CHECK(same);
+
+    Vector3Stream positionsOnly;
+    SkinDualQuaternion(palette.data(), mesh.Weights(), mesh.positions, positionsOnly);
+    same = true;
+    for (size_t i = 0; i < count; ++i)
+        same = same && Near(positionsOnly.Get(i), positions.Get(i));
+    CHECK(same);
+}
+
+TEST_CASE(SkinLinearBlendMatchesMatrixSum)
+{
+    const size_t boneCount = 30, count = 1005;
+    std::vector<Matrix44> palette(boneCount);
+    for (size_t b = 0; b < boneCount; ++b) {
+        float scale = Test::Random(0.5f, 1.5f);
+        Transform t(Test::RandomUnitQuaternion(), Vector3(Test::Random(-3.0f, 3.0f), Test::Random(-3.0f, 3.0f), Test::Random(-3.0f, 3.0f)), scale);
+        palette[b] = t.ToMatrix44();
+    }
+    Mesh mesh(count, boneCount);
+
+    Vector3Stream positions, normals, positionsOnly;
+    SkinLinearBlend(palette.data(), mesh.Weights(), mesh.positions, mesh.normals, positions, normals);
+    SkinLinearBlend(palette.data(), mesh.Weights(), mesh.positions, positionsOnly);
+    CHECK(positions.Size() == count && normals.Size() == count && positionsOnly.Size() == count);
+
+    for (size_t i = 0; i < count; ++i) {
+        // The per-influence loop the kernel replaces.
+        Vector3 p = mesh.positions.Get(i), n = mesh.normals.Get(i);
+        Vector3 ep(0.0f, 0.0f, 0.0f), en(0.0f, 0.0f, 0.0f);
+        for (int k = 0; k < 4; ++k) {
+            const Matrix44& m = palette[mesh.bones[k][i]];
+            float w = mesh.weights[k][i];
+            Vector4 sp = m * Vector4(p.x, p.y, p.z, 1.0f);
+            ep = ep + Vector3(sp.x, sp.y, sp.z) * w;
+            en = en + Vector3(n.x * m[0][0] + n.y * m[1][0] + n.z * m[2][0], n.x * m[0][1] + n.y * m[1][1] + n.z * m[2][1], n.x * m[0][2] + n.y * m[1][2] + n.z * m[2][2]) * w;
+        }
+        Vector3 sp = positions.Get(i), sn = normals.Get(i);
+        CHECK_NEAR(sp.x, ep.x, 1e-4);
+        CHECK_NEAR(sp.y, ep.y, 1e-4);
+        CHECK_NEAR(sp.z, ep.z, 1e-4);
+        CHECK_NEAR(sn.x, en.x, 1e-5);
+        CHECK_NEAR(sn.y, en.y, 1e-5);
+        CHECK_NEAR(sn.z, en.z, 1e-5);
+        CHECK(Near(positionsOnly.Get(i), sp));
+    }
+
+    SkinningOptions options;
+    options.parallelThreshold = 1;
+    options.threadCount = 4;
+    Vector3Stream threaded;
+    SkinLinearBlend(palette.data(), mesh.Weights(), mesh.positions, threaded, options);
+    bool same = true;
+    for (size_t i = 0; i < count; ++i)
+        same = same && Near(threaded.Get(i), positionsOnly.Get(i));
+    CHECK(same);
+}
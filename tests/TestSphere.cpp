@@ -0,0 +1,257 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Sphere.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector3 RandomPoint(float lo, float hi)
+    {
+        return Vector3(Test::Random(lo, hi), Test::Random(lo, hi), Test::Random(lo, hi));
+    }
+
+    // A stretched, offset cloud, like a mesh that is longer than it is wide.
+    Vector3Stream Cloud(size_t count)
+    {
+        Vector3Stream points(count);
+        for (size_t i = 0; i < count; ++i) {
+            Vector3 p = RandomPoint(-1.0f, 1.0f);
+            points.Set(i, Vector3(p.x * 4.0f + 10.0f, p.y - 3.0f, p.z * 0.5f));
+        }
+        return points;
+    }
+
+    bool ContainsAll(const Sphere& s, const Vector3Stream& points)
+    {
+        bool ok = true;
+        for (size_t i = 0; i < points.Size(); ++i)
+            ok = ok && s.Contains(points.Get(i));
+        return ok;
+    }
+
+    struct Spheres {
+        std::vector<float> x, y, z, radius;
+
+        void Add(const Sphere& s)
+        {
+            x.push_back(s.center.x);
+            y.push_back(s.center.y);
+            z.push_back(s.center.z);
+            radius.push_back(s.radius);
+        }
+
+        SphereStreamView View() const { return SphereStreamView(x.data(), y.data(), z.data(), radius.data(), x.size()); }
+    };
+}
+
+TEST_CASE(SphereMergeAndIntersect)
+{
+    Sphere s;
+    CHECK(s.IsEmpty() && !s.Contains(Vector3(0.0f, 0.0f, 0.0f)));
+    s.Merge(Vector3(1.0f, 0.0f, 0.0f));
+    CHECK(s.radius == 0.0f && s.Contains(Vector3(1.0f, 0.0f, 0.0f)));
+    s.Merge(Vector3(-1.0f, 0.0f, 0.0f));
+    CHECK_NEAR(s.radius, 1.0f, 1e-6);
+    CHECK_NEAR(s.center.x, 0.0f, 1e-6);
+
+    Sphere inner(Vector3(0.2f, 0.0f, 0.0f), 0.5f), outer(Vector3(3.0f, 0.0f, 0.0f), 1.0f);
+    Sphere merged = s;
+    CHECK(merged.Merge(inner).radius == s.radius);
+    merged.Merge(outer);
+    CHECK_NEAR(merged.radius, 2.5f, 1e-6);
+    CHECK_NEAR(merged.center.x, 1.5f, 1e-6);
+    CHECK(Sphere().Merge(outer).center == outer.center);
+
+    CHECK(Intersects(s, inner) && !Intersects(s, outer));
+    CHECK(Intersects(s, Sphere(Vector3(3.0f, 0.0f, 0.0f), 2.0f)));
+    CHECK(!Intersects(s, Sphere()));
+
+    AABB box(Vector3(1.5f, 1.5f, -1.0f), Vector3(2.0f, 2.0f, 1.0f));
+    // The nearest corner edge is sqrt(2) * 1.5 away.
+    CHECK(!Intersects(Sphere(Vector3(0.0f, 0.0f, 0.0f), 2.1f), box));
+    CHECK(Intersects(Sphere(Vector3(0.0f, 0.0f, 0.0f), 2.13f), box));
+    CHECK(Intersects(Sphere(Vector3(1.8f, 1.8f, 0.0f), 0.01f), box));
+    CHECK(!Intersects(Sphere(Vector3(1.8f, 1.8f, 0.0f), 1.0f), AABB()));
+}
+
+TEST_CASE(BoundingVolumesOfPointClouds)
+{
+    // Odd count to cover the scalar tails and more than one chunk.
+    const size_t count = 5003;
+    Vector3Stream points = Cloud(count);
+    std::vector<Vector3> aos(count);
+    for (size_t i = 0; i < count; ++i)
+        aos[i] = points.Get(i);
+
+    AABB expected;
+    for (size_t i = 0; i < count; ++i)
+        expected.Merge(points.Get(i));
+    AABB box = BoundingBox(points);
+    CHECK(box.minimum == expected.minimum && box.maximum == expected.maximum);
+    AABB fromArray = BoundingBox(Vector3ArrayView(aos.data(), count));
+    CHECK(fromArray.minimum == expected.minimum && fromArray.maximum == expected.maximum);
+
+    // Splitting across threads gives the same results.
+    BoundsOptions threaded;
+    threaded.parallelThreshold = 0;
+    threaded.threadCount = 4;
+    AABB threadedBox = BoundingBox(points, threaded);
+    CHECK(threadedBox.minimum == expected.minimum && threadedBox.maximum == expected.maximum);
+
+    Sphere ritter = BoundingSphere(points);
+    Sphere welzl = BoundingSphere(points, SphereFit::Welzl);
+    Sphere threadedRitter = BoundingSphere(points, SphereFit::Ritter, threaded);
+    CHECK(ContainsAll(ritter, points));
+    CHECK(ContainsAll(welzl, points));
+    CHECK(threadedRitter.center == ritter.center && threadedRitter.radius == ritter.radius);
+    Sphere fromArrayRitter = BoundingSphere(Vector3ArrayView(aos.data(), count));
+    CHECK(fromArrayRitter.center == ritter.center && fromArrayRitter.radius == ritter.radius);
+
+    // The exact sphere is no larger than Ritter's, which is close to it,
+    // and no smaller than half the widest extent.
+    CHECK(welzl.radius <= ritter.radius);
+    CHECK(ritter.radius < welzl.radius * 1.1f);
+    CHECK(welzl.radius >= (box.maximum.x - box.minimum.x) * 0.5f);
+
+    CHECK(BoundingSphere(Vector3Stream()).IsEmpty());
+    CHECK(BoundingSphere(Vector3Stream(), SphereFit::Welzl).IsEmpty());
+    CHECK(BoundingBox(Vector3Stream()).IsEmpty());
+}
+
+TEST_CASE(WelzlIsMinimal)
+{
+    // Points on a known sphere, plus points inside it.
+    for (int n = 0; n < 10; ++n) {
+        Vector3 center = RandomPoint(-5.0f, 5.0f);
+        float radius = Test::Random(0.5f, 3.0f);
+        Vector3Stream points(200);
+        for (size_t i = 0; i < points.Size(); ++i) {
+            Vector3D<float> d(Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f), Test::Random(-1.0f, 1.0f));
+            d = Normalize(d) * (i % 3 == 0 ? radius * Test::Random(0.0f, 1.0f) : radius);
+            points.Set(i, center + Vector3(d.x, d.y, d.z));
+        }
+        Sphere s = BoundingSphere(points, SphereFit::Welzl);
+        CHECK(ContainsAll(s, points));
+        CHECK_NEAR(s.radius, radius, radius * 1e-3);
+    }
+
+    // Degenerate sets: one point, collinear and coplanar points.
+    Vector3Stream single(1);
+    single.Set(0, Vector3(1.0f, 2.0f, 3.0f));
+    Sphere point = BoundingSphere(single, SphereFit::Welzl);
+    CHECK(point.radius == 0.0f && point.center == Vector3(1.0f, 2.0f, 3.0f));
+
+    Vector3Stream line(9), plane(40);
+    for (size_t i = 0; i < line.Size(); ++i)
+        line.Set(i, Vector3(float(i), 2.0f * float(i), 0.0f));
+    for (size_t i = 0; i < plane.Size(); ++i) {
+        float a = 0.157f * float(i);
+        plane.Set(i, Vector3(cosf(a) * 2.0f, sinf(a) * 2.0f, 1.0f));
+    }
+    Sphere segment = BoundingSphere(line, SphereFit::Welzl), circle = BoundingSphere(plane, SphereFit::Welzl);
+    CHECK(ContainsAll(segment, line) && ContainsAll(circle, plane));
+    CHECK_NEAR(segment.radius, sqrtf(64.0f + 256.0f) * 0.5f, 1e-5);
+    CHECK_NEAR(circle.radius, 2.0f, 1e-3);
+    CHECK_NEAR(circle.center.z, 1.0f, 1e-5);
+}
+
+TEST_CASE(SphereCollectOverlaps)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 203;
+    Spheres spheres;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::vector<AABB> boxes;
+    for (size_t i = 0; i < count; ++i) {
+        spheres.Add(Sphere(RandomPoint(-10.0f, 10.0f), Test::Random(0.1f, 2.0f)));
+        AABB box = AABB::FromCenterExtents(RandomPoint(-10.0f, 10.0f), RandomPoint(0.1f, 2.0f));
+        boxes.push_back(box);
+        minX.push_back(box.minimum.x);
+        minY.push_back(box.minimum.y);
+        minZ.push_back(box.minimum.z);
+        maxX.push_back(box.maximum.x);
+        maxY.push_back(box.maximum.y);
+        maxZ.push_back(box.maximum.z);
+    }
+    AABBStreamView boxView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), count);
+
+    for (int n = 0; n < 10; ++n) {
+        Sphere query(RandomPoint(-8.0f, 8.0f), Test::Random(1.0f, 6.0f));
+        AABB boxQuery = AABB::FromCenterExtents(query.center, Vector3(query.radius, query.radius * 0.5f, query.radius));
+        std::vector<uint32_t> spheresHit(count), boxesHit(count), fromBox(count);
+        size_t sphereCount = CollectOverlaps(query, spheres.View(), spheresHit.data());
+        size_t boxCount = CollectOverlaps(query, boxView, boxesHit.data());
+        size_t fromBoxCount = CollectOverlaps(boxQuery, spheres.View(), fromBox.data());
+
+        std::vector<uint32_t> expectedSpheres, expectedBoxes, expectedFromBox;
+        for (uint32_t i = 0; i < count; ++i) {
+            Sphere s(Vector3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]);
+            if (Intersects(query, s))
+                expectedSpheres.push_back(i);
+            if (Intersects(query, boxes[i]))
+                expectedBoxes.push_back(i);
+            if (Intersects(s, boxQuery))
+                expectedFromBox.push_back(i);
+        }
+        spheresHit.resize(sphereCount);
+        boxesHit.resize(boxCount);
+        fromBox.resize(fromBoxCount);
+        CHECK(spheresHit == expectedSpheres);
+        CHECK(boxesHit == expectedBoxes);
+        CHECK(fromBox == expectedFromBox);
+    }
+}
+
+TEST_CASE(SphereCollectOverlapsSkipsEmpty)
+{
+    // Every third element is empty but would overlap by distance alone;
+    // nine elements cover both the lane blocks and the scalar tail.
+    const size_t count = 9;
+    Spheres spheres;
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::vector<AABB> boxes;
+    for (size_t i = 0; i < count; ++i) {
+        bool empty = i % 3 == 1;
+        spheres.Add(Sphere(Vector3(0.5f, 0.0f, 0.0f), empty ? -0.5f : 0.5f));
+        AABB box = empty ? AABB(Vector3(0.5f, 0.5f, 0.5f), Vector3(0.0f, 0.0f, 0.0f)) : AABB(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.5f, 0.5f, 0.5f));
+        boxes.push_back(box);
+        minX.push_back(box.minimum.x);
+        minY.push_back(box.minimum.y);
+        minZ.push_back(box.minimum.z);
+        maxX.push_back(box.maximum.x);
+        maxY.push_back(box.maximum.y);
+        maxZ.push_back(box.maximum.z);
+    }
+    AABBStreamView boxView(minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data(), count);
+
+    Sphere query(Vector3(0.0f, 0.0f, 0.0f), 2.0f);
+    AABB boxQuery(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+    std::vector<uint32_t> hits(count), expected;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (i % 3 != 1)
+            expected.push_back(i);
+    }
+    hits.resize(CollectOverlaps(query, spheres.View(), hits.data()));
+    CHECK(hits == expected);
+    hits.resize(count);
+    hits.resize(CollectOverlaps(query, boxView, hits.data()));
+    CHECK(hits == expected);
+    hits.resize(count);
+    hits.resize(CollectOverlaps(boxQuery, spheres.View(), hits.data()));
+    CHECK(hits == expected);
+    for (uint32_t i = 0; i < count; ++i) {
+        Sphere s(Vector3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]);
+        CHECK(Intersects(query, s) == (i % 3 != 1));
+        CHECK(Intersects(query, boxes[i]) == (i % 3 != 1));
+        CHECK(Intersects(s, boxQuery) == (i % 3 != 1));
+    }
+
+    // An empty query overlaps nothing.
+    Sphere emptyQuery(Vector3(0.5f, 0.0f, 0.0f), -0.5f);
+    hits.resize(count);
+    CHECK(CollectOverlaps(emptyQuery, spheres.View(), hits.data()) == 0);
+    CHECK(CollectOverlaps(emptyQuery, boxView, hits.data()) == 0);
+    CHECK(CollectOverlaps(AABB(Vector3(1.0f, 1.0f, 1.0f), Vector3(0.0f, 0.0f, 0.0f)), spheres.View(), hits.data()) == 0);
+}
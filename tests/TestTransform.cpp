@@ -0,0 +1,146 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "Transform.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Transform RandomTransform()
+    {
+        float scale = Test::Random(0.5f, 2.0f);
+        return Transform(Test::RandomUnitQuaternion(), Test::RandomVector(5.0f), Test::Random(0.0f, 1.0f) < 0.2f ? -scale : scale);
+    }
+
+    Vector3 MatrixPoint(const Matrix44& m, const Vector3& p)
+    {
+        Vector4 r = m * Vector4(p.x, p.y, p.z, 1.0f);
+        return Vector3(r.x, r.y, r.z);
+    }
+
+    void CheckPoint(const Vector3& a, const Vector3& b, double tolerance)
+    {
+        CHECK_NEAR(a.x, b.x, tolerance);
+        CHECK_NEAR(a.y, b.y, tolerance);
+        CHECK_NEAR(a.z, b.z, tolerance);
+    }
+}
+
+TEST_CASE(TransformMatchesMatrix)
+{
+    CHECK(sizeof(Transform) * 2 == sizeof(Matrix44));
+
+    for (int n = 0; n < 100; ++n) {
+        Transform t = RandomTransform();
+        Matrix44 m = t.ToMatrix44();
+        Vector3 p = Test::RandomVector(3.0f);
+        CheckPoint(t.TransformPoint(p), MatrixPoint(m, p), 1e-4);
+
+        // Matrix44 * Vector4 always applies the translation row.
+        CheckPoint(t.TransformDirection(p), MatrixPoint(m, p) - t.translation, 1e-4);
+    }
+
+    Transform identity;
+    Vector3 p(1.0f, -2.0f, 3.0f);
+    CHECK(identity.TransformPoint(p) == p);
+}
+
+TEST_CASE(TransformComposeAndInverse)
+{
+    for (int n = 0; n < 100; ++n) {
+        Transform a = RandomTransform(), b = RandomTransform();
+        Vector3 p = Test::RandomVector(3.0f);
+
+        // a * b applies a first, like the matrix product.
+        Transform ab = a * b;
+        CheckPoint(ab.TransformPoint(p), b.TransformPoint(a.TransformPoint(p)), 1e-3);
+        CheckPoint(ab.TransformPoint(p), MatrixPoint(a.ToMatrix44() * b.ToMatrix44(), p), 1e-3);
+
+        Transform c = a;
+        c *= b;
+        CHECK(c.TransformPoint(p) == ab.TransformPoint(p));
+
+        CheckPoint(a.Inverse().TransformPoint(a.TransformPoint(p)), p, 1e-4);
+        CheckPoint((a * a.Inverse()).TransformPoint(p), p, 1e-4);
+    }
+}
+
+TEST_CASE(TransformMatrixRoundTrip)
+{
+    for (int n = 0; n < 200; ++n) {
+        Transform t = RandomTransform();
+        Transform back = Transform::FromMatrix44(t.ToMatrix44());
+
+        CHECK_NEAR(back.scale, t.scale, 1e-5);
+        CheckPoint(back.translation, t.translation, 0.0);
+        // q and -q are the same rotation.
+        float sign = back.rotation.DotProduct(back.rotation, t.rotation) < 0.0f ? -1.0f : 1.0f;
+        CHECK_NEAR(back.rotation.w * sign, t.rotation.w, 1e-5);
+        CheckPoint(Vector3(back.rotation.v.x, back.rotation.v.y, back.rotation.v.z) * sign, Vector3(t.rotation.v.x, t.rotation.v.y, t.rotation.v.z), 1e-5);
+    }
+
+    // Half turns about each axis take the non-trace branches.
+    for (int axis = 0; axis < 3; ++axis) {
+        Vector3D<float> v(0.0f, 0.0f, 0.0f);
+        v[axis] = 1.0f;
+        Transform t(Quaternion<float>(0.0f, v), Vector3(1.0f, 2.0f, 3.0f), 2.0f);
+        Transform back = Transform::FromMatrix44(t.ToMatrix44());
+        CHECK_NEAR(fabsf(back.rotation.v[axis]), 1.0, 1e-6);
+        CHECK_NEAR(back.scale, 2.0, 1e-6);
+    }
+}
+
+TEST_CASE(TransformLerp)
+{
+    Transform a = RandomTransform(), b = RandomTransform();
+    Vector3 p = Test::RandomVector(3.0f);
+    CheckPoint(Lerp(a, b, 0.0f).TransformPoint(p), a.TransformPoint(p), 1e-4);
+    CheckPoint(Lerp(a, b, 1.0f).TransformPoint(p), b.TransformPoint(p), 1e-4);
+
+    // Halfway between opposite-sign encodings of one rotation is that
+    // rotation, not a degenerate quaternion.
+    Transform c(a.rotation * -1.0f, a.translation, a.scale);
+    Transform mid = Lerp(a, c, 0.5f);
+    CheckPoint(mid.TransformPoint(p), a.TransformPoint(p), 1e-4);
+
+    Transform half = Lerp(Transform(), Transform(Quaternion<float>(0.0f, Vector3D<float>(0.0f, 0.0f, 1.0f)), Vector3(2.0f, 0.0f, 0.0f), 3.0f), 0.5f);
+    CHECK_NEAR(half.scale, 2.0, 1e-6);
+    CheckPoint(half.TransformDirection(Vector3(1.0f, 0.0f, 0.0f)), Vector3(0.0f, 2.0f, 0.0f), 1e-5);
+    CheckPoint(half.translation, Vector3(1.0f, 0.0f, 0.0f), 0.0);
+}
+
+TEST_CASE(TransformBatchMatchesScalar)
+{
+    // Odd count to cover the scalar tail.
+    const size_t count = 37;
+    std::vector<Transform> a(count), b(count), out(count);
+    for (size_t i = 0; i < count; ++i) {
+        a[i] = RandomTransform();
+        b[i] = RandomTransform();
+    }
+
+    Compose(a.data(), b.data(), out.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        Transform expected = a[i] * b[i];
+        CHECK_NEAR(out[i].rotation.w, expected.rotation.w, 1e-6);
+        CHECK_NEAR(out[i].rotation.v.z, expected.rotation.v.z, 1e-6);
+        CheckPoint(out[i].translation, expected.translation, 1e-5);
+        CHECK(out[i].scale == expected.scale);
+    }
+
+    Lerp(a.data(), b.data(), 0.3f, out.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        Transform expected = Lerp(a[i], b[i], 0.3f);
+        CHECK_NEAR(out[i].rotation.w, expected.rotation.w, 1e-6);
+        CHECK_NEAR(out[i].rotation.v.x, expected.rotation.v.x, 1e-6);
+        CheckPoint(out[i].translation, expected.translation, 1e-5);
+        CHECK_NEAR(out[i].scale, expected.scale, 1e-6);
+    }
+
+    // In place.
+    std::vector<Transform> c = a;
+    Compose(c.data(), b.data(), c.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        CheckPoint(c[i].translation, (a[i] * b[i]).translation, 1e-5);
+}
@@ -0,0 +1,124 @@
+#include "TestFramework.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "TransformHierarchy.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    // q * (0, v) * conjugate(q)
+    Vector3 Rotate(const Quaternion<float>& q, const Vector3& v)
+    {
+        Quaternion<float> conjugate(q.w, Vector3D<float>(-q.v.x, -q.v.y, -q.v.z));
+        Quaternion<float> r = q * Quaternion<float>(0.0f, Vector3D<float>(v.x, v.y, v.z)) * conjugate;
+        return Vector3(r.v.x, r.v.y, r.v.z);
+    }
+
+    // A point through the local transforms from node up to the root.
+    Vector3 ToWorld(const TransformHierarchy& h, uint32_t node, Vector3 p)
+    {
+        for (; node != TransformHierarchy::NoParent; node = h.Parent(node)) {
+            const Vector3& s = h.Scale(node);
+            p = Rotate(h.Rotation(node), Vector3(p.x * s.x, p.y * s.y, p.z * s.z)) + h.Translation(node);
+        }
+        return p;
+    }
+
+    TransformHierarchy RandomHierarchy(size_t count)
+    {
+        TransformHierarchy h;
+        for (size_t i = 0; i < count; ++i) {
+            // A few roots, and parents biased towards recent nodes so the
+            // trees get deep.
+            uint32_t parent = TransformHierarchy::NoParent;
+            if (i > 0 && i % 97 != 0)
+                parent = (uint32_t)(i - 1 - (size_t)Test::Random(0.0f, (float)std::min<size_t>(i - 1, 8)));
+            h.Add(parent, Test::RandomUnitQuaternion(), Test::RandomVector(2.0f), Vector3(Test::Random(0.8f, 1.2f), Test::Random(0.8f, 1.2f), Test::Random(0.8f, 1.2f)));
+        }
+        return h;
+    }
+
+    bool SameWorld(const TransformHierarchy& a, const TransformHierarchy& b)
+    {
+        for (uint32_t i = 0; i < a.Size(); ++i)
+            for (int r = 0; r < 4; ++r)
+                for (int c = 0; c < 4; ++c)
+                    if (a.World(i)[r][c] != b.World(i)[r][c])
+                        return false;
+        return true;
+    }
+}
+
+TEST_CASE(HierarchyWorldMatchesLocalChain)
+{
+    TransformHierarchy h = RandomHierarchy(300);
+    h.Update();
+
+    for (uint32_t i = 0; i < h.Size(); i += 7) {
+        Vector3 p = Test::RandomVector(1.0f);
+        Vector4 world = h.World(i) * Vector4(p.x, p.y, p.z, 1.0f);
+        Vector3 expected = ToWorld(h, i, p);
+        double tolerance = 1e-4 * (1.0 + fabs(expected.x) + fabs(expected.y) + fabs(expected.z));
+        CHECK_NEAR(world.x, expected.x, tolerance);
+        CHECK_NEAR(world.y, expected.y, tolerance);
+        CHECK_NEAR(world.z, expected.z, tolerance);
+        CHECK(world.w == 1.0f);
+    }
+}
+
+TEST_CASE(HierarchyDirtyUpdate)
+{
+    TransformHierarchy h = RandomHierarchy(500);
+    h.Update();
+
+    // Changing a few nodes and updating matches a hierarchy updated from
+    // scratch with the same values.
+    for (int n = 0; n < 10; ++n) {
+        uint32_t node = (uint32_t)Test::Random(0.0f, 499.0f);
+        h.SetTranslation(node, Test::RandomVector(2.0f));
+        h.SetRotation((node * 7) % 500, Test::RandomUnitQuaternion());
+    }
+    h.Update();
+
+    TransformHierarchy fresh;
+    for (uint32_t i = 0; i < h.Size(); ++i)
+        fresh.Add(h.Parent(i), h.Rotation(i), h.Translation(i), h.Scale(i));
+    fresh.Update();
+    CHECK(SameWorld(h, fresh));
+
+    // Nothing marked: nothing moves.
+    Matrix44 before = h.World(250);
+    h.Update();
+    CHECK(h.World(250)[3][0] == before[3][0] && h.World(250)[1][2] == before[1][2]);
+}
+
+TEST_CASE(HierarchyThreadedUpdate)
+{
+    TransformHierarchy serial = RandomHierarchy(5000), threaded = serial;
+    HierarchyUpdateOptions options;
+    options.parallelThreshold = 1;
+    options.threadCount = 4;
+
+    serial.Update();
+    threaded.Update(options);
+    CHECK(SameWorld(serial, threaded));
+
+    for (uint32_t i = 3; i < serial.Size(); i += 101) {
+        serial.SetScale(i, Vector3(2.0f, 1.0f, 0.5f));
+        threaded.SetScale(i, Vector3(2.0f, 1.0f, 0.5f));
+    }
+    serial.Update();
+    threaded.Update(options);
+    CHECK(SameWorld(serial, threaded));
+
+    // A single deep chain has no independent subtrees to hand out.
+    TransformHierarchy chain;
+    for (uint32_t i = 0; i < 100; ++i)
+        chain.Add(i == 0 ? TransformHierarchy::NoParent : i - 1, Test::RandomUnitQuaternion(), Test::RandomVector(0.1f));
+    TransformHierarchy chainSerial = chain;
+    chain.Update(options);
+    chainSerial.Update();
+    CHECK(SameWorld(chain, chainSerial));
+}
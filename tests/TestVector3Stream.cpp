@@ -0,0 +1,89 @@
+#include "TestFramework.h"
+
+#include "Vector3Stream.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    std::vector<Vector3> RandomVectors(size_t count)
+    {
+        std::vector<Vector3> v(count);
+        for (size_t i = 0; i < count; ++i)
+            v[i] = Vector3(Test::Random(-5.0f, 5.0f), Test::Random(-5.0f, 5.0f), Test::Random(-5.0f, 5.0f));
+        return v;
+    }
+
+    bool Near(const Vector3& a, const Vector3& b)
+    {
+        return fabsf(a.x - b.x) <= 1e-5f && fabsf(a.y - b.y) <= 1e-5f && fabsf(a.z - b.z) <= 1e-5f;
+    }
+}
+
+TEST_CASE(Vector3StreamRoundTrip)
+{
+    std::vector<Vector3> v = RandomVectors(19);
+    Vector3Stream s(Vector3ArrayView(v.data(), v.size()));
+    CHECK(s.Size() == v.size());
+
+    std::vector<Vector3> back(v.size());
+    s.CopyTo(back.data());
+    for (size_t i = 0; i < v.size(); ++i) {
+        CHECK(s.Get(i) == v[i]);
+        CHECK(back[i] == v[i]);
+    }
+
+    s.Resize(25);
+    CHECK(s.Get(18) == v[18]);
+    CHECK(s.Get(24) == Vector3());
+}
+
+TEST_CASE(Vector3StreamMatchesScalarFunctions)
+{
+    const size_t count = 37;
+    std::vector<Vector3> a = RandomVectors(count);
+    std::vector<Vector3> b = RandomVectors(count);
+    a[5] = Vector3();
+
+    Vector3Stream sa(Vector3ArrayView(a.data(), count));
+    Vector3ArrayView vb(b.data(), count);
+    Vector3Stream out;
+    std::vector<float> scalars(count);
+
+    Add(sa, vb, out);
+    for (size_t i = 0; i < count; ++i)
+        CHECK(out.Get(i) == a[i] + b[i]);
+
+    Subtract(vb, sa, out);
+    for (size_t i = 0; i < count; ++i)
+        CHECK(out.Get(i) == b[i] - a[i]);
+
+    Scale(sa, 0.25f, out);
+    for (size_t i = 0; i < count; ++i)
+        CHECK(out.Get(i) == a[i] * 0.25f);
+
+    CrossProduct(sa, vb, out);
+    for (size_t i = 0; i < count; ++i)
+        CHECK(Near(out.Get(i), CrossProduct(a[i], b[i])));
+
+    Normalize(sa, out);
+    for (size_t i = 0; i < count; ++i)
+        CHECK(Near(out.Get(i), Normalize(a[i])));
+
+    DotProduct(sa, vb, scalars.data());
+    for (size_t i = 0; i < count; ++i)
+        CHECK_NEAR(scalars[i], DotProduct(a[i], b[i]), 1e-4);
+
+    Magnitude(vb, scalars.data());
+    for (size_t i = 0; i < count; ++i)
+        CHECK_NEAR(scalars[i], b[i].Magnitude(), 1e-5);
+}
+
+TEST_CASE(Vector3StreamInPlace)
+{
+    std::vector<Vector3> a = RandomVectors(17);
+    Vector3Stream s(Vector3ArrayView(a.data(), a.size()));
+
+    Normalize(s, s);
+    for (size_t i = 0; i < a.size(); ++i)
+        CHECK(Near(s.Get(i), Normalize(a[i])));
+}
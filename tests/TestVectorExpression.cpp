@@ -0,0 +1,102 @@
+#include "TestFramework.h"
+
+#include <vector>
+
+#include "VectorExpression.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    Vector3 RandomVector3()
+    {
+        return Vector3(Test::Random(-4.0f, 4.0f), Test::Random(-4.0f, 4.0f), Test::Random(-4.0f, 4.0f));
+    }
+
+    Vector4 RandomVector4()
+    {
+        return Vector4(Test::Random(-4.0f, 4.0f), Test::Random(-4.0f, 4.0f), Test::Random(-4.0f, 4.0f), Test::Random(-4.0f, 4.0f));
+    }
+
+    bool Near(const Vector3& a, const Vector3& b)
+    {
+        return fabsf(a.x - b.x) < 1e-5f && fabsf(a.y - b.y) < 1e-5f && fabsf(a.z - b.z) < 1e-5f;
+    }
+
+    bool Near(const Vector4& a, const Vector4& b)
+    {
+        return fabsf(a.x - b.x) < 1e-5f && fabsf(a.y - b.y) < 1e-5f && fabsf(a.z - b.z) < 1e-5f && fabsf(a.w - b.w) < 1e-5f;
+    }
+
+    // A vertex-like struct, so the array view has a stride.
+    struct Particle {
+        Vector3 position;
+        float mass;
+    };
+}
+
+TEST_CASE(LazyVectorsMatchEagerOperators)
+{
+    Vector3 p = RandomVector3(), v = RandomVector3(), a = RandomVector3();
+    float dt = 0.016f;
+    Vector3 lazy = Lazy(p) + Lazy(v) * dt + Lazy(a) * (0.5f * dt * dt);
+    CHECK(Near(lazy, p + v * dt + a * (0.5f * dt * dt)));
+
+    // Plain vectors join as uniform operands on either side.
+    Vector3 mixed = (p - Lazy(v)) ^ (Lazy(a) + v);
+    CHECK(Near(mixed, (p - v) ^ (a + v)));
+    Vector3 scaled = -(2.0f * Lazy(p)) / 4.0f;
+    CHECK(Near(scaled, p * -0.5f));
+
+    Vector4 q = RandomVector4(), r = RandomVector4();
+    Vector4 lazy4 = Lazy(q) * 3.0f - r;
+    CHECK(Near(lazy4, q * 3.0f - r));
+    Vector4 cross4 = Lazy(q) ^ r;
+    CHECK(Near(cross4, q ^ r) && cross4.w == 0.0f);
+}
+
+TEST_CASE(LazyArraysFuseIntoOnePass)
+{
+    // Odd count to cover the SIMD blocks and the scalar tail.
+    const size_t count = 45;
+    std::vector<Particle> particles(count);
+    std::vector<Vector3> velocities(count), aosOut(count);
+    std::vector<Vector4> q(count), r(count), out4(count);
+    Vector3Stream accelerations(count), out;
+    for (size_t i = 0; i < count; ++i) {
+        particles[i].position = RandomVector3();
+        velocities[i] = RandomVector3();
+        accelerations.Set(i, RandomVector3());
+        q[i] = RandomVector4();
+        r[i] = RandomVector4();
+    }
+
+    float dt = 0.5f;
+    Vector3 gravity(0.0f, -9.8f, 0.0f);
+    Vector3ArrayView positions(&particles[0].position, count, sizeof(Particle));
+    Vector3ArrayView velocityView(velocities.data(), count);
+    Evaluate(Lazy(positions) + Lazy(velocityView) * dt + (Lazy(accelerations) + gravity) * (0.5f * dt * dt), out);
+    Evaluate(Lazy(velocityView) ^ Lazy(accelerations), aosOut.data());
+    Evaluate(Lazy(q.data(), count) - Lazy(r.data(), count) / 2.0f, out4.data());
+    CHECK(out.Size() == count);
+
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 acceleration = accelerations.Get(i);
+        Vector3 expected = particles[i].position + velocities[i] * dt + (acceleration + gravity) * (0.5f * dt * dt);
+        ok = ok && Near(out.Get(i), expected);
+        ok = ok && Near(aosOut[i], velocities[i] ^ acceleration);
+        ok = ok && Near(out4[i], q[i] - r[i] * 0.5f);
+    }
+    CHECK(ok);
+
+    // In place, over a stream and over an array.
+    Vector3Stream doubled = accelerations;
+    Evaluate(Lazy(doubled) * 2.0f - Lazy(accelerations), doubled);
+    Evaluate(-Lazy(Vector3ArrayView(aosOut.data(), count)), aosOut.data());
+    for (size_t i = 0; i < count; ++i) {
+        Vector3 acceleration = accelerations.Get(i);
+        ok = ok && Near(doubled.Get(i), acceleration);
+        ok = ok && Near(aosOut[i], acceleration ^ velocities[i]);
+    }
+    CHECK(ok);
+}
@@ -0,0 +1,121 @@
+#include "TestFramework.h"
+
+#include "MathCommon.h"
+#include "MatrixClipSpace.h"
+
+using namespace Oblivion::Math;
+
+namespace {
+    constexpr double Abs(double d) { return d < 0.0 ? -d : d; }
+
+    // Compile-time checks: these only build if the operations fold.
+    constexpr Vector<3, double> a(1.0, 2.0, 3.0);
+    constexpr Vector<3, double> b(4.0, -5.0, 6.0);
+    static_assert(a + b == Vector<3, double>(5.0, -3.0, 9.0), "add");
+    static_assert(a - b == Vector<3, double>(-3.0, 7.0, -3.0), "subtract");
+    static_assert(DotProduct(a, b) == 12.0, "dot product");
+    static_assert(CrossProduct(a, b) == Vector<3, double>(27.0, 6.0, -13.0), "cross product");
+    static_assert(a * 2.0 / 2.0 == a, "scale");
+    static_assert(Vector<5, int>(1, 2, 3, 4, 5).SquaredMagnitude() == 55, "array storage");
+
+    constexpr Matrix<3, 3, double> basis(Vector<3, double>(0.0, 1.0, 0.0), Vector<3, double>(-1.0, 0.0, 0.0), Vector<3, double>(0.0, 0.0, 1.0));
+    static_assert(basis * Transpose(basis) == Matrix<3, 3, double>::Identity(), "orthonormal basis");
+    static_assert(basis * Vector<3, double>(1.0, 0.0, 0.0) == Vector<3, double>(0.0, 1.0, 0.0), "row-vector transform");
+    static_assert(Determinant(basis) == 1.0, "3x3 determinant");
+    static_assert(Determinant(Matrix<4, 4, double>(2.0)) == 16.0, "4x4 determinant");
+    static_assert(Transpose(Matrix<2, 3, int>(Vector<3, int>(1, 2, 3), Vector<3, int>(4, 5, 6)))[2][1] == 6, "transpose");
+
+    constexpr Matrix<4, 4, double> projection = MakePerspective(PI / 2.0, 1.0, 0.1, 100.0);
+    static_assert(Abs(projection[1][1] - 1.0) < 1e-6, "perspective folds");
+    static_assert(MakeOrthographic(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f)[0][0] == 1.0f, "orthographic folds");
+
+    float MaxDifference(const Matrix44& x, const Matrix44& y)
+    {
+        float difference = 0.0f;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                difference = fmaxf(difference, fabsf(x[i][j] - y[i][j]));
+        return difference;
+    }
+
+    Matrix44 RandomMatrix()
+    {
+        Matrix44 m;
+        for (int i = 0; i < 4; ++i)
+            for (int j = 0; j < 4; ++j)
+                m[i][j] = Test::Random(-4.0f, 4.0f);
+        return m;
+    }
+}
+
+TEST_CASE(CoreMatchesFloatTypes)
+{
+    for (int n = 0; n < 100; ++n) {
+        Matrix44 x = RandomMatrix(), y = RandomMatrix();
+        Matrix<4, 4, float> cx = x, cy = y;
+
+        Matrix44 product = cx * cy;
+        CHECK(MaxDifference(product, MultiplyReference(x, y)) < 1e-4f);
+        CHECK_NEAR(Determinant(cx), x.Determinant(), 1e-2);
+
+        Vector4 v(Test::Random(), Test::Random(), Test::Random(), 1.0f);
+        Vector4 transformed = cx * Vector<4, float>(v);
+        Vector4 expected = TransformReference(x, v);
+        CHECK_NEAR(transformed.x, expected.x, 1e-4);
+        CHECK_NEAR(transformed.y, expected.y, 1e-4);
+        CHECK_NEAR(transformed.z, expected.z, 1e-4);
+
+        Vector3 p(Test::Random(), Test::Random(), Test::Random()), q(Test::Random(), Test::Random(), Test::Random());
+        Vector3 cross = CrossProduct(Vector<3, float>(p), Vector<3, float>(q));
+        CHECK(cross == CrossProduct(p, q));
+    }
+}
+
+TEST_CASE(CoreMakeProjectionMatchesRuntime)
+{
+    Matrix44 expected = Perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f);
+    Matrix44 folded = MakePerspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f);
+    CHECK(MaxDifference(expected, folded) < 1e-5f);
+
+    expected = Orthographic(-2.0f, 3.0f, -1.0f, 4.0f, 0.5f, 20.0f);
+    folded = MakeOrthographic(-2.0f, 3.0f, -1.0f, 4.0f, 0.5f, 20.0f);
+    CHECK(MaxDifference(expected, folded) == 0.0f);
+}
+
+TEST_CASE(CoreDoublePrecisionTemplates)
+{
+    // Quaternion<T> and Mat3x3<T> now work with double components.
+    Quaternion<double> q(0.5, Vector3D<double>(0.5, 0.5, 0.5));
+    Quaternion<double> identity;
+    identity.SetIdentity();
+    CHECK(q * identity == q);
+
+    Mat3x3<double> m(2.0);
+    Vector3D<double> v = m * Vector3D<double>(1.0, 2.0, 3.0);
+    CHECK(v == Vector3D<double>(2.0, 4.0, 6.0));
+
+    Vector3D<double> big(1e8, 0.0, 0.0);
+    CHECK((big + Vector3D<double>(1e-4, 0.0, 0.0)).x != big.x);
+}
+
+TEST_CASE(HalfConversions)
+{
+    CHECK(Half(1.0f).bits == 0x3c00);
+    CHECK(Half(-2.0f).bits == 0xc000);
+    CHECK(Half(65504.0f).bits == 0x7bff);
+    CHECK(Half(65520.0f).bits == 0x7c00);
+    CHECK(Half(5.9604645e-8f).bits == 0x0001);
+    CHECK(Half(1.0f + 1.0f / 2048.0f).bits == 0x3c00); // tie rounds to even
+    CHECK(Half(1.0f + 3.0f / 2048.0f).bits == 0x3c02);
+
+    for (int n = 0; n < 1000; ++n) {
+        float f = Test::Random(-1000.0f, 1000.0f);
+        float roundTrip = Half(f);
+        CHECK_NEAR(roundTrip, f, fabs(f) / 1024.0);
+    }
+
+    Vector<3, Half> h(1.5f, -2.0f, 0.25f);
+    Vector<3, Half> sum = h + h;
+    CHECK(float(sum.x) == 3.0f && float(sum.y) == -4.0f && float(sum.z) == 0.5f);
+    CHECK(sizeof(Vector<3, Half>) == 6);
+}